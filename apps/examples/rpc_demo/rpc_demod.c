@@ -123,11 +123,12 @@ static int handle_read(struct rpmsg_rpc_syscall *syscall,
 	payload = buf + sizeof(*resp);
 
 	/*
-	 * For STD_IN read up to the buf size. Otherwise read
-	 * only the size requested in in syscall->rgs.int_field2
+	 * Read only the size requested in syscall->args.int_field2, the
+	 * remote sizes it to what fits in its answer buffer and keeps
+	 * the bytes it did not consume yet for its next reads.
 	 */
 	bytes_read = sizeof(buf) - sizeof(*resp);
-	if (!syscall->args.int_field1 && syscall->args.int_field2 < bytes_read)
+	if (syscall->args.int_field2 < bytes_read)
 		bytes_read = syscall->args.int_field2;
 
 	bytes_read = read(syscall->args.int_field1, payload, bytes_read);
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <openamp/open_amp.h>
 #include <metal/alloc.h>
+#include <metal/time.h>
 #include "platform_info.h"
 #include "rpmsg-ping.h"
 
@@ -111,6 +112,7 @@ int app (struct rpmsg_device *rdev, void *priv)
 	int ret;
 	int i, s, max_size;
 	int num_pkgs;
+	unsigned long long start, elapsed;
 
 	LPRINTF(" 1 - Send data to remote core, retrieve the echo");
 	LPRINTF(" and validate its integrity ..\r\n");
@@ -152,6 +154,7 @@ int app (struct rpmsg_device *rdev, void *priv)
 		LPRINTF("echo test: package size %d, num of packages: %d\r\n",
 			size, num_pkgs);
 		rnum = 0;
+		start = metal_get_timestamp();
 		for (i = 0; i < num_pkgs; i++) {
 			i_payload->num = i;
 			while (!err_cnt && !ept_deleted) {
@@ -175,6 +178,14 @@ int app (struct rpmsg_device *rdev, void *priv)
 
 		if (err_cnt || ept_deleted)
 			break;
+
+		/*
+		 * Time per message in metal_get_timestamp() units, the
+		 * sends overlapping the echoes
+		 */
+		elapsed = metal_get_timestamp() - start;
+		LPRINTF("echo test: package size %d, %llu per message\r\n",
+			size, elapsed / num_pkgs);
 	}
 
 	if (ept_deleted)
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the remote processor virtio device setup.
+ *
+ * N simulated remote cores, each a thread setting DRIVER_OK in its
+ * resource table some time after it is started, are brought up once with
+ * remoteproc_create_virtio() one after the other, then with
+ * remoteproc_create_virtio_async() driven from a single notification
+ * loop. The cost of remoteproc_get_notification() is then measured with
+ * all the devices up, and with one device still waiting for its remote.
+ *
+ * Usage: rproc-async-bench [cores] [remote boot time in us]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <metal/atomic.h>
+#include <metal/io.h>
+#include <metal/sleep.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/remoteproc.h>
+#include <openamp/remoteproc_virtio.h>
+
+#define MAX_CORES	64
+#define SHM_SIZE	0x10000
+#define SHM_PA(i)	(0x100000UL * ((i) + 1))
+#define VRING_NUM	16
+#define VRING_ALIGN	16
+#define NOTIFY_LOOPS	1000000
+
+METAL_PACKED_BEGIN
+struct bench_rsc_table {
+	unsigned int version;
+	unsigned int num;
+	unsigned int reserved[2];
+	unsigned int offset[1];
+	struct fw_rsc_vdev vdev;
+	struct fw_rsc_vdev_vring vring[2];
+} METAL_PACKED_END;
+
+struct bench_core {
+	struct remoteproc rproc;
+	struct remoteproc_mem mem;
+	struct metal_io_region io;
+	metal_phys_addr_t pa;
+	void *shm;
+	struct bench_rsc_table *rsc;
+	struct virtio_device *vdev;
+	pthread_t thread;
+	int started;
+	atomic_int kick;
+	int ready;
+};
+
+static struct bench_core cores[MAX_CORES + 1];
+static unsigned int boot_us = 20000;
+static int num_ready;
+
+/* Remote side: boot, publish DRIVER_OK, then notify the host */
+static void *bench_remote(void *arg)
+{
+	struct bench_core *core = arg;
+
+	metal_sleep_usec(boot_us);
+	core->rsc->vdev.status = VIRTIO_CONFIG_STATUS_DRIVER_OK;
+	atomic_store(&core->kick, 1);
+	return NULL;
+}
+
+static struct remoteproc *bench_init(struct remoteproc *rproc,
+				     const struct remoteproc_ops *ops,
+				     void *arg)
+{
+	rproc->ops = ops;
+	rproc->priv = arg;
+	return rproc;
+}
+
+static void bench_remove(struct remoteproc *rproc)
+{
+	(void)rproc;
+}
+
+static int bench_start(struct remoteproc *rproc)
+{
+	struct bench_core *core = rproc->priv;
+
+	if (pthread_create(&core->thread, NULL, bench_remote, core))
+		return -1;
+	core->started = 1;
+	return 0;
+}
+
+static int bench_stop(struct remoteproc *rproc)
+{
+	struct bench_core *core = rproc->priv;
+
+	if (!core->started)
+		return 0;
+	core->started = 0;
+	return pthread_join(core->thread, NULL);
+}
+
+static const struct remoteproc_ops bench_ops = {
+	.init = bench_init,
+	.remove = bench_remove,
+	.start = bench_start,
+	.stop = bench_stop,
+};
+
+static int bench_setup(int i)
+{
+	struct bench_core *core = &cores[i];
+	struct bench_rsc_table *rsc;
+	int k;
+
+	memset(core, 0, sizeof(*core));
+	core->shm = calloc(1, SHM_SIZE);
+	if (!core->shm)
+		return -1;
+	core->pa = SHM_PA(i);
+	metal_io_init(&core->io, core->shm, &core->pa, SHM_SIZE, -1, 0, NULL);
+	if (!remoteproc_init(&core->rproc, &bench_ops, core))
+		return -1;
+	remoteproc_init_mem(&core->mem, "shm", core->pa, core->pa, SHM_SIZE,
+			    &core->io);
+	remoteproc_add_mem(&core->rproc, &core->mem);
+
+	rsc = core->shm;
+	rsc->version = 1;
+	rsc->num = 1;
+	rsc->offset[0] = offsetof(struct bench_rsc_table, vdev);
+	rsc->vdev.type = RSC_VDEV;
+	rsc->vdev.id = VIRTIO_ID_RPMSG;
+	rsc->vdev.num_of_vrings = 2;
+	for (k = 0; k < 2; k++) {
+		rsc->vring[k].da = core->pa + 0x1000 + k * 0x4000;
+		rsc->vring[k].align = VRING_ALIGN;
+		rsc->vring[k].num = VRING_NUM;
+		rsc->vring[k].notifyid = k + 1;
+	}
+	core->rsc = rsc;
+
+	if (remoteproc_config(&core->rproc, NULL))
+		return -1;
+	return remoteproc_set_rsc_table(&core->rproc, (void *)rsc,
+					sizeof(*rsc));
+}
+
+static void bench_teardown(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (cores[i].vdev)
+			remoteproc_remove_virtio(&cores[i].rproc,
+						 cores[i].vdev);
+		remoteproc_shutdown(&cores[i].rproc);
+		remoteproc_remove(&cores[i].rproc);
+		free(cores[i].shm);
+	}
+}
+
+static void bench_ready(struct remoteproc *rproc, struct virtio_device *vdev,
+			int status)
+{
+	struct bench_core *core = rproc->priv;
+
+	(void)vdev;
+	if (!status) {
+		core->ready = 1;
+		num_ready++;
+	}
+}
+
+static unsigned long long bench_notify(struct bench_core *core, int loops)
+{
+	unsigned long long start;
+	int i;
+
+	start = metal_get_timestamp();
+	for (i = 0; i < loops; i++)
+		remoteproc_get_notification(&core->rproc,
+					    core->vdev->notifyid);
+	return (metal_get_timestamp() - start) / loops;
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	unsigned long long start, blocking, async;
+	struct bench_core *idle;
+	int n = 8;
+	int i;
+
+	if (argc > 1)
+		n = atoi(argv[1]);
+	if (argc > 2)
+		boot_us = atoi(argv[2]);
+	if (n < 1 || n > MAX_CORES) {
+		printf("cores must be between 1 and %d\r\n", MAX_CORES);
+		return -1;
+	}
+	metal_init(&metal_param);
+
+	for (i = 0; i < n; i++)
+		if (bench_setup(i))
+			goto err;
+	start = metal_get_timestamp();
+	for (i = 0; i < n; i++) {
+		remoteproc_start(&cores[i].rproc);
+		cores[i].vdev = remoteproc_create_virtio(&cores[i].rproc, 0,
+							 VIRTIO_DEV_DEVICE,
+							 NULL);
+		if (!cores[i].vdev)
+			goto err;
+	}
+	blocking = metal_get_timestamp() - start;
+	bench_teardown(n);
+
+	for (i = 0; i < n; i++)
+		if (bench_setup(i))
+			goto err;
+	num_ready = 0;
+	start = metal_get_timestamp();
+	for (i = 0; i < n; i++) {
+		remoteproc_start(&cores[i].rproc);
+		cores[i].vdev =
+			remoteproc_create_virtio_async(&cores[i].rproc, 0,
+						       VIRTIO_DEV_DEVICE, NULL,
+						       bench_ready);
+		if (!cores[i].vdev)
+			goto err;
+	}
+	while (num_ready < n) {
+		for (i = 0; i < n; i++)
+			if (atomic_exchange(&cores[i].kick, 0))
+				bench_notify(&cores[i], 1);
+	}
+	async = metal_get_timestamp() - start;
+
+	printf("%d cores, remote boot %u us\r\n", n, boot_us);
+	printf("blocking setup: %llu us\r\n", blocking / 1000);
+	printf("async setup: %llu us\r\n", async / 1000);
+	printf("notification, all devices ready: %llu ns\r\n",
+	       bench_notify(&cores[0], NOTIFY_LOOPS));
+
+	/* A core never started keeps its device waiting for the remote */
+	idle = &cores[n];
+	if (bench_setup(n))
+		goto err;
+	idle->vdev = remoteproc_create_virtio_async(&idle->rproc, 0,
+						    VIRTIO_DEV_DEVICE, NULL,
+						    bench_ready);
+	if (!idle->vdev)
+		goto err;
+	printf("notification, one device waiting: %llu ns\r\n",
+	       bench_notify(idle, NOTIFY_LOOPS));
+	bench_teardown(n + 1);
+
+	metal_finish();
+	return 0;
+
+err:
+	printf("remoteproc setup failed\r\n");
+	metal_finish();
+	return -1;
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the remote processor boot time, raw versus compressed
+ * image.
+ *
+ * Both images are read from a simulated flash store: the file is held in
+ * memory and every read from it is delayed as if the flash delivered the
+ * given number of KiB per second. The raw image is loaded to target memory
+ * and the remote started, then the same is done with the compressed image
+ * (made by scripts/rproc_compress.py from the raw image) through the
+ * compressed image store. Both loads must leave the same target memory.
+ * The compressed image is then booted again with elf_symtab_ops, which
+ * also loads the ELF symbol table with the headers, and the given symbol
+ * must be found. A symbol table over a block long straddles blocks and is
+ * assembled from them.
+ *
+ * Usage: rproc-boot-bench <raw image> <compressed image> [flash KiB/s]
+ *                         [target address] [target size] [symbol]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <metal/io.h>
+#include <metal/sleep.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/compressed_image_store.h>
+#include <openamp/elf_loader.h>
+#include <openamp/remoteproc.h>
+
+#define DEFAULT_FLASH_KBPS	20000
+#define DEFAULT_TARGET_SIZE	0x1000000UL
+#define DEFAULT_SYMBOL		"_start"
+
+struct bench_flash {
+	unsigned char *data;
+	size_t size;
+	unsigned long kbps;
+	/* Flash read time not slept yet, in ns */
+	unsigned long long owed_ns;
+	size_t bytes_read;
+};
+
+static unsigned char *target;
+static unsigned long target_size = DEFAULT_TARGET_SIZE;
+static metal_phys_addr_t target_pa;
+static const char *symbol = DEFAULT_SYMBOL;
+
+/* Sleep for the time the flash would have taken to deliver len bytes */
+static void bench_flash_read(struct bench_flash *flash, size_t len)
+{
+	flash->bytes_read += len;
+	flash->owed_ns += (unsigned long long)len * 1000000000ULL /
+			  (flash->kbps * 1024);
+	if (flash->owed_ns >= 1000) {
+		metal_sleep_usec(flash->owed_ns / 1000);
+		flash->owed_ns %= 1000;
+	}
+}
+
+static int bench_flash_open(void *store, const char *path,
+			    const void **img_data)
+{
+	struct bench_flash *flash = store;
+
+	(void)path;
+	flash->bytes_read = 0;
+	flash->owed_ns = 0;
+	/* Hand the ELF header over, as a flash store reading a page would */
+	bench_flash_read(flash, flash->size < 0x100 ? flash->size : 0x100);
+	*img_data = flash->data;
+	return flash->size < 0x100 ? (int)flash->size : 0x100;
+}
+
+static void bench_flash_close(void *store)
+{
+	(void)store;
+}
+
+static int bench_flash_load(void *store, size_t offset, size_t size,
+			    const void **data, metal_phys_addr_t pa,
+			    struct metal_io_region *io, char is_blocking)
+{
+	struct bench_flash *flash = store;
+
+	(void)is_blocking;
+	if (offset > flash->size || size > flash->size - offset)
+		return -1;
+	bench_flash_read(flash, size);
+	if (pa == RPROC_LOAD_ANYADDR) {
+		*data = flash->data + offset;
+		return (int)size;
+	}
+	return metal_io_block_write(io, metal_io_phys_to_offset(io, pa),
+				    flash->data + offset, size);
+}
+
+static const struct image_store_ops bench_flash_ops = {
+	.open = bench_flash_open,
+	.close = bench_flash_close,
+	.load = bench_flash_load,
+	.features = SUPPORT_SEEK,
+};
+
+static struct remoteproc *bench_init(struct remoteproc *rproc,
+				     const struct remoteproc_ops *ops,
+				     void *arg)
+{
+	rproc->ops = ops;
+	rproc->priv = arg;
+	return rproc;
+}
+
+static void bench_remove(struct remoteproc *rproc)
+{
+	(void)rproc;
+}
+
+static int bench_start(struct remoteproc *rproc)
+{
+	(void)rproc;
+	return 0;
+}
+
+static int bench_stop(struct remoteproc *rproc)
+{
+	(void)rproc;
+	return 0;
+}
+
+static const struct remoteproc_ops bench_ops = {
+	.init = bench_init,
+	.remove = bench_remove,
+	.start = bench_start,
+	.stop = bench_stop,
+};
+
+static int bench_read_file(const char *path, struct bench_flash *flash)
+{
+	FILE *file;
+	long size;
+
+	file = fopen(path, "rb");
+	if (!file)
+		return -1;
+	if (fseek(file, 0, SEEK_END) || (size = ftell(file)) <= 0 ||
+	    fseek(file, 0, SEEK_SET)) {
+		fclose(file);
+		return -1;
+	}
+	flash->size = size;
+	flash->data = malloc(size);
+	if (!flash->data || fread(flash->data, 1, size, file) != flash->size) {
+		fclose(file);
+		return -1;
+	}
+	fclose(file);
+	return 0;
+}
+
+/*
+ * Load the image and start the remote, returns the time taken in ns. With
+ * sym_da, the symbol table is loaded too and the symbol looked up.
+ */
+static long long bench_boot(struct bench_flash *flash, bool compressed,
+			    metal_phys_addr_t *sym_da)
+{
+	struct compressed_image_store zs = {
+		.store = flash,
+		.ops = &bench_flash_ops,
+	};
+	struct remoteproc rproc;
+	struct remoteproc_mem mem;
+	struct metal_io_region io;
+	unsigned long long start, end;
+	void *img_info = NULL;
+	size_t sym_size;
+	int ret;
+
+	memset(target, 0, target_size);
+	metal_io_init(&io, target, &target_pa, target_size, -1, 0, NULL);
+	if (!remoteproc_init(&rproc, &bench_ops, NULL))
+		return -1;
+	remoteproc_init_mem(&mem, "target", target_pa, target_pa, target_size,
+			    &io);
+	remoteproc_add_mem(&rproc, &mem);
+	if (remoteproc_config(&rproc, NULL))
+		return -1;
+	if (sym_da)
+		rproc.loader = &elf_symtab_ops;
+
+	start = metal_get_timestamp();
+	if (compressed)
+		ret = remoteproc_load(&rproc, NULL, &zs,
+				      &compressed_image_store_ops,
+				      sym_da ? &img_info : NULL);
+	else
+		ret = remoteproc_load(&rproc, NULL, flash, &bench_flash_ops,
+				      sym_da ? &img_info : NULL);
+	if (!ret)
+		ret = remoteproc_start(&rproc);
+	end = metal_get_timestamp();
+
+	if (!ret && sym_da)
+		ret = rproc.loader->locate_symbol(img_info, symbol, sym_da,
+						  &sym_size);
+	if (img_info)
+		rproc.loader->release(img_info);
+
+	remoteproc_shutdown(&rproc);
+	remoteproc_remove(&rproc);
+	return ret ? -1 : (long long)(end - start);
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	struct bench_flash raw = { 0 }, packed = { 0 };
+	unsigned long kbps = DEFAULT_FLASH_KBPS;
+	long long raw_ns, packed_ns, sym_ns;
+	metal_phys_addr_t sym_da = 0;
+	unsigned char *ref = NULL;
+	int ret = -1;
+
+	if (argc < 3) {
+		printf("usage: %s <raw image> <compressed image> [flash KiB/s] [target address] [target size] [symbol]\r\n",
+		       argv[0]);
+		return -1;
+	}
+	if (argc > 3)
+		kbps = strtoul(argv[3], NULL, 0);
+	if (argc > 4)
+		target_pa = strtoull(argv[4], NULL, 0);
+	if (argc > 5)
+		target_size = strtoul(argv[5], NULL, 0);
+	if (argc > 6)
+		symbol = argv[6];
+	if (!kbps || !target_size) {
+		printf("flash speed and target size must not be 0\r\n");
+		return -1;
+	}
+	metal_init(&metal_param);
+
+	if (bench_read_file(argv[1], &raw) ||
+	    bench_read_file(argv[2], &packed)) {
+		printf("failed to read the images\r\n");
+		goto out;
+	}
+	raw.kbps = kbps;
+	packed.kbps = kbps;
+	target = malloc(target_size);
+	ref = malloc(target_size);
+	if (!target || !ref)
+		goto out;
+
+	raw_ns = bench_boot(&raw, false, NULL);
+	memcpy(ref, target, target_size);
+	packed_ns = bench_boot(&packed, true, NULL);
+	if (raw_ns < 0 || packed_ns < 0) {
+		printf("boot failed\r\n");
+		goto out;
+	}
+	if (memcmp(ref, target, target_size)) {
+		printf("target memory differs between the two images\r\n");
+		goto out;
+	}
+	sym_ns = bench_boot(&packed, true, &sym_da);
+	if (sym_ns < 0) {
+		printf("boot with symbols failed or %s not found\r\n", symbol);
+		goto out;
+	}
+
+	printf("flash %lu KiB/s\r\n", kbps);
+	printf("raw image: %zu bytes read, boot %lld us\r\n",
+	       raw.bytes_read, raw_ns / 1000);
+	printf("compressed image: %zu bytes read, boot %lld us\r\n",
+	       packed.bytes_read, packed_ns / 1000);
+	printf("compressed image with symbols: %zu bytes read, boot %lld us, %s at 0x%llx\r\n",
+	       packed.bytes_read, sym_ns / 1000, symbol,
+	       (unsigned long long)sym_da);
+	ret = 0;
+
+out:
+	free(ref);
+	free(target);
+	free(packed.data);
+	free(raw.data);
+	metal_finish();
+	return ret;
+}
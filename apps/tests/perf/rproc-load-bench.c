@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the remote processor image load, blocking versus
+ * non-blocking image store.
+ *
+ * The image is loaded to target memory from a file with
+ * mmap_image_store_ops, which copies each segment before the loader goes
+ * on, then with mmap_image_store_async_ops, whose worker thread copies a
+ * segment while the loader clears its BSS and issues the next one. Both
+ * loads must leave the same target memory. The gain is largest for images
+ * with several large segments and a large BSS.
+ *
+ * Usage: rproc-load-bench <image> [loops] [target address] [target size]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <metal/io.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/mmap_image_store.h>
+#include <openamp/remoteproc.h>
+
+#define DEFAULT_LOOPS		20
+#define DEFAULT_TARGET_SIZE	0x1000000UL
+
+static unsigned char *target;
+static unsigned long target_size = DEFAULT_TARGET_SIZE;
+static metal_phys_addr_t target_pa;
+
+static struct remoteproc *bench_init(struct remoteproc *rproc,
+				     const struct remoteproc_ops *ops,
+				     void *arg)
+{
+	rproc->ops = ops;
+	rproc->priv = arg;
+	return rproc;
+}
+
+static void bench_remove(struct remoteproc *rproc)
+{
+	(void)rproc;
+}
+
+static const struct remoteproc_ops bench_ops = {
+	.init = bench_init,
+	.remove = bench_remove,
+};
+
+/* Load the image, returns the time taken in ns */
+static long long bench_load(const char *path,
+			    const struct image_store_ops *store_ops)
+{
+	struct mmap_image_store store = { .fd = -1 };
+	struct remoteproc rproc;
+	struct remoteproc_mem mem;
+	struct metal_io_region io;
+	unsigned long long start, end;
+	int ret;
+
+	/* Dirty the target so that the BSS clearing is really done */
+	memset(target, 0xa5, target_size);
+	metal_io_init(&io, target, &target_pa, target_size, -1, 0, NULL);
+	if (!remoteproc_init(&rproc, &bench_ops, NULL))
+		return -1;
+	remoteproc_init_mem(&mem, "target", target_pa, target_pa, target_size,
+			    &io);
+	remoteproc_add_mem(&rproc, &mem);
+	if (remoteproc_config(&rproc, NULL))
+		return -1;
+
+	start = metal_get_timestamp();
+	ret = remoteproc_load(&rproc, path, &store, store_ops, NULL);
+	end = metal_get_timestamp();
+
+	remoteproc_remove(&rproc);
+	return ret ? -1 : (long long)(end - start);
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	long long blocking = 0, async = 0, ns;
+	unsigned long loops = DEFAULT_LOOPS, i;
+	unsigned char *ref = NULL;
+	int ret = -1;
+
+	if (argc < 2) {
+		printf("usage: %s <image> [loops] [target address] [target size]\r\n",
+		       argv[0]);
+		return -1;
+	}
+	if (argc > 2)
+		loops = strtoul(argv[2], NULL, 0);
+	if (argc > 3)
+		target_pa = strtoull(argv[3], NULL, 0);
+	if (argc > 4)
+		target_size = strtoul(argv[4], NULL, 0);
+	if (!loops || !target_size) {
+		printf("loops and target size must not be 0\r\n");
+		return -1;
+	}
+	metal_init(&metal_param);
+
+	target = malloc(target_size);
+	ref = malloc(target_size);
+	if (!target || !ref)
+		goto out;
+
+	/* Alternate the stores so that both see the same page cache */
+	for (i = 0; i < loops; i++) {
+		ns = bench_load(argv[1], &mmap_image_store_ops);
+		if (ns < 0)
+			goto fail;
+		blocking += ns;
+		memcpy(ref, target, target_size);
+		ns = bench_load(argv[1], &mmap_image_store_async_ops);
+		if (ns < 0)
+			goto fail;
+		async += ns;
+		if (memcmp(ref, target, target_size)) {
+			printf("target memory differs between the two stores\r\n");
+			goto out;
+		}
+	}
+
+	printf("%lu loads of %s\r\n", loops, argv[1]);
+	printf("blocking store: %lld us\r\n", blocking / (long long)loops / 1000);
+	printf("non-blocking store: %lld us\r\n", async / (long long)loops / 1000);
+	ret = 0;
+	goto out;
+
+fail:
+	printf("load failed\r\n");
+out:
+	free(ref);
+	free(target);
+	metal_finish();
+	return ret;
+}
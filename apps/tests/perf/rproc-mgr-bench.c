@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host benchmark of the remoteproc manager.
+ *
+ * N simulated remote cores, each a thread setting DRIVER_OK in its
+ * resource table some time after it is started, are brought up once one
+ * after the other with remoteproc_create_virtio(), then all together with
+ * remoteproc_mgr_start() and remoteproc_mgr_create_virtio() driven from
+ * one remoteproc_mgr_poll() loop. Once ready, every remote posts messages
+ * and notifies the manager for each; the loop accounts them with
+ * remoteproc_mgr_count_rx(). The statistics are checked against what the
+ * remotes did, and the cost of an idle poll and of a notification
+ * dispatch is measured.
+ *
+ * Usage: rproc-mgr-bench [cores] [remote boot time in us] [messages]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <metal/atomic.h>
+#include <metal/io.h>
+#include <metal/sleep.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/remoteproc.h>
+#include <openamp/remoteproc_manager.h>
+#include <openamp/remoteproc_virtio.h>
+
+#define MAX_CORES	64
+#define SHM_SIZE	0x10000
+#define SHM_PA(i)	(0x100000UL * ((i) + 1))
+#define VRING_NUM	16
+#define VRING_ALIGN	16
+#define MSG_LEN		64
+#define POLL_LOOPS	1000000
+
+METAL_PACKED_BEGIN
+struct bench_rsc_table {
+	unsigned int version;
+	unsigned int num;
+	unsigned int reserved[2];
+	unsigned int offset[1];
+	struct fw_rsc_vdev vdev;
+	struct fw_rsc_vdev_vring vring[2];
+} METAL_PACKED_END;
+
+struct bench_core {
+	struct remoteproc_mgr_entry entry;
+	struct remoteproc_mem mem;
+	struct metal_io_region io;
+	metal_phys_addr_t pa;
+	void *shm;
+	struct bench_rsc_table *rsc;
+	struct virtio_device *vdev;
+	pthread_t thread;
+	int started;
+	/* Messages posted by the remote and not accounted yet */
+	atomic_ulong posted;
+};
+
+static struct bench_core cores[MAX_CORES];
+static struct remoteproc_mgr mgr;
+static unsigned int boot_us = 20000;
+static unsigned long msgs = 10000;
+static int num_ready;
+/* Set once all the remotes are ready, so that they send together */
+static atomic_int go;
+
+/* Remote side: boot, publish DRIVER_OK, then post its messages */
+static void *bench_remote(void *arg)
+{
+	struct bench_core *core = arg;
+	unsigned long i;
+
+	metal_sleep_usec(boot_us);
+	core->rsc->vdev.status = VIRTIO_CONFIG_STATUS_DRIVER_OK;
+	remoteproc_mgr_notify(&core->entry);
+	while (!atomic_load(&go))
+		metal_sleep_usec(10);
+	for (i = 0; i < msgs; i++) {
+		atomic_fetch_add(&core->posted, 1);
+		remoteproc_mgr_notify(&core->entry);
+	}
+	return NULL;
+}
+
+static struct remoteproc *bench_init(struct remoteproc *rproc,
+				     const struct remoteproc_ops *ops,
+				     void *arg)
+{
+	rproc->ops = ops;
+	rproc->priv = arg;
+	return rproc;
+}
+
+static void bench_remove(struct remoteproc *rproc)
+{
+	(void)rproc;
+}
+
+static int bench_start(struct remoteproc *rproc)
+{
+	struct bench_core *core = rproc->priv;
+
+	if (pthread_create(&core->thread, NULL, bench_remote, core))
+		return -1;
+	core->started = 1;
+	return 0;
+}
+
+static int bench_stop(struct remoteproc *rproc)
+{
+	struct bench_core *core = rproc->priv;
+
+	if (!core->started)
+		return 0;
+	core->started = 0;
+	return pthread_join(core->thread, NULL);
+}
+
+static const struct remoteproc_ops bench_ops = {
+	.init = bench_init,
+	.remove = bench_remove,
+	.start = bench_start,
+	.stop = bench_stop,
+};
+
+static int bench_setup(int i)
+{
+	struct bench_core *core = &cores[i];
+	struct remoteproc *rproc;
+	struct bench_rsc_table *rsc;
+	int k;
+
+	memset(core, 0, sizeof(*core));
+	core->shm = calloc(1, SHM_SIZE);
+	if (!core->shm)
+		return -1;
+	core->pa = SHM_PA(i);
+	metal_io_init(&core->io, core->shm, &core->pa, SHM_SIZE, -1, 0, NULL);
+	rproc = remoteproc_mgr_add(&mgr, &core->entry, &bench_ops, core);
+	if (!rproc)
+		return -1;
+	remoteproc_init_mem(&core->mem, "shm", core->pa, core->pa, SHM_SIZE,
+			    &core->io);
+	remoteproc_add_mem(rproc, &core->mem);
+
+	rsc = core->shm;
+	rsc->version = 1;
+	rsc->num = 1;
+	rsc->offset[0] = offsetof(struct bench_rsc_table, vdev);
+	rsc->vdev.type = RSC_VDEV;
+	rsc->vdev.id = VIRTIO_ID_RPMSG;
+	rsc->vdev.num_of_vrings = 2;
+	for (k = 0; k < 2; k++) {
+		rsc->vring[k].da = core->pa + 0x1000 + k * 0x4000;
+		rsc->vring[k].align = VRING_ALIGN;
+		rsc->vring[k].num = VRING_NUM;
+		rsc->vring[k].notifyid = k + 1;
+	}
+	core->rsc = rsc;
+
+	if (remoteproc_config(rproc, NULL))
+		return -1;
+	return remoteproc_set_rsc_table(rproc, (void *)rsc, sizeof(*rsc));
+}
+
+static int bench_teardown(int n)
+{
+	struct remoteproc *rproc;
+	int i, ret = 0;
+
+	for (i = 0; i < n; i++) {
+		rproc = &cores[i].entry.rproc;
+		if (cores[i].vdev)
+			remoteproc_remove_virtio(rproc, cores[i].vdev);
+		remoteproc_shutdown(rproc);
+		if (remoteproc_mgr_remove(&cores[i].entry))
+			ret = -1;
+		free(cores[i].shm);
+	}
+	return ret;
+}
+
+static void bench_ready(struct remoteproc_mgr_entry *entry,
+			struct virtio_device *vdev, int status)
+{
+	(void)entry;
+	(void)vdev;
+	if (!status)
+		num_ready++;
+}
+
+/* Account the messages posted by the remotes since the last call */
+static unsigned long bench_receive(int n)
+{
+	unsigned long posted, total = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		posted = atomic_exchange(&cores[i].posted, 0);
+		total += posted;
+		while (posted--)
+			remoteproc_mgr_count_rx(&cores[i].entry, MSG_LEN);
+	}
+	return total;
+}
+
+static int bench_check(const char *what, unsigned long long got,
+		       unsigned long long expected)
+{
+	if (got == expected)
+		return 0;
+	printf("%s: %llu, expected %llu\r\n", what, got, expected);
+	return -1;
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	unsigned long long start, sequential, managed, rx_time, poll_ns;
+	unsigned long long dispatch_ns;
+	struct remoteproc_mgr_stats stats;
+	unsigned long received = 0, posted;
+	int n = 8;
+	int i, err = 0;
+
+	if (argc > 1)
+		n = atoi(argv[1]);
+	if (argc > 2)
+		boot_us = atoi(argv[2]);
+	if (argc > 3)
+		msgs = strtoul(argv[3], NULL, 0);
+	if (n < 1 || n > MAX_CORES) {
+		printf("cores must be between 1 and %d\r\n", MAX_CORES);
+		return -1;
+	}
+	metal_init(&metal_param);
+	remoteproc_mgr_init(&mgr, NULL, bench_ready);
+
+	/* One after the other, each create waits for its remote */
+	atomic_store(&go, 1);
+	for (i = 0; i < n; i++)
+		if (bench_setup(i))
+			goto err;
+	start = metal_get_timestamp();
+	for (i = 0; i < n; i++) {
+		remoteproc_start(&cores[i].entry.rproc);
+		cores[i].vdev =
+			remoteproc_create_virtio(&cores[i].entry.rproc, 0,
+						 VIRTIO_DEV_DEVICE, NULL);
+		if (!cores[i].vdev)
+			goto err;
+	}
+	sequential = metal_get_timestamp() - start;
+	if (bench_teardown(n))
+		goto err;
+
+	/* All together with the manager */
+	atomic_store(&go, 0);
+	for (i = 0; i < n; i++)
+		if (bench_setup(i))
+			goto err;
+	num_ready = 0;
+	start = metal_get_timestamp();
+	if (remoteproc_mgr_start(&mgr) != n)
+		goto err;
+	for (i = 0; i < n; i++) {
+		cores[i].vdev = remoteproc_mgr_create_virtio(&cores[i].entry, 0,
+							     VIRTIO_DEV_DEVICE,
+							     NULL);
+		if (!cores[i].vdev)
+			goto err;
+	}
+	while (num_ready < n) {
+		if (!remoteproc_mgr_poll(&mgr))
+			metal_sleep_usec(50);
+	}
+	managed = metal_get_timestamp() - start;
+
+	/*
+	 * Traffic from all the remotes, accounted from the poll loop. A
+	 * notification may be dispatched before the message it announces is
+	 * collected, so the messages are collected on every pass.
+	 */
+	start = metal_get_timestamp();
+	atomic_store(&go, 1);
+	while (received < n * msgs) {
+		remoteproc_mgr_poll(&mgr);
+		posted = bench_receive(n);
+		received += posted;
+		if (!posted)
+			metal_sleep_usec(50);
+	}
+	rx_time = metal_get_timestamp() - start;
+
+	remoteproc_mgr_get_stats(&mgr, &stats);
+	err |= bench_check("managed", stats.num, n);
+	err |= bench_check("running", stats.states[RPROC_RUNNING], n);
+	err |= bench_check("ready", stats.ready, n);
+	err |= bench_check("errors", stats.errors, 0);
+	err |= bench_check("received messages", stats.rx_msgs,
+			   (unsigned long long)n * msgs);
+	err |= bench_check("received bytes", stats.rx_bytes,
+			   (unsigned long long)n * msgs * MSG_LEN);
+	if (!stats.notifications || stats.max_boot_time > managed) {
+		printf("notifications %llu, longest boot %llu ns\r\n",
+		       stats.notifications, stats.max_boot_time);
+		err = -1;
+	}
+
+	/* Stop the remotes first, so that the loop is idle */
+	for (i = 0; i < n; i++)
+		bench_stop(&cores[i].entry.rproc);
+	while (remoteproc_mgr_poll(&mgr))
+		;
+	start = metal_get_timestamp();
+	for (i = 0; i < POLL_LOOPS; i++)
+		err |= remoteproc_mgr_poll(&mgr);
+	poll_ns = (metal_get_timestamp() - start) / POLL_LOOPS;
+	start = metal_get_timestamp();
+	for (i = 0; i < POLL_LOOPS; i++) {
+		remoteproc_mgr_notify(&cores[i % n].entry);
+		remoteproc_mgr_poll(&mgr);
+	}
+	dispatch_ns = (metal_get_timestamp() - start) / POLL_LOOPS;
+
+	printf("%d cores, remote boot %u us, %lu messages of %d bytes each\r\n",
+	       n, boot_us, msgs, MSG_LEN);
+	printf("sequential bring-up: %llu us\r\n", sequential / 1000);
+	printf("manager bring-up: %llu us, longest boot %llu us\r\n",
+	       managed / 1000, stats.max_boot_time / 1000);
+	printf("received: %llu messages, %llu bytes in %llu us\r\n",
+	       stats.rx_msgs, stats.rx_bytes, rx_time / 1000);
+	printf("idle poll: %llu ns, notify and dispatch: %llu ns\r\n",
+	       poll_ns, dispatch_ns);
+
+	if (bench_teardown(n))
+		goto err;
+	remoteproc_mgr_get_stats(&mgr, &stats);
+	err |= bench_check("managed after removal", stats.num, 0);
+	printf("checks %s\r\n", err ? "failed" : "passed");
+	metal_finish();
+	return err ? -1 : 0;
+
+err:
+	printf("remoteproc setup failed\r\n");
+	metal_finish();
+	return -1;
+}
@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Loopback of the virtio front ends against the emulated virtio-mmio
+ * device, in one process.
+ *
+ * For each device a struct virtio_mmio_dev runs the register file, its io
+ * region is the cfg_io of a virtio-mmio driver and its interrupt callback
+ * calls virtio_mmio_isr(): both ends use the same ring code, the driver in
+ * the VIRTIO_DEV_DRIVER role and the device in the VIRTIO_DEV_DEVICE role.
+ *
+ * - virtio_blk is served by virtio_blk_file from a temporary file. Data is
+ *   written and read back, flushed, and the device ID is read, then 4 KiB
+ *   reads are issued one at a time and in batches.
+ * - virtio_net is looped back by virtio_net_dev. Frames sent are received
+ *   intact, one at a time and in batches, for small and full size frames.
+ * - virtio_console writes lines on the virtqueues of the emulated device,
+ *   the virtio_console_reader on the driver side reads them back.
+ *
+ * Every part checks the data it got back and reports its throughput.
+ *
+ * Usage: virtio-loopback-bench [iterations]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <metal/alloc.h>
+#include <metal/io.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/virtio.h>
+#include <openamp/virtio_blk.h>
+#include <openamp/virtio_blk_file.h>
+#include <openamp/virtio_console.h>
+#include <openamp/virtio_mmio.h>
+#include <openamp/virtio_mmio_dev.h>
+#include <openamp/virtio_net.h>
+#include <openamp/virtio_net_dev.h>
+
+#define LOOP_SHM_PA		0x80000000UL
+#define LOOP_SHM_SIZE		0x200000
+#define LOOP_VRING_SIZE		0x8000
+#define LOOP_BUF_OFF		0x20000
+#define LOOP_MAX_QUEUES		2
+#define LOOP_VRING_NUM		256
+
+#define BLK_FILE_SIZE		(16 << 20)
+#define BLK_BATCH		16
+#define BLK_IO_SIZE		4096
+
+#define NET_BUF_SIZE		2048
+#define NET_RX_NUM		128
+#define NET_TX_NUM		64
+#define NET_BATCH		32
+
+#define CON_RING_SIZE		4096
+#define CON_BUF_NUM		32
+#define CON_BUF_SIZE		256
+
+/* One driver and its emulated device, sharing one memory */
+struct loop {
+	struct virtio_mmio_dev dev;
+	struct virtio_mmio_dev_queue queues[LOOP_MAX_QUEUES];
+	struct virtio_mmio_device drv;
+	struct virtqueue *vqs[LOOP_MAX_QUEUES];
+	unsigned int num_queues;
+	struct metal_io_region shm_io;
+	metal_phys_addr_t shm_pa;
+	unsigned char *shm;
+};
+
+static unsigned char pattern[BLK_IO_SIZE * 2];
+static int errors;
+
+static int bench_check(const char *what, int ok)
+{
+	if (!ok) {
+		printf("%s: check failed\r\n", what);
+		errors++;
+	}
+	return ok ? 0 : -1;
+}
+
+/* The device interrupt goes straight to the driver */
+static void loop_irq(struct virtio_mmio_dev *dev)
+{
+	struct loop *l = metal_container_of(dev, struct loop, dev);
+
+	virtio_mmio_isr(&l->drv.vdev);
+}
+
+static int loop_init(struct loop *l, const char *name, uint32_t device_id,
+		     uint32_t features, unsigned int num_queues, void *config,
+		     uint32_t config_len)
+{
+	struct virtqueue *vq;
+	unsigned int i;
+
+	l->shm = aligned_alloc(4096, LOOP_SHM_SIZE);
+	if (!l->shm)
+		return -1;
+	memset(l->shm, 0, LOOP_SHM_SIZE);
+	l->shm_pa = LOOP_SHM_PA;
+	metal_io_init(&l->shm_io, l->shm, &l->shm_pa, LOOP_SHM_SIZE, -1, 0,
+		      NULL);
+	l->num_queues = num_queues;
+	for (i = 0; i < num_queues; i++)
+		l->queues[i].num_max = LOOP_VRING_NUM;
+	if (virtio_mmio_dev_init(&l->dev, device_id,
+				 VIRTIO_RING_F_EVENT_IDX | features, l->queues,
+				 num_queues, &l->shm_io, config, config_len,
+				 loop_irq))
+		return -1;
+
+	/* The driver accesses the registers through the device io region */
+	l->drv.device_mode = VIRTIO_DEV_DRIVER;
+	l->drv.shm_mem.base = (void *)LOOP_SHM_PA;
+	l->drv.shm_mem.size = LOOP_SHM_SIZE;
+	l->drv.shm_device.name = name;
+	l->drv.shm_device.num_regions = 1;
+	l->drv.cfg_io = &l->dev.io;
+	if (virtio_mmio_device_init(&l->drv, (uintptr_t)l->shm, 0, NULL))
+		return -1;
+
+	/* Preallocated virtqueues, their vrings at the start of the memory */
+	for (i = 0; i < num_queues; i++) {
+		vq = virtqueue_allocate(LOOP_VRING_NUM);
+		if (!vq)
+			return -1;
+		vq->vq_nentries = LOOP_VRING_NUM;
+		vq->vq_free_cnt = LOOP_VRING_NUM;
+		vq->vq_ring.desc = (void *)(l->shm + i * LOOP_VRING_SIZE);
+		l->vqs[i] = vq;
+	}
+	virtio_mmio_register_device(&l->drv.vdev, num_queues, l->vqs);
+
+	return 0;
+}
+
+static void loop_deinit(struct loop *l)
+{
+	unsigned int i;
+
+	virtio_mmio_dev_reset(&l->dev);
+	for (i = 0; i < l->num_queues; i++)
+		virtqueue_free(l->vqs[i]);
+	metal_free_memory(l->drv.vdev.vrings_info);
+	free(l->shm);
+	memset(l, 0, sizeof(*l));
+}
+
+static double bench_rate(unsigned long long bytes, unsigned long long ns)
+{
+	return ns ? (double)bytes * 1000 / ns : 0;
+}
+
+static void blk_serve(struct virtqueue *vq)
+{
+	virtio_blk_file_serve(vq->priv, vq);
+}
+
+static int bench_blk(unsigned long loops)
+{
+	static struct loop l;
+	char path[] = "/tmp/virtio-loopback-XXXXXX";
+	char id[VIRTIO_BLK_ID_BYTES];
+	struct virtio_blk_config config;
+	struct virtio_blk_file bf;
+	struct virtio_blk_req *reqs;
+	unsigned long long start, ns;
+	struct virtio_blk blk;
+	unsigned long i, it;
+	unsigned char *data;
+	uint32_t features;
+	int batch, fd, ret = -1;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		return -1;
+	if (ftruncate(fd, BLK_FILE_SIZE)) {
+		close(fd);
+		unlink(path);
+		return -1;
+	}
+	close(fd);
+	ret = virtio_blk_file_open(&bf, path, false);
+	unlink(path);
+	if (ret)
+		return ret;
+	ret = -1;
+
+	features = virtio_blk_file_get_config(&bf, &config);
+	l.queues[0].callback = blk_serve;
+	l.queues[0].priv = &bf;
+	memset(&blk, 0, sizeof(blk));
+	if (loop_init(&l, "virtio-loopback-blk", VIRTIO_ID_BLOCK, features, 1,
+		      &config, sizeof(config)) ||
+	    virtio_blk_init(&blk, &l.drv.vdev))
+		goto out;
+	bench_check("blk capacity",
+		    blk.capacity == BLK_FILE_SIZE / VIRTIO_BLK_SECTOR_SIZE);
+
+	reqs = (struct virtio_blk_req *)(l.shm + LOOP_BUF_OFF);
+	data = l.shm + LOOP_BUF_OFF + 0x1000;
+	memcpy(data, pattern, sizeof(pattern));
+	bench_check("blk write",
+		    !virtio_blk_transfer(&blk, &reqs[0], VIRTIO_BLK_T_OUT, 8,
+					 data, sizeof(pattern)));
+	memset(data, 0, sizeof(pattern));
+	bench_check("blk read",
+		    !virtio_blk_transfer(&blk, &reqs[0], VIRTIO_BLK_T_IN, 8,
+					 data, sizeof(pattern)) &&
+		    !memcmp(data, pattern, sizeof(pattern)));
+	bench_check("blk flush",
+		    !virtio_blk_transfer(&blk, &reqs[0], VIRTIO_BLK_T_FLUSH, 0,
+					 NULL, 0));
+	bench_check("blk id",
+		    !virtio_blk_transfer(&blk, &reqs[0], VIRTIO_BLK_T_GET_ID, 0,
+					 data, VIRTIO_BLK_ID_BYTES));
+	memcpy(id, data, sizeof(id));
+	bench_check("blk id", !strncmp(id, strrchr(path, '/') + 1, sizeof(id)));
+
+	for (batch = 1; batch <= BLK_BATCH; batch *= BLK_BATCH) {
+		start = metal_get_timestamp();
+		for (it = 0; it < loops / batch; it++) {
+			for (i = 0; i < (unsigned long)batch; i++) {
+				if (virtio_blk_submit(&blk, &reqs[i],
+						      VIRTIO_BLK_T_IN,
+						      (it * batch + i) * 8 %
+						      (blk.capacity - 8),
+						      data + i * BLK_IO_SIZE,
+						      BLK_IO_SIZE))
+					goto out;
+			}
+			virtio_blk_kick(&blk);
+			virtio_blk_poll(&blk);
+			if (blk.inflight)
+				goto out;
+		}
+		ns = metal_get_timestamp() - start;
+		printf("blk: 4 KiB reads in batches of %2d: %llu ns per request, %.0f MB/s\r\n",
+		       batch, ns / (loops / batch * batch),
+		       bench_rate((unsigned long long)loops / batch * batch *
+				  BLK_IO_SIZE, ns));
+	}
+	bench_check("blk errors", !bf.errors);
+	ret = 0;
+
+out:
+	if (ret)
+		printf("blk: loopback failed\r\n");
+	if (blk.vdev)
+		virtio_blk_deinit(&blk);
+	if (l.shm)
+		loop_deinit(&l);
+	virtio_blk_file_close(&bf);
+	return ret;
+}
+
+static struct virtio_net_dev net_dev;
+static unsigned long net_received;
+static uint32_t net_expected_len;
+
+static void net_serve_tx(struct virtqueue *vq)
+{
+	(void)vq;
+	virtio_net_dev_serve_tx(&net_dev);
+}
+
+static void net_rx(struct virtio_net *net, struct virtio_net_frame *frame)
+{
+	uint32_t off = 0;
+	unsigned int i;
+
+	(void)net;
+	net_received++;
+	if (frame->len != net_expected_len) {
+		errors++;
+		return;
+	}
+	for (i = 0; i < frame->num; i++) {
+		if (memcmp(frame->data[i], pattern + off, frame->seg_len[i])) {
+			errors++;
+			return;
+		}
+		off += frame->seg_len[i];
+	}
+}
+
+static int bench_net_run(struct virtio_net *net, uint32_t len, int batch,
+			 unsigned long loops)
+{
+	unsigned long long start, ns;
+	unsigned long it, received;
+	uint32_t room;
+	void *buf;
+	int i;
+
+	net_expected_len = len;
+	received = net_received;
+	start = metal_get_timestamp();
+	for (it = 0; it < loops / batch; it++) {
+		for (i = 0; i < batch; i++) {
+			buf = virtio_net_get_tx_buffer(net, &room);
+			if (!buf || room < len)
+				return -1;
+			memcpy(buf, pattern, len);
+			if (virtio_net_send_nocopy(net, buf, len))
+				return -1;
+		}
+		virtio_net_kick(net);
+		virtio_net_poll(net);
+	}
+	ns = metal_get_timestamp() - start;
+	received = net_received - received;
+	printf("net: %4u byte frames in batches of %2d: %llu ns per frame, %.0f MB/s\r\n",
+	       len, batch, ns / (loops / batch * batch),
+	       bench_rate((unsigned long long)received * len, ns));
+
+	return bench_check("net frames", received == loops / batch * batch);
+}
+
+static int bench_net(unsigned long loops)
+{
+	static struct loop l;
+	struct virtio_net_pool rx_pool, tx_pool;
+	struct virtio_net_config config;
+	struct virtio_net net;
+	uint32_t features;
+	int ret = -1;
+
+	memset(&net_dev, 0, sizeof(net_dev));
+	memcpy(net_dev.mac, "\x02\x00\x00\x00\x00\x01", sizeof(net_dev.mac));
+	features = virtio_net_dev_get_config(&net_dev, &config);
+	l.queues[VIRTIO_NET_TXQ].callback = net_serve_tx;
+	memset(&net, 0, sizeof(net));
+	rx_pool.num = NET_RX_NUM;
+	rx_pool.buf_size = NET_BUF_SIZE;
+	tx_pool.num = NET_TX_NUM;
+	tx_pool.buf_size = NET_BUF_SIZE;
+	if (loop_init(&l, "virtio-loopback-net", VIRTIO_ID_NETWORK, features,
+		      2, &config, sizeof(config)))
+		goto out;
+	rx_pool.base = l.shm + LOOP_BUF_OFF;
+	tx_pool.base = l.shm + LOOP_BUF_OFF + NET_RX_NUM * NET_BUF_SIZE;
+	if (virtio_net_init(&net, &l.drv.vdev, &rx_pool, &tx_pool, net_rx,
+			    NULL))
+		goto out;
+	virtio_net_dev_start(&net_dev, l.queues[VIRTIO_NET_RXQ].vq,
+			     l.queues[VIRTIO_NET_TXQ].vq);
+	bench_check("net mac", !memcmp(net.mac, net_dev.mac, sizeof(net.mac)));
+
+	if (bench_net_run(&net, 64, 1, loops) ||
+	    bench_net_run(&net, 64, NET_BATCH, loops) ||
+	    bench_net_run(&net, VIRTIO_NET_MAX_FRAME, 1, loops) ||
+	    bench_net_run(&net, VIRTIO_NET_MAX_FRAME, NET_BATCH, loops))
+		goto out;
+	bench_check("net drops", !net_dev.dropped && !net.rx_dropped);
+	ret = 0;
+
+out:
+	if (ret)
+		printf("net: loopback failed\r\n");
+	if (net.vdev)
+		virtio_net_deinit(&net);
+	if (l.shm)
+		loop_deinit(&l);
+	return ret;
+}
+
+/*
+ * virtio_console takes a virtio device in the device role: hand it the
+ * virtqueues the emulated device created when the driver enabled them,
+ * and the status written by the driver.
+ */
+static int con_create_virtqueues(struct virtio_device *vdev,
+				 unsigned int flags, unsigned int nvqs,
+				 const char *names[], vq_callback callbacks[],
+				 void *callback_args[])
+{
+	struct virtio_mmio_dev *dev = metal_container_of(vdev,
+							 struct virtio_mmio_dev,
+							 vdev);
+	static struct virtio_vring_info vrings[LOOP_MAX_QUEUES];
+	unsigned int i;
+
+	(void)flags;
+	(void)names;
+	(void)callback_args;
+	if (nvqs > dev->num_queues)
+		return -EINVAL;
+	for (i = 0; i < nvqs; i++) {
+		if (!dev->queues[i].vq)
+			return -ENODEV;
+		dev->queues[i].vq->callback = callbacks ? callbacks[i] : NULL;
+		vrings[i].vq = dev->queues[i].vq;
+	}
+	vdev->vrings_info = vrings;
+	vdev->vrings_num = nvqs;
+
+	return 0;
+}
+
+static void con_delete_virtqueues(struct virtio_device *vdev)
+{
+	vdev->vrings_info = NULL;
+	vdev->vrings_num = 0;
+}
+
+/* The status the driver wrote in the register file */
+static uint8_t con_get_status(struct virtio_device *vdev)
+{
+	return metal_container_of(vdev, struct virtio_mmio_dev, vdev)->status;
+}
+
+static const struct virtio_dispatch con_dispatch = {
+	.create_virtqueues = con_create_virtqueues,
+	.delete_virtqueues = con_delete_virtqueues,
+	.get_status = con_get_status,
+};
+
+/* Lines read back by the console reader */
+struct con_lines {
+	char line[64];
+	unsigned int pos;
+	unsigned long next;
+	unsigned long lines;
+	unsigned long long bytes;
+};
+
+/* Pass the pending data to the reader, then read and check the lines */
+static void con_collect(struct virtio_console *con,
+			struct virtio_console_reader *rd, struct con_lines *cl)
+{
+	char out[CON_BUF_SIZE * 4];
+	unsigned long seq;
+	int k, n;
+
+	virtio_console_flush(con);
+	while ((n = virtio_console_read(rd, out, sizeof(out))) > 0) {
+		cl->bytes += n;
+		for (k = 0; k < n; k++) {
+			if (cl->pos < sizeof(cl->line) - 1)
+				cl->line[cl->pos++] = out[k];
+			if (out[k] != '\n')
+				continue;
+			cl->line[cl->pos] = '\0';
+			if (sscanf(cl->line, "line %lx", &seq) != 1 ||
+			    seq != cl->next)
+				errors++;
+			cl->next = seq + 1;
+			cl->lines++;
+			cl->pos = 0;
+		}
+	}
+}
+
+static int bench_console(unsigned long loops)
+{
+	static char ring[CON_RING_SIZE];
+	static struct loop l;
+	struct virtio_console_reader rd;
+	struct con_lines cl = { .pos = 0 };
+	struct virtio_console con;
+	unsigned long long start, ns;
+	char line[32];
+	unsigned long i;
+	int len, ret = -1;
+
+	memset(&rd, 0, sizeof(rd));
+	memset(&con, 0, sizeof(con));
+	if (loop_init(&l, "virtio-loopback-console", VIRTIO_ID_CONSOLE, 0, 2,
+		      NULL, 0) ||
+	    virtio_console_reader_init(&rd, &l.drv.vdev,
+				       l.shm + LOOP_BUF_OFF, CON_BUF_NUM,
+				       CON_BUF_SIZE))
+		goto out;
+	l.dev.vdev.func = &con_dispatch;
+	if (virtio_console_init(&con, &l.dev.vdev, ring, sizeof(ring)))
+		goto out;
+
+	/* Flush once a receive buffer can be filled */
+	start = metal_get_timestamp();
+	for (i = 0; i < loops; i++) {
+		len = snprintf(line, sizeof(line), "line %08lx\n", i);
+		/* A message dropped for lack of room is written again */
+		while (virtio_console_write(&con, line, len) == -EAGAIN)
+			con_collect(&con, &rd, &cl);
+		if (virtio_console_pending(&con) >= CON_BUF_SIZE)
+			con_collect(&con, &rd, &cl);
+	}
+	while (virtio_console_pending(&con))
+		con_collect(&con, &rd, &cl);
+	ns = metal_get_timestamp() - start;
+
+	printf("console: %lu lines, %llu ns per line, %.0f MB/s\r\n",
+	       cl.lines, ns / loops, bench_rate(cl.bytes, ns));
+	bench_check("console lines", cl.lines == loops && !cl.pos);
+	bench_check("console bytes", rd.bytes == cl.bytes);
+	ret = 0;
+
+out:
+	if (ret)
+		printf("console: loopback failed\r\n");
+	if (con.vdev)
+		virtio_console_deinit(&con);
+	if (rd.vdev)
+		virtio_console_reader_deinit(&rd);
+	if (l.shm)
+		loop_deinit(&l);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	unsigned long loops = 100000;
+	unsigned int i;
+	int ret = 0;
+
+	if (argc > 1)
+		loops = strtoul(argv[1], NULL, 0);
+	if (loops < BLK_BATCH) {
+		printf("iterations must be at least %d\r\n", BLK_BATCH);
+		return -1;
+	}
+	metal_init(&metal_param);
+	for (i = 0; i < sizeof(pattern); i++)
+		pattern[i] = i * 7 + 1;
+
+	ret |= bench_blk(loops);
+	ret |= bench_net(loops);
+	ret |= bench_console(loops);
+
+	printf("checks %s\r\n", ret || errors ? "failed" : "passed");
+	metal_finish();
+	return ret || errors ? -1 : 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Cost of the virtqueue operations, measured in a single thread.
+ *
+ * A driver and a device virtqueue share one vring. A round trip adds a
+ * buffer to the driver virtqueue and kicks, takes it on the device side,
+ * returns it as used and kicks, then gets it back on the driver side: it
+ * goes through every memory fence of the ring protocol once. The best of
+ * several runs is reported in nanoseconds, and in CPU cycles where a cycle
+ * counter is readable from user space (x86 TSC).
+ *
+ * Usage: vq-bench [round trips per run]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <metal/io.h>
+#include <metal/sys.h>
+#include <metal/time.h>
+#include <openamp/virtio.h>
+#include <openamp/virtqueue.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_CYCLES	1
+#endif
+
+#define VRING_NUM	64
+#define VRING_ALIGN	4096
+#define BENCH_RUNS	5
+
+static unsigned char ring[0x4000] __attribute__((aligned(VRING_ALIGN)));
+static unsigned char buf[64];
+static struct metal_io_region io;
+static metal_phys_addr_t buf_pa;
+static struct virtio_device driver_vdev, device_vdev;
+static struct virtqueue *driver_vq, *device_vq;
+
+static int bench_setup(void)
+{
+	struct vring_alloc_info info = {
+		.vaddr = ring,
+		.align = VRING_ALIGN,
+		.num_descs = VRING_NUM,
+	};
+
+	buf_pa = (uintptr_t)buf;
+	metal_io_init(&io, buf, &buf_pa, sizeof(buf), -1, 0, NULL);
+	driver_vdev.role = VIRTIO_DEV_DRIVER;
+	device_vdev.role = VIRTIO_DEV_DEVICE;
+	driver_vdev.features = VIRTIO_RING_F_EVENT_IDX;
+	device_vdev.features = VIRTIO_RING_F_EVENT_IDX;
+	driver_vq = virtqueue_allocate(VRING_NUM);
+	device_vq = virtqueue_allocate(VRING_NUM);
+	if (!driver_vq || !device_vq)
+		return -1;
+	if (virtqueue_create(&driver_vdev, 0, "driver", &info, NULL, NULL,
+			     driver_vq) ||
+	    virtqueue_create(&device_vdev, 0, "device", &info, NULL, NULL,
+			     device_vq))
+		return -1;
+	driver_vq->shm_io = &io;
+	device_vq->shm_io = &io;
+	return 0;
+}
+
+static void bench_round_trips(unsigned long loops)
+{
+	struct virtqueue_buf vqbuf = { .buf = buf, .len = sizeof(buf) };
+	uint16_t head, idx;
+	unsigned long i;
+	uint32_t len;
+
+	for (i = 0; i < loops; i++) {
+		virtqueue_add_buffer(driver_vq, &vqbuf, 1, 0, buf);
+		virtqueue_kick(driver_vq);
+		virtqueue_get_available_buffer(device_vq, &head, &len);
+		virtqueue_add_consumed_buffer(device_vq, head, len);
+		virtqueue_kick(device_vq);
+		virtqueue_get_buffer(driver_vq, &len, &idx);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	unsigned long long start, ns, best_ns = ~0ULL;
+#ifdef BENCH_HAVE_CYCLES
+	unsigned long long cycles, best_cycles = ~0ULL;
+#endif
+	unsigned long loops = 1000000;
+	int run;
+
+	if (argc > 1)
+		loops = strtoul(argv[1], NULL, 0);
+	if (!loops)
+		return -1;
+	metal_init(&metal_param);
+	if (bench_setup()) {
+		printf("virtqueue setup failed\r\n");
+		metal_finish();
+		return -1;
+	}
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		start = metal_get_timestamp();
+#ifdef BENCH_HAVE_CYCLES
+		cycles = __rdtsc();
+#endif
+		bench_round_trips(loops);
+#ifdef BENCH_HAVE_CYCLES
+		cycles = (__rdtsc() - cycles) / loops;
+		if (cycles < best_cycles)
+			best_cycles = cycles;
+#endif
+		ns = (metal_get_timestamp() - start) / loops;
+		if (ns < best_ns)
+			best_ns = ns;
+	}
+
+	printf("round trip: %llu ns\r\n", best_ns);
+#ifdef BENCH_HAVE_CYCLES
+	printf("round trip: %llu cycles\r\n", best_cycles);
+#endif
+	virtqueue_free(driver_vq);
+	virtqueue_free(device_vq);
+	metal_finish();
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Two-thread litmus test of the virtqueue memory ordering.
+ *
+ * A driver and a device virtqueue share one vring, each run by its own
+ * thread. Every buffer exchange is an instance of the message passing
+ * litmus test, once in each direction: the payload is written, then the
+ * index is published; the other side reads the index, then the payload.
+ * The driver fills each buffer with the sequence number of the exchange,
+ * the device checks it and answers with its complement, which the driver
+ * checks in turn. Seeing a published buffer with a stale payload is the
+ * outcome the release/acquire fences forbid; the test fails if it ever
+ * shows up. Run it on a multi-core machine, ideally a weakly ordered one
+ * such as ARMv8, where a missing fence is not hidden by the hardware. A
+ * side finding the ring empty yields, so it also runs on a single core.
+ *
+ * Usage: vq-litmus [exchanges]
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <metal/atomic.h>
+#include <metal/io.h>
+#include <metal/sys.h>
+#include <openamp/virtio.h>
+#include <openamp/virtqueue.h>
+
+#define VRING_NUM	64
+#define VRING_ALIGN	4096
+#define PAYLOAD_WORDS	8
+
+static unsigned char ring[0x4000] __attribute__((aligned(VRING_ALIGN)));
+static uint64_t bufs[VRING_NUM][PAYLOAD_WORDS];
+static struct metal_io_region io;
+static metal_phys_addr_t bufs_pa;
+static struct virtio_device driver_vdev, device_vdev;
+static struct virtqueue *driver_vq, *device_vq;
+static unsigned long long exchanges = 1000000;
+static atomic_ullong forbidden;
+
+static int litmus_setup(void)
+{
+	struct vring_alloc_info info = {
+		.vaddr = ring,
+		.align = VRING_ALIGN,
+		.num_descs = VRING_NUM,
+	};
+
+	bufs_pa = (uintptr_t)bufs;
+	metal_io_init(&io, bufs, &bufs_pa, sizeof(bufs), -1, 0, NULL);
+	driver_vdev.role = VIRTIO_DEV_DRIVER;
+	device_vdev.role = VIRTIO_DEV_DEVICE;
+	driver_vdev.features = VIRTIO_RING_F_EVENT_IDX;
+	device_vdev.features = VIRTIO_RING_F_EVENT_IDX;
+	driver_vq = virtqueue_allocate(VRING_NUM);
+	device_vq = virtqueue_allocate(VRING_NUM);
+	if (!driver_vq || !device_vq)
+		return -1;
+	if (virtqueue_create(&driver_vdev, 0, "driver", &info, NULL, NULL,
+			     driver_vq) ||
+	    virtqueue_create(&device_vdev, 0, "device", &info, NULL, NULL,
+			     device_vq))
+		return -1;
+	driver_vq->shm_io = &io;
+	device_vq->shm_io = &io;
+	return 0;
+}
+
+/* Count the payload words that do not hold the expected value */
+static unsigned int litmus_check(const uint64_t *buf, uint64_t expect)
+{
+	unsigned int i, bad = 0;
+
+	for (i = 0; i < PAYLOAD_WORDS; i++)
+		if (buf[i] != expect)
+			bad++;
+	return bad;
+}
+
+static void *litmus_device(void *arg)
+{
+	unsigned long long seq;
+	uint64_t *buf;
+	uint32_t len;
+	uint16_t head;
+	unsigned int i;
+
+	(void)arg;
+	for (seq = 0; seq < exchanges; seq++) {
+		while (!(buf = virtqueue_get_available_buffer(device_vq,
+							       &head, &len)))
+			sched_yield();
+		atomic_fetch_add(&forbidden, litmus_check(buf, seq));
+		for (i = 0; i < PAYLOAD_WORDS; i++)
+			buf[i] = ~(uint64_t)seq;
+		virtqueue_add_consumed_buffer(device_vq, head, len);
+		virtqueue_kick(device_vq);
+	}
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	unsigned long long sent = 0, done = 0;
+	struct virtqueue_buf vqbuf;
+	pthread_t thread;
+	uint64_t *buf;
+	uint32_t len;
+	uint16_t idx;
+	unsigned int i;
+
+	if (argc > 1)
+		exchanges = strtoull(argv[1], NULL, 0);
+	metal_init(&metal_param);
+	if (litmus_setup() ||
+	    pthread_create(&thread, NULL, litmus_device, NULL)) {
+		printf("virtqueue setup failed\r\n");
+		metal_finish();
+		return -1;
+	}
+
+	while (done < exchanges) {
+		while (sent < exchanges && driver_vq->vq_free_cnt) {
+			buf = bufs[sent % VRING_NUM];
+			for (i = 0; i < PAYLOAD_WORDS; i++)
+				buf[i] = sent;
+			vqbuf.buf = buf;
+			vqbuf.len = sizeof(bufs[0]);
+			virtqueue_add_buffer(driver_vq, &vqbuf, 1, 0, buf);
+			virtqueue_kick(driver_vq);
+			sent++;
+		}
+		buf = virtqueue_get_buffer(driver_vq, &len, &idx);
+		if (!buf) {
+			sched_yield();
+			continue;
+		}
+		atomic_fetch_add(&forbidden,
+				 litmus_check(buf, ~(uint64_t)done));
+		done++;
+	}
+	pthread_join(thread, NULL);
+
+	printf("%llu exchanges, %llu stale payload words\r\n", exchanges,
+	       (unsigned long long)atomic_load(&forbidden));
+	virtqueue_free(driver_vq);
+	virtqueue_free(device_vq);
+	metal_finish();
+	return atomic_load(&forbidden) ? -1 : 0;
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Loopback test of the stubs generated from calc.idl.
+ *
+ * A driver and a device RPMsg virtio device share one memory, the client
+ * being on the driver side and the server on the device side, both in
+ * this thread. The synchronous stubs process the messages of both sides
+ * from their poll function. Every rpc of calc.idl is called and its
+ * answer checked, then the in place request path, and the rejection of
+ * malformed requests and answers.
+ *
+ * Usage: rpc-stub-loopback
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <metal/io.h>
+#include <metal/sys.h>
+#include <openamp/remoteproc.h>
+#include <openamp/remoteproc_virtio.h>
+#include <openamp/rpmsg_virtio.h>
+#include "calc_rpc.h"
+
+#define SHM_SIZE	0x40000
+#define RSC_OFFSET	0x0
+#define VRING0_OFFSET	0x1000
+#define VRING1_OFFSET	0x5000
+#define POOL_OFFSET	0x10000
+#define POOL_SIZE	(SHM_SIZE - POOL_OFFSET)
+#define VRING_NUM	64
+#define VRING_ALIGN	16
+#define TIMEOUT_MS	1000
+
+METAL_PACKED_BEGIN
+struct loop_rsc {
+	struct fw_rsc_vdev vdev;
+	struct fw_rsc_vdev_vring vring[2];
+} METAL_PACKED_END;
+
+static unsigned char shm[SHM_SIZE] __attribute__((aligned(4096)));
+static metal_phys_addr_t shm_pa;
+static struct metal_io_region io;
+static struct rpmsg_virtio_shm_pool pool;
+static struct virtio_device *drv_vdev, *dev_vdev;
+static struct rpmsg_virtio_device drv_rvdev, dev_rvdev;
+static struct rpmsg_rpc_clt clt;
+static struct rpmsg_rpc_svr svr;
+
+static int pings;
+static unsigned int log_level;
+static char log_msg[129];
+
+int calc_add_impl(struct rpmsg_rpc_svr *rpcs, const struct calc_add_req *req,
+		  struct calc_add_resp *resp)
+{
+	(void)rpcs;
+	resp->sum = req->a + req->b;
+	return 0;
+}
+
+int calc_scale_impl(struct rpmsg_rpc_svr *rpcs,
+		    const struct calc_scale_req *req,
+		    struct calc_scale_resp *resp)
+{
+	int i;
+
+	(void)rpcs;
+	for (i = 0; i < 2; i++) {
+		resp->r[i].x = req->p[i].x * (int32_t)req->k;
+		resp->r[i].y = req->p[i].y * (int32_t)req->k;
+	}
+	return 0;
+}
+
+int calc_write_impl(struct rpmsg_rpc_svr *rpcs,
+		    const struct calc_write_req *req,
+		    struct calc_write_resp *resp)
+{
+	(void)rpcs;
+	if (req->fd != 1)
+		return -EBADF;
+	resp->len = req->buf_len;
+	return 0;
+}
+
+int calc_echo_impl(struct rpmsg_rpc_svr *rpcs, const struct calc_echo_req *req,
+		   struct calc_echo_resp *resp)
+{
+	(void)rpcs;
+	resp->stamp = 0x1122334455667788ULL;
+	memcpy(resp->data, req->data, req->data_len);
+	/* A 3 bytes echo answers a length over the bound of the IDL */
+	resp->data_len = req->data_len == 3 ? 1000 : req->data_len;
+	return 0;
+}
+
+int calc_ping_impl(struct rpmsg_rpc_svr *rpcs)
+{
+	(void)rpcs;
+	pings++;
+	return 7;
+}
+
+int calc_origin_impl(struct rpmsg_rpc_svr *rpcs,
+		     const struct calc_origin_req *req,
+		     struct calc_origin_resp *resp)
+{
+	(void)rpcs;
+	resp->q.x = -req->p.x;
+	resp->q.y = -req->p.y;
+	return 0;
+}
+
+int calc_log_impl(struct rpmsg_rpc_svr *rpcs, const struct calc_log_req *req)
+{
+	(void)rpcs;
+	log_level = req->level;
+	memcpy(log_msg, req->msg, req->msg_len);
+	log_msg[req->msg_len] = '\0';
+	return 0;
+}
+
+static int loop_notify(void *priv, uint32_t id)
+{
+	(void)priv;
+	(void)id;
+	return 0;
+}
+
+/* Process the messages pending on both sides */
+static int loop_poll(void *arg)
+{
+	(void)arg;
+	rproc_virtio_notified(dev_vdev, RSC_NOTIFY_ID_ANY);
+	rproc_virtio_notified(drv_vdev, RSC_NOTIFY_ID_ANY);
+	return 0;
+}
+
+static struct virtio_device *loop_vdev(unsigned int role,
+				       struct loop_rsc *rsc)
+{
+	struct virtio_device *vdev;
+
+	vdev = rproc_virtio_create_vdev(role, 0, &rsc->vdev, &io, NULL,
+					loop_notify, NULL);
+	if (!vdev)
+		return NULL;
+	if (rproc_virtio_init_vring(vdev, 0, 1, shm + VRING0_OFFSET, &io,
+				    VRING_NUM, VRING_ALIGN) ||
+	    rproc_virtio_init_vring(vdev, 1, 2, shm + VRING1_OFFSET, &io,
+				    VRING_NUM, VRING_ALIGN)) {
+		rproc_virtio_remove_vdev(vdev);
+		return NULL;
+	}
+	return vdev;
+}
+
+static int loop_init(void)
+{
+	struct loop_rsc *rsc = (struct loop_rsc *)(shm + RSC_OFFSET);
+	int i;
+
+	metal_io_init(&io, shm, &shm_pa, SHM_SIZE, -1, 0, NULL);
+	rsc->vdev.type = RSC_VDEV;
+	rsc->vdev.id = VIRTIO_ID_RPMSG;
+	rsc->vdev.num_of_vrings = 2;
+	for (i = 0; i < 2; i++) {
+		rsc->vring[i].num = VRING_NUM;
+		rsc->vring[i].align = VRING_ALIGN;
+		rsc->vring[i].notifyid = i + 1;
+	}
+
+	drv_vdev = loop_vdev(VIRTIO_DEV_DRIVER, rsc);
+	dev_vdev = loop_vdev(VIRTIO_DEV_DEVICE, rsc);
+	if (!drv_vdev || !dev_vdev)
+		return -1;
+	rpmsg_virtio_init_shm_pool(&pool, shm + POOL_OFFSET, POOL_SIZE);
+	/* The driver side must be up first, it sets DRIVER_OK */
+	if (rpmsg_init_vdev(&drv_rvdev, drv_vdev, NULL, &io, &pool) ||
+	    rpmsg_init_vdev(&dev_rvdev, dev_vdev, NULL, &io, NULL))
+		return -1;
+
+	if (rpmsg_rpc_server_init(&svr, &dev_rvdev.rdev, calc_services,
+				  CALC_NUM_SERVICES, NULL) ||
+	    rpmsg_rpc_client_init(&clt, &drv_rvdev.rdev, NULL, NULL, 0))
+		return -1;
+	/* No name service, bind the endpoints to each other */
+	svr.ept.dest_addr = clt.ept.addr;
+	clt.ept.dest_addr = svr.ept.addr;
+	return 0;
+}
+
+static void loop_deinit(void)
+{
+	rpmsg_rpc_client_release(&clt);
+	rpmsg_rpc_server_release(&svr);
+	rpmsg_deinit_vdev(&dev_rvdev);
+	rpmsg_deinit_vdev(&drv_rvdev);
+	rproc_virtio_remove_vdev(dev_vdev);
+	rproc_virtio_remove_vdev(drv_vdev);
+}
+
+static int async_status;
+static int32_t async_sum;
+
+static void loop_add_cb(struct rpmsg_rpc_call *call, int status, void *data,
+			size_t len)
+{
+	const struct calc_add_resp *resp = calc_add_decode(data, len);
+
+	(void)call;
+	async_status = status;
+	async_sum = resp ? resp->sum : -1;
+}
+
+static int loop_check(const char *what, int ok)
+{
+	if (ok)
+		return 0;
+	printf("%s failed\r\n", what);
+	return -1;
+}
+
+static int loop_test(void)
+{
+	struct calc_point p[2] = { { 1, 2 }, { 3, 4 } }, o = { 5, -6 };
+	struct calc_add_resp add;
+	struct calc_scale_resp scale;
+	struct calc_write_resp write;
+	struct calc_echo_resp echo;
+	struct calc_origin_resp origin;
+	struct calc_add_req *add_req;
+	struct calc_echo_req *echo_req;
+	struct rpmsg_rpc_call call;
+	unsigned char data[400], big[300];
+	int32_t one = 1;
+	int err = 0, ret;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i;
+	memset(big, 0, sizeof(big));
+
+	ret = calc_add(&clt, loop_poll, NULL, TIMEOUT_MS, 40, 2, &add);
+	err |= loop_check("add", !ret && add.sum == 42);
+	ret = calc_scale(&clt, loop_poll, NULL, TIMEOUT_MS, p, 3, &scale);
+	err |= loop_check("scale", !ret && scale.r[0].x == 3 &&
+			  scale.r[0].y == 6 && scale.r[1].x == 9 &&
+			  scale.r[1].y == 12);
+	ret = calc_write(&clt, loop_poll, NULL, TIMEOUT_MS, 1, "hello", 5,
+			 &write);
+	err |= loop_check("write", !ret && write.len == 5);
+	ret = calc_write(&clt, loop_poll, NULL, TIMEOUT_MS, 2, "hello", 5,
+			 &write);
+	err |= loop_check("write error status", ret == -EBADF);
+	ret = calc_write(&clt, loop_poll, NULL, TIMEOUT_MS, 1, big,
+			 sizeof(big), &write);
+	err |= loop_check("write over the bound", ret == -EMSGSIZE);
+
+	memset(&echo, 0, sizeof(echo));
+	ret = calc_echo(&clt, loop_poll, NULL, TIMEOUT_MS, data, sizeof(data),
+			&echo);
+	err |= loop_check("echo", !ret && echo.data_len == sizeof(data) &&
+			  echo.stamp == 0x1122334455667788ULL &&
+			  !memcmp(echo.data, data, sizeof(data)));
+	ret = calc_echo(&clt, loop_poll, NULL, TIMEOUT_MS, data, 10, &echo);
+	err |= loop_check("short echo", !ret && echo.data_len == 10);
+	ret = calc_echo(&clt, loop_poll, NULL, TIMEOUT_MS, data, 3, &echo);
+	err |= loop_check("answer over the bound", ret == -EMSGSIZE);
+
+	ret = calc_ping(&clt, loop_poll, NULL, TIMEOUT_MS);
+	err |= loop_check("ping", ret == 7 && pings == 1);
+	ret = calc_origin(&clt, loop_poll, NULL, TIMEOUT_MS, &o, &origin);
+	err |= loop_check("origin", !ret && origin.q.x == -5 &&
+			  origin.q.y == 6);
+
+	ret = calc_log_call(&clt, 3, "boot ok", 7);
+	loop_poll(NULL);
+	err |= loop_check("log", ret > 0 && log_level == 3 &&
+			  !strcmp(log_msg, "boot ok"));
+
+	/* Request built in place in the transmit buffer */
+	add_req = calc_add_alloc(&clt, true);
+	if (!add_req)
+		return loop_check("in place request", 0);
+	add_req->a = 1000;
+	add_req->b = -1;
+	ret = calc_add_send(&clt, &call, add_req, loop_add_cb, NULL);
+	if (ret > 0)
+		ret = rpmsg_rpc_client_wait(&call, loop_poll, NULL, TIMEOUT_MS);
+	err |= loop_check("in place request", !ret && !async_status &&
+			  async_sum == 999);
+
+	/* Requests shorter than their params are rejected by the server */
+	ret = rpmsg_rpc_client_call_async(&clt, &call, CALC_ADD_ID, &one,
+					  sizeof(one), loop_add_cb, NULL);
+	if (ret > 0)
+		ret = rpmsg_rpc_client_wait(&call, loop_poll, NULL, TIMEOUT_MS);
+	err |= loop_check("short request", ret == -EPROTO && async_sum == -1);
+
+	/* Lengths over the bound are rejected before sending */
+	echo_req = calc_echo_alloc(&clt, true);
+	if (!echo_req)
+		return loop_check("in place request over the bound", 0);
+	echo_req->data_len = 401;
+	ret = calc_echo_send(&clt, &call, echo_req, NULL, NULL);
+	err |= loop_check("in place request over the bound", ret == -EMSGSIZE);
+
+	/* A buffer not sent goes back to the pool */
+	add_req = calc_add_alloc(&clt, true);
+	if (add_req)
+		rpmsg_rpc_client_release_tx_params(&clt, add_req);
+
+	err |= loop_check("short answer", !calc_add_decode("ab", 2) &&
+			  !calc_echo_decode(NULL, 0));
+	return err;
+}
+
+int main(void)
+{
+	struct metal_init_params metal_param = METAL_INIT_DEFAULTS;
+	int err;
+
+	metal_init(&metal_param);
+	if (loop_init()) {
+		printf("loopback setup failed\r\n");
+		metal_finish();
+		return -1;
+	}
+	err = loop_test();
+	loop_deinit();
+	printf("checks %s\r\n", err ? "failed" : "passed");
+	metal_finish();
+	return err ? -1 : 0;
+}
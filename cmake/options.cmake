@@ -84,6 +84,12 @@ if (WITH_VIRTIO_MMIO_DRV)
   add_definitions(-DWITH_VIRTIO_MMIO_DRV)
 endif (WITH_VIRTIO_MMIO_DRV)
 
+option (WITH_VIRTIO_MMIO_DEV "Build with virtio mmio device emulation support enabled" OFF)
+
+if (WITH_VIRTIO_MMIO_DEV)
+  add_definitions(-DWITH_VIRTIO_MMIO_DEV)
+endif (WITH_VIRTIO_MMIO_DEV)
+
 option (WITH_DCACHE "Build with all cache operations enabled" OFF)
 
 if (WITH_DCACHE)
@@ -111,6 +117,12 @@ if (WITH_DCACHE_RSC_TABLE)
   message(DEPRECATION "deprecated cmake option replaced by WITH_DCACHE" ...)
 endif (WITH_DCACHE_RSC_TABLE)
 
+option (WITH_SHBUF_DIRECT "Build with plain CPU copies to the shared buffers, which must be coherent normal memory" OFF)
+
+if (WITH_SHBUF_DIRECT)
+  add_definitions(-DRPMSG_VIRTIO_SHBUF_DIRECT)
+endif (WITH_SHBUF_DIRECT)
+
 # Set the complication flags
 set (CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -Wall -Wextra")
 
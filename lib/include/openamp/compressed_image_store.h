@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef COMPRESSED_IMAGE_STORE_H_
+#define COMPRESSED_IMAGE_STORE_H_
+
+#include <openamp/remoteproc_loader.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* "RPZ1" read as a little endian word */
+#define COMPRESSED_IMAGE_MAGIC		0x315A5052UL
+
+/**
+ * @brief Compressed image file header
+ *
+ * The uncompressed image is cut in blocks of block_size bytes, the last
+ * one possibly shorter, and each block is compressed on its own with
+ * the LZ4 block format. A block whose compressed size equals its size
+ * is stored as is. The header is followed by num_blocks + 1 offsets in
+ * the file: block n spans from offset n to offset n + 1. All fields are
+ * little endian. scripts/rproc_compress.py creates such files.
+ */
+struct compressed_image_header {
+	/** COMPRESSED_IMAGE_MAGIC */
+	uint32_t magic;
+
+	/** Uncompressed size of every block but the last one */
+	uint32_t block_size;
+
+	/** Uncompressed size of the image */
+	uint32_t image_size;
+
+	/** Number of blocks */
+	uint32_t num_blocks;
+};
+
+/**
+ * @brief Compressed image store
+ *
+ * Image store decompressing an image read from another image store.
+ * Set store and ops to the store holding the file, then pass it to
+ * remoteproc_load() with compressed_image_store_ops. Blocks loaded to
+ * target memory are decompressed straight into it; only one block and
+ * the longest load to local memory spanning blocks, e.g. a section
+ * header table or a reload chunk, are ever held in local memory. Loads to
+ * local memory are always returned in full. Images without the
+ * compressed header are passed through unchanged. The store holding
+ * the file must support seeking.
+ */
+struct compressed_image_store {
+	/** Image store holding the compressed file */
+	void *store;
+
+	/** Operations of the image store holding the compressed file */
+	const struct image_store_ops *ops;
+
+	/** Image is not compressed, requests go to the underlying store */
+	bool raw;
+
+	/** Uncompressed size of a block */
+	uint32_t block_size;
+
+	/** Uncompressed size of the image */
+	uint32_t image_size;
+
+	/** Number of blocks */
+	uint32_t num_blocks;
+
+	/** Offsets of the compressed blocks in the file */
+	uint32_t *blocks;
+
+	/** Block decompression buffer */
+	unsigned char *scratch;
+
+	/** Block held in the scratch buffer, num_blocks if none */
+	uint32_t scratch_block;
+
+	/** Buffer for loads to local memory spanning several blocks */
+	unsigned char *hdr_buf;
+
+	/** Size of the header buffer, grown to the longest such load */
+	size_t hdr_buf_len;
+};
+
+/** Image store operations of the compressed image store */
+extern const struct image_store_ops compressed_image_store_ops;
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* COMPRESSED_IMAGE_STORE_H_ */
@@ -169,6 +169,11 @@ typedef struct elf64_phdr {
 #define PT_LOPROC  0x70000000
 #define PT_HIPROC  0x7fffffff
 
+/* Segment flags */
+#define PF_X       0x1             /* Executable */
+#define PF_W       0x2             /* Writable */
+#define PF_R       0x4             /* Readable */
+
 /* ELF32 section header. */
 typedef struct {
 	Elf32_Word sh_name;
@@ -277,12 +282,53 @@ typedef struct elf64_sym {
 	Elf64_Xword st_size;
 } Elf64_Sym;
 
+/* Macros to extract information from 'st_info' field of symbol entries */
+#define ELF32_ST_BIND(i) ((i) >> 4)
+#define ELF32_ST_TYPE(i) ((i) & 0xf)
+#define ELF64_ST_BIND(i) ELF32_ST_BIND(i)
+#define ELF64_ST_TYPE(i) ELF32_ST_TYPE(i)
+
+/* Symbol binding */
+#define STB_LOCAL       0
+#define STB_GLOBAL      1
+#define STB_WEAK        2
+
+/* Symbol type */
+#define STT_NOTYPE      0
+#define STT_OBJECT      1
+#define STT_FUNC        2
+#define STT_SECTION     3
+#define STT_FILE        4
+
+/* Undefined section index */
+#define SHN_UNDEF       0
+
 /* ARM specific dynamic relocation codes */
 #define     R_ARM_GLOB_DAT	21	/* 0x15 */
 #define     R_ARM_JUMP_SLOT	22	/* 0x16 */
 #define     R_ARM_RELATIVE	23	/* 0x17 */
 #define     R_ARM_ABS32		2	/* 0x02 */
 
+/* Index the .symtab symbols as well as the section names */
+#define ELF_INDEX_SYMBOLS 0x1U
+
+/* ELF section and symbol name index */
+struct elf_index {
+	/* ELF_INDEX_* options */
+	unsigned int flags;
+	/* Hash table of section indexes + 1 by name, 0 for a free slot */
+	uint32_t *sections;
+	uint32_t sections_mask;
+	/* Symbol table and its string table, with ELF_INDEX_SYMBOLS */
+	void *symtab;
+	uint32_t symnum;
+	char *strtab;
+	size_t strtab_size;
+	/* Hash table of symbol indexes + 1 by name, 0 for a free slot */
+	uint32_t *symbols;
+	uint32_t symbols_mask;
+};
+
 /* ELF decoding information */
 struct elf32_info {
 	Elf32_Ehdr ehdr;
@@ -290,6 +336,7 @@ struct elf32_info {
 	Elf32_Phdr *phdrs;
 	Elf32_Shdr *shdrs;
 	void *shstrtab;
+	struct elf_index index;
 };
 
 struct elf64_info {
@@ -298,6 +345,7 @@ struct elf64_info {
 	Elf64_Phdr *phdrs;
 	Elf64_Shdr *shdrs;
 	void *shstrtab;
+	struct elf_index index;
 };
 
 #define ELF_STATE_INIT              0x0L
@@ -305,10 +353,14 @@ struct elf64_info {
 #define ELF_STATE_WAIT_FOR_SHDRS    0x200L
 #define ELF_STATE_WAIT_FOR_SHSTRTAB 0x400L
 #define ELF_STATE_HDRS_COMPLETE     0x800L
+#define ELF_STATE_WAIT_FOR_SYMTAB   0x1000L
+#define ELF_STATE_WAIT_FOR_STRTAB   0x2000L
 #define ELF_STATE_MASK              0xFF00L
 #define ELF_NEXT_SEGMENT_MASK       0x00FFL
 
 extern const struct loader_ops elf_ops;
+/* ELF loader which also loads and indexes the .symtab symbols */
+extern const struct loader_ops elf_symtab_ops;
 
 /**
  * @internal
@@ -438,6 +490,55 @@ metal_phys_addr_t elf_get_entry(void *img_info);
 int elf_locate_rsc_table(void *img_info, metal_phys_addr_t *da,
 			 size_t *offset, size_t *size);
 
+/**
+ * @internal
+ *
+ * @brief Check if the last loaded segment is writable
+ *
+ * It tells if the segment returned by the last elf_load() call has the
+ * PF_W flag, i.e. if the remote may modify it at run time.
+ *
+ * @param img_info	Pointer to ELF image information
+ *
+ * @return 1 if writable, 0 if read only, negative value for failure.
+ */
+int elf_segment_is_writable(void *img_info);
+
+/**
+ * @brief Locate a section by name
+ *
+ * Section names are hashed when the ELF headers are loaded, so the
+ * lookup does not scan the section headers.
+ *
+ * @param img_info	Pointer to ELF image information
+ * @param name		Section name, e.g. ".resource_table"
+ * @param da		Pointer to the section device address
+ * @param size		Pointer to the section size
+ *
+ * @return 0 if found, -RPROC_ENODEV if there is no such section, or other
+ * negative value for failure.
+ */
+int elf_find_section(void *img_info, const char *name,
+		     metal_phys_addr_t *da, size_t *size);
+
+/**
+ * @brief Locate a symbol by name
+ *
+ * Only available if the image was loaded with elf_symtab_ops, which loads
+ * the .symtab symbols with the headers and hashes their names. A global
+ * or weak symbol is preferred over a local one of the same name.
+ *
+ * @param img_info	Pointer to ELF image information
+ * @param name		Symbol name
+ * @param da		Pointer to the symbol value, i.e. its device address
+ * @param size		Pointer to the symbol size
+ *
+ * @return 0 if found, -RPROC_ENODEV if there is no such symbol or no
+ * symbol table, or other negative value for failure.
+ */
+int elf_find_symbol(void *img_info, const char *name,
+		    metal_phys_addr_t *da, size_t *size);
+
 #if defined __cplusplus
 }
 #endif
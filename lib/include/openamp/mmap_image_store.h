@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef MMAP_IMAGE_STORE_H_
+#define MMAP_IMAGE_STORE_H_
+
+#include <openamp/remoteproc_loader.h>
+#include <stddef.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief File backed image store
+ *
+ * Pass a pointer to it as the store argument of remoteproc_load() with
+ * mmap_image_store_ops, and the firmware file as the path. The file is
+ * mapped read only: headers are handed to the loader in place, and
+ * segments are copied from the page cache straight to target memory.
+ * The file stays mapped until the image is closed. Only available on
+ * systems providing mmap().
+ *
+ * With mmap_image_store_async_ops, the segments are copied by a worker
+ * thread started at open: remoteproc_load() clears the BSS of a segment
+ * and issues the next one while the previous one is copied, and waits
+ * for the copies once, before writing the resource table.
+ */
+struct mmap_image_worker;
+
+struct mmap_image_store {
+	/** File descriptor of the firmware file, -1 when closed */
+	int fd;
+
+	/** Start of the file mapping */
+	const void *base;
+
+	/** Size of the firmware file */
+	size_t size;
+
+	/** Copy worker of the non-blocking store, NULL otherwise */
+	struct mmap_image_worker *worker;
+};
+
+/** Image store operations of the file backed image store */
+extern const struct image_store_ops mmap_image_store_ops;
+
+/** Image store operations copying segments in a worker thread */
+extern const struct image_store_ops mmap_image_store_async_ops;
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* MMAP_IMAGE_STORE_H_ */
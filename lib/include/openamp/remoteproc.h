@@ -12,6 +12,7 @@
 #ifndef REMOTEPROC_H
 #define REMOTEPROC_H
 
+#include <metal/atomic.h>
 #include <metal/io.h>
 #include <metal/mutex.h>
 #include <metal/compiler.h>
@@ -355,6 +356,7 @@ struct fw_rsc_vendor {
 struct loader_ops;
 struct image_store_ops;
 struct remoteproc_ops;
+struct rsc_table_cache;
 
 /** @brief Memory used by the remote processor */
 struct remoteproc_mem {
@@ -377,6 +379,23 @@ struct remoteproc_mem {
 	struct metal_list node;
 };
 
+/**
+ * @brief Chunk of a read only segment loaded by remoteproc_reload()
+ *
+ * Remembers what a chunk of segment data left in target memory, so that
+ * the next reload can skip it if the new image has the same data there.
+ */
+struct remoteproc_seg_hash {
+	/** Device address of the chunk */
+	metal_phys_addr_t da;
+
+	/** Size of the chunk */
+	size_t len;
+
+	/** FNV-1a hash of the chunk data */
+	uint64_t hash;
+};
+
 /**
  * @brief A remote processor instance
  *
@@ -420,6 +439,21 @@ struct remoteproc {
 
 	/** Private data */
 	void *priv;
+
+	/** Read only segment chunks in target memory from the last reload */
+	struct remoteproc_seg_hash *seg_hashes;
+
+	/** Number of entries in seg_hashes */
+	unsigned int seg_hashes_num;
+
+	/** Optional callback invoked after each state change */
+	void (*state_cb)(struct remoteproc *rproc, unsigned int state);
+
+	/** Last successful parse of the resource table */
+	struct rsc_table_cache *rsc_cache;
+
+	/** Number of virtio devices waiting for their remote to be ready */
+	atomic_uint vdevs_pending;
 };
 
 /**
@@ -563,6 +597,23 @@ struct remoteproc *remoteproc_init(struct remoteproc *rproc,
  */
 int remoteproc_remove(struct remoteproc *rproc);
 
+/**
+ * @brief Set the state change callback
+ *
+ * The callback is invoked with the new state each time remoteproc_config(),
+ * remoteproc_load(), remoteproc_start(), remoteproc_stop() or
+ * remoteproc_shutdown() changes the remoteproc state. It is called without
+ * the remoteproc lock held, so it can start the next lifecycle step.
+ *
+ * @param rproc		Pointer to the remoteproc instance
+ * @param state_cb	State change callback, NULL to remove it
+ *
+ * @return 0 for success, negative value for failure
+ */
+int remoteproc_set_state_cb(struct remoteproc *rproc,
+			    void (*state_cb)(struct remoteproc *rproc,
+					     unsigned int state));
+
 /**
  * @brief Initialize remoteproc memory
  *
@@ -730,7 +781,9 @@ int remoteproc_shutdown(struct remoteproc *rproc);
  *
  * Expects the user application defines how to open the executable file and how
  * to get data from the executable file and how to load data to the target
- * memory.
+ * memory. If the image store supports SUPPORT_NONBLOCK_LOAD, segments are
+ * copied in the background and waited for before the resource table is
+ * updated.
  *
  * @param rproc		Pointer to the remoteproc instance
  * @param path		Optional path to the image file
@@ -745,6 +798,40 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 		    void *store, const struct image_store_ops *store_ops,
 		    void **img_info);
 
+/**
+ * @brief Reloads the executable, skipping unchanged segments
+ *
+ * Works as remoteproc_load(), but read only segments are read once to
+ * local memory in chunks, and the hash of each chunk is kept. A chunk with
+ * the same address, size and hash as in the previous reload is not
+ * written to target memory again; the BSS part is always cleared.
+ * Writable segments, which the remote may have modified while running,
+ * and the resource table are always written.
+ *
+ * The hashes are kept across remoteproc_stop(), which keeps the target
+ * memory, and dropped by remoteproc_shutdown(), after which target memory
+ * may be lost: the next reload then writes every segment.
+ *
+ * Only target memory writes are saved: every segment is still read from
+ * the image store in full, through local memory instead of straight to
+ * target memory. This pays off when the store is fast compared to target
+ * memory, e.g. a file on the host page cache. With a slow store such as
+ * flash or a compressed image, reading dominates and a reload takes
+ * about as long as remoteproc_load().
+ *
+ * @param rproc		Pointer to the remoteproc instance
+ * @param path		Optional path to the image file
+ * @param store		Pointer to user defined image store argument
+ * @param store_ops	Pointer to image store operations
+ * @param img_info	Pointer to memory which stores image information used
+ *			by remoteproc loader
+ *
+ * @return 0 for success and negative value for failure
+ */
+int remoteproc_reload(struct remoteproc *rproc, const char *path,
+		      void *store, const struct image_store_ops *store_ops,
+		      void **img_info);
+
 /**
  * @brief Loads the executable
  *
@@ -831,6 +918,37 @@ remoteproc_create_virtio(struct remoteproc *rproc,
 			 int vdev_id, unsigned int role,
 			 void (*rst_cb)(struct virtio_device *vdev));
 
+/**
+ * @brief Create virtio device without waiting for the remote
+ *
+ * Works as remoteproc_create_virtio(), but instead of busy waiting for the
+ * remote to set the virtio status to DRIVER_OK, the vrings are set up and
+ * ready_cb is called once remoteproc_get_notification() finds the status
+ * set, e.g. on the notification the remote sends after writing it. This
+ * lets one thread bring up many remoteprocs at the same time.
+ *
+ * ready_cb is called from remoteproc_get_notification(), or before this
+ * function returns if the remote is already ready. Its status is 0 if the
+ * virtio device can be used, e.g. by rpmsg_init_vdev() which then does
+ * not wait either, or negative if the vrings could not be set up and the
+ * device has to be removed.
+ *
+ * @param rproc		Pointer to the remoteproc instance
+ * @param vdev_id	virtio device ID
+ * @param role		virtio device role
+ * @param rst_cb	virtio device reset callback
+ * @param ready_cb	Callback invoked when the remote is ready
+ *
+ * @return Pointer to the created virtio device, NULL for failure.
+ */
+struct virtio_device *
+remoteproc_create_virtio_async(struct remoteproc *rproc,
+			       int vdev_id, unsigned int role,
+			       void (*rst_cb)(struct virtio_device *vdev),
+			       void (*ready_cb)(struct remoteproc *rproc,
+						struct virtio_device *vdev,
+						int status));
+
 /**
  * @brief Remove virtio device
  *
@@ -34,6 +34,8 @@ extern "C" {
 
 /* Loader feature macros */
 #define SUPPORT_SEEK 1UL
+/* Image store can copy to target memory in the background */
+#define SUPPORT_NONBLOCK_LOAD 2UL
 
 /* Remoteproc loader any address */
 #define RPROC_LOAD_ANYADDR ((metal_phys_addr_t)-1)
@@ -62,7 +64,19 @@ struct image_store_ops {
 	/** User-defined callback to close the "firmware" to clean up after loading */
 	void (*close)(void *store);
 
-	/** User-defined callback to load the firmware contents to target memory or local memory */
+	/**
+	 * User-defined callback to load the firmware contents to target memory or local memory
+	 *
+	 * With SUPPORT_NONBLOCK_LOAD, loads to target memory are issued with
+	 * is_blocking set to 0: the callback may return the size as soon as
+	 * the copy is queued, e.g. to a DMA engine or a worker thread, and
+	 * read the next segment while it is written. Loads to local memory
+	 * are always blocking.
+	 *
+	 * Loads to local memory always return the full size asked for.
+	 * Headers may be any size; remoteproc_reload() reads segment data
+	 * in chunks of at most 64 KiB.
+	 */
 	int (*load)(void *store, size_t offset, size_t size,
 		    const void **data,
 		    metal_phys_addr_t pa,
@@ -70,6 +84,12 @@ struct image_store_ops {
 
 	/** Loader supported features. e.g. seek */
 	unsigned int features;
+
+	/**
+	 * User-defined callback to wait for the non-blocking loads to complete,
+	 * required with SUPPORT_NONBLOCK_LOAD. Returns 0 or a negative error.
+	 */
+	int (*wait)(void *store);
 };
 
 /** @brief Loader operations */
@@ -102,6 +122,21 @@ struct loader_ops {
 
 	/** Get load state from the image information */
 	int (*get_load_state)(void *img_info);
+
+	/**
+	 * Optional: tell if the segment returned by the last load_data call
+	 * may be written at run time (1) or is read only (0). Only read only
+	 * segments are skipped by remoteproc_reload().
+	 */
+	int (*segment_is_writable)(void *img_info);
+
+	/** Optional: get the target address and size of a named section */
+	int (*locate_section)(void *img_info, const char *name,
+			      metal_phys_addr_t *da, size_t *size);
+
+	/** Optional: get the target address and size of a named symbol */
+	int (*locate_symbol)(void *img_info, const char *name,
+			     metal_phys_addr_t *da, size_t *size);
 };
 
 #if defined __cplusplus
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef REMOTEPROC_MANAGER_H_
+#define REMOTEPROC_MANAGER_H_
+
+#include <metal/atomic.h>
+#include <metal/list.h>
+#include <metal/utilities.h>
+#include <openamp/remoteproc.h>
+#include <openamp/virtio.h>
+#include <stdbool.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+struct remoteproc_mgr;
+
+/** @brief Remoteproc instance owned by a remoteproc manager */
+struct remoteproc_mgr_entry {
+	/** Remoteproc instance */
+	struct remoteproc rproc;
+
+	/** Manager owning the entry */
+	struct remoteproc_mgr *mgr;
+
+	/** Set by remoteproc_mgr_notify(), cleared when dispatched */
+	atomic_int pending;
+
+	/** Notifications dispatched to remoteproc_get_notification() */
+	unsigned long long notifications;
+
+	/** Messages received from the remote, see remoteproc_mgr_count_rx() */
+	unsigned long long rx_msgs;
+
+	/** Bytes received from the remote */
+	unsigned long long rx_bytes;
+
+	/** Messages sent to the remote, see remoteproc_mgr_count_tx() */
+	unsigned long long tx_msgs;
+
+	/** Bytes sent to the remote */
+	unsigned long long tx_bytes;
+
+	/** Failed lifecycle operations and notification dispatches */
+	unsigned long errors;
+
+	/** Timestamp of the last remoteproc_mgr_start() */
+	unsigned long long start_time;
+
+	/** Time from the start to the remote being ready */
+	unsigned long long boot_time;
+
+	/** The virtio devices created by remoteproc_mgr_create_virtio() are ready */
+	bool ready;
+
+	/** List node */
+	struct metal_list node;
+};
+
+/** @brief Aggregate statistics of a remoteproc manager */
+struct remoteproc_mgr_stats {
+	/** Number of managed remoteprocs */
+	unsigned int num;
+
+	/** Number of remoteprocs in each RPROC_* state */
+	unsigned int states[RPROC_LAST];
+
+	/** Number of remoteprocs whose remote is ready */
+	unsigned int ready;
+
+	/** Notifications dispatched to remoteproc_get_notification() */
+	unsigned long long notifications;
+
+	/** Messages received from all the remotes */
+	unsigned long long rx_msgs;
+
+	/** Bytes received from all the remotes */
+	unsigned long long rx_bytes;
+
+	/** Messages sent to all the remotes */
+	unsigned long long tx_msgs;
+
+	/** Bytes sent to all the remotes */
+	unsigned long long tx_bytes;
+
+	/** Failed lifecycle operations and notification dispatches */
+	unsigned long errors;
+
+	/** Longest time from the start to a remote being ready */
+	unsigned long long max_boot_time;
+
+	/**
+	 * Time the statistics were taken at: the throughput is the counter
+	 * difference between two calls divided by their time difference
+	 */
+	unsigned long long time;
+};
+
+/**
+ * @brief Remoteproc manager
+ *
+ * Owns many remoteproc instances and multiplexes their notifications on
+ * one event loop: interrupt handlers call remoteproc_mgr_notify() for the
+ * instance their channel belongs to, and the loop calls
+ * remoteproc_mgr_poll() which calls remoteproc_get_notification() of the
+ * notified instances only.
+ *
+ * Apart from remoteproc_mgr_notify(), which is interrupt safe, the manager
+ * functions must be called from the thread running the event loop.
+ * Times are in metal_get_timestamp() units.
+ */
+struct remoteproc_mgr {
+	/** Managed remoteprocs */
+	struct metal_list entries;
+
+	/** Number of entries notified and not dispatched yet */
+	atomic_int pending;
+
+	/** Optional callback invoked after a remoteproc state change */
+	void (*state_cb)(struct remoteproc_mgr_entry *entry,
+			 unsigned int state);
+
+	/** Optional callback invoked when a virtio device is ready */
+	void (*ready_cb)(struct remoteproc_mgr_entry *entry,
+			 struct virtio_device *vdev, int status);
+};
+
+/**
+ * @brief Initialize a remoteproc manager
+ *
+ * @param mgr		Pointer to the remoteproc manager
+ * @param state_cb	Optional remoteproc state change callback
+ * @param ready_cb	Optional virtio device ready callback, see
+ *			remoteproc_create_virtio_async()
+ */
+void remoteproc_mgr_init(struct remoteproc_mgr *mgr,
+			 void (*state_cb)(struct remoteproc_mgr_entry *entry,
+					  unsigned int state),
+			 void (*ready_cb)(struct remoteproc_mgr_entry *entry,
+					  struct virtio_device *vdev,
+					  int status));
+
+/**
+ * @brief Initialize a remoteproc instance and add it to the manager
+ *
+ * The manager uses the remoteproc state change callback, use the one of
+ * the manager instead.
+ *
+ * @param mgr		Pointer to the remoteproc manager
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ * @param ops		Remoteproc operations, see remoteproc_init()
+ * @param priv		Remoteproc private data, see remoteproc_init()
+ *
+ * @return Pointer to the remoteproc instance, NULL for failure.
+ */
+struct remoteproc *remoteproc_mgr_add(struct remoteproc_mgr *mgr,
+				      struct remoteproc_mgr_entry *entry,
+				      const struct remoteproc_ops *ops,
+				      void *priv);
+
+/**
+ * @brief Remove a remoteproc instance from the manager
+ *
+ * The remoteproc instance is removed with remoteproc_remove(), it must be
+ * offline.
+ *
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ *
+ * @return 0 for success, negative value for failure
+ */
+int remoteproc_mgr_remove(struct remoteproc_mgr_entry *entry);
+
+/**
+ * @brief Get the entry of a managed remoteproc instance
+ *
+ * @param rproc		Pointer to the remoteproc instance
+ *
+ * @return Pointer to the entry holding the remoteproc instance
+ */
+static inline struct remoteproc_mgr_entry *
+remoteproc_mgr_entry(struct remoteproc *rproc)
+{
+	return metal_container_of(rproc, struct remoteproc_mgr_entry, rproc);
+}
+
+/**
+ * @brief Start all the ready remoteproc instances
+ *
+ * The instances are started one after the other without waiting for
+ * the remotes, whose readiness is reported to the ready callback by
+ * remoteproc_mgr_poll().
+ *
+ * @param mgr		Pointer to the remoteproc manager
+ *
+ * @return Number of started instances, or the error of the last failed
+ * start.
+ */
+int remoteproc_mgr_start(struct remoteproc_mgr *mgr);
+
+/**
+ * @brief Create virtio device of a managed remoteproc instance
+ *
+ * Works as remoteproc_create_virtio_async() with the manager ready
+ * callback, and records the boot time once the remote is ready.
+ *
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ * @param vdev_id	virtio device ID
+ * @param role		virtio device role
+ * @param rst_cb	virtio device reset callback
+ *
+ * @return Pointer to the created virtio device, NULL for failure.
+ */
+struct virtio_device *
+remoteproc_mgr_create_virtio(struct remoteproc_mgr_entry *entry,
+			     int vdev_id, unsigned int role,
+			     void (*rst_cb)(struct virtio_device *vdev));
+
+/**
+ * @brief Notify the manager that a remoteproc instance got a notification
+ *
+ * Can be called from interrupt context, e.g. by the handler of the
+ * interrupt or socket of the remote.
+ *
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ */
+void remoteproc_mgr_notify(struct remoteproc_mgr_entry *entry);
+
+/**
+ * @brief Dispatch the pending notifications
+ *
+ * Calls remoteproc_get_notification() of each remoteproc instance notified
+ * since the last call. Returns at once if there is none.
+ *
+ * @param mgr		Pointer to the remoteproc manager
+ *
+ * @return Number of remoteproc instances dispatched
+ */
+int remoteproc_mgr_poll(struct remoteproc_mgr *mgr);
+
+/**
+ * @brief Account a message received from a managed remote
+ *
+ * Called by the application, e.g. from its RPMsg endpoint callback, to
+ * feed the throughput statistics.
+ *
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ * @param len		Message length in bytes
+ */
+static inline void remoteproc_mgr_count_rx(struct remoteproc_mgr_entry *entry,
+					   size_t len)
+{
+	entry->rx_msgs++;
+	entry->rx_bytes += len;
+}
+
+/**
+ * @brief Account a message sent to a managed remote
+ *
+ * @param entry		Pointer to the entry holding the remoteproc instance
+ * @param len		Message length in bytes
+ */
+static inline void remoteproc_mgr_count_tx(struct remoteproc_mgr_entry *entry,
+					   size_t len)
+{
+	entry->tx_msgs++;
+	entry->tx_bytes += len;
+}
+
+/**
+ * @brief Get the aggregate statistics of the managed remoteprocs
+ *
+ * @param mgr		Pointer to the remoteproc manager
+ * @param stats		Pointer to the statistics to fill
+ */
+void remoteproc_mgr_get_stats(struct remoteproc_mgr *mgr,
+			      struct remoteproc_mgr_stats *stats);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* REMOTEPROC_MANAGER_H_ */
@@ -36,6 +36,8 @@ extern "C" {
 #define RSC_TABLE_INVALIDATE(x, s)	do { } while (0)
 #endif /* VIRTIO_CACHED_RSC_TABLE || VIRTIO_USE_DCACHE */
 
+struct remoteproc;
+
 /* define vdev notification function user should implement */
 typedef int (*rpvdev_notify_func)(void *priv, uint32_t id);
 
@@ -58,6 +60,10 @@ struct remoteproc_virtio {
 
 	/** List node */
 	struct metal_list node;
+
+	/** Callback waiting for the remote to be ready, NULL once called */
+	void (*ready_cb)(struct remoteproc *rproc, struct virtio_device *vdev,
+			 int status);
 };
 
 /**
@@ -126,6 +132,17 @@ int rproc_virtio_notified(struct virtio_device *vdev, uint32_t notifyid);
  */
 void rproc_virtio_wait_remote_ready(struct virtio_device *vdev);
 
+/**
+ * @brief Check if the remote core is ready to start communications
+ *
+ * Non blocking version of rproc_virtio_wait_remote_ready().
+ *
+ * @param vdev	Pointer to the virtio device
+ *
+ * @return 1 if the remote processor is ready, 0 otherwise.
+ */
+int rproc_virtio_remote_ready(struct virtio_device *vdev);
+
 #if defined __cplusplus
 }
 #endif
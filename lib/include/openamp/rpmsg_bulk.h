@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef RPMSG_BULK_H
+#define RPMSG_BULK_H
+
+#include <openamp/open_amp.h>
+#include <metal/compiler.h>
+#include <metal/io.h>
+#include <metal/spinlock.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Allocation unit of the bulk buffers, a power of 2 */
+#ifndef RPMSG_BULK_BLOCK_SIZE
+#define RPMSG_BULK_BLOCK_SIZE	4096
+#endif
+
+/* Descriptors queued in each direction before a message is sent */
+#ifndef RPMSG_BULK_BATCH
+#define RPMSG_BULK_BATCH	16
+#endif
+
+/*
+ * Buffers a side passes before getting them back. The returns queued by
+ * the receiver are bounded by this number, so releasing never fails.
+ */
+#ifndef RPMSG_BULK_MAX_IN_FLIGHT
+#define RPMSG_BULK_MAX_IN_FLIGHT	64
+#endif
+
+/* Orders of the buddy allocator, up to 2^(N - 1) blocks per buffer */
+#define RPMSG_BULK_MAX_ORDERS	24
+
+/**
+ * @brief Bulk buffer descriptor
+ *
+ * Sent to pass the ownership of a buffer to the peer, and back to return
+ * it once consumed.
+ */
+METAL_PACKED_BEGIN
+struct rpmsg_bulk_desc {
+	/** Offset of the buffer in the carveout */
+	uint32_t offset;
+
+	/** Length of the data */
+	uint32_t len;
+
+	/** Value chosen by the sender, returned with the buffer */
+	uint64_t cookie;
+} METAL_PACKED_END;
+
+/**
+ * @brief Header of the bulk messages
+ *
+ * Followed by num_xfer descriptors of buffers passed to the receiver of
+ * the message, then num_ret descriptors of buffers returned to it.
+ */
+METAL_PACKED_BEGIN
+struct rpmsg_bulk_msg {
+	/** Number of buffers passed */
+	uint16_t num_xfer;
+
+	/** Number of buffers returned */
+	uint16_t num_ret;
+} METAL_PACKED_END;
+
+struct rpmsg_bulk;
+
+/**
+ * @brief Receive callback, called for each buffer passed by the peer
+ *
+ * The buffer belongs to the application until given back with
+ * rpmsg_bulk_release(). The descriptor is only valid during the call.
+ */
+typedef void (*rpmsg_bulk_rx_cb)(struct rpmsg_bulk *ch,
+				 const struct rpmsg_bulk_desc *desc,
+				 void *data);
+
+/**
+ * @brief Done callback, called for each buffer returned by the peer
+ *
+ * The buffer goes back to the local pool when the callback returns.
+ */
+typedef void (*rpmsg_bulk_done_cb)(struct rpmsg_bulk *ch, void *data,
+				   uint64_t cookie);
+
+/** @brief Buddy allocator of the local part of the carveout */
+struct rpmsg_bulk_pool {
+	/** Offset of the local part in the carveout */
+	unsigned long base;
+
+	/** Number of blocks */
+	unsigned int num;
+
+	/** Highest order */
+	unsigned int max_order;
+
+	/** Free blocks of each order, indexed by their first block */
+	unsigned long *free[RPMSG_BULK_MAX_ORDERS];
+
+	/** Order + 1 of each allocated buffer, indexed by its first block */
+	uint8_t *order;
+
+	/** Buffers passed to the peer and not returned, by their first block */
+	unsigned long *sent;
+};
+
+/**
+ * @brief Bulk data channel
+ *
+ * Passes the ownership of large buffers of a carveout shared by both
+ * cores. Only descriptors go through the RPMsg endpoint: the data stays
+ * in place.
+ *
+ * The carveout is split in two parts, one for the buffers sent by each
+ * side. Each side allocates from its own part only, so the allocator
+ * state is local and needs no lock shared with the peer. A buffer comes
+ * back to its owner once the peer releases it.
+ *
+ * Passed and returned descriptors are batched: a message is sent once
+ * RPMSG_BULK_BATCH descriptors are queued in one direction or on
+ * rpmsg_bulk_flush(), returns riding along with the transfers.
+ */
+struct rpmsg_bulk {
+	/** RPMsg endpoint */
+	struct rpmsg_endpoint ept;
+
+	/** I/O region of the carveout */
+	struct metal_io_region *io;
+
+	/** Protects the pool and the queued descriptors */
+	struct metal_spinlock lock;
+
+	/** Pool of the buffers sent by this side */
+	struct rpmsg_bulk_pool pool;
+
+	/** Descriptors of the buffers to pass */
+	struct rpmsg_bulk_desc xfer[RPMSG_BULK_BATCH];
+	unsigned int num_xfer;
+
+	/** Descriptors of the buffers to return */
+	struct rpmsg_bulk_desc ret[RPMSG_BULK_MAX_IN_FLIGHT];
+	unsigned int num_ret;
+
+	/** Receive callback */
+	rpmsg_bulk_rx_cb rx_cb;
+
+	/** Done callback, optional */
+	rpmsg_bulk_done_cb done_cb;
+
+	/** Private data of the callbacks */
+	void *priv;
+
+	/** Buffers passed to the peer and not returned yet */
+	unsigned int in_flight;
+
+	/**
+	 * Descriptors received out of the carveout, or returned for a buffer
+	 * not passed to the peer
+	 */
+	unsigned int invalid;
+};
+
+/**
+ * @brief Create a bulk data channel
+ *
+ * @param ch		Pointer to the channel
+ * @param rdev		RPMsg device
+ * @param name		Endpoint name
+ * @param src		Local address
+ * @param dest		Peer address
+ * @param io		I/O region of the carveout, as from remoteproc_mmap()
+ * @param tx_off	Offset of the part of the carveout sent by this side
+ * @param tx_size	Size of this part
+ * @param rx_cb		Receive callback
+ * @param done_cb	Done callback, optional
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_bulk_create(struct rpmsg_bulk *ch, struct rpmsg_device *rdev,
+		      const char *name, uint32_t src, uint32_t dest,
+		      struct metal_io_region *io, unsigned long tx_off,
+		      unsigned long tx_size, rpmsg_bulk_rx_cb rx_cb,
+		      rpmsg_bulk_done_cb done_cb);
+
+/**
+ * @brief Destroy a bulk data channel
+ *
+ * The buffers held by either side are lost for the channel.
+ *
+ * @param ch		Pointer to the channel
+ */
+void rpmsg_bulk_destroy(struct rpmsg_bulk *ch);
+
+/**
+ * @brief Allocate a buffer to send
+ *
+ * The size is rounded up to a power of 2 number of blocks.
+ *
+ * @param ch		Pointer to the channel
+ * @param size		Size of the buffer
+ *
+ * @return Pointer to the buffer, NULL if no buffer is free
+ */
+void *rpmsg_bulk_alloc(struct rpmsg_bulk *ch, uint32_t size);
+
+/**
+ * @brief Free a buffer allocated and not sent
+ *
+ * Buffers in flight are left alone, they are freed when returned.
+ *
+ * @param ch		Pointer to the channel
+ * @param data		Buffer
+ */
+void rpmsg_bulk_free(struct rpmsg_bulk *ch, void *data);
+
+/**
+ * @brief Pass a buffer to the peer
+ *
+ * Queues the descriptor of the buffer, sending the queued descriptors once
+ * a batch is complete. Never blocks.
+ *
+ * @param ch		Pointer to the channel
+ * @param data		Buffer from rpmsg_bulk_alloc(), not in flight
+ * @param len		Length of the data
+ * @param cookie	Value returned to the done callback
+ *
+ * @return 0 for success, -EAGAIN if RPMSG_BULK_MAX_IN_FLIGHT buffers are
+ * in flight or the batch could not be sent, other negative value for
+ * failure
+ */
+int rpmsg_bulk_send(struct rpmsg_bulk *ch, void *data, uint32_t len,
+		    uint64_t cookie);
+
+/**
+ * @brief Return a received buffer to the peer
+ *
+ * Queues the descriptor of the buffer, sending the queued descriptors once
+ * a batch is complete. Never blocks, may be called from the receive
+ * callback.
+ *
+ * @param ch		Pointer to the channel
+ * @param desc		Descriptor passed to the receive callback
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_bulk_release(struct rpmsg_bulk *ch,
+		       const struct rpmsg_bulk_desc *desc);
+
+/**
+ * @brief Send the queued descriptors
+ *
+ * Never blocks.
+ *
+ * @param ch		Pointer to the channel
+ *
+ * @return 0 for success, -EAGAIN if no TX buffer is available
+ */
+int rpmsg_bulk_flush(struct rpmsg_bulk *ch);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* RPMSG_BULK_H */
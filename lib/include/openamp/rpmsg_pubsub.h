@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef RPMSG_PUBSUB_H
+#define RPMSG_PUBSUB_H
+
+#include <openamp/open_amp.h>
+#include <metal/compiler.h>
+#include <metal/list.h>
+#include <metal/spinlock.h>
+#include <metal/utilities.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Messages of a topic held at a time, local and received */
+#ifndef RPMSG_PUBSUB_MSGS
+#define RPMSG_PUBSUB_MSGS	32
+#endif
+
+/* Message types */
+#define RPMSG_PUBSUB_DATA	1
+#define RPMSG_PUBSUB_SUB	2
+#define RPMSG_PUBSUB_UNSUB	3
+
+/* Policies of a full subscriber queue */
+#define RPMSG_PUBSUB_DROP_NEWEST	0
+#define RPMSG_PUBSUB_DROP_OLDEST	1
+
+/** @brief Header of each topic message */
+METAL_PACKED_BEGIN
+struct rpmsg_pubsub_hdr {
+	/** RPMSG_PUBSUB_* message type */
+	uint16_t type;
+
+	/** Reserved, 0 */
+	uint16_t reserved;
+} METAL_PACKED_END;
+
+struct rpmsg_pubsub_topic;
+struct rpmsg_pubsub_sub;
+
+/**
+ * @brief Published message
+ *
+ * Shared by all the local subscribers, which each hold a reference on it
+ * until they put it.
+ */
+struct rpmsg_pubsub_msg {
+	/** Payload */
+	void *data;
+
+	/** Payload length */
+	uint32_t len;
+
+	/** Topic of the message */
+	struct rpmsg_pubsub_topic *topic;
+
+	/** References, protected by the topic lock */
+	unsigned int ref;
+
+	/** Received RPMsg buffer holding the payload, NULL if local */
+	void *rx_buf;
+
+	/** Next message to free */
+	struct rpmsg_pubsub_msg *next;
+};
+
+/**
+ * @brief Notify callback, called when a message is queued
+ *
+ * Called with the topic lock held: it may only signal the subscriber, not
+ * call the topic functions.
+ */
+typedef void (*rpmsg_pubsub_notify_cb)(struct rpmsg_pubsub_sub *sub);
+
+/** @brief Subscriber of a topic */
+struct rpmsg_pubsub_sub {
+	/** Node in the subscribers of the topic */
+	struct metal_list node;
+
+	/** Topic */
+	struct rpmsg_pubsub_topic *topic;
+
+	/** Queue of the messages not taken yet */
+	struct rpmsg_pubsub_msg **queue;
+
+	/** Queue depth */
+	unsigned int depth;
+	unsigned int head;
+	unsigned int tail;
+
+	/** RPMSG_PUBSUB_DROP_* policy when the queue is full */
+	int policy;
+
+	/** Notify callback, optional */
+	rpmsg_pubsub_notify_cb notify_cb;
+
+	/** Private data of the notify callback */
+	void *priv;
+
+	/** Messages dropped because the queue was full */
+	unsigned int dropped;
+};
+
+/**
+ * @brief Topic
+ *
+ * A topic is an endpoint named after it, announced through the name
+ * service. Each core creates the topic once, with the address announced
+ * by the peer if known, and its local subscribers subscribe to it.
+ *
+ * A published payload is written once in a local buffer of the topic,
+ * the local subscribers get a reference on it. If the peer core has
+ * subscribers, the payload is copied once in an RPMsg buffer, whatever
+ * their number, and the received buffer is in turn shared by the
+ * subscribers of the peer. The cores tell each other whether they have
+ * subscribers, so nothing is sent to a core without any.
+ */
+struct rpmsg_pubsub_topic {
+	/** RPMsg endpoint */
+	struct rpmsg_endpoint ept;
+
+	/** Protects the subscribers, their queues and the messages */
+	struct metal_spinlock lock;
+
+	/** Subscribers */
+	struct metal_list subs;
+	unsigned int num_subs;
+
+	/** Subscription state last sent to the peer, -1 if none */
+	int advertised;
+
+	/** The peer has subscribers */
+	bool peer_subs;
+
+	/** Messages */
+	struct rpmsg_pubsub_msg msgs[RPMSG_PUBSUB_MSGS];
+	unsigned long used[metal_bitmap_longs(RPMSG_PUBSUB_MSGS)];
+
+	/** Local payload buffers, one per message up to num */
+	char *pool;
+	unsigned int num;
+	uint32_t size;
+
+	/** Messages not sent to the peer for lack of TX buffer */
+	unsigned int tx_dropped;
+
+	/** Messages received and dropped for lack of free message */
+	unsigned int rx_dropped;
+};
+
+/**
+ * @brief Create a topic
+ *
+ * @param topic		Pointer to the topic
+ * @param rdev		RPMsg device
+ * @param name		Topic name
+ * @param dest		Address announced by the peer, or RPMSG_ADDR_ANY
+ * @param pool		Payload buffers of the local publishers, may be NULL
+ * @param num		Number of payload buffers, up to RPMSG_PUBSUB_MSGS
+ * @param size		Size of each payload buffer
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_pubsub_topic_create(struct rpmsg_pubsub_topic *topic,
+			      struct rpmsg_device *rdev, const char *name,
+			      uint32_t dest, void *pool, unsigned int num,
+			      uint32_t size);
+
+/**
+ * @brief Destroy a topic
+ *
+ * The subscribers must have unsubscribed and put their messages.
+ *
+ * @param topic		Pointer to the topic
+ */
+void rpmsg_pubsub_topic_destroy(struct rpmsg_pubsub_topic *topic);
+
+/**
+ * @brief Subscribe to a topic
+ *
+ * @param topic		Pointer to the topic
+ * @param sub		Pointer to the subscriber
+ * @param queue		Queue storage, depth entries
+ * @param depth		Queue depth
+ * @param policy	RPMSG_PUBSUB_DROP_* policy when the queue is full
+ * @param notify_cb	Notify callback, optional
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_pubsub_subscribe(struct rpmsg_pubsub_topic *topic,
+			   struct rpmsg_pubsub_sub *sub,
+			   struct rpmsg_pubsub_msg **queue, unsigned int depth,
+			   int policy, rpmsg_pubsub_notify_cb notify_cb);
+
+/**
+ * @brief Unsubscribe from a topic
+ *
+ * The messages not taken yet are put.
+ *
+ * @param sub		Pointer to the subscriber
+ */
+void rpmsg_pubsub_unsubscribe(struct rpmsg_pubsub_sub *sub);
+
+/**
+ * @brief Get a local message to publish
+ *
+ * @param topic		Pointer to the topic
+ *
+ * @return Message whose data points to a payload buffer of the topic
+ * size, NULL if none is free
+ */
+struct rpmsg_pubsub_msg *rpmsg_pubsub_alloc(struct rpmsg_pubsub_topic *topic);
+
+/**
+ * @brief Publish a message
+ *
+ * Never blocks. The reference of the caller is given to the topic.
+ *
+ * @param msg		Message from rpmsg_pubsub_alloc()
+ * @param len		Payload length
+ *
+ * @return 0 for success, -EAGAIN if the peer could not be sent the
+ * message, other negative value for failure
+ */
+int rpmsg_pubsub_publish(struct rpmsg_pubsub_msg *msg, uint32_t len);
+
+/**
+ * @brief Publish a payload
+ *
+ * Same as rpmsg_pubsub_publish(), the payload being copied once to a
+ * local payload buffer if there are local subscribers.
+ *
+ * @param topic		Pointer to the topic
+ * @param data		Payload
+ * @param len		Payload length
+ *
+ * @return 0 for success, -EAGAIN if the peer could not be sent the
+ * message or no payload buffer is free, other negative value for failure
+ */
+int rpmsg_pubsub_publish_copy(struct rpmsg_pubsub_topic *topic,
+			      const void *data, uint32_t len);
+
+/**
+ * @brief Take the oldest queued message of a subscriber
+ *
+ * @param sub		Pointer to the subscriber
+ *
+ * @return Message, to put once read, NULL if none
+ */
+struct rpmsg_pubsub_msg *rpmsg_pubsub_take(struct rpmsg_pubsub_sub *sub);
+
+/**
+ * @brief Put a message taken by a subscriber
+ *
+ * @param msg		Message
+ */
+void rpmsg_pubsub_put(struct rpmsg_pubsub_msg *msg);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* RPMSG_PUBSUB_H */
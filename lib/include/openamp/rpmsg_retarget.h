@@ -27,6 +27,19 @@ extern "C" {
 
 #define DEFAULT_PROXY_ENDPOINT  0xFFUL
 
+/* Largest proxy message, syscall header included */
+#ifndef RPMSG_RPC_BUF_SIZE
+#define RPMSG_RPC_BUF_SIZE	496UL
+#endif
+
+/*
+ * Writes in flight before waiting for answers. The proxy needs free
+ * buffers to answer, so keep this well under the number of buffers.
+ */
+#ifndef RPMSG_RPC_MAX_POSTED
+#define RPMSG_RPC_MAX_POSTED	4U
+#endif
+
 struct rpmsg_rpc_data;
 
 typedef int (*rpmsg_rpc_poll)(void *arg);
@@ -54,6 +67,43 @@ struct rpmsg_rpc_data {
 	rpmsg_rpc_shutdown_cb shutdown_cb;
 	metal_mutex_t lock;
 	struct metal_spinlock buflock;
+
+	/** Writes sent without waiting whose answers are still due */
+	unsigned int posted;
+
+	/** First error reported by a posted write, returned on next call */
+	int posted_err;
+
+	/** Set while the write coalescing buffer is being filled or sent */
+	atomic_flag wbuf_busy;
+
+	/** File descriptor the coalesced bytes belong to */
+	int wbuf_fd;
+
+	/** Number of bytes waiting in the write coalescing buffer */
+	size_t wbuf_len;
+
+	/** Tx buffer reserved to send the coalesced bytes, NULL if none */
+	void *wbuf_tx;
+
+	/** Size of the reserved tx buffer */
+	uint32_t wbuf_tx_len;
+
+	/** Write coalescing buffer */
+	unsigned char wbuf[RPMSG_RPC_BUF_SIZE -
+			  sizeof(struct rpmsg_rpc_syscall) - 1];
+
+	/** File descriptor the read-ahead data belongs to, -1 if none */
+	int rbuf_fd;
+
+	/** Offset of the first unread byte in the read-ahead payload */
+	size_t rbuf_off;
+
+	/** Number of unread bytes left in the read-ahead payload */
+	size_t rbuf_len;
+
+	/** Read answer, syscall header followed by the read-ahead payload */
+	unsigned char rbuf[RPMSG_RPC_BUF_SIZE];
 };
 
 /**
@@ -101,7 +151,8 @@ void rpmsg_rpc_release(struct rpmsg_rpc_data *rpc);
  * @brief Request RPMsg RPC call
  *
  * This function sends RPC request it will return with the length
- * of data and the response buffer.
+ * of data and the response buffer. Writes still coalesced locally
+ * are sent before the request.
  *
  * @param rpc		Pointer to remoteproc procedure call data struct
  * @param req		Pointer to request buffer
@@ -115,6 +166,31 @@ int rpmsg_rpc_send(struct rpmsg_rpc_data *rpc,
 		   void *req, size_t len,
 		   void *resp, size_t resp_len);
 
+/**
+ * @internal
+ *
+ * @brief Flush buffered RPMsg RPC writes
+ *
+ * Writes are not waited for one by one: small writes are coalesced in
+ * a local buffer while earlier writes are in flight, and large writes
+ * are split in several requests sent back to back. The coalesced bytes
+ * are sent from the endpoint callback as soon as the last write in flight
+ * is answered, in a tx buffer reserved by the writer: they are held no
+ * longer than one proxy round trip. Only if no tx buffer could be
+ * reserved do they wait for the next call. This function sends what is
+ * still buffered and waits until the proxy has answered every outstanding
+ * write.
+ *
+ * Applications that write from time to time and then stay idle for a
+ * long time should call it to push their last output out.
+ *
+ * @param rpc	Pointer to remoteproc procedure call data struct
+ *
+ * @return 0 on success, or the error reported by the first failed
+ *	   write since the previous call.
+ */
+int rpmsg_rpc_flush(struct rpmsg_rpc_data *rpc);
+
 /**
  * @internal
  *
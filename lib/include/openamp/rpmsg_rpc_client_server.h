@@ -9,7 +9,10 @@
 #define RPMSG_RPC_CLIENT_SERVER_H
 
 #include <openamp/open_amp.h>
+#include <metal/atomic.h>
 #include <metal/compiler.h>
+#include <metal/list.h>
+#include <metal/spinlock.h>
 
 #if defined __cplusplus
 extern "C" {
@@ -17,42 +20,109 @@ extern "C" {
 
 #define RPMSG_RPC_OK		0
 #define RPMSG_RPC_INVALID_ID	(-1L)
+#define RPMSG_RPC_MSG_TOO_BIG	(-2L)
 #define RPMSG_RPC_SERVICE_NAME "rpmsg-rpc"
 
 /* RPMSG_BUFFER_SIZE = 512
  * sizeof(struct rpmsg_hdr) = 16
  * RPMSG_BUFFER_SIZE - sizeof(struct rpmsg_hdr) - 1 = 495
  * Aligning to 64 bits -> 488UL
+ *
+ * This is only the size of the fixed request and answer structures below.
+ * Messages are sized at runtime from the RPMsg buffer size and larger ones
+ * are split in fragments.
  */
 #define MAX_BUF_LEN	488UL
-#define MAX_FUNC_ID_LEN sizeof(unsigned long int)
+#define MAX_FUNC_ID_LEN sizeof(struct rpmsg_rpc_req_hdr)
+
+/*
+ * Largest params of a request and of an answer built in place in a single
+ * buffer, as checked at compile time by the generated stubs.
+ */
+#define RPMSG_RPC_MAX_REQ_PARAMS	(MAX_BUF_LEN - MAX_FUNC_ID_LEN)
+#define RPMSG_RPC_MAX_ANSWER_PARAMS	\
+	(MAX_BUF_LEN - sizeof(struct rpmsg_rpc_answer_hdr))
+
+/* Flag set in the correlation ID of each fragment of a message */
+#define RPMSG_RPC_SEQ_FRAG	0x80000000U
+
+/* Wait forever in rpmsg_rpc_client_wait() */
+#define RPMSG_RPC_WAIT_FOREVER	0xFFFFFFFFU
 
 struct rpmsg_rpc_clt;
 struct rpmsg_rpc_svr;
+struct rpmsg_rpc_call;
 
 typedef void (*rpmsg_rpc_shutdown_cb)(struct rpmsg_rpc_clt *rpc);
 typedef void (*app_cb)(struct rpmsg_rpc_clt *rpc, int statust, void *data,
 		       size_t len);
 typedef int (*rpmsg_rpc_syscall_cb)(void *data, struct rpmsg_rpc_svr *rpcs);
+typedef void (*rpmsg_rpc_call_cb)(struct rpmsg_rpc_call *call, int status,
+				  void *data, size_t len);
+typedef int (*rpmsg_rpc_clt_poll)(void *arg);
+
+/** @brief RPC request message header */
+METAL_PACKED_BEGIN
+struct rpmsg_rpc_req_hdr {
+	/** Service ID */
+	uint32_t id;
+
+	/** Correlation ID echoed in the answer, 0 if the call is not tracked */
+	uint32_t seq;
+} METAL_PACKED_END;
+
+/**
+ * @brief RPC fragment header
+ *
+ * Messages that do not fit in one RPMsg buffer are sent as a sequence of
+ * fragments. Each fragment carries the message header with
+ * RPMSG_RPC_SEQ_FRAG set in its correlation ID, followed by this header and
+ * a chunk of the params. Fragments of a message are sent in order.
+ */
+METAL_PACKED_BEGIN
+struct rpmsg_rpc_frag_hdr {
+	/** Offset of the chunk in the params */
+	uint32_t offset;
+
+	/** Total length of the params */
+	uint32_t total;
+} METAL_PACKED_END;
 
 /**
  * struct rpmsg_rpc_request - rpc request message
  *
- * @id: service id
+ * @hdr: request header
  * @params: request params
  *
  */
+METAL_PACKED_BEGIN
 struct rpmsg_rpc_request {
+	struct rpmsg_rpc_req_hdr hdr;
+	unsigned char params[MAX_BUF_LEN - MAX_FUNC_ID_LEN];
+} METAL_PACKED_END;
+
+/** @brief RPC answer message header */
+METAL_PACKED_BEGIN
+struct rpmsg_rpc_answer_hdr {
+	/** Service ID */
 	uint32_t id;
-	unsigned char params[MAX_BUF_LEN];
-};
 
-/** @brief RPC request message */
+	/** Correlation ID of the request */
+	uint32_t seq;
+
+	/** Status of RPC */
+	int32_t status;
+} METAL_PACKED_END;
+
+/** @brief RPC answer message */
 METAL_PACKED_BEGIN
 struct rpmsg_rpc_answer {
 	/** Service ID */
 	uint32_t id;
 
+	/** Correlation ID of the request */
+	uint32_t seq;
+
 	/** Status of RPC */
 	int32_t status;
 
@@ -60,6 +130,21 @@ struct rpmsg_rpc_answer {
 	unsigned char params[MAX_BUF_LEN];
 } METAL_PACKED_END;
 
+/** @brief Service ID lookup index of a service table */
+struct rpmsg_rpc_index {
+	/** Position in the service table plus one of each slot, 0 if empty */
+	uint16_t *slots;
+
+	/** Number of slots */
+	unsigned int n_slots;
+
+	/** Right shift applied to the hashed ID in hashed mode */
+	unsigned int shift;
+
+	/** Slots are indexed by service ID instead of its hash */
+	bool dense;
+};
+
 /** @brief Table for services */
 struct rpmsg_rpc_services {
 	/** Service ID */
@@ -92,6 +177,30 @@ struct rpmsg_rpc_svr {
 
 	/** Number of services */
 	unsigned int n_services;
+
+	/** Service ID lookup index */
+	struct rpmsg_rpc_index index;
+
+	/** Correlation ID of the request being dispatched */
+	uint32_t seq;
+
+	/** Length of the request being dispatched, header included */
+	size_t len;
+
+	/** Buffer used to reassemble fragmented requests */
+	void *rx_buf;
+
+	/** Size of the reassembly buffer */
+	size_t rx_buf_len;
+
+	/** Correlation ID of the request being reassembled */
+	uint32_t rx_seq;
+
+	/** Number of params bytes reassembled so far */
+	size_t rx_off;
+
+	/** Total params length of the request being reassembled, 0 if none */
+	size_t rx_total;
 };
 
 /**
@@ -112,6 +221,63 @@ struct rpmsg_rpc_clt {
 
 	/** Number of services */
 	unsigned int n_services;
+
+	/** Service ID lookup index */
+	struct rpmsg_rpc_index index;
+
+	/** List of asynchronous calls waiting for their answer */
+	struct metal_list pending;
+
+	/** Lock protecting the pending list */
+	struct metal_spinlock lock;
+
+	/** Last correlation ID allocated */
+	uint32_t seq;
+
+	/** Lock keeping the fragments of a request contiguous */
+	metal_mutex_t tx_lock;
+};
+
+/**
+ * @brief Asynchronous remote procedure call
+ *
+ * Caller-owned handle of one in-flight request. Several calls, even to the
+ * same service ID, can be in flight at once: answers are matched on the
+ * correlation ID allocated when the call is issued.
+ */
+struct rpmsg_rpc_call {
+	/** Node in the client pending list */
+	struct metal_list node;
+
+	/** Client the call has been issued on */
+	struct rpmsg_rpc_clt *rpc;
+
+	/** Service ID */
+	uint32_t id;
+
+	/** Correlation ID */
+	uint32_t seq;
+
+	/** Completion callback, may be NULL */
+	rpmsg_rpc_call_cb cb;
+
+	/** Private data of the completion callback */
+	void *priv;
+
+	/** Status of the call, valid once it is completed */
+	int status;
+
+	/** Buffer used to reassemble a fragmented answer, may be NULL */
+	void *rx_buf;
+
+	/** Size of the reassembly buffer */
+	size_t rx_len;
+
+	/** Number of bytes reassembled so far */
+	size_t rx_off;
+
+	/** Set while the call is waiting for its answer */
+	atomic_flag nacked;
 };
 
 /**
@@ -153,7 +319,11 @@ int rpmsg_rpc_client_init(struct rpmsg_rpc_clt *rpc,
  *
  * @brief Initialize RPMsg rpc for server
  *
- * This function create endpoint and loads services into table
+ * This function create endpoint and loads services into table. An index
+ * of the service IDs is built so that requests are dispatched in constant
+ * time whatever the number of services. The service callbacks receive the
+ * request in place in the receive buffer, header included, its length
+ * being in rpcs->len.
  *
  * @param rpcs				Pointer to the server rpc
  * @param rdev				Pointer to the rpmsg device
@@ -167,11 +337,38 @@ int rpmsg_rpc_server_init(struct rpmsg_rpc_svr *rpcs, struct rpmsg_device *rdev,
 			  const struct rpmsg_rpc_services *services, int len,
 			  rpmsg_ns_unbind_cb rpmsg_service_server_unbind);
 
+/**
+ * @brief Set the buffer used to reassemble large requests
+ *
+ * Requests larger than one RPMsg buffer are received in fragments and
+ * reassembled in this buffer before being dispatched. It holds the
+ * request header followed by the params. Without it, or if it is too
+ * small, such requests are answered with RPMSG_RPC_MSG_TOO_BIG.
+ *
+ * @param rpcs	Pointer to the server rpc
+ * @param buf	Reassembly buffer
+ * @param len	Size of the reassembly buffer
+ */
+void rpmsg_rpc_server_set_rx_buffer(struct rpmsg_rpc_svr *rpcs, void *buf,
+				    size_t len);
+
+/**
+ * @brief Release RPMsg rpc for server
+ *
+ * This function destroys the endpoint and releases the service lookup index
+ *
+ * @param rpcs	Pointer to the server rpc
+ */
+void rpmsg_rpc_server_release(struct rpmsg_rpc_svr *rpcs);
+
 /**
  * @internal
  *
  * @brief Request RPMsg RPC call
  *
+ * Params larger than one RPMsg buffer are sent in fragments, waiting for
+ * free buffers as the remote consumes them.
+ *
  * @param rpc			Pointer to client remoteproc procedure call
  *				data
  * @param rpc_id		Function id
@@ -184,12 +381,159 @@ int rpmsg_rpc_client_send(struct rpmsg_rpc_clt *rpc,
 			  unsigned int rpc_id, void *request_param,
 			  size_t req_param_size);
 
+/**
+ * @brief Issue an asynchronous RPMsg RPC call
+ *
+ * The call is tracked with its own correlation ID, so it does not wait for
+ * previous calls to complete. When the answer is received, the call is
+ * removed from the pending list and cb is invoked with the answer status
+ * and params. The params are only valid during the callback. If the
+ * endpoint is released before the answer is received, cb is invoked with
+ * a negative status and no params. The call is completed before cb is
+ * invoked and is not touched afterwards, so cb may free or reuse it.
+ *
+ * @param rpc			Pointer to client remoteproc procedure call
+ *				data
+ * @param call			Pointer to the caller-owned call handle
+ * @param rpc_id		Function id
+ * @param request_param		Pointer to request buffer
+ * @param req_param_size	Length of the request data
+ * @param cb			Completion callback, may be NULL
+ * @param priv			Private data of the completion callback
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_client_call_async(struct rpmsg_rpc_clt *rpc,
+				struct rpmsg_rpc_call *call,
+				unsigned int rpc_id, void *request_param,
+				size_t req_param_size,
+				rpmsg_rpc_call_cb cb, void *priv);
+
+/**
+ * @brief Issue an asynchronous RPMsg RPC call with a large answer
+ *
+ * Same as \ref rpmsg_rpc_client_call_async, with a buffer to reassemble an
+ * answer larger than one RPMsg buffer. For a fragmented answer, cb is
+ * invoked once all the fragments are received, with data pointing to
+ * resp_buf. If the answer does not fit in resp_buf the call completes
+ * with -EMSGSIZE. If cb is NULL, the answer params are copied to resp_buf
+ * whether fragmented or not, and their length is stored in call->rx_off
+ * for \ref rpmsg_rpc_client_wait callers.
+ *
+ * @param rpc			Pointer to client remoteproc procedure call
+ *				data
+ * @param call			Pointer to the caller-owned call handle
+ * @param rpc_id		Function id
+ * @param request_param		Pointer to request buffer
+ * @param req_param_size	Length of the request data
+ * @param resp_buf		Buffer to reassemble the answer params
+ * @param resp_len		Size of resp_buf
+ * @param cb			Completion callback, may be NULL
+ * @param priv			Private data of the completion callback
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_client_call_stream(struct rpmsg_rpc_clt *rpc,
+				 struct rpmsg_rpc_call *call,
+				 unsigned int rpc_id, void *request_param,
+				 size_t req_param_size,
+				 void *resp_buf, size_t resp_len,
+				 rpmsg_rpc_call_cb cb, void *priv);
+
+/**
+ * @brief Get a tx buffer to build the params of a request in place
+ *
+ * The params are written directly in the RPMsg buffer, then sent with
+ * \ref rpmsg_rpc_client_call_nocopy or released with
+ * \ref rpmsg_rpc_client_release_tx_params. Such requests are not
+ * fragmented: the params must fit in one buffer.
+ *
+ * @param rpc	Pointer to client remoteproc procedure call data
+ * @param len	Length of the request params
+ * @param wait	Wait while no tx buffer is available
+ *
+ * @return Pointer to the params area of the buffer, NULL if no buffer is
+ * available or the params do not fit.
+ */
+void *rpmsg_rpc_client_get_tx_params(struct rpmsg_rpc_clt *rpc, size_t len,
+				     bool wait);
+
+/**
+ * @brief Release a tx buffer got and not sent
+ *
+ * @param rpc		Pointer to client remoteproc procedure call data
+ * @param params	Params area from \ref rpmsg_rpc_client_get_tx_params
+ */
+void rpmsg_rpc_client_release_tx_params(struct rpmsg_rpc_clt *rpc,
+					void *params);
+
+/**
+ * @brief Issue an RPMsg RPC call built in place in a tx buffer
+ *
+ * Same as \ref rpmsg_rpc_client_call_stream, the params being sent without
+ * copy. If call is NULL the request is not tracked and no answer is
+ * expected. The buffer is released on failure.
+ *
+ * @param rpc		Pointer to client remoteproc procedure call data
+ * @param call		Pointer to the caller-owned call handle, may be NULL
+ * @param rpc_id	Function id
+ * @param params	Params area from \ref rpmsg_rpc_client_get_tx_params
+ * @param len		Length of the request params
+ * @param resp_buf	Buffer to reassemble the answer params, may be NULL
+ * @param resp_len	Size of resp_buf
+ * @param cb		Completion callback, may be NULL
+ * @param priv		Private data of the completion callback
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_client_call_nocopy(struct rpmsg_rpc_clt *rpc,
+				 struct rpmsg_rpc_call *call,
+				 unsigned int rpc_id, void *params, size_t len,
+				 void *resp_buf, size_t resp_len,
+				 rpmsg_rpc_call_cb cb, void *priv);
+
+/**
+ * @brief Cancel an asynchronous RPMsg RPC call
+ *
+ * The call is removed from the pending list and its status set to
+ * -ECANCELED. A late answer is dropped. The completion callback is not
+ * invoked.
+ *
+ * @param call	Pointer to the call handle
+ *
+ * @return 0 on success, -ENOENT if the call is no longer pending.
+ */
+int rpmsg_rpc_client_cancel(struct rpmsg_rpc_call *call);
+
+/**
+ * @brief Wait for the completion of an asynchronous RPMsg RPC call
+ *
+ * The call completes before its callback is invoked, so the wait may
+ * return while the callback is still running. To use the answer params
+ * after the wait, issue the call with a response buffer and no callback.
+ *
+ * @param call		Pointer to the call handle
+ * @param poll		Function processing incoming messages, may be NULL
+ *			if they are processed in another context
+ * @param poll_arg	Argument of the poll function
+ * @param timeout_ms	Timeout in milliseconds or RPMSG_RPC_WAIT_FOREVER.
+ *			On timeout the call is cancelled.
+ *
+ * @return Status of the answer, -ETIMEDOUT on timeout, or a negative value
+ * if the call has been cancelled.
+ */
+int rpmsg_rpc_client_wait(struct rpmsg_rpc_call *call,
+			  rpmsg_rpc_clt_poll poll, void *poll_arg,
+			  uint32_t timeout_ms);
+
 /**
  * @internal
  *
  * @brief Request RPMsg RPC call
  *
- * This function sends RPC request
+ * This function sends RPC request. The answer carries the correlation ID
+ * of the request being dispatched, so it must be sent from the service
+ * callback. Params larger than one RPMsg buffer are sent in fragments.
  *
  * @param rpcs		Pointer to server rpc data
  * @param rpc_id	Function id
@@ -203,6 +547,50 @@ int rpmsg_rpc_server_send(struct rpmsg_rpc_svr *rpcs, uint32_t rpc_id,
 			  int status, void *request_param,
 			  size_t param_size);
 
+/**
+ * @brief Get a tx buffer to build the params of an answer in place
+ *
+ * Same as \ref rpmsg_rpc_client_get_tx_params for the answers, sent with
+ * \ref rpmsg_rpc_server_send_nocopy or released with
+ * \ref rpmsg_rpc_server_release_tx_params.
+ *
+ * @param rpcs	Pointer to server rpc data
+ * @param len	Length of the answer params
+ * @param wait	Wait while no tx buffer is available
+ *
+ * @return Pointer to the params area of the buffer, NULL if no buffer is
+ * available or the params do not fit.
+ */
+void *rpmsg_rpc_server_get_tx_params(struct rpmsg_rpc_svr *rpcs, size_t len,
+				     bool wait);
+
+/**
+ * @brief Release a tx buffer got and not sent
+ *
+ * @param rpcs		Pointer to server rpc data
+ * @param params	Params area from \ref rpmsg_rpc_server_get_tx_params
+ */
+void rpmsg_rpc_server_release_tx_params(struct rpmsg_rpc_svr *rpcs,
+					void *params);
+
+/**
+ * @brief Send an answer built in place in a tx buffer
+ *
+ * Same as \ref rpmsg_rpc_server_send, the params being sent without copy.
+ * It must be sent from the service callback. The buffer is released on
+ * failure.
+ *
+ * @param rpcs		Pointer to server rpc data
+ * @param rpc_id	Function id
+ * @param status	Status of rpc
+ * @param params	Params area from \ref rpmsg_rpc_server_get_tx_params
+ * @param len		Length of the answer params
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_server_send_nocopy(struct rpmsg_rpc_svr *rpcs, uint32_t rpc_id,
+				 int status, void *params, size_t len);
+
 #if defined __cplusplus
 }
 #endif
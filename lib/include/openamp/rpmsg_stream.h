@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef RPMSG_STREAM_H
+#define RPMSG_STREAM_H
+
+#include <openamp/open_amp.h>
+#include <metal/compiler.h>
+#include <metal/spinlock.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Receive window of a stream, in RPMsg buffers: the number of received
+ * buffers a stream can hold before the peer has to wait for credit.
+ */
+#ifndef RPMSG_STREAM_WINDOW
+#define RPMSG_STREAM_WINDOW	16
+#endif
+
+/* Message types */
+#define RPMSG_STREAM_CONNECT	1
+#define RPMSG_STREAM_ACCEPT	2
+#define RPMSG_STREAM_DATA	3
+#define RPMSG_STREAM_CREDIT	4
+#define RPMSG_STREAM_CLOSE	5
+#define RPMSG_STREAM_RESET	6
+
+/* Stream states */
+#define RPMSG_STREAM_CLOSED		0
+#define RPMSG_STREAM_LISTEN		1
+#define RPMSG_STREAM_CONNECTING		2
+#define RPMSG_STREAM_CONNECTED		3
+#define RPMSG_STREAM_PEER_CLOSED	4
+
+/* Events passed to the event callback */
+#define RPMSG_STREAM_EV_CONNECTED	1
+#define RPMSG_STREAM_EV_READABLE	2
+#define RPMSG_STREAM_EV_WRITABLE	3
+#define RPMSG_STREAM_EV_CLOSED		4
+
+/**
+ * @brief Header of each stream message
+ *
+ * Every message advertises the receive window of its sender, so that
+ * credit travels with the data in both directions.
+ */
+METAL_PACKED_BEGIN
+struct rpmsg_stream_hdr {
+	/** RPMSG_STREAM_* message type */
+	uint16_t type;
+
+	/** Reserved, 0 */
+	uint16_t reserved;
+
+	/** Receive window of the sender, in buffers */
+	uint32_t buf_alloc;
+
+	/** Number of DATA buffers consumed by the sender so far */
+	uint32_t fwd_cnt;
+} METAL_PACKED_END;
+
+struct rpmsg_stream;
+
+/** @brief Event callback, called with one of RPMSG_STREAM_EV_* */
+typedef void (*rpmsg_stream_event_cb)(struct rpmsg_stream *s, int event);
+
+/**
+ * @brief Accept callback of a listening stream
+ *
+ * Returns an unused stream to connect to the peer at address src, or NULL
+ * to refuse the connection. The event_cb and priv of the returned stream
+ * are kept, its event_cb defaults to the one of the listening stream.
+ */
+typedef struct rpmsg_stream *(*rpmsg_stream_accept_cb)(struct rpmsg_stream *ls,
+							uint32_t src);
+
+/** @brief Received DATA buffer held by a stream */
+struct rpmsg_stream_seg {
+	/** RPMsg buffer, starting with the stream header */
+	char *buf;
+
+	/** Length of the data following the header */
+	uint32_t len;
+};
+
+/**
+ * @brief Connection oriented byte stream over an RPMsg endpoint
+ *
+ * A listening stream waits for connections on an endpoint announced
+ * through the name service. Each connection gets its own endpoint on both
+ * sides.
+ *
+ * Flow control counts RPMsg buffers: a stream sends at most as many DATA
+ * buffers as the receive window of its peer allows beyond the ones the
+ * peer consumed. Small writes are coalesced in a buffer which is sent once
+ * full or on rpmsg_stream_flush(). Received buffers are held and read in
+ * place, they are released to the RPMsg device once consumed.
+ *
+ * All the calls are non blocking except the sending of the control
+ * messages, which waits for a TX buffer like rpmsg_send().
+ */
+struct rpmsg_stream {
+	/** RPMsg endpoint */
+	struct rpmsg_endpoint ept;
+
+	/** RPMSG_STREAM_* state */
+	int state;
+
+	/** Protects the receive ring and the credit of the peer */
+	struct metal_spinlock lock;
+
+	/** Accept callback of a listening stream */
+	rpmsg_stream_accept_cb accept_cb;
+
+	/** Event callback */
+	rpmsg_stream_event_cb event_cb;
+
+	/** Private data of the callbacks */
+	void *priv;
+
+	/** Held DATA buffers, from rx_tail to rx_head */
+	struct rpmsg_stream_seg rx[RPMSG_STREAM_WINDOW];
+	unsigned int rx_head;
+	unsigned int rx_tail;
+
+	/** Read offset in the first held buffer */
+	uint32_t rx_off;
+
+	/** DATA buffers consumed */
+	uint32_t fwd_cnt;
+
+	/** fwd_cnt last advertised to the peer */
+	uint32_t fwd_sent;
+
+	/** TX buffer being filled, NULL if none */
+	char *tx_buf;
+
+	/** Length of the data in tx_buf */
+	uint32_t tx_len;
+
+	/** Room for data in tx_buf */
+	uint32_t tx_size;
+
+	/** DATA buffers sent, including tx_buf */
+	uint32_t tx_cnt;
+
+	/** Receive window of the peer, in buffers */
+	uint32_t peer_buf_alloc;
+
+	/** DATA buffers consumed by the peer */
+	uint32_t peer_fwd_cnt;
+};
+
+/**
+ * @brief Listen for stream connections
+ *
+ * Creates an endpoint named after the service, announced to the peer
+ * through the name service.
+ *
+ * @param ls		Pointer to the listening stream
+ * @param rdev		RPMsg device
+ * @param name		Service name
+ * @param accept_cb	Accept callback
+ * @param event_cb	Default event callback of the accepted streams
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_stream_listen(struct rpmsg_stream *ls, struct rpmsg_device *rdev,
+			const char *name, rpmsg_stream_accept_cb accept_cb,
+			rpmsg_stream_event_cb event_cb);
+
+/**
+ * @brief Connect a stream to a listening stream
+ *
+ * Typically called from the name service bind callback of the RPMsg
+ * device. The event callback gets RPMSG_STREAM_EV_CONNECTED once the
+ * connection is accepted, or RPMSG_STREAM_EV_CLOSED if it is refused.
+ *
+ * @param s		Pointer to the stream
+ * @param rdev		RPMsg device
+ * @param name		Service name
+ * @param dest		Address of the listening endpoint
+ * @param event_cb	Event callback
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_stream_connect(struct rpmsg_stream *s, struct rpmsg_device *rdev,
+			 const char *name, uint32_t dest,
+			 rpmsg_stream_event_cb event_cb);
+
+/**
+ * @brief Write to a stream
+ *
+ * Copies the data to TX buffers. Full buffers are sent, the last one is
+ * kept to coalesce the next writes until rpmsg_stream_flush().
+ *
+ * @param s		Pointer to the stream
+ * @param data		Data
+ * @param len		Length of the data
+ *
+ * @return Number of bytes written, -EAGAIN if out of credit or TX
+ * buffers, -ENOTCONN or -EPIPE if the stream is not connected
+ */
+int rpmsg_stream_write(struct rpmsg_stream *s, const void *data,
+		       uint32_t len);
+
+/**
+ * @brief Send the partially filled TX buffer of a stream
+ *
+ * @param s		Pointer to the stream
+ *
+ * @return 0 for success, negative value for failure
+ */
+int rpmsg_stream_flush(struct rpmsg_stream *s);
+
+/**
+ * @brief Get the next received data in place
+ *
+ * The data stays valid until consumed by rpmsg_stream_consume().
+ *
+ * @param s		Pointer to the stream
+ * @param data		Returns the address of the data
+ *
+ * @return Number of contiguous bytes at data, 0 at the end of the stream,
+ * -EAGAIN if no data is available
+ */
+int rpmsg_stream_peek(struct rpmsg_stream *s, void **data);
+
+/**
+ * @brief Consume received data
+ *
+ * Releases the fully consumed buffers and returns credit to the peer.
+ * The credit is sent without waiting for a TX buffer while received
+ * buffers are still held, and retried by the next write, flush or peek.
+ * Once all the received data is consumed, it waits for a TX buffer.
+ *
+ * @param s		Pointer to the stream
+ * @param len		Number of bytes to consume
+ */
+void rpmsg_stream_consume(struct rpmsg_stream *s, uint32_t len);
+
+/**
+ * @brief Read from a stream
+ *
+ * @param s		Pointer to the stream
+ * @param buf		Destination buffer
+ * @param len		Size of the destination buffer
+ *
+ * @return Number of bytes read, 0 at the end of the stream, -EAGAIN if no
+ * data is available
+ */
+int rpmsg_stream_read(struct rpmsg_stream *s, void *buf, uint32_t len);
+
+/**
+ * @brief Close a stream
+ *
+ * Flushes the pending data, tells the peer and destroys the endpoint. The
+ * received data not consumed yet is dropped.
+ *
+ * @param s		Pointer to the stream
+ */
+void rpmsg_stream_close(struct rpmsg_stream *s);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* RPMSG_STREAM_H */
@@ -29,6 +29,7 @@ extern "C" {
 
 /* The feature bitmap for virtio rpmsg */
 #define VIRTIO_RPMSG_F_NS	0 /* RP supports name service notifications */
+#define VIRTIO_RPMSG_F_RESIZE	1 /* RP supports resizing the vrings */
 
 #ifdef VIRTIO_CACHED_BUFFERS
 #warning "VIRTIO_CACHED_BUFFERS is deprecated, please use VIRTIO_USE_DCACHE"
@@ -73,6 +74,30 @@ struct rpmsg_virtio_config {
 	bool split_shpool;
 };
 
+/**
+ * @brief Vring resize area of the RPMsg virtio configuration space
+ *
+ * Starts the vdev configuration space when the VIRTIO_RPMSG_F_RESIZE
+ * feature is negotiated. The host writes the proposed vring sizes and
+ * bumps req, the remote writes req back to ack once it has stopped using
+ * the vrings, see rpmsg_virtio_resize(). Either side writes req to abort
+ * when it rejects or gives up the resize.
+ */
+METAL_PACKED_BEGIN
+struct rpmsg_virtio_resize_config {
+	/** Sequence number of the last resize proposed by the host */
+	uint32_t req;
+
+	/** Sequence number of the last resize acknowledged by the remote */
+	uint32_t ack;
+
+	/** Proposed number of descriptors of each vring, in vdev order */
+	uint32_t vring_num[2];
+
+	/** Sequence number of the last resize that failed */
+	uint32_t abort;
+} METAL_PACKED_END;
+
 /** @brief Representation of a RPMsg device based on virtio */
 struct rpmsg_virtio_device {
 	/** RPMsg device */
@@ -93,9 +118,23 @@ struct rpmsg_virtio_device {
 	/** Pointer to the shared buffer I/O region */
 	struct metal_io_region *shbuf_io;
 
+	/**
+	 * The shared buffers are declared coherent normal memory with
+	 * RPMSG_VIRTIO_SHBUF_DIRECT and mapped in our address space, so they
+	 * are written with plain CPU stores instead of going through
+	 * \ref metal_io_block_write
+	 */
+	bool shbuf_io_direct;
+
 	/** Pointer to the shared buffers pool */
 	struct rpmsg_virtio_shm_pool *shpool;
 
+	/**
+	 * Number of descriptors each vring has memory for: its size at
+	 * initialization, e.g. from the resource table
+	 */
+	uint32_t vring_num_max[2];
+
 	/**
 	 * RPMsg buffer reclaimer that contains buffers released by the
 	 * \ref rpmsg_virtio_release_tx_buffer function
@@ -349,6 +388,62 @@ int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
  */
 void rpmsg_deinit_vdev(struct rpmsg_virtio_device *rvdev);
 
+/**
+ * @brief Resize the vrings of a running rpmsg virtio device
+ *
+ * Host side only, the device must have the VIRTIO_RPMSG_F_RESIZE feature.
+ * The new vring sizes are proposed to the remote through the vdev
+ * configuration space, and the function waits until the remote has
+ * acknowledged them with rpmsg_virtio_resize_poll(). The virtqueues are
+ * then rebuilt on the same vring addresses, with the buffers carved again
+ * from the shared memory pool, and the driver ready is set again. The
+ * endpoints are kept.
+ *
+ * The rpmsg traffic must be quiesced on both sides: no message in flight,
+ * and no buffer held with rpmsg_hold_rx_buffer() or obtained with
+ * rpmsg_get_tx_payload_buffer(). A vring cannot grow beyond its size at
+ * initialization, which the memory reserved for it was sized for.
+ *
+ * The remote is waited for at most 15 seconds. If it rejects the sizes,
+ * the device keeps running with the old vrings. If it does not answer in
+ * time, or the virtqueues cannot be rebuilt, the resize is aborted in the
+ * configuration space and the device has to be deinitialized.
+ *
+ * @param rvdev		Pointer to the rpmsg virtio device
+ * @param rx_num	Number of descriptors of the receive vring, power of 2
+ * @param tx_num	Number of descriptors of the send vring, power of 2
+ * @param shpool	Pointer to the shared memory pool array, as for
+ *			rpmsg_init_vdev_with_config(). The pools are reset.
+ * @param config	Pointer to the new buffer sizes, NULL to keep them
+ *
+ * @return 0 on success, RPMSG_ERR_PERM if the device cannot be resized,
+ * RPMSG_ERR_PARAM if the sizes are invalid or rejected by the remote,
+ * RPMSG_ERR_DEV_STATE if the resize was aborted, otherwise error code.
+ */
+int rpmsg_virtio_resize(struct rpmsg_virtio_device *rvdev,
+			unsigned int rx_num, unsigned int tx_num,
+			struct rpmsg_virtio_shm_pool *shpool,
+			const struct rpmsg_virtio_config *config);
+
+/**
+ * @brief Apply the vring resize proposed by the host
+ *
+ * Remote side only. Returns at once if no resize is pending. Sizes the
+ * vrings have no memory for are rejected, and the device keeps running.
+ * Otherwise the virtqueues are deleted, the resize is acknowledged, and
+ * the host is waited for at most 15 seconds to set the driver ready on
+ * the rebuilt vrings. Call it when the vdev is notified, e.g. after
+ * remoteproc_get_notification().
+ *
+ * @param rvdev	Pointer to the rpmsg virtio device
+ *
+ * @return 1 if the vrings have been resized, 0 if no resize is pending,
+ * RPMSG_ERR_PARAM if the sizes were rejected, RPMSG_ERR_DEV_STATE if the
+ * resize was aborted, in which case the device has to be deinitialized,
+ * otherwise error code.
+ */
+int rpmsg_virtio_resize_poll(struct rpmsg_virtio_device *rvdev);
+
 /**
  * @brief Initialize default shared buffers pool
  *
@@ -19,11 +19,56 @@ extern "C" {
 /* Standard control request handling. */
 typedef int (*rsc_handler)(struct remoteproc *rproc, void *rsc);
 
+/** @brief Resource handled by a parse of the resource table */
+struct rsc_cache_entry {
+	/** Resource type */
+	uint32_t type;
+
+	/** Offset of the resource in the resource table */
+	uint32_t offset;
+};
+
+/**
+ * @brief Parsed resource table
+ *
+ * Compact record of the last successful parse of a resource table, keyed
+ * by the hash of the table as it was before the parse assigned the notify
+ * IDs. When the same table is handled again, e.g. on a warm restart of the
+ * same firmware, handle_rsc_table() replays it instead of walking and
+ * validating the table again.
+ */
+struct rsc_table_cache {
+	/** Hash of the resource table before it was parsed */
+	uint64_t hash;
+
+	/** Size of the resource table */
+	size_t size;
+
+	/** Notify IDs allocated by the parse */
+	unsigned long bitmap;
+
+	/** Number of handled resources */
+	unsigned int num;
+
+	/** Number of notify IDs assigned to the virtio resources */
+	unsigned int num_ids;
+
+	/** Handled resources, in resource table order */
+	struct rsc_cache_entry *entries;
+
+	/** Notify IDs of the virtio devices each followed by its vrings */
+	uint32_t *ids;
+};
+
 /**
  * @internal
  *
  * @brief This function parses resource table.
  *
+ * If the table matches the one recorded by the last parse of the
+ * remoteproc instance, and its notify IDs are still free, the recorded
+ * parse is replayed instead.
+ *
  * @param rproc		Pointer to remote remoteproc
  * @param rsc_table	Resource table to parse
  * @param len		Size of rsc table
@@ -76,6 +121,24 @@ int handle_vendor_rsc(struct remoteproc *rproc, void *rsc);
  */
 size_t find_rsc(void *rsc_table, unsigned int rsc_type, unsigned int index);
 
+/**
+ * @internal
+ *
+ * @brief Find out location of a resource type from the parsed resource table.
+ *
+ * Works as find_rsc() without reading the resource table.
+ *
+ * @param cache		Pointer to the parsed resource table, can be NULL
+ * @param size		Size of the resource table
+ * @param rsc_type	Type of the resource
+ * @param index		Index of the resource of the specified type
+ *
+ * @return The offset to the resource on success, or 0 if the resource or
+ * the parsed resource table of this size is not found.
+ */
+size_t rsc_table_cache_find(const struct rsc_table_cache *cache, size_t size,
+			    unsigned int rsc_type, unsigned int index);
+
 #if defined __cplusplus
 }
 #endif
@@ -161,6 +161,9 @@ struct virtio_device_id {
 #define VIRTIO_TRANSPORT_F_START      28
 #define VIRTIO_TRANSPORT_F_END        32
 
+/* Compliance with the virtio 1.0 specification, e.g. virtio-mmio version 2 */
+#define VIRTIO_F_VERSION_1            (1ULL << 32)
+
 #ifdef VIRTIO_DEBUG
 #include <metal/log.h>
 /*
@@ -182,6 +185,15 @@ struct virtio_device_id {
 
 //定义了 VirtIO MMIO 环形队列的内存对齐要求，设置为 4096 字节
 #define VIRTIO_MMIO_VRING_ALIGNMENT           4096
+
+/*
+ * Used ring alignment of virtio-mmio version 2 vrings: the rings addresses
+ * are programmed separately, so a cache line is enough to keep the used
+ * ring apart from the avail ring.
+ */
+#ifndef VIRTIO_MMIO_V2_VRING_ALIGNMENT
+#define VIRTIO_MMIO_V2_VRING_ALIGNMENT        64
+#endif
 /*
 定义了一个函数指针类型，指向的函数用于重置 VirtIO 设备。
 这种类型的函数通常在设备需要被重置到初始状态时被调用，
@@ -506,7 +518,8 @@ static inline int virtio_get_features(struct virtio_device *vdev,
  * @param dev		Pointer to device structure.
  * @param features	Features supported by the driver as a bitfield.
  *
- * @return 0 on success, otherwise error code.
+ * @return 0 on success, -EIO if the transport gave the device up with
+ * VIRTIO_CONFIG_STATUS_FAILED during the negotiation, otherwise error code.
  */
 static inline int virtio_set_features(struct virtio_device *vdev,
 				      uint32_t features)
@@ -518,6 +531,9 @@ static inline int virtio_set_features(struct virtio_device *vdev,
 		return -ENXIO;
 
 	vdev->func->set_features(vdev, features);
+	if (vdev->func->get_status &&
+	    (vdev->func->get_status(vdev) & VIRTIO_CONFIG_STATUS_FAILED))
+		return -EIO;
 	return 0;
 }
 
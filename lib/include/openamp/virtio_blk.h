@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_BLK_H
+#define OPENAMP_VIRTIO_BLK_H
+
+#include <metal/compiler.h>
+#include <openamp/virtio.h>
+#include <openamp/virtqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Feature bits */
+#define VIRTIO_BLK_F_SIZE_MAX		1
+#define VIRTIO_BLK_F_SEG_MAX		2
+#define VIRTIO_BLK_F_RO			5
+#define VIRTIO_BLK_F_BLK_SIZE		6
+#define VIRTIO_BLK_F_FLUSH		9
+
+/* Request types */
+#define VIRTIO_BLK_T_IN			0
+#define VIRTIO_BLK_T_OUT		1
+#define VIRTIO_BLK_T_FLUSH		4
+#define VIRTIO_BLK_T_GET_ID		8
+
+/* Request status, written by the device */
+#define VIRTIO_BLK_S_OK			0
+#define VIRTIO_BLK_S_IOERR		1
+#define VIRTIO_BLK_S_UNSUPP		2
+
+/** Size of the sectors the requests are addressed in */
+#define VIRTIO_BLK_SECTOR_SIZE		512
+
+/** Size of the device ID returned by VIRTIO_BLK_T_GET_ID */
+#define VIRTIO_BLK_ID_BYTES		20
+
+/** Descriptors used by a request: header, data and status */
+#define VIRTIO_BLK_REQ_DESCS		3
+
+/** @brief Device configuration layout, up to the block size */
+METAL_PACKED_BEGIN
+struct virtio_blk_config {
+	/** Capacity in 512 bytes sectors */
+	uint64_t capacity;
+
+	/** Maximum size of a segment, if VIRTIO_BLK_F_SIZE_MAX */
+	uint32_t size_max;
+
+	/** Maximum number of segments, if VIRTIO_BLK_F_SEG_MAX */
+	uint32_t seg_max;
+
+	/** Legacy geometry */
+	uint16_t cylinders;
+	uint8_t heads;
+	uint8_t sectors;
+
+	/** Optimal block size, if VIRTIO_BLK_F_BLK_SIZE */
+	uint32_t blk_size;
+} METAL_PACKED_END;
+
+/** @brief Request header, read by the device */
+METAL_PACKED_BEGIN
+struct virtio_blk_outhdr {
+	/** VIRTIO_BLK_T_* */
+	uint32_t type;
+
+	/** Reserved, 0 */
+	uint32_t reserved;
+
+	/** First sector */
+	uint64_t sector;
+} METAL_PACKED_END;
+
+/**
+ * @brief Block request
+ *
+ * The header and status are accessed by the device: the request, like
+ * the data buffer, must be located in the shared memory of the virtqueue.
+ */
+struct virtio_blk_req {
+	/** Request header */
+	struct virtio_blk_outhdr hdr;
+
+	/** VIRTIO_BLK_S_* written by the device */
+	uint8_t status;
+
+	/** 0 once completed, -EBUSY while in flight, negative error */
+	int result;
+
+	/** Optional completion callback, called by virtio_blk_poll() */
+	void (*done)(struct virtio_blk_req *req);
+
+	/** Private data of the completion callback */
+	void *priv;
+};
+
+/**
+ * @brief Virtio block device front end
+ *
+ * Requests are queued by virtio_blk_submit() without notifying the
+ * device, so that a batch of them costs a single notification issued by
+ * virtio_blk_kick(). Completions are reaped by virtio_blk_poll().
+ *
+ * The virtqueue is not locked: virtio_blk_submit(), virtio_blk_kick(),
+ * virtio_blk_poll() and virtio_blk_transfer() must be called from a single
+ * context, or serialized by the caller. The virtqueue callback, run in the
+ * transport interrupt context, does not touch the virtqueue: it only calls
+ * the optional done_cb, which typically wakes up the context calling
+ * virtio_blk_poll().
+ */
+struct virtio_blk {
+	/** Virtio device, its priv points to the virtio_blk */
+	struct virtio_device *vdev;
+
+	/** Request virtqueue */
+	struct virtqueue *vq;
+
+	/** Capacity in 512 bytes sectors */
+	uint64_t capacity;
+
+	/** Optimal block size */
+	uint32_t blk_size;
+
+	/** The device is read only */
+	bool ro;
+
+	/** Requests in flight */
+	unsigned int inflight;
+
+	/** Completed requests */
+	unsigned long long completed;
+
+	/**
+	 * Optional callback, called from the virtqueue callback when requests
+	 * complete. It must not call the virtio_blk functions.
+	 */
+	void (*done_cb)(struct virtio_blk *blk);
+
+	/** Private data of the done callback */
+	void *priv;
+};
+
+/**
+ * @brief Initialize a virtio block device front end
+ *
+ * Negotiates the features, reads the configuration, creates the request
+ * virtqueue and sets the device status to DRIVER_OK. done_cb and priv
+ * are set by the caller before.
+ *
+ * @param blk		Pointer to the block device
+ * @param vdev		Virtio device in the driver role
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_blk_init(struct virtio_blk *blk, struct virtio_device *vdev);
+
+/**
+ * @brief Deinitialize a virtio block device front end
+ *
+ * @param blk		Pointer to the block device
+ */
+void virtio_blk_deinit(struct virtio_blk *blk);
+
+/**
+ * @brief Queue a block request
+ *
+ * The device is not notified, call virtio_blk_kick() once the batch is
+ * queued.
+ *
+ * @param blk		Pointer to the block device
+ * @param req		Request, in shared memory
+ * @param type		VIRTIO_BLK_T_*
+ * @param sector	First sector
+ * @param buf		Data buffer, in shared memory, NULL for a flush
+ * @param len		Data length, multiple of VIRTIO_BLK_SECTOR_SIZE for
+ *			reads and writes
+ *
+ * @return 0 for success, -EAGAIN if the virtqueue is full, other negative
+ * value for failure
+ */
+int virtio_blk_submit(struct virtio_blk *blk, struct virtio_blk_req *req,
+		      uint32_t type, uint64_t sector, void *buf, uint32_t len);
+
+/**
+ * @brief Notify the device of the queued requests
+ *
+ * @param blk		Pointer to the block device
+ */
+void virtio_blk_kick(struct virtio_blk *blk);
+
+/**
+ * @brief Reap the completed requests
+ *
+ * Sets the result of each completed request and calls its completion
+ * callback, then re-enables the virtqueue callback.
+ *
+ * @param blk		Pointer to the block device
+ *
+ * @return Number of completed requests
+ */
+int virtio_blk_poll(struct virtio_blk *blk);
+
+/**
+ * @brief Execute a block request synchronously
+ *
+ * Submits the request, notifies the device and polls until completion.
+ *
+ * @param blk		Pointer to the block device
+ * @param req		Request, in shared memory
+ * @param type		VIRTIO_BLK_T_*
+ * @param sector	First sector
+ * @param buf		Data buffer, in shared memory
+ * @param len		Data length
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_blk_transfer(struct virtio_blk *blk, struct virtio_blk_req *req,
+			uint32_t type, uint64_t sector, void *buf,
+			uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_BLK_H */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_BLK_FILE_H
+#define OPENAMP_VIRTIO_BLK_FILE_H
+
+#include <openamp/virtio_blk.h>
+#include <openamp/virtqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of data descriptors of a request */
+#define VIRTIO_BLK_FILE_SEG_MAX		64
+
+/**
+ * @brief File backed virtio block device (back end)
+ *
+ * Reference device side implementation serving the requests of a
+ * virtio_blk front end from a file, on top of a virtqueue in the
+ * VIRTIO_DEV_DEVICE role of any transport. Only available on systems
+ * providing preadv() and pwritev().
+ */
+struct virtio_blk_file {
+	/** File descriptor of the backing file, -1 when closed */
+	int fd;
+
+	/** Capacity in 512 bytes sectors */
+	uint64_t capacity;
+
+	/** Serve the file read only */
+	bool ro;
+
+	/** Device ID returned to VIRTIO_BLK_T_GET_ID */
+	char id[VIRTIO_BLK_ID_BYTES];
+
+	/** Served requests */
+	unsigned long long requests;
+
+	/** Requests completed with an error status */
+	unsigned long long errors;
+};
+
+/**
+ * @brief Open the backing file of a file backed block device
+ *
+ * @param bf		Pointer to the file backed block device
+ * @param path		Path of the backing file
+ * @param ro		Serve the file read only
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_blk_file_open(struct virtio_blk_file *bf, const char *path,
+			 bool ro);
+
+/**
+ * @brief Close the backing file of a file backed block device
+ *
+ * @param bf		Pointer to the file backed block device
+ */
+void virtio_blk_file_close(struct virtio_blk_file *bf);
+
+/**
+ * @brief Get the features and configuration to expose to the front end
+ *
+ * @param bf		Pointer to the file backed block device
+ * @param config	Configuration space to fill
+ *
+ * @return Device features
+ */
+uint32_t virtio_blk_file_get_config(struct virtio_blk_file *bf,
+				    struct virtio_blk_config *config);
+
+/**
+ * @brief Serve the requests available on a virtqueue
+ *
+ * Executes each available request on the backing file and returns it to
+ * the front end, then notifies the front end once if needed. Requests with
+ * a buffer outside of the shared memory, a buffer in the wrong direction
+ * or too many data descriptors complete with VIRTIO_BLK_S_IOERR; chains
+ * without a writable status byte or longer than the ring are returned
+ * with no status. Every valid head is returned to the used ring.
+ *
+ * @param bf		Pointer to the file backed block device
+ * @param vq		Request virtqueue, in the VIRTIO_DEV_DEVICE role
+ *
+ * @return Number of served requests
+ */
+int virtio_blk_file_serve(struct virtio_blk_file *bf, struct virtqueue *vq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_BLK_FILE_H */
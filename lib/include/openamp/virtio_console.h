@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_CONSOLE_H
+#define OPENAMP_VIRTIO_CONSOLE_H
+
+#include <metal/atomic.h>
+#include <openamp/virtio.h>
+#include <openamp/virtqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Feature bits */
+#define VIRTIO_CONSOLE_F_SIZE		0
+#define VIRTIO_CONSOLE_F_MULTIPORT	1
+#define VIRTIO_CONSOLE_F_EMERG_WRITE	2
+
+/* Virtqueues of port 0, named from the driver side */
+#define VIRTIO_CONSOLE_RXQ		0
+#define VIRTIO_CONSOLE_TXQ		1
+
+struct virtio_console;
+
+/** @brief Input callback, called for the data written by the driver */
+typedef void (*virtio_console_input_cb)(struct virtio_console *con,
+					const void *data, uint32_t len);
+
+/**
+ * @brief Console log channel (device side)
+ *
+ * Log channel of a remote processor over a VIRTIO_ID_CONSOLE or
+ * VIRTIO_ID_RPROC_SERIAL device in the VIRTIO_DEV_DEVICE role.
+ *
+ * virtio_console_write() only copies the data to a local ring and never
+ * blocks: messages that do not fit are dropped and counted.
+ * virtio_console_flush(), called from a less critical context, moves the
+ * ring contents to the receive buffers of the driver, filling each buffer
+ * before using the next one, and notifies the driver once.
+ *
+ * The writer and the flusher may run concurrently, but the calls to
+ * virtio_console_write() must be serialized by the caller, for instance
+ * by using one channel per context.
+ */
+struct virtio_console {
+	/** Virtio device, its priv points to the virtio_console */
+	struct virtio_device *vdev;
+
+	/** Receive virtqueue of the driver, carrying the log */
+	struct virtqueue *rxq;
+
+	/** Transmit virtqueue of the driver, carrying the input */
+	struct virtqueue *txq;
+
+	/** Local ring */
+	char *ring;
+
+	/** Size of the local ring, a power of 2 */
+	uint32_t size;
+
+	/** Producer position, written by virtio_console_write() */
+	atomic_uint head;
+
+	/** Consumer position, written by virtio_console_flush() */
+	atomic_uint tail;
+
+	/** The driver set DRIVER_OK */
+	bool ready;
+
+	/** Optional input callback, the input is discarded without it */
+	virtio_console_input_cb input_cb;
+
+	/** Private data of the input callback */
+	void *priv;
+
+	/** Messages dropped because the ring was full */
+	atomic_uint dropped;
+
+	/** Bytes passed to the driver */
+	unsigned long long flushed;
+};
+
+/**
+ * @brief Initialize a console log channel
+ *
+ * Creates the virtqueues without waiting for the driver: data is kept in
+ * the local ring until the driver sets DRIVER_OK.
+ *
+ * @param con		Pointer to the console
+ * @param vdev		Virtio device in the device role
+ * @param ring		Local ring, in local memory
+ * @param size		Size of the local ring, a power of 2
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_console_init(struct virtio_console *con, struct virtio_device *vdev,
+			void *ring, uint32_t size);
+
+/**
+ * @brief Deinitialize a console log channel
+ *
+ * @param con		Pointer to the console
+ */
+void virtio_console_deinit(struct virtio_console *con);
+
+/**
+ * @brief Write a message to the log
+ *
+ * Never blocks. The message is copied whole or dropped.
+ *
+ * @param con		Pointer to the console
+ * @param data		Message
+ * @param len		Message length
+ *
+ * @return 0 for success, -EAGAIN if the message is dropped, other
+ * negative value for failure
+ */
+int virtio_console_write(struct virtio_console *con, const void *data,
+			 uint32_t len);
+
+/**
+ * @brief Get the number of bytes waiting in the local ring
+ *
+ * Lets the caller flush only once a receive buffer can be filled.
+ *
+ * @param con		Pointer to the console
+ *
+ * @return Number of bytes to flush
+ */
+uint32_t virtio_console_pending(struct virtio_console *con);
+
+/**
+ * @brief Pass the local ring contents to the driver
+ *
+ * Also serves the input of the driver. The data left over for lack of
+ * receive buffers is passed by the next call.
+ *
+ * @param con		Pointer to the console
+ *
+ * @return Number of bytes passed to the driver
+ */
+int virtio_console_flush(struct virtio_console *con);
+
+/**
+ * @brief Console log reader (driver side)
+ *
+ * Streams the log of a virtio_console out of receive buffers taken from a
+ * pool. A buffer is posted to the device again as soon as it is read.
+ */
+struct virtio_console_reader {
+	/** Virtio device, its priv points to the reader */
+	struct virtio_device *vdev;
+
+	/** Receive virtqueue */
+	struct virtqueue *rxq;
+
+	/** Transmit virtqueue */
+	struct virtqueue *txq;
+
+	/** Receive buffers, located in the shared memory of the virtqueues */
+	char *pool;
+
+	/** Number of receive buffers */
+	unsigned int num;
+
+	/** Size of each receive buffer */
+	uint32_t buf_size;
+
+	/** Receive buffer being read, NULL if none */
+	char *cur;
+
+	/** Length of the data in the current buffer */
+	uint32_t cur_len;
+
+	/** Read offset in the current buffer */
+	uint32_t cur_off;
+
+	/** Optional callback, called when data is received */
+	void (*data_cb)(struct virtio_console_reader *rd);
+
+	/** Private data of the data callback */
+	void *priv;
+
+	/** Bytes read */
+	unsigned long long bytes;
+};
+
+/**
+ * @brief Initialize a console log reader
+ *
+ * Creates the virtqueues, posts the receive buffers and sets the device
+ * status to DRIVER_OK.
+ *
+ * @param rd		Pointer to the reader
+ * @param vdev		Virtio device in the driver role
+ * @param pool		Receive buffers, in shared memory
+ * @param num		Number of receive buffers
+ * @param buf_size	Size of each receive buffer
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_console_reader_init(struct virtio_console_reader *rd,
+			       struct virtio_device *vdev, void *pool,
+			       unsigned int num, uint32_t buf_size);
+
+/**
+ * @brief Deinitialize a console log reader
+ *
+ * @param rd		Pointer to the reader
+ */
+void virtio_console_reader_deinit(struct virtio_console_reader *rd);
+
+/**
+ * @brief Read the log
+ *
+ * Never blocks.
+ *
+ * @param rd		Pointer to the reader
+ * @param buf		Destination buffer
+ * @param len		Size of the destination buffer
+ *
+ * @return Number of bytes read, 0 if no data is available
+ */
+int virtio_console_read(struct virtio_console_reader *rd, void *buf,
+			uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_CONSOLE_H */
@@ -8,6 +8,7 @@
 #ifndef OPENAMP_VIRTIO_MMIO_H
 #define OPENAMP_VIRTIO_MMIO_H
 
+#include <metal/atomic.h>
 #include <metal/device.h>
 #include <openamp/virtio.h>
 #include <openamp/virtqueue.h>
@@ -17,7 +18,9 @@ extern "C" {
 #endif
 
 /* Enable support for legacy devices */
+#ifndef VIRTIO_MMIO_NO_LEGACY
 #define VIRTIO_MMIO_LEGACY
+#endif
 
 /* Control registers -控制寄存器*/
 
@@ -61,7 +64,7 @@ extern "C" {
 /* 用于选择写入的特性位掩码集的寄存器 */
 #define VIRTIO_MMIO_DRIVER_FEATURES_SEL	0x024
 
-#ifndef VIRTIO_MMIO_NO_LEGACY /* LEGACY DEVICES ONLY! */
+#ifdef VIRTIO_MMIO_LEGACY /* LEGACY DEVICES ONLY! */
 /* Guest's memory page size in bytes - Write Only */
 #define VIRTIO_MMIO_GUEST_PAGE_SIZE	0x028
 #endif
@@ -174,7 +177,7 @@ struct virtio_mmio_device {
 	/*基础 VirtIO 设备结构。这是所有 VirtIO 设备共有的基本配置，包括功能标志、队列信息等*/
 	struct virtio_device vdev;
 
-	/** Device configuration space metal_io_region */
+	/** Device configuration space metal_io_region, region 1 if not preset */
 	/*分别指向设备配置空间和共享内存空间的 metal_io_region 结构体的指针*/
 	struct metal_io_region *cfg_io;
 
@@ -204,6 +207,12 @@ struct virtio_mmio_device {
 	/** Custom user data */
 	/*指向用户自定义数据的指针。这允许开发者将额外的数据或配置与 VirtIO MMIO 设备关联，为设备的使用和管理提供更大的灵活性*/
 	void *user_data;
+
+	/** Schedules virtio_mmio_process_deferred(), NULL to run the callbacks in the ISR */
+	void (*defer_cb)(struct virtio_mmio_device *vmdev);
+
+	/** Set by the ISR when virtqueue callbacks are deferred */
+	atomic_int deferred;
 };
 
 /**
@@ -253,6 +262,29 @@ int virtio_mmio_device_init(struct virtio_mmio_device *vmdev, uintptr_t virt_mem
  */
 void virtio_mmio_isr(struct virtio_device *vdev);
 
+/**
+ * @brief Defer the virtqueue callbacks out of the interrupt service routine.
+ *
+ * Once set, virtio_mmio_isr() only acknowledges the interrupt and calls
+ * defer_cb, which is expected to schedule a bottom half or worker calling
+ * virtio_mmio_process_deferred().
+ *
+ * @param vmdev		Pointer to virtio_mmio_device structure.
+ * @param defer_cb	Callback scheduling the bottom half, NULL to run the
+ *			virtqueue callbacks in the ISR again.
+ */
+void virtio_mmio_set_deferred(struct virtio_mmio_device *vmdev,
+			      void (*defer_cb)(struct virtio_mmio_device *vmdev));
+
+/**
+ * @brief Run the virtqueue callbacks deferred by the ISR.
+ *
+ * @param vdev Pointer to virtio_device structure.
+ *
+ * @return Number of virtqueue callbacks invoked.
+ */
+int virtio_mmio_process_deferred(struct virtio_device *vdev);
+
 #ifdef __cplusplus
 }
 #endif
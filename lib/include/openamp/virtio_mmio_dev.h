@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_MMIO_DEV_H
+#define OPENAMP_VIRTIO_MMIO_DEV_H
+
+#include <metal/atomic.h>
+#include <metal/io.h>
+#include <openamp/virtio.h>
+#include <openamp/virtio_mmio.h>
+#include <openamp/virtqueue.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of the register file before the device configuration space */
+#define VIRTIO_MMIO_DEV_REGS_SIZE	VIRTIO_MMIO_CONFIG
+
+/** @brief Virtqueue of an emulated virtio-mmio device */
+struct virtio_mmio_dev_queue {
+	/** Maximum number of descriptors, reported in QUEUE_NUM_MAX */
+	uint32_t num_max;
+
+	/** Number of descriptors set by the driver */
+	uint32_t num;
+
+	/** Vring addresses set by the driver */
+	uint64_t desc;
+	uint64_t avail;
+	uint64_t used;
+
+	/** Called when the driver notifies the queue, can be NULL */
+	vq_callback callback;
+
+	/** Virtqueue private data, available in vq->priv */
+	void *priv;
+
+	/** Virtqueue, created when the driver sets QUEUE_READY */
+	struct virtqueue *vq;
+};
+
+/**
+ * @brief Emulated virtio-mmio device (back end)
+ *
+ * Implements the version 2 virtio-mmio register file on the device side.
+ * The driver accesses it through the io region, whose operations run the
+ * register state machine: with a trapping hypervisor or device model the
+ * trapped accesses are forwarded to it, in the same address space the io
+ * region is directly used as the cfg_io of a struct virtio_mmio_device.
+ *
+ * The vrings and buffers set up by the driver are accessed through shm_io
+ * with the common virtqueue code in the VIRTIO_DEV_DEVICE role.
+ *
+ * Register accesses are expected to be serialized by the caller.
+ */
+struct virtio_mmio_dev {
+	/** Base virtio device structure, in the VIRTIO_DEV_DEVICE role */
+	struct virtio_device vdev;
+
+	/** Register file and configuration space exposed to the driver */
+	struct metal_io_region io;
+
+	/** Memory holding the vrings and buffers of the driver */
+	struct metal_io_region *shm_io;
+
+	/** Virtio vendor ID, set before virtio_mmio_dev_init() */
+	uint32_t vendor_id;
+
+	/** Features offered to the driver, VIRTIO_F_VERSION_1 is implied */
+	uint64_t device_features;
+
+	/** Features written by the driver */
+	uint64_t driver_features;
+
+	/** Feature and queue selectors */
+	uint32_t device_features_sel;
+	uint32_t driver_features_sel;
+	uint32_t queue_sel;
+
+	/** Device status */
+	uint32_t status;
+
+	/** Pending VIRTIO_MMIO_INT_* bits */
+	atomic_int interrupt_status;
+
+	/** Device configuration space */
+	uint8_t *config;
+	uint32_t config_len;
+	uint32_t config_generation;
+
+	/** Virtqueues */
+	struct virtio_mmio_dev_queue *queues;
+	unsigned int num_queues;
+
+	/** Raises the interrupt of the driver */
+	void (*irq_cb)(struct virtio_mmio_dev *dev);
+
+	/** Optional callback invoked after the driver wrote the status */
+	void (*status_cb)(struct virtio_mmio_dev *dev, uint32_t status);
+};
+
+/**
+ * @brief Initialize an emulated virtio-mmio device
+ *
+ * @param dev		Pointer to the device
+ * @param device_id	Virtio device ID
+ * @param features	Device features
+ * @param queues	Virtqueues, num_max, callback and priv set
+ * @param num_queues	Number of virtqueues
+ * @param shm_io	Memory holding the vrings and buffers of the driver
+ * @param config	Device configuration space, can be NULL
+ * @param config_len	Size of the configuration space
+ * @param irq_cb	Callback raising the interrupt of the driver
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_mmio_dev_init(struct virtio_mmio_dev *dev, uint32_t device_id,
+			 uint64_t features, struct virtio_mmio_dev_queue *queues,
+			 unsigned int num_queues, struct metal_io_region *shm_io,
+			 void *config, uint32_t config_len,
+			 void (*irq_cb)(struct virtio_mmio_dev *dev));
+
+/**
+ * @brief Reset an emulated virtio-mmio device
+ *
+ * Deletes the virtqueues and clears the negotiated state, as when the
+ * driver writes 0 to the status register.
+ *
+ * @param dev		Pointer to the device
+ */
+void virtio_mmio_dev_reset(struct virtio_mmio_dev *dev);
+
+/**
+ * @brief Read a register of an emulated virtio-mmio device
+ *
+ * @param dev		Pointer to the device
+ * @param offset	Register offset
+ * @param width		Access width in bytes
+ *
+ * @return Register value
+ */
+uint64_t virtio_mmio_dev_read(struct virtio_mmio_dev *dev,
+			      unsigned long offset, int width);
+
+/**
+ * @brief Write a register of an emulated virtio-mmio device
+ *
+ * @param dev		Pointer to the device
+ * @param offset	Register offset
+ * @param value		Value to write
+ * @param width		Access width in bytes
+ */
+void virtio_mmio_dev_write(struct virtio_mmio_dev *dev, unsigned long offset,
+			   uint64_t value, int width);
+
+/**
+ * @brief Notify the driver of a device configuration space change
+ *
+ * Bumps the configuration generation and raises the configuration change
+ * interrupt, to be called after the device updated its config space.
+ *
+ * @param dev		Pointer to the device
+ */
+void virtio_mmio_dev_config_changed(struct virtio_mmio_dev *dev);
+
+/**
+ * @brief Serve the buffers the driver made available on a virtqueue
+ *
+ * Calls handler on each available buffer and returns it to the driver
+ * with the length returned by the handler, then notifies the driver once
+ * if needed.
+ *
+ * @param dev		Pointer to the device
+ * @param idx		Virtqueue index
+ * @param handler	Buffer handler, returns the number of bytes written to
+ *			the buffer
+ * @param priv		Handler private data
+ *
+ * @return Number of buffers served, negative value for failure
+ */
+int virtio_mmio_dev_serve(struct virtio_mmio_dev *dev, unsigned int idx,
+			  uint32_t (*handler)(void *priv, void *buf,
+					      uint32_t len),
+			  void *priv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_MMIO_DEV_H */
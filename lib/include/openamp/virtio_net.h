@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_NET_H
+#define OPENAMP_VIRTIO_NET_H
+
+#include <metal/compiler.h>
+#include <openamp/virtio.h>
+#include <openamp/virtqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Feature bits */
+#define VIRTIO_NET_F_CSUM		0
+#define VIRTIO_NET_F_MTU		3
+#define VIRTIO_NET_F_MAC		5
+#define VIRTIO_NET_F_MRG_RXBUF		15
+#define VIRTIO_NET_F_STATUS		16
+
+/* Virtqueues */
+#define VIRTIO_NET_RXQ			0
+#define VIRTIO_NET_TXQ			1
+
+/** Largest frame: Ethernet with a VLAN tag, without FCS */
+#define VIRTIO_NET_MAX_FRAME		1518
+
+/** Maximum number of RX buffers a frame can be merged from */
+#define VIRTIO_NET_RX_SEG_MAX		8
+
+/** @brief Device configuration layout */
+METAL_PACKED_BEGIN
+struct virtio_net_config {
+	/** MAC address, if VIRTIO_NET_F_MAC */
+	uint8_t mac[6];
+
+	/** Link status, if VIRTIO_NET_F_STATUS */
+	uint16_t status;
+
+	/** Maximum number of queue pairs, if VIRTIO_NET_F_MQ */
+	uint16_t max_virtqueue_pairs;
+
+	/** MTU, if VIRTIO_NET_F_MTU */
+	uint16_t mtu;
+} METAL_PACKED_END;
+
+/**
+ * @brief Header preceding each frame in the buffers
+ *
+ * num_buffers is only present with VIRTIO_NET_F_MRG_RXBUF or
+ * VIRTIO_F_VERSION_1, the header is 2 bytes shorter otherwise.
+ */
+METAL_PACKED_BEGIN
+struct virtio_net_hdr {
+	uint8_t flags;
+	uint8_t gso_type;
+	uint16_t hdr_len;
+	uint16_t gso_size;
+	uint16_t csum_start;
+	uint16_t csum_offset;
+
+	/** Number of RX buffers the frame is merged from */
+	uint16_t num_buffers;
+} METAL_PACKED_END;
+
+/**
+ * @brief Received frame
+ *
+ * The segments point into the RX buffers, which are not copied: they are
+ * posted to the device again once the frame is released.
+ */
+struct virtio_net_frame {
+	/** Frame length */
+	uint32_t len;
+
+	/** Number of segments */
+	unsigned int num;
+
+	/** Segment data */
+	void *data[VIRTIO_NET_RX_SEG_MAX];
+
+	/** Segment lengths */
+	uint32_t seg_len[VIRTIO_NET_RX_SEG_MAX];
+
+	/** Set by virtio_net_hold_rx_frame() */
+	bool held;
+};
+
+/** @brief Buffer pool, located in the shared memory of the virtqueues */
+struct virtio_net_pool {
+	/** Address of the first buffer */
+	void *base;
+
+	/** Number of buffers */
+	unsigned int num;
+
+	/** Size of each buffer, including the virtio_net_hdr */
+	uint32_t buf_size;
+};
+
+struct virtio_net;
+
+/**
+ * @brief Receive callback
+ *
+ * The frame is released when the callback returns, unless the callback
+ * holds it with virtio_net_hold_rx_frame().
+ */
+typedef void (*virtio_net_rx_cb)(struct virtio_net *net,
+				 struct virtio_net_frame *frame);
+
+/**
+ * @brief Virtio network device front end
+ *
+ * RX buffers come from a pool and are posted back to the device as soon
+ * as the frames they hold are released, without copying the frames.
+ * With VIRTIO_NET_F_MRG_RXBUF a frame can span several RX buffers, so the
+ * buffers can be smaller than a frame.
+ *
+ * TX frames are built in buffers of the TX pool and queued without
+ * notifying the device, so that a batch of them costs a single
+ * notification issued by virtio_net_kick(). TX completions do not raise
+ * interrupts: the buffers are reclaimed when the TX pool runs out.
+ *
+ * The RX functions (virtio_net_poll(), virtio_net_release_rx_frame()) and
+ * the TX functions (virtio_net_get_tx_buffer(), virtio_net_send(),
+ * virtio_net_send_nocopy(), virtio_net_kick()) use separate virtqueues:
+ * each group must be serialized by the caller, but the two groups may run
+ * concurrently. The RX virtqueue callback, run in the transport interrupt
+ * context, does not touch the virtqueues: it only calls the optional
+ * rx_notify, which typically wakes up the context calling
+ * virtio_net_poll().
+ */
+struct virtio_net {
+	/** Virtio device, its priv points to the virtio_net */
+	struct virtio_device *vdev;
+
+	/** Receive virtqueue */
+	struct virtqueue *rxq;
+
+	/** Transmit virtqueue */
+	struct virtqueue *txq;
+
+	/** MAC address, zero if the device provides none */
+	uint8_t mac[6];
+
+	/** Size of the virtio_net_hdr used by the device */
+	uint32_t hdr_len;
+
+	/** RX buffer pool */
+	struct virtio_net_pool rx_pool;
+
+	/** TX buffer pool */
+	struct virtio_net_pool tx_pool;
+
+	/** Free TX buffers, linked through their first word */
+	void *tx_free;
+
+	/** Frame being received */
+	struct virtio_net_frame rx_frame;
+
+	/** RX buffers still to receive for rx_frame */
+	unsigned int rx_missing;
+
+	/** rx_frame is dropped */
+	bool rx_drop;
+
+	/** Receive callback */
+	virtio_net_rx_cb rx_cb;
+
+	/** Private data of the receive callback */
+	void *priv;
+
+	/**
+	 * Optional callback, called from the RX virtqueue callback when frames
+	 * arrive. It must not call the virtio_net functions.
+	 */
+	void (*rx_notify)(struct virtio_net *net);
+
+	/** Received frames */
+	unsigned long long rx_frames;
+
+	/** Dropped received frames */
+	unsigned long long rx_dropped;
+
+	/** Transmitted frames */
+	unsigned long long tx_frames;
+};
+
+/**
+ * @brief Initialize a virtio network device front end
+ *
+ * Negotiates the features, creates the virtqueues, posts the RX buffers
+ * and sets the device status to DRIVER_OK. rx_notify is set by the caller
+ * before, the frames are received by calling virtio_net_poll().
+ *
+ * Without VIRTIO_NET_F_MRG_RXBUF an RX buffer must hold a header and a
+ * VIRTIO_NET_MAX_FRAME bytes frame, with it VIRTIO_NET_RX_SEG_MAX buffers
+ * must.
+ *
+ * @param net		Pointer to the network device
+ * @param vdev		Virtio device in the driver role
+ * @param rx_pool	RX buffer pool
+ * @param tx_pool	TX buffer pool
+ * @param rx_cb		Receive callback
+ * @param priv		Private data of the receive callback
+ *
+ * @return 0 for success, negative value for failure
+ */
+int virtio_net_init(struct virtio_net *net, struct virtio_device *vdev,
+		    const struct virtio_net_pool *rx_pool,
+		    const struct virtio_net_pool *tx_pool,
+		    virtio_net_rx_cb rx_cb, void *priv);
+
+/**
+ * @brief Deinitialize a virtio network device front end
+ *
+ * @param net		Pointer to the network device
+ */
+void virtio_net_deinit(struct virtio_net *net);
+
+/**
+ * @brief Receive the available frames
+ *
+ * Calls the receive callback for each received frame and posts the
+ * released RX buffers back to the device.
+ *
+ * @param net		Pointer to the network device
+ *
+ * @return Number of received frames
+ */
+int virtio_net_poll(struct virtio_net *net);
+
+/**
+ * @brief Hold a received frame
+ *
+ * Called from the receive callback to keep the RX buffers of the frame
+ * after the callback returns. The frame structure itself is reused: copy
+ * it to release the frame later.
+ *
+ * @param frame		Frame passed to the receive callback
+ */
+void virtio_net_hold_rx_frame(struct virtio_net_frame *frame);
+
+/**
+ * @brief Release a held frame
+ *
+ * Posts the RX buffers of the frame back to the device.
+ *
+ * @param net		Pointer to the network device
+ * @param frame		Copy of the held frame
+ */
+void virtio_net_release_rx_frame(struct virtio_net *net,
+				 struct virtio_net_frame *frame);
+
+/**
+ * @brief Get a TX buffer to build a frame in
+ *
+ * @param net		Pointer to the network device
+ * @param len		Returns the maximum frame length
+ *
+ * @return Pointer to the frame data, NULL if no TX buffer is free
+ */
+void *virtio_net_get_tx_buffer(struct virtio_net *net, uint32_t *len);
+
+/**
+ * @brief Give back a TX buffer without sending it
+ *
+ * @param net		Pointer to the network device
+ * @param data		Frame data returned by virtio_net_get_tx_buffer()
+ */
+void virtio_net_release_tx_buffer(struct virtio_net *net, void *data);
+
+/**
+ * @brief Queue a frame built in a TX buffer
+ *
+ * The buffer is owned by the device until it is reclaimed. The device is
+ * not notified, call virtio_net_kick() once the batch is queued.
+ *
+ * @param net		Pointer to the network device
+ * @param data		Frame data returned by virtio_net_get_tx_buffer()
+ * @param len		Frame length
+ *
+ * @return 0 for success, -EAGAIN if the virtqueue is full, other negative
+ * value for failure
+ */
+int virtio_net_send_nocopy(struct virtio_net *net, void *data, uint32_t len);
+
+/**
+ * @brief Copy a frame to a TX buffer and queue it
+ *
+ * @param net		Pointer to the network device
+ * @param data		Frame data
+ * @param len		Frame length
+ *
+ * @return 0 for success, -EAGAIN if no TX buffer is free, other negative
+ * value for failure
+ */
+int virtio_net_send(struct virtio_net *net, const void *data, uint32_t len);
+
+/**
+ * @brief Notify the device of the queued frames
+ *
+ * @param net		Pointer to the network device
+ */
+void virtio_net_kick(struct virtio_net *net);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_NET_H */
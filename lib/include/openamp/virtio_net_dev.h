@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef OPENAMP_VIRTIO_NET_DEV_H
+#define OPENAMP_VIRTIO_NET_DEV_H
+
+#include <openamp/virtio_net.h>
+#include <openamp/virtqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct virtio_net_dev;
+
+/**
+ * @brief Transmit callback, called for each frame sent by the front end
+ *
+ * The frame is only valid during the callback.
+ */
+typedef void (*virtio_net_dev_tx_cb)(struct virtio_net_dev *dev,
+				     const void *frame, uint32_t len);
+
+/**
+ * @brief In-process virtio network device (back end)
+ *
+ * Reference device side implementation exchanging frames with a
+ * virtio_net front end over two virtqueues in the VIRTIO_DEV_DEVICE role
+ * of any transport. The frames sent by the front end are handed to a
+ * transmit callback, or looped back to the front end without one, and
+ * virtio_net_dev_receive() passes frames to the front end.
+ */
+struct virtio_net_dev {
+	/** Receive virtqueue of the front end */
+	struct virtqueue *rxq;
+
+	/** Transmit virtqueue of the front end */
+	struct virtqueue *txq;
+
+	/** MAC address exposed to the front end */
+	uint8_t mac[6];
+
+	/** Size of the virtio_net_hdr used by the front end */
+	uint32_t hdr_len;
+
+	/** Frames can be merged from several RX buffers */
+	bool mrg_rxbuf;
+
+	/** Transmit callback, NULL to loop the frames back */
+	virtio_net_dev_tx_cb tx_cb;
+
+	/** Private data of the transmit callback */
+	void *priv;
+
+	/** Transmitted frames spanning several descriptors are copied here */
+	uint8_t bounce[sizeof(struct virtio_net_hdr) + VIRTIO_NET_MAX_FRAME];
+
+	/** Frames sent by the front end */
+	unsigned long long tx_frames;
+
+	/** Frames passed to the front end */
+	unsigned long long rx_frames;
+
+	/** Frames dropped for lack of RX buffers or too long */
+	unsigned long long dropped;
+};
+
+/**
+ * @brief Get the features and configuration to expose to the front end
+ *
+ * @param dev		Pointer to the network device
+ * @param config	Configuration space to fill
+ *
+ * @return Device features
+ */
+uint32_t virtio_net_dev_get_config(struct virtio_net_dev *dev,
+				   struct virtio_net_config *config);
+
+/**
+ * @brief Start the network device
+ *
+ * Called once the front end set DRIVER_OK, the virtqueues give the
+ * negotiated features.
+ *
+ * @param dev		Pointer to the network device
+ * @param rxq		Receive virtqueue of the front end
+ * @param txq		Transmit virtqueue of the front end
+ */
+void virtio_net_dev_start(struct virtio_net_dev *dev, struct virtqueue *rxq,
+			  struct virtqueue *txq);
+
+/**
+ * @brief Serve the frames sent by the front end
+ *
+ * Hands each frame to the transmit callback, or loops it back, then
+ * notifies the front end once if needed.
+ *
+ * @param dev		Pointer to the network device
+ *
+ * @return Number of served frames
+ */
+int virtio_net_dev_serve_tx(struct virtio_net_dev *dev);
+
+/**
+ * @brief Pass a frame to the front end
+ *
+ * The front end is not notified, call virtio_net_dev_kick_rx() once the
+ * batch is passed.
+ *
+ * @param dev		Pointer to the network device
+ * @param frame		Frame data
+ * @param len		Frame length
+ *
+ * @return 0 for success, -EAGAIN if the frame is dropped for lack of RX
+ * buffers, other negative value for failure
+ */
+int virtio_net_dev_receive(struct virtio_net_dev *dev, const void *frame,
+			   uint32_t len);
+
+/**
+ * @brief Notify the front end of the passed frames
+ *
+ * @param dev		Pointer to the network device
+ */
+void virtio_net_dev_kick_rx(struct virtio_net_dev *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENAMP_VIRTIO_NET_DEV_H */
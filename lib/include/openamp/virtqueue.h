@@ -426,6 +426,33 @@ uint32_t virtqueue_get_desc_size(struct virtqueue *vq);
 
 uint32_t virtqueue_get_buffer_length(struct virtqueue *vq, uint16_t idx);
 void *virtqueue_get_buffer_addr(struct virtqueue *vq, uint16_t idx);
+uint16_t virtqueue_get_buffer_flags(struct virtqueue *vq, uint16_t idx);
+
+/**
+ * @brief Get the next descriptor of a descriptor chain
+ *
+ * Lets the device walk the chain whose head is returned by
+ * virtqueue_get_available_buffer().
+ *
+ * @param vq	Pointer to VirtIO queue control block
+ * @param idx	Index of the current descriptor
+ *
+ * @return Index of the next descriptor, VQ_RING_DESC_CHAIN_END at the end
+ * of the chain
+ */
+uint16_t virtqueue_get_next_desc(struct virtqueue *vq, uint16_t idx);
+
+/**
+ * @brief Test if the other side made buffers available to this side
+ *
+ * Checks the used ring index for the driver, the available ring index for
+ * the device, against the index this side consumed up to.
+ *
+ * @param vq	Pointer to VirtIO queue control block
+ *
+ * @return 1 if buffers are waiting to be consumed, 0 otherwise
+ */
+int virtqueue_pending(struct virtqueue *vq);
 
 /**
  * @brief Test if virtqueue is empty
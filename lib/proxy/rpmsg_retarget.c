@@ -6,6 +6,7 @@
  */
 
 #include <errno.h>
+#include <metal/cpu.h>
 #include <metal/mutex.h>
 #include <metal/spinlock.h>
 #include <metal/utilities.h>
@@ -22,6 +23,9 @@
  *************************************************************************/
 static struct rpmsg_rpc_data *rpmsg_default_rpc;
 
+static void rpmsg_rpc_wbuf_kick(struct rpmsg_rpc_data *rpc, bool wait);
+static void rpmsg_rpc_wbuf_drop(struct rpmsg_rpc_data *rpc);
+
 static int rpmsg_rpc_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len,
 			    uint32_t src, void *priv)
 {
@@ -36,18 +40,38 @@ static int rpmsg_rpc_ept_cb(struct rpmsg_endpoint *ept, void *data, size_t len,
 			rpmsg_destroy_ept(ept);
 		} else {
 			struct rpmsg_rpc_data *rpc;
+			bool idle = false;
 
 			rpc = metal_container_of(ept,
 						 struct rpmsg_rpc_data,
 						 ept);
 			metal_spinlock_acquire(&rpc->buflock);
-			if (rpc->respbuf && rpc->respbuf_len != 0) {
-				if (len > rpc->respbuf_len)
-					len = rpc->respbuf_len;
-				memcpy(rpc->respbuf, data, len);
+			if (rpc->posted) {
+				/*
+				 * The proxy answers in order and posted
+				 * writes always go out before a request we
+				 * wait for, so this answers a posted write.
+				 */
+				rpc->posted--;
+				idle = !rpc->posted;
+				if (rpc->posted_err >= 0) {
+					if (syscall->id != WRITE_SYSCALL_ID)
+						rpc->posted_err = -EINVAL;
+					else if (syscall->args.int_field1 < 0)
+						rpc->posted_err =
+						syscall->args.int_field1;
+				}
+			} else {
+				if (rpc->respbuf && rpc->respbuf_len != 0) {
+					if (len > rpc->respbuf_len)
+						len = rpc->respbuf_len;
+					memcpy(rpc->respbuf, data, len);
+				}
+				atomic_flag_clear(&rpc->nacked);
 			}
-			atomic_flag_clear(&rpc->nacked);
 			metal_spinlock_release(&rpc->buflock);
+			if (idle)
+				rpmsg_rpc_wbuf_kick(rpc, false);
 		}
 	}
 
@@ -60,12 +84,185 @@ static void rpmsg_service_unbind(struct rpmsg_endpoint *ept)
 
 	rpc = metal_container_of(ept, struct rpmsg_rpc_data, ept);
 	rpc->ept_destroyed = 1;
+	rpmsg_rpc_wbuf_drop(rpc);
 	rpmsg_destroy_ept(ept);
+	metal_spinlock_acquire(&rpc->buflock);
+	rpc->posted = 0;
+	metal_spinlock_release(&rpc->buflock);
 	atomic_flag_clear(&rpc->nacked);
 	if (rpc->shutdown_cb)
 		rpc->shutdown_cb(rpc);
 }
 
+/* Poll until no more than max posted writes are waiting for an answer */
+static void rpmsg_rpc_wait_posted(struct rpmsg_rpc_data *rpc,
+				  unsigned int max)
+{
+	unsigned int posted;
+
+	do {
+		metal_spinlock_acquire(&rpc->buflock);
+		posted = rpc->posted;
+		metal_spinlock_release(&rpc->buflock);
+		if (posted > max && rpc->poll)
+			rpc->poll(rpc->poll_arg);
+	} while (posted > max && !rpc->ept_destroyed);
+}
+
+/*
+ * Send a write request without waiting for its answer, in the given tx
+ * buffer or in a new one if buf is NULL. Unless called from the endpoint
+ * callback (wait is false), the number of posted writes is bounded first.
+ */
+static int rpmsg_rpc_post_write(struct rpmsg_rpc_data *rpc, int fd,
+				const void *ptr, size_t len,
+				void *buf, uint32_t buf_len, bool wait)
+{
+	struct rpmsg_rpc_syscall *syscall = buf;
+	unsigned char *payload;
+	size_t null_term = fd == 1 ? 1 : 0;
+	size_t payload_size = sizeof(*syscall) + len + null_term;
+	int ret;
+
+	if (wait)
+		rpmsg_rpc_wait_posted(rpc, RPMSG_RPC_MAX_POSTED - 1);
+	if (!syscall)
+		syscall = rpmsg_get_tx_payload_buffer(&rpc->ept, &buf_len,
+						      wait);
+	if (!syscall)
+		return RPMSG_ERR_NO_BUFF;
+	if (payload_size > buf_len) {
+		rpmsg_release_tx_buffer(&rpc->ept, syscall);
+		return RPMSG_ERR_BUFF_SIZE;
+	}
+
+	syscall->id = WRITE_SYSCALL_ID;
+	syscall->args.int_field1 = fd;
+	syscall->args.int_field2 = len;
+	syscall->args.data_len = len + null_term;
+	payload = (unsigned char *)syscall + sizeof(*syscall);
+	memcpy(payload, ptr, len);
+	if (null_term)
+		payload[len] = 0;
+
+	/* Count it before sending, the answer may come back at once */
+	metal_spinlock_acquire(&rpc->buflock);
+	rpc->posted++;
+	metal_spinlock_release(&rpc->buflock);
+	ret = rpmsg_send_nocopy(&rpc->ept, syscall, payload_size);
+	if (ret < 0) {
+		metal_spinlock_acquire(&rpc->buflock);
+		rpc->posted--;
+		metal_spinlock_release(&rpc->buflock);
+		rpmsg_release_tx_buffer(&rpc->ept, syscall);
+	}
+
+	return ret;
+}
+
+static void rpmsg_rpc_wbuf_claim(struct rpmsg_rpc_data *rpc)
+{
+	while (atomic_flag_test_and_set(&rpc->wbuf_busy))
+		metal_cpu_yield();
+}
+
+static void rpmsg_rpc_wbuf_unclaim(struct rpmsg_rpc_data *rpc)
+{
+	atomic_flag_clear(&rpc->wbuf_busy);
+}
+
+/*
+ * Reserve the tx buffer the coalesced bytes will be sent in, while the
+ * writer can still wait for one. The endpoint callback pushing them out
+ * when the link goes idle must not wait: without a reserved buffer, the
+ * bytes would stay behind until the next call if none is free by then.
+ * The write buffer must be claimed.
+ */
+static void rpmsg_rpc_wbuf_reserve(struct rpmsg_rpc_data *rpc)
+{
+	if (rpc->wbuf_len && !rpc->wbuf_tx)
+		rpc->wbuf_tx = rpmsg_get_tx_payload_buffer(&rpc->ept,
+							   &rpc->wbuf_tx_len,
+							   true);
+}
+
+/* Send the coalesced bytes, the write buffer must be claimed */
+static int rpmsg_rpc_wbuf_send(struct rpmsg_rpc_data *rpc, bool wait)
+{
+	void *buf = rpc->wbuf_tx;
+	int ret;
+
+	if (!rpc->wbuf_len)
+		return 0;
+	/* The buffer is sent, or released on failure */
+	rpc->wbuf_tx = NULL;
+	ret = rpmsg_rpc_post_write(rpc, rpc->wbuf_fd, rpc->wbuf,
+				   rpc->wbuf_len, buf, rpc->wbuf_tx_len, wait);
+	if (ret >= 0)
+		rpc->wbuf_len = 0;
+
+	return ret;
+}
+
+/* Drop the coalesced bytes when the endpoint goes away */
+static void rpmsg_rpc_wbuf_drop(struct rpmsg_rpc_data *rpc)
+{
+	if (atomic_flag_test_and_set(&rpc->wbuf_busy))
+		return;
+	if (rpc->wbuf_tx)
+		rpmsg_release_tx_buffer(&rpc->ept, rpc->wbuf_tx);
+	rpc->wbuf_tx = NULL;
+	rpc->wbuf_len = 0;
+	rpmsg_rpc_wbuf_unclaim(rpc);
+}
+
+/*
+ * Small writes are held back only while earlier writes are in flight.
+ * Both the writer, after filling the buffer, and the endpoint callback,
+ * when the last posted write is answered, try to push the buffer out;
+ * whoever finds it busy leaves the job to the current owner.
+ */
+static void rpmsg_rpc_wbuf_kick(struct rpmsg_rpc_data *rpc, bool wait)
+{
+	unsigned int posted;
+
+	metal_spinlock_acquire(&rpc->buflock);
+	posted = rpc->posted;
+	metal_spinlock_release(&rpc->buflock);
+	if (posted || atomic_flag_test_and_set(&rpc->wbuf_busy))
+		return;
+	(void)rpmsg_rpc_wbuf_send(rpc, wait);
+	rpmsg_rpc_wbuf_unclaim(rpc);
+}
+
+static int rpmsg_rpc_take_err(struct rpmsg_rpc_data *rpc)
+{
+	int ret;
+
+	metal_spinlock_acquire(&rpc->buflock);
+	ret = rpc->posted_err;
+	rpc->posted_err = 0;
+	metal_spinlock_release(&rpc->buflock);
+
+	return ret;
+}
+
+/* Send buffered writes and wait for all their answers */
+static int rpmsg_rpc_drain(struct rpmsg_rpc_data *rpc)
+{
+	int ret;
+
+	rpmsg_rpc_wbuf_claim(rpc);
+	ret = rpmsg_rpc_wbuf_send(rpc, true);
+	rpmsg_rpc_wbuf_unclaim(rpc);
+	if (ret < 0)
+		return -EINVAL;
+
+	rpmsg_rpc_wait_posted(rpc, 0);
+
+	return rpmsg_rpc_take_err(rpc);
+}
+
 int rpmsg_rpc_init(struct rpmsg_rpc_data *rpc,
 		   struct rpmsg_device *rdev,
 		   const char *ept_name, uint32_t ept_addr,
@@ -85,6 +282,16 @@ int rpmsg_rpc_init(struct rpmsg_rpc_data *rpc,
 	rpc->ept_destroyed = 0;
 	rpc->respbuf = NULL;
 	rpc->respbuf_len = 0;
+	rpc->posted = 0;
+	rpc->posted_err = 0;
+	rpc->wbuf_busy = (atomic_flag)ATOMIC_FLAG_INIT;
+	rpc->wbuf_fd = -1;
+	rpc->wbuf_len = 0;
+	rpc->wbuf_tx = NULL;
+	rpc->wbuf_tx_len = 0;
+	rpc->rbuf_fd = -1;
+	rpc->rbuf_off = 0;
+	rpc->rbuf_len = 0;
 	rpc->nacked = (atomic_flag)ATOMIC_FLAG_INIT;
 	atomic_flag_test_and_set(&rpc->nacked);
 	ret = rpmsg_create_ept(&rpc->ept, rdev,
@@ -105,9 +312,12 @@ void rpmsg_rpc_release(struct rpmsg_rpc_data *rpc)
 {
 	if (!rpc)
 		return;
-	if (rpc->ept_destroyed == 0)
-		rpmsg_destroy_ept(&rpc->ept);
 	metal_mutex_acquire(&rpc->lock);
+	if (rpc->ept_destroyed == 0) {
+		(void)rpmsg_rpc_drain(rpc);
+		rpmsg_rpc_wbuf_drop(rpc);
+		rpmsg_destroy_ept(&rpc->ept);
+	}
 	metal_spinlock_acquire(&rpc->buflock);
 	rpc->respbuf = NULL;
 	rpc->respbuf_len = 0;
@@ -124,6 +334,14 @@ int rpmsg_rpc_send(struct rpmsg_rpc_data *rpc,
 
 	if (!rpc)
 		return -EINVAL;
+
+	/* Coalesced writes were issued first, keep them first */
+	rpmsg_rpc_wbuf_claim(rpc);
+	ret = rpmsg_rpc_wbuf_send(rpc, true);
+	rpmsg_rpc_wbuf_unclaim(rpc);
+	if (ret < 0)
+		return -EINVAL;
+
 	metal_spinlock_acquire(&rpc->buflock);
 	rpc->respbuf = resp;
 	rpc->respbuf_len = resp_len;
@@ -141,6 +359,19 @@ int rpmsg_rpc_send(struct rpmsg_rpc_data *rpc,
 	return ret;
 }
 
+int rpmsg_rpc_flush(struct rpmsg_rpc_data *rpc)
+{
+	int ret;
+
+	if (!rpc)
+		return -EINVAL;
+	metal_mutex_acquire(&rpc->lock);
+	ret = rpmsg_rpc_drain(rpc);
+	metal_mutex_release(&rpc->lock);
+
+	return ret;
+}
+
 void rpmsg_set_default_rpc(struct rpmsg_rpc_data *rpc)
 {
 	if (!rpc)
@@ -159,23 +390,22 @@ void rpmsg_set_default_rpc(struct rpmsg_rpc_data *rpc)
  *       Open a file.  Minimal implementation
  *
  *************************************************************************/
-#define MAX_BUF_LEN 496UL
-
 int _open(const char *filename, int flags, int mode)
 {
 	struct rpmsg_rpc_data *rpc = rpmsg_default_rpc;
 	struct rpmsg_rpc_syscall *syscall;
 	struct rpmsg_rpc_syscall resp;
-	int filename_len = strlen(filename) + 1;
-	unsigned int payload_size = sizeof(*syscall) + filename_len;
-	unsigned char tmpbuf[MAX_BUF_LEN];
+	int filename_len;
+	unsigned int payload_size;
+	unsigned char tmpbuf[RPMSG_RPC_BUF_SIZE];
 	int ret;
 
-	if (!filename || payload_size > (int)MAX_BUF_LEN) {
+	if (!filename || !rpc)
 		return -EINVAL;
-	}
 
-	if (!rpc)
+	filename_len = strlen(filename) + 1;
+	payload_size = sizeof(*syscall) + filename_len;
+	if (payload_size > RPMSG_RPC_BUF_SIZE)
 		return -EINVAL;
 
 	/* Construct rpc payload */
@@ -187,8 +417,10 @@ int _open(const char *filename, int flags, int mode)
 	memcpy(tmpbuf + sizeof(*syscall), filename, filename_len);
 
 	resp.id = 0;
+	metal_mutex_acquire(&rpc->lock);
 	ret = rpmsg_rpc_send(rpc, tmpbuf, payload_size,
 			     (void *)&resp, sizeof(resp));
+	metal_mutex_release(&rpc->lock);
 	if (ret >= 0) {
 		/* Obtain return args and return to caller */
 		if (resp.id == OPEN_SYSCALL_ID)
@@ -200,6 +432,59 @@ int _open(const char *filename, int flags, int mode)
 	return ret;
 }
 
+/*
+ * Fill the read-ahead buffer. A full buffer is asked for so that the
+ * next sequential reads are served locally. Standard input is only
+ * read for what the caller asked, to not hold back input it does not
+ * want yet.
+ */
+static int rpmsg_rpc_read_ahead(struct rpmsg_rpc_data *rpc, int fd,
+				size_t len)
+{
+	struct rpmsg_rpc_syscall syscall;
+	struct rpmsg_rpc_syscall *resp = (void *)rpc->rbuf;
+	size_t max = sizeof(rpc->rbuf) - sizeof(*resp);
+	int ret;
+
+	if (fd != 0 || len > max)
+		len = max;
+
+	rpc->rbuf_fd = -1;
+	rpc->rbuf_off = 0;
+	rpc->rbuf_len = 0;
+
+	/* Construct rpc payload */
+	syscall.id = READ_SYSCALL_ID;
+	syscall.args.int_field1 = fd;
+	syscall.args.int_field2 = len;
+	syscall.args.data_len = 0;	/*not used */
+
+	resp->id = 0;
+	ret = rpmsg_rpc_send(rpc, (void *)&syscall, sizeof(syscall),
+			     rpc->rbuf, sizeof(rpc->rbuf));
+	if (ret < 0)
+		return ret;
+	if (resp->id != READ_SYSCALL_ID)
+		return -EINVAL;
+	if (resp->args.int_field1 <= 0)
+		return resp->args.int_field1;
+
+	rpc->rbuf_fd = fd;
+	rpc->rbuf_len = resp->args.data_len;
+	if (rpc->rbuf_len > max)
+		rpc->rbuf_len = max;
+
+	return rpc->rbuf_len;
+}
+
+static void rpmsg_rpc_read_drop(struct rpmsg_rpc_data *rpc, int fd)
+{
+	if (rpc->rbuf_fd == fd) {
+		rpc->rbuf_fd = -1;
+		rpc->rbuf_len = 0;
+	}
+}
+
 /*************************************************************************
  *
  *   FUNCTION
@@ -213,45 +498,27 @@ int _open(const char *filename, int flags, int mode)
  *************************************************************************/
 int _read(int fd, char *buffer, int buflen)
 {
-	struct rpmsg_rpc_syscall syscall;
-	struct rpmsg_rpc_syscall *resp;
 	struct rpmsg_rpc_data *rpc = rpmsg_default_rpc;
-	int payload_size = sizeof(syscall);
-	unsigned char tmpbuf[MAX_BUF_LEN];
 	int ret;
 
-	if (!rpc || !buffer || buflen == 0)
+	if (!rpc || !buffer || buflen <= 0)
 		return -EINVAL;
 
-	/* Construct rpc payload */
-	syscall.id = READ_SYSCALL_ID;
-	syscall.args.int_field1 = fd;
-	syscall.args.int_field2 = buflen;
-	syscall.args.data_len = 0;	/*not used */
-
-	resp = (void *)tmpbuf;
-	resp->id = 0;
-	ret = rpmsg_rpc_send(rpc, (void *)&syscall, payload_size,
-			     tmpbuf, sizeof(tmpbuf));
-
-	/* Obtain return args and return to caller */
-	if (ret >= 0) {
-		if (resp->id == READ_SYSCALL_ID) {
-			if (resp->args.int_field1 > 0) {
-				int tmplen = resp->args.data_len;
-				unsigned char *tmpptr = tmpbuf;
-
-				tmpptr += sizeof(*resp);
-				if (tmplen > buflen)
-					tmplen = buflen;
-				memcpy(buffer, tmpptr, tmplen);
-			}
-			ret = resp->args.int_field1;
-		} else {
-			ret = -EINVAL;
-		}
+	metal_mutex_acquire(&rpc->lock);
+	if (rpc->rbuf_fd != fd || !rpc->rbuf_len) {
+		ret = rpmsg_rpc_read_ahead(rpc, fd, buflen);
+		if (ret <= 0)
+			goto out;
 	}
 
+	ret = rpc->rbuf_len < (size_t)buflen ? (int)rpc->rbuf_len : buflen;
+	memcpy(buffer, rpc->rbuf + sizeof(struct rpmsg_rpc_syscall) +
+	       rpc->rbuf_off, ret);
+	rpc->rbuf_off += ret;
+	rpc->rbuf_len -= ret;
+out:
+	metal_mutex_release(&rpc->lock);
+
 	return ret;
 }
 
@@ -268,44 +535,53 @@ int _read(int fd, char *buffer, int buflen)
  *************************************************************************/
 int _write(int fd, const char *ptr, int len)
 {
-	int ret;
-	struct rpmsg_rpc_syscall *syscall;
-	struct rpmsg_rpc_syscall resp;
-	int payload_size = sizeof(*syscall) + len;
 	struct rpmsg_rpc_data *rpc = rpmsg_default_rpc;
-	unsigned char tmpbuf[MAX_BUF_LEN];
-	unsigned char *tmpptr;
-	int null_term = 0;
+	size_t chunk;
+	int off;
+	int ret;
 
-	if (!rpc)
+	if (!rpc || !ptr || len < 0)
 		return -EINVAL;
-	if (fd == 1)
-		null_term = 1;
+	if (!len)
+		return 0;
 
-	syscall = (void *)tmpbuf;
-	syscall->id = WRITE_SYSCALL_ID;
-	syscall->args.int_field1 = fd;
-	syscall->args.int_field2 = len;
-	syscall->args.data_len = len + null_term;
-	tmpptr = tmpbuf + sizeof(*syscall);
-	memcpy(tmpptr, ptr, len);
-	if (null_term == 1) {
-		*(char *)(tmpptr + len + null_term) = 0;
-		payload_size += 1;
-	}
-	resp.id = 0;
-	ret = rpmsg_rpc_send(rpc, tmpbuf, payload_size,
-			     (void *)&resp, sizeof(resp));
+	metal_mutex_acquire(&rpc->lock);
+	rpmsg_rpc_read_drop(rpc, fd);
 
-	if (ret >= 0) {
-		if (resp.id == WRITE_SYSCALL_ID)
-			ret = resp.args.int_field1;
-		else
-			ret = -EINVAL;
+	/* Report a failed earlier write before taking more data */
+	ret = rpmsg_rpc_take_err(rpc);
+	if (ret < 0)
+		goto out;
+
+	rpmsg_rpc_wbuf_claim(rpc);
+	if (rpc->wbuf_len && (rpc->wbuf_fd != fd ||
+			      rpc->wbuf_len + len > sizeof(rpc->wbuf)))
+		ret = rpmsg_rpc_wbuf_send(rpc, true);
+	if (ret >= 0 && (size_t)len <= sizeof(rpc->wbuf)) {
+		memcpy(rpc->wbuf + rpc->wbuf_len, ptr, len);
+		rpc->wbuf_fd = fd;
+		rpc->wbuf_len += len;
+		rpmsg_rpc_wbuf_reserve(rpc);
+		rpmsg_rpc_wbuf_unclaim(rpc);
+		rpmsg_rpc_wbuf_kick(rpc, true);
+		ret = len;
+		goto out;
+	}
+	rpmsg_rpc_wbuf_unclaim(rpc);
+
+	/* Large write: send every chunk back to back */
+	for (off = 0; ret >= 0 && off < len; off += chunk) {
+		chunk = len - off;
+		if (chunk > sizeof(rpc->wbuf))
+			chunk = sizeof(rpc->wbuf);
+		ret = rpmsg_rpc_post_write(rpc, fd, ptr + off, chunk, NULL, 0,
+					   true);
 	}
+	ret = ret < 0 ? -EINVAL : len;
+out:
+	metal_mutex_release(&rpc->lock);
 
 	return ret;
-
 }
 
 /*************************************************************************
@@ -321,7 +597,7 @@ int _write(int fd, const char *ptr, int len)
  *************************************************************************/
 int _close(int fd)
 {
-	int ret;
+	int ret, err;
 	struct rpmsg_rpc_syscall syscall;
 	struct rpmsg_rpc_syscall resp;
 	int payload_size = sizeof(syscall);
@@ -335,8 +611,12 @@ int _close(int fd)
 	syscall.args.data_len = 0;	/*not used */
 
 	resp.id = 0;
+	metal_mutex_acquire(&rpc->lock);
+	rpmsg_rpc_read_drop(rpc, fd);
+	err = rpmsg_rpc_drain(rpc);
 	ret = rpmsg_rpc_send(rpc, (void *)&syscall, payload_size,
 			     (void *)&resp, sizeof(resp));
+	metal_mutex_release(&rpc->lock);
 
 	if (ret >= 0) {
 		if (resp.id == CLOSE_SYSCALL_ID)
@@ -344,6 +624,9 @@ int _close(int fd)
 		else
 			ret = -EINVAL;
 	}
+	/* Writes still in flight at close time report their error here */
+	if (ret >= 0 && err < 0)
+		ret = err;
 
 	return ret;
 }
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <metal/alloc.h>
+#include <metal/io.h>
+#include <metal/log.h>
+#include <openamp/compressed_image_store.h>
+#include <string.h>
+
+static uint32_t compressed_image_le32(const unsigned char *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+	       (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Decode an LZ4 block, the output must be exactly dst_len bytes */
+static int compressed_image_lz4(const unsigned char *src, size_t src_len,
+				unsigned char *dst, size_t dst_len)
+{
+	const unsigned char *src_end = src + src_len;
+	unsigned char *dp = dst;
+	const unsigned char *match;
+	size_t len, off;
+	unsigned char token, b;
+
+	while (src < src_end) {
+		token = *src++;
+
+		/* Literals */
+		len = token >> 4;
+		if (len == 15) {
+			do {
+				if (src >= src_end)
+					return -EINVAL;
+				b = *src++;
+				len += b;
+			} while (b == 255);
+		}
+		if (len > (size_t)(src_end - src) ||
+		    len > (size_t)(dst + dst_len - dp))
+			return -EINVAL;
+		memcpy(dp, src, len);
+		dp += len;
+		src += len;
+
+		/* The last sequence has no match */
+		if (src == src_end)
+			break;
+
+		/* Match */
+		if (src_end - src < 2)
+			return -EINVAL;
+		off = src[0] | (size_t)src[1] << 8;
+		src += 2;
+		if (!off || off > (size_t)(dp - dst))
+			return -EINVAL;
+		len = token & 15;
+		if (len == 15) {
+			do {
+				if (src >= src_end)
+					return -EINVAL;
+				b = *src++;
+				len += b;
+			} while (b == 255);
+		}
+		len += 4;
+		if (len > (size_t)(dst + dst_len - dp))
+			return -EINVAL;
+		match = dp - off;
+		if (off >= len) {
+			memcpy(dp, match, len);
+			dp += len;
+		} else {
+			/* Overlapping match repeats the last off bytes */
+			while (len--)
+				*dp++ = *match++;
+		}
+	}
+
+	return dp == dst + dst_len ? 0 : -EINVAL;
+}
+
+static size_t compressed_image_block_len(struct compressed_image_store *zs,
+					 uint32_t block)
+{
+	size_t start = (size_t)block * zs->block_size;
+
+	if (zs->image_size - start < zs->block_size)
+		return zs->image_size - start;
+	return zs->block_size;
+}
+
+/* Decompress a block to dst, which may be target memory */
+static int compressed_image_inflate(struct compressed_image_store *zs,
+				    uint32_t block, unsigned char *dst)
+{
+	size_t raw_len = compressed_image_block_len(zs, block);
+	size_t len = zs->blocks[block + 1] - zs->blocks[block];
+	const void *src = NULL;
+	int ret;
+
+	ret = zs->ops->load(zs->store, zs->blocks[block], len, &src,
+			    RPROC_LOAD_ANYADDR, NULL, 1);
+	if (ret != (int)len || !src) {
+		metal_log(METAL_LOG_ERROR,
+			  "compressed image: failed to read block %u\r\n",
+			  block);
+		return -EIO;
+	}
+
+	if (len == raw_len) {
+		memcpy(dst, src, len);
+		return 0;
+	}
+	ret = compressed_image_lz4(src, len, dst, raw_len);
+	if (ret)
+		metal_log(METAL_LOG_ERROR,
+			  "compressed image: block %u is corrupted\r\n",
+			  block);
+
+	return ret;
+}
+
+static int compressed_image_get_block(struct compressed_image_store *zs,
+				      uint32_t block)
+{
+	int ret;
+
+	if (zs->scratch_block == block)
+		return 0;
+	zs->scratch_block = zs->num_blocks;
+	ret = compressed_image_inflate(zs, block, zs->scratch);
+	if (!ret)
+		zs->scratch_block = block;
+
+	return ret;
+}
+
+/*
+ * Copy a range of the uncompressed image to dst if it is directly
+ * accessible, or else to io at io_offset. Whole blocks are decompressed
+ * straight to dst, the others go through the scratch buffer.
+ */
+static int compressed_image_copy(struct compressed_image_store *zs,
+				 size_t offset, size_t size,
+				 unsigned char *dst,
+				 struct metal_io_region *io,
+				 unsigned long io_offset)
+{
+	size_t done, pos, boff, raw_len, len;
+	uint32_t block;
+	int ret;
+
+	for (done = 0; done < size; done += len) {
+		pos = offset + done;
+		block = pos / zs->block_size;
+		boff = pos % zs->block_size;
+		raw_len = compressed_image_block_len(zs, block);
+		len = raw_len - boff;
+		if (len > size - done)
+			len = size - done;
+
+		if (dst && len == raw_len) {
+			ret = compressed_image_inflate(zs, block, dst + done);
+		} else {
+			ret = compressed_image_get_block(zs, block);
+			if (ret)
+				return ret;
+			if (dst)
+				memcpy(dst + done, zs->scratch + boff, len);
+			else if (metal_io_block_write(io, io_offset + done,
+						      zs->scratch + boff,
+						      len) != (int)len)
+				ret = -EIO;
+		}
+		if (ret)
+			return ret;
+	}
+
+	return (int)size;
+}
+
+static void compressed_image_free(struct compressed_image_store *zs)
+{
+	metal_free_memory(zs->blocks);
+	metal_free_memory(zs->scratch);
+	metal_free_memory(zs->hdr_buf);
+	zs->blocks = NULL;
+	zs->scratch = NULL;
+	zs->hdr_buf = NULL;
+	zs->hdr_buf_len = 0;
+}
+
+static int compressed_image_open(void *store, const char *path,
+				 const void **img_data)
+{
+	struct compressed_image_store *zs = store;
+	const unsigned char *data;
+	const void *index;
+	size_t index_len;
+	uint32_t i;
+	int ret;
+
+	if (!zs || !zs->ops || !img_data)
+		return -EINVAL;
+	/* Blocks are read out of order, through the block index */
+	if (!(zs->ops->features & SUPPORT_SEEK)) {
+		metal_log(METAL_LOG_ERROR,
+			  "compressed image: the store cannot seek\r\n");
+		return -EINVAL;
+	}
+
+	zs->raw = false;
+	zs->blocks = NULL;
+	zs->scratch = NULL;
+	zs->hdr_buf = NULL;
+	zs->hdr_buf_len = 0;
+	ret = zs->ops->open(zs->store, path, (const void **)&data);
+	if (ret <= 0)
+		return ret;
+	if ((size_t)ret < sizeof(struct compressed_image_header) ||
+	    compressed_image_le32(data) != COMPRESSED_IMAGE_MAGIC) {
+		zs->raw = true;
+		*img_data = data;
+		return ret;
+	}
+
+	zs->block_size = compressed_image_le32(data + 4);
+	zs->image_size = compressed_image_le32(data + 8);
+	zs->num_blocks = compressed_image_le32(data + 12);
+	if (!zs->block_size || !zs->image_size ||
+	    zs->image_size > INT_MAX || zs->num_blocks !=
+	    (zs->image_size - 1) / zs->block_size + 1) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	index_len = ((size_t)zs->num_blocks + 1) * sizeof(uint32_t);
+	zs->blocks = metal_allocate_memory(index_len);
+	zs->scratch = metal_allocate_memory(zs->block_size);
+	if (!zs->blocks || !zs->scratch) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	ret = zs->ops->load(zs->store, sizeof(struct compressed_image_header),
+			    index_len, &index, RPROC_LOAD_ANYADDR, NULL, 1);
+	if (ret != (int)index_len || !index) {
+		ret = -EIO;
+		goto err;
+	}
+	for (i = 0; i <= zs->num_blocks; i++) {
+		zs->blocks[i] = compressed_image_le32((const unsigned char *)
+						      index + i * 4);
+		if (i && (zs->blocks[i] < zs->blocks[i - 1] ||
+			  zs->blocks[i] - zs->blocks[i - 1] >
+			  compressed_image_block_len(zs, i - 1))) {
+			ret = -EINVAL;
+			goto err;
+		}
+	}
+
+	/* Hand the first block to the loader to identify the image */
+	zs->scratch_block = zs->num_blocks;
+	ret = compressed_image_get_block(zs, 0);
+	if (ret)
+		goto err;
+	*img_data = zs->scratch;
+	return (int)compressed_image_block_len(zs, 0);
+
+err:
+	metal_log(METAL_LOG_ERROR, "compressed image: invalid image %d\r\n",
+		  ret);
+	compressed_image_free(zs);
+	zs->ops->close(zs->store);
+	return ret;
+}
+
+static void compressed_image_close(void *store)
+{
+	struct compressed_image_store *zs = store;
+
+	if (!zs || !zs->ops)
+		return;
+	if (!zs->raw)
+		compressed_image_free(zs);
+	zs->ops->close(zs->store);
+}
+
+static int compressed_image_load(void *store, size_t offset, size_t size,
+				 const void **data, metal_phys_addr_t pa,
+				 struct metal_io_region *io, char is_blocking)
+{
+	struct compressed_image_store *zs = store;
+	unsigned long io_offset;
+	unsigned char *va;
+	size_t boff;
+	int ret;
+
+	if (!zs || !zs->ops)
+		return -EINVAL;
+	if (zs->raw)
+		return zs->ops->load(zs->store, offset, size, data, pa, io,
+				     is_blocking);
+	if (offset > zs->image_size || size > zs->image_size - offset)
+		return -EINVAL;
+
+	if (pa == RPROC_LOAD_ANYADDR) {
+		if (!data)
+			return -EINVAL;
+		boff = offset % zs->block_size;
+		if (boff + size <= zs->block_size) {
+			ret = compressed_image_get_block(zs,
+							 offset /
+							 zs->block_size);
+			if (ret)
+				return ret;
+			*data = zs->scratch + boff;
+			return (int)size;
+		}
+		/* Loads spanning blocks are assembled in hdr_buf */
+		if (size > zs->hdr_buf_len) {
+			metal_free_memory(zs->hdr_buf);
+			zs->hdr_buf_len = 0;
+			zs->hdr_buf = metal_allocate_memory(size);
+			if (!zs->hdr_buf)
+				return -ENOMEM;
+			zs->hdr_buf_len = size;
+		}
+		ret = compressed_image_copy(zs, offset, size, zs->hdr_buf,
+					    NULL, 0);
+		if (ret >= 0)
+			*data = zs->hdr_buf;
+		return ret;
+	}
+
+	if (!io)
+		return -EINVAL;
+	io_offset = metal_io_phys_to_offset(io, pa);
+	if (io_offset == METAL_BAD_OFFSET)
+		return -EINVAL;
+	va = io->ops.block_write ? NULL : metal_io_phys_to_virt(io, pa);
+
+	return compressed_image_copy(zs, offset, size, va, io, io_offset);
+}
+
+const struct image_store_ops compressed_image_store_ops = {
+	.open = compressed_image_open,
+	.close = compressed_image_close,
+	.load = compressed_image_load,
+	.features = SUPPORT_SEEK,
+};
@@ -174,6 +174,61 @@ static int *elf_load_state(void *elf_info)
 	}
 }
 
+static struct elf_index *elf_index_ptr(void *elf_info)
+{
+	if (elf_is_64(elf_info) == 0) {
+		struct elf32_info *einfo = elf_info;
+
+		return &einfo->index;
+	} else {
+		struct elf64_info *einfo = elf_info;
+
+		return &einfo->index;
+	}
+}
+
+/* FNV-1a hash of a section or symbol name */
+static uint32_t elf_name_hash(const char *name)
+{
+	uint32_t hash = 0x811c9dc5U;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 0x01000193U;
+	}
+	return hash;
+}
+
+static uint32_t *elf_index_alloc(uint32_t num, uint32_t *mask)
+{
+	uint32_t *slots;
+	uint32_t size = 1;
+
+	/* Keep the table at most half full so that probes stay short */
+	while (size < 2 * num)
+		size <<= 1;
+	slots = metal_allocate_memory(size * sizeof(*slots));
+	if (!slots)
+		return NULL;
+	memset(slots, 0, size * sizeof(*slots));
+	*mask = size - 1;
+	return slots;
+}
+
+/*
+ * Entries are linearly probed, so among entries of the same name the
+ * first added is the first found.
+ */
+static void elf_index_add(uint32_t *slots, uint32_t mask, const char *name,
+			  uint32_t entry)
+{
+	uint32_t i = elf_name_hash(name) & mask;
+
+	while (slots[i])
+		i = (i + 1) & mask;
+	slots[i] = entry + 1;
+}
+
 static void elf_parse_segment(void *elf_info, const void *elf_phdr,
 			      unsigned int *p_type, size_t *p_offset,
 			      metal_phys_addr_t *p_vaddr,
@@ -238,43 +293,6 @@ static const void *elf_get_segment_from_index(void *elf_info, int index)
 	}
 }
 
-static void *elf_get_section_from_name(void *elf_info, const char *name)
-{
-	unsigned int i;
-	const char *name_table;
-
-	if (elf_is_64(elf_info) == 0) {
-		struct elf32_info *einfo = elf_info;
-		Elf32_Ehdr *ehdr = &einfo->ehdr;
-		Elf32_Shdr *shdr = einfo->shdrs;
-
-		name_table = einfo->shstrtab;
-		if (!shdr || !name_table)
-			return NULL;
-		for (i = 0; i < ehdr->e_shnum; i++, shdr++) {
-			if (strcmp(name, name_table + shdr->sh_name))
-				continue;
-			else
-				return shdr;
-		}
-	} else {
-		struct elf64_info *einfo = elf_info;
-		Elf64_Ehdr *ehdr = &einfo->ehdr;
-		Elf64_Shdr *shdr = einfo->shdrs;
-
-		name_table = einfo->shstrtab;
-		if (!shdr || !name_table)
-			return NULL;
-		for (i = 0; i < ehdr->e_shnum; i++, shdr++) {
-			if (strcmp(name, name_table + shdr->sh_name))
-				continue;
-			else
-				return shdr;
-		}
-	}
-	return NULL;
-}
-
 static void *elf_get_section_from_index(void *elf_info, int index)
 {
 	if (elf_is_64(elf_info) == 0) {
@@ -353,6 +371,216 @@ static void elf_parse_section(void *elf_info, void *elf_shdr,
 	}
 }
 
+static const char *elf_section_name(void *elf_info, const void *elf_shdr)
+{
+	const char *name_table = *elf_shstrtab_ptr(elf_info);
+
+	if (elf_is_64(elf_info) == 0) {
+		const Elf32_Shdr *shdr = elf_shdr;
+
+		return name_table + shdr->sh_name;
+	} else {
+		const Elf64_Shdr *shdr = elf_shdr;
+
+		return name_table + shdr->sh_name;
+	}
+}
+
+static void *elf_get_section_from_name(void *elf_info, const char *name)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+	void *shdr;
+	int i;
+
+	if (!*elf_shtable_ptr(elf_info) || !*elf_shstrtab_ptr(elf_info))
+		return NULL;
+	if (index->sections) {
+		uint32_t mask = index->sections_mask;
+		uint32_t slot;
+
+		for (slot = elf_name_hash(name) & mask; index->sections[slot];
+		     slot = (slot + 1) & mask) {
+			shdr = elf_get_section_from_index(elf_info,
+							  index->sections[slot] - 1);
+			if (shdr && !strcmp(name, elf_section_name(elf_info, shdr)))
+				return shdr;
+		}
+		return NULL;
+	}
+	/* No index, e.g. it could not be allocated */
+	for (i = 0; i < elf_shnum(elf_info); i++) {
+		shdr = elf_get_section_from_index(elf_info, i);
+		if (!strcmp(name, elf_section_name(elf_info, shdr)))
+			return shdr;
+	}
+	return NULL;
+}
+
+static void *elf_get_section_from_type(void *elf_info, unsigned int type)
+{
+	unsigned int sh_type;
+	void *shdr;
+	int i;
+
+	for (i = 0; i < elf_shnum(elf_info); i++) {
+		shdr = elf_get_section_from_index(elf_info, i);
+		if (!shdr)
+			return NULL;
+		elf_parse_section(elf_info, shdr, &sh_type, NULL, NULL, NULL,
+				  NULL, NULL, NULL, NULL, NULL);
+		if (sh_type == type)
+			return shdr;
+	}
+	return NULL;
+}
+
+static void elf_index_sections(void *elf_info)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+	int shnum = elf_shnum(elf_info);
+	void *shdr;
+	int i;
+
+	index->sections = elf_index_alloc(shnum, &index->sections_mask);
+	if (!index->sections) {
+		metal_log(METAL_LOG_DEBUG, "no memory to index sections\r\n");
+		return;
+	}
+	for (i = 0; i < shnum; i++) {
+		shdr = elf_get_section_from_index(elf_info, i);
+		elf_index_add(index->sections, index->sections_mask,
+			      elf_section_name(elf_info, shdr), i);
+	}
+}
+
+static void elf_parse_symbol(void *elf_info, uint32_t i,
+			     uint32_t *st_name, unsigned int *st_info,
+			     unsigned int *st_shndx,
+			     metal_phys_addr_t *st_value, size_t *st_size)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+
+	if (elf_is_64(elf_info) == 0) {
+		const Elf32_Sym *sym = (const Elf32_Sym *)index->symtab + i;
+
+		if (st_name)
+			*st_name = sym->st_name;
+		if (st_info)
+			*st_info = sym->st_info;
+		if (st_shndx)
+			*st_shndx = sym->st_shndx;
+		if (st_value)
+			*st_value = (metal_phys_addr_t)sym->st_value;
+		if (st_size)
+			*st_size = (size_t)sym->st_size;
+	} else {
+		const Elf64_Sym *sym = (const Elf64_Sym *)index->symtab + i;
+
+		if (st_name)
+			*st_name = sym->st_name;
+		if (st_info)
+			*st_info = sym->st_info;
+		if (st_shndx)
+			*st_shndx = sym->st_shndx;
+		if (st_value)
+			*st_value = (metal_phys_addr_t)sym->st_value;
+		if (st_size)
+			*st_size = (size_t)sym->st_size;
+	}
+}
+
+/*
+ * Return the name of a symbol worth looking up, i.e. a defined object,
+ * function or label, NULL otherwise. local tells its binding.
+ */
+static const char *elf_symbol_name(void *elf_info, uint32_t i, int *local)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+	unsigned int st_info, st_shndx;
+	uint32_t st_name;
+
+	elf_parse_symbol(elf_info, i, &st_name, &st_info, &st_shndx,
+			 NULL, NULL);
+	if (st_name == 0 || st_name >= index->strtab_size ||
+	    st_shndx == SHN_UNDEF || ELF32_ST_TYPE(st_info) == STT_SECTION ||
+	    ELF32_ST_TYPE(st_info) == STT_FILE)
+		return NULL;
+	*local = ELF32_ST_BIND(st_info) == STB_LOCAL;
+	return index->strtab + st_name;
+}
+
+static void elf_index_symbols(void *elf_info)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+	const char *name;
+	int pass, local;
+	uint32_t i;
+
+	index->symbols = elf_index_alloc(index->symnum, &index->symbols_mask);
+	if (!index->symbols) {
+		metal_log(METAL_LOG_DEBUG, "no memory to index symbols\r\n");
+		return;
+	}
+	/* Global symbols first, so that they shadow the local ones */
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < index->symnum; i++) {
+			name = elf_symbol_name(elf_info, i, &local);
+			if (name && local == pass)
+				elf_index_add(index->symbols,
+					      index->symbols_mask, name, i);
+		}
+	}
+}
+
+static int elf_get_symbol_from_name(void *elf_info, const char *name,
+				    uint32_t *sym)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+	const char *sym_name;
+	int local, found = 0;
+	uint32_t i;
+
+	if (index->symbols) {
+		uint32_t mask = index->symbols_mask;
+		uint32_t slot;
+
+		for (slot = elf_name_hash(name) & mask; index->symbols[slot];
+		     slot = (slot + 1) & mask) {
+			*sym = index->symbols[slot] - 1;
+			sym_name = elf_symbol_name(elf_info, *sym, &local);
+			if (sym_name && !strcmp(name, sym_name))
+				return 1;
+		}
+		return 0;
+	}
+	/* No index, e.g. it could not be allocated */
+	for (i = 0; i < index->symnum; i++) {
+		sym_name = elf_symbol_name(elf_info, i, &local);
+		if (!sym_name || strcmp(name, sym_name))
+			continue;
+		if (!found || !local)
+			*sym = i;
+		found = 1;
+		if (!local)
+			break;
+	}
+	return found;
+}
+
+static void elf_index_release(void *elf_info)
+{
+	struct elf_index *index = elf_index_ptr(elf_info);
+
+	if (index->sections)
+		metal_free_memory(index->sections);
+	if (index->symtab)
+		metal_free_memory(index->symtab);
+	if (index->strtab)
+		metal_free_memory(index->strtab);
+	if (index->symbols)
+		metal_free_memory(index->symbols);
+}
+
 static const void *elf_next_load_segment(void *elf_info, int *nseg,
 				   metal_phys_addr_t *da,
 				   size_t *noffset, size_t *nfsize,
@@ -392,9 +620,10 @@ int elf_identify(const void *img_data, size_t len)
 		return 0;
 }
 
-int elf_load_header(const void *img_data, size_t offset, size_t len,
-		    void **img_info, int last_load_state,
-		    size_t *noffset, size_t *nlen)
+static int elf_parse_header(const void *img_data, size_t offset, size_t len,
+			    void **img_info, int last_load_state,
+			    size_t *noffset, size_t *nlen,
+			    unsigned int index_flags)
 {
 	int *load_state;
 
@@ -420,6 +649,7 @@ int elf_load_header(const void *img_data, size_t offset, size_t len,
 				memset(*img_info, 0, infosize);
 			}
 			memcpy(*img_info, img_data, tmpsize);
+			elf_index_ptr(*img_info)->flags |= index_flags;
 			load_state = elf_load_state(*img_info);
 			*load_state = ELF_STATE_WAIT_FOR_PHDRS;
 			last_load_state = ELF_STATE_WAIT_FOR_PHDRS;
@@ -523,6 +753,91 @@ int elf_load_header(const void *img_data, size_t offset, size_t len,
 		memcpy(*shstrtab,
 		       (const char *)img_data + shstrtab_offset,
 		       shstrtab_size);
+		elf_index_sections(*img_info);
+		if ((elf_index_ptr(*img_info)->flags & ELF_INDEX_SYMBOLS) == 0) {
+			*load_state = (*load_state & (~ELF_STATE_MASK)) |
+				       ELF_STATE_HDRS_COMPLETE;
+			*nlen = 0;
+			return *load_state;
+		}
+		*load_state = (*load_state & (~ELF_STATE_MASK)) |
+			       ELF_STATE_WAIT_FOR_SYMTAB;
+	}
+	/* Get ELF symbol table */
+	if ((*load_state & ELF_STATE_WAIT_FOR_SYMTAB) != 0) {
+		struct elf_index *index = elf_index_ptr(*img_info);
+		size_t symtab_size;
+		size_t symtab_offset;
+		size_t sym_size;
+		void *shdr;
+
+		metal_log(METAL_LOG_DEBUG, "Loading ELF symtab.\r\n");
+		shdr = elf_get_section_from_type(*img_info, SHT_SYMTAB);
+		sym_size = elf_is_64(*img_info) ? sizeof(Elf64_Sym) :
+			   sizeof(Elf32_Sym);
+		if (shdr)
+			elf_parse_section(*img_info, shdr, NULL, NULL,
+					  NULL, &symtab_offset,
+					  &symtab_size, NULL, NULL,
+					  NULL, NULL);
+		if (!shdr || symtab_size < sym_size) {
+			/* Stripped image, only sections can be looked up */
+			*load_state = (*load_state & (~ELF_STATE_MASK)) |
+				       ELF_STATE_HDRS_COMPLETE;
+			*nlen = 0;
+			return *load_state;
+		}
+		if (offset > symtab_offset ||
+		    offset + len < symtab_offset + symtab_size) {
+			*noffset = symtab_offset;
+			*nlen = symtab_size;
+			return *load_state;
+		}
+		index->symtab = metal_allocate_memory(symtab_size);
+		if (!index->symtab)
+			return -RPROC_ENOMEM;
+		memcpy(index->symtab,
+		       (const char *)img_data + symtab_offset - offset,
+		       symtab_size);
+		index->symnum = symtab_size / sym_size;
+		*load_state = (*load_state & (~ELF_STATE_MASK)) |
+			       ELF_STATE_WAIT_FOR_STRTAB;
+	}
+	/* Get ELF symbol string table */
+	if ((*load_state & ELF_STATE_WAIT_FOR_STRTAB) != 0) {
+		struct elf_index *index = elf_index_ptr(*img_info);
+		size_t strtab_size;
+		size_t strtab_offset;
+		unsigned int strndx;
+		void *shdr;
+
+		metal_log(METAL_LOG_DEBUG, "Loading ELF symbol strtab.\r\n");
+		shdr = elf_get_section_from_type(*img_info, SHT_SYMTAB);
+		elf_parse_section(*img_info, shdr, NULL, NULL, NULL, NULL,
+				  NULL, &strndx, NULL, NULL, NULL);
+		shdr = elf_get_section_from_index(*img_info, strndx);
+		if (!shdr)
+			return -RPROC_EINVAL;
+		elf_parse_section(*img_info, shdr, NULL, NULL,
+				  NULL, &strtab_offset,
+				  &strtab_size, NULL, NULL,
+				  NULL, NULL);
+		if (offset > strtab_offset ||
+		    offset + len < strtab_offset + strtab_size) {
+			*noffset = strtab_offset;
+			*nlen = strtab_size;
+			return *load_state;
+		}
+		index->strtab = metal_allocate_memory(strtab_size + 1);
+		if (!index->strtab)
+			return -RPROC_ENOMEM;
+		memcpy(index->strtab,
+		       (const char *)img_data + strtab_offset - offset,
+		       strtab_size);
+		/* Names are used as C strings, make sure the last one ends */
+		index->strtab[strtab_size] = '\0';
+		index->strtab_size = strtab_size;
+		elf_index_symbols(*img_info);
 		*load_state = (*load_state & (~ELF_STATE_MASK)) |
 			       ELF_STATE_HDRS_COMPLETE;
 		*nlen = 0;
@@ -531,6 +846,24 @@ int elf_load_header(const void *img_data, size_t offset, size_t len,
 	return last_load_state;
 }
 
+int elf_load_header(const void *img_data, size_t offset, size_t len,
+		    void **img_info, int last_load_state,
+		    size_t *noffset, size_t *nlen)
+{
+	return elf_parse_header(img_data, offset, len, img_info,
+				last_load_state, noffset, nlen, 0);
+}
+
+static int elf_load_header_symtab(const void *img_data, size_t offset,
+				  size_t len, void **img_info,
+				  int last_load_state,
+				  size_t *noffset, size_t *nlen)
+{
+	return elf_parse_header(img_data, offset, len, img_info,
+				last_load_state, noffset, nlen,
+				ELF_INDEX_SYMBOLS);
+}
+
 int elf_load(struct remoteproc *rproc,
 	     const void *img_data, size_t offset, size_t len,
 	     void **img_info, int last_load_state,
@@ -632,6 +965,7 @@ void elf_release(void *img_info)
 			metal_free_memory(elf_info->shdrs);
 		if (elf_info->shstrtab)
 			metal_free_memory(elf_info->shstrtab);
+		elf_index_release(img_info);
 		metal_free_memory(img_info);
 
 	} else {
@@ -643,6 +977,7 @@ void elf_release(void *img_info)
 			metal_free_memory(elf_info->shdrs);
 		if (elf_info->shstrtab)
 			metal_free_memory(elf_info->shstrtab);
+		elf_index_release(img_info);
 		metal_free_memory(img_info);
 	}
 }
@@ -702,6 +1037,56 @@ int elf_get_load_state(void *img_info)
 	return *load_state;
 }
 
+int elf_segment_is_writable(void *img_info)
+{
+	const void *phdr;
+	int nsegment;
+
+	if (!img_info)
+		return -RPROC_EINVAL;
+	/* The load state holds the index following the last segment */
+	nsegment = *elf_load_state(img_info) & ELF_NEXT_SEGMENT_MASK;
+	phdr = elf_get_segment_from_index(img_info, nsegment - 1);
+	if (!phdr)
+		return -RPROC_EINVAL;
+	if (elf_is_64(img_info) == 0)
+		return (((const Elf32_Phdr *)phdr)->p_flags & PF_W) != 0;
+	else
+		return (((const Elf64_Phdr *)phdr)->p_flags & PF_W) != 0;
+}
+
+int elf_find_section(void *img_info, const char *name,
+		     metal_phys_addr_t *da, size_t *size)
+{
+	void *shdr;
+
+	if (!img_info || !name)
+		return -RPROC_EINVAL;
+	if ((*elf_load_state(img_info) & ELF_STATE_HDRS_COMPLETE) == 0)
+		return -RPROC_ERR_LOADER_STATE;
+	shdr = elf_get_section_from_name(img_info, name);
+	if (!shdr)
+		return -RPROC_ENODEV;
+	elf_parse_section(img_info, shdr, NULL, NULL, da, NULL, size,
+			  NULL, NULL, NULL, NULL);
+	return 0;
+}
+
+int elf_find_symbol(void *img_info, const char *name,
+		    metal_phys_addr_t *da, size_t *size)
+{
+	uint32_t sym;
+
+	if (!img_info || !name)
+		return -RPROC_EINVAL;
+	if ((*elf_load_state(img_info) & ELF_STATE_HDRS_COMPLETE) == 0)
+		return -RPROC_ERR_LOADER_STATE;
+	if (!elf_get_symbol_from_name(img_info, name, &sym))
+		return -RPROC_ENODEV;
+	elf_parse_symbol(img_info, sym, NULL, NULL, NULL, da, size);
+	return 0;
+}
+
 const struct loader_ops elf_ops = {
 	.load_header = elf_load_header,
 	.load_data = elf_load,
@@ -709,4 +1094,19 @@ const struct loader_ops elf_ops = {
 	.release = elf_release,
 	.get_entry = elf_get_entry,
 	.get_load_state = elf_get_load_state,
+	.segment_is_writable = elf_segment_is_writable,
+	.locate_section = elf_find_section,
+	.locate_symbol = elf_find_symbol,
+};
+
+const struct loader_ops elf_symtab_ops = {
+	.load_header = elf_load_header_symtab,
+	.load_data = elf_load,
+	.locate_rsc_table = elf_locate_rsc_table,
+	.release = elf_release,
+	.get_entry = elf_get_entry,
+	.get_load_state = elf_get_load_state,
+	.segment_is_writable = elf_segment_is_writable,
+	.locate_section = elf_find_section,
+	.locate_symbol = elf_find_symbol,
 };
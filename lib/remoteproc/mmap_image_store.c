@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <metal/alloc.h>
+#include <metal/io.h>
+#include <metal/log.h>
+#include <openamp/mmap_image_store.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Copies the worker can have queued before a load has to wait */
+#define MMAP_IMAGE_QUEUE_LEN	16
+
+struct mmap_image_copy {
+	const void *src;
+	size_t size;
+	struct metal_io_region *io;
+	unsigned long io_offset;
+};
+
+struct mmap_image_worker {
+	pthread_t thread;
+	/* Protects the queue, error and stop, signalled on any change */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct mmap_image_copy queue[MMAP_IMAGE_QUEUE_LEN];
+	/* Index of the oldest copy, which the worker may be running */
+	unsigned int head;
+	/* Copies queued or running */
+	unsigned int count;
+	/* First copy error since the last wait */
+	int error;
+	bool stop;
+};
+
+static int mmap_image_copy(struct metal_io_region *io,
+			   unsigned long io_offset, const void *src,
+			   size_t size)
+{
+	void *va = metal_io_virt(io, io_offset);
+
+	/*
+	 * The pages are not dropped after the copy: remoteproc_reload()
+	 * reads segments from the store to hash them, and headers may share
+	 * their pages. They are clean file pages the kernel can reclaim
+	 * behind the sequential read, and close() unmaps them all after the
+	 * last read.
+	 */
+	if (va && !io->ops.block_write)
+		memcpy(va, src, size);
+	else if (metal_io_block_write(io, io_offset, src, size) != (int)size)
+		return -EIO;
+
+	return 0;
+}
+
+static void *mmap_image_worker_run(void *arg)
+{
+	struct mmap_image_worker *worker = arg;
+	struct mmap_image_copy copy;
+	int ret;
+
+	pthread_mutex_lock(&worker->lock);
+	while (1) {
+		while (!worker->count && !worker->stop)
+			pthread_cond_wait(&worker->cond, &worker->lock);
+		/* Queued copies are finished before stopping */
+		if (!worker->count)
+			break;
+		copy = worker->queue[worker->head];
+		pthread_mutex_unlock(&worker->lock);
+		ret = mmap_image_copy(copy.io, copy.io_offset, copy.src,
+				      copy.size);
+		pthread_mutex_lock(&worker->lock);
+		if (ret && !worker->error)
+			worker->error = ret;
+		worker->head = (worker->head + 1) % MMAP_IMAGE_QUEUE_LEN;
+		worker->count--;
+		pthread_cond_broadcast(&worker->cond);
+	}
+	pthread_mutex_unlock(&worker->lock);
+
+	return NULL;
+}
+
+static void mmap_image_worker_stop(struct mmap_image_store *image)
+{
+	struct mmap_image_worker *worker = image->worker;
+
+	if (!worker)
+		return;
+	pthread_mutex_lock(&worker->lock);
+	worker->stop = true;
+	pthread_cond_broadcast(&worker->cond);
+	pthread_mutex_unlock(&worker->lock);
+	pthread_join(worker->thread, NULL);
+	pthread_cond_destroy(&worker->cond);
+	pthread_mutex_destroy(&worker->lock);
+	metal_free_memory(worker);
+	image->worker = NULL;
+}
+
+static int mmap_image_open(void *store, const char *path,
+			   const void **img_data)
+{
+	struct mmap_image_store *image = store;
+	struct stat st;
+	void *base;
+	int fd, ret;
+
+	if (!image || !path || !img_data)
+		return -EINVAL;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		ret = -errno;
+		metal_log(METAL_LOG_ERROR, "failed to open %s: %d\r\n",
+			  path, ret);
+		return ret;
+	}
+	if (fstat(fd, &st) < 0) {
+		ret = -errno;
+		goto err;
+	}
+	/* The open callback reports the image size as an int */
+	if (st.st_size <= 0 || st.st_size > INT_MAX) {
+		ret = -EFBIG;
+		goto err;
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (base == MAP_FAILED) {
+		ret = -errno;
+		goto err;
+	}
+	/*
+	 * The loader walks the image mostly forward: start reading it all
+	 * now so that the segments are in the page cache when needed.
+	 */
+	(void)madvise(base, st.st_size, MADV_SEQUENTIAL);
+	(void)madvise(base, st.st_size, MADV_WILLNEED);
+
+	image->fd = fd;
+	image->base = base;
+	image->size = st.st_size;
+	image->worker = NULL;
+	*img_data = base;
+	return (int)st.st_size;
+
+err:
+	metal_log(METAL_LOG_ERROR, "failed to map %s: %d\r\n", path, ret);
+	close(fd);
+	return ret;
+}
+
+static void mmap_image_close(void *store)
+{
+	struct mmap_image_store *image = store;
+
+	if (!image || image->fd < 0)
+		return;
+	/* The worker reads from the mapping until its queue is empty */
+	mmap_image_worker_stop(image);
+	munmap((void *)image->base, image->size);
+	close(image->fd);
+	image->fd = -1;
+	image->base = NULL;
+	image->size = 0;
+}
+
+static int mmap_image_load(void *store, size_t offset, size_t size,
+			   const void **data, metal_phys_addr_t pa,
+			   struct metal_io_region *io, char is_blocking)
+{
+	struct mmap_image_store *image = store;
+	struct mmap_image_worker *worker;
+	struct mmap_image_copy *copy;
+	const unsigned char *src;
+	unsigned long io_offset;
+
+	if (!image || image->fd < 0 || offset > image->size ||
+	    size > image->size - offset || size > INT_MAX)
+		return -EINVAL;
+	src = (const unsigned char *)image->base + offset;
+
+	if (pa == RPROC_LOAD_ANYADDR) {
+		/* Headers are read in place, no copy */
+		if (!data)
+			return -EINVAL;
+		*data = src;
+		return (int)size;
+	}
+
+	if (!io)
+		return -EINVAL;
+	io_offset = metal_io_phys_to_offset(io, pa);
+	if (io_offset == METAL_BAD_OFFSET)
+		return -EINVAL;
+	worker = image->worker;
+	if (is_blocking || !worker)
+		return mmap_image_copy(io, io_offset, src, size) ?
+		       -EIO : (int)size;
+
+	pthread_mutex_lock(&worker->lock);
+	while (worker->count == MMAP_IMAGE_QUEUE_LEN)
+		pthread_cond_wait(&worker->cond, &worker->lock);
+	copy = &worker->queue[(worker->head + worker->count) %
+			      MMAP_IMAGE_QUEUE_LEN];
+	copy->src = src;
+	copy->size = size;
+	copy->io = io;
+	copy->io_offset = io_offset;
+	worker->count++;
+	pthread_cond_broadcast(&worker->cond);
+	pthread_mutex_unlock(&worker->lock);
+
+	return (int)size;
+}
+
+static int mmap_image_open_async(void *store, const char *path,
+				 const void **img_data)
+{
+	struct mmap_image_store *image = store;
+	struct mmap_image_worker *worker;
+	int size, ret;
+
+	size = mmap_image_open(store, path, img_data);
+	if (size < 0)
+		return size;
+
+	worker = metal_allocate_memory(sizeof(*worker));
+	if (!worker) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	memset(worker, 0, sizeof(*worker));
+	pthread_mutex_init(&worker->lock, NULL);
+	pthread_cond_init(&worker->cond, NULL);
+	ret = -pthread_create(&worker->thread, NULL, mmap_image_worker_run,
+			      worker);
+	if (ret) {
+		pthread_cond_destroy(&worker->cond);
+		pthread_mutex_destroy(&worker->lock);
+		metal_free_memory(worker);
+		goto err;
+	}
+	image->worker = worker;
+	return size;
+
+err:
+	metal_log(METAL_LOG_ERROR, "failed to start the copy worker: %d\r\n",
+		  ret);
+	mmap_image_close(store);
+	return ret;
+}
+
+static int mmap_image_wait(void *store)
+{
+	struct mmap_image_store *image = store;
+	struct mmap_image_worker *worker;
+	int ret;
+
+	if (!image || !image->worker)
+		return 0;
+	worker = image->worker;
+	pthread_mutex_lock(&worker->lock);
+	while (worker->count)
+		pthread_cond_wait(&worker->cond, &worker->lock);
+	ret = worker->error;
+	worker->error = 0;
+	pthread_mutex_unlock(&worker->lock);
+
+	return ret;
+}
+
+const struct image_store_ops mmap_image_store_ops = {
+	.open = mmap_image_open,
+	.close = mmap_image_close,
+	.load = mmap_image_load,
+	.features = SUPPORT_SEEK,
+};
+
+const struct image_store_ops mmap_image_store_async_ops = {
+	.open = mmap_image_open_async,
+	.close = mmap_image_close,
+	.load = mmap_image_load,
+	.features = SUPPORT_SEEK | SUPPORT_NONBLOCK_LOAD,
+	.wait = mmap_image_wait,
+};
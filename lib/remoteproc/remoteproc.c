@@ -29,6 +29,26 @@ remoteproc_check_fw_format(const void *img_data, size_t img_len)
 		return NULL;
 }
 
+/* Called without the lock held, once a lifecycle step is over */
+static void remoteproc_state_changed(struct remoteproc *rproc,
+				     unsigned int old_state,
+				     unsigned int state)
+{
+	void (*state_cb)(struct remoteproc *rproc, unsigned int state);
+
+	state_cb = rproc->state_cb;
+	if (state != old_state && state_cb)
+		state_cb(rproc, state);
+}
+
+/* Forget the segments kept for remoteproc_reload() */
+static void remoteproc_drop_seg_hashes(struct remoteproc *rproc)
+{
+	metal_free_memory(rproc->seg_hashes);
+	rproc->seg_hashes = NULL;
+	rproc->seg_hashes_num = 0;
+}
+
 /* try the internal list added by remoteproc_add_mem first and then get_mem callback */
 static struct remoteproc_mem *
 remoteproc_get_mem(struct remoteproc *rproc, const char *name,
@@ -195,6 +215,9 @@ int remoteproc_remove(struct remoteproc *rproc)
 
 	metal_mutex_acquire(&rproc->lock);
 	if (rproc->state == RPROC_OFFLINE) {
+		remoteproc_drop_seg_hashes(rproc);
+		metal_free_memory(rproc->rsc_cache);
+		rproc->rsc_cache = NULL;
 		if (rproc->ops->remove)
 			rproc->ops->remove(rproc);
 	} else {
@@ -204,12 +227,27 @@ int remoteproc_remove(struct remoteproc *rproc)
 	return ret;
 }
 
+int remoteproc_set_state_cb(struct remoteproc *rproc,
+			    void (*state_cb)(struct remoteproc *rproc,
+					     unsigned int state))
+{
+	if (!rproc)
+		return -RPROC_EINVAL;
+
+	metal_mutex_acquire(&rproc->lock);
+	rproc->state_cb = state_cb;
+	metal_mutex_release(&rproc->lock);
+	return 0;
+}
+
 int remoteproc_config(struct remoteproc *rproc, void *data)
 {
 	int ret = -RPROC_ENODEV;
+	unsigned int old_state, state;
 
 	if (rproc) {
 		metal_mutex_acquire(&rproc->lock);
+		old_state = rproc->state;
 		if (rproc->state == RPROC_OFFLINE) {
 			/* configure operation is allowed if the state is
 			 * offline or ready. This function can be called
@@ -223,7 +261,9 @@ int remoteproc_config(struct remoteproc *rproc, void *data)
 		} else {
 			ret = -RPROC_EINVAL;
 		}
+		state = rproc->state;
 		metal_mutex_release(&rproc->lock);
+		remoteproc_state_changed(rproc, old_state, state);
 	}
 	return ret;
 }
@@ -231,16 +271,20 @@ int remoteproc_config(struct remoteproc *rproc, void *data)
 int remoteproc_start(struct remoteproc *rproc)
 {
 	int ret = -RPROC_ENODEV;
+	unsigned int old_state, state;
 
 	if (rproc) {
 		metal_mutex_acquire(&rproc->lock);
+		old_state = rproc->state;
 		if (rproc->state == RPROC_READY) {
 			ret = rproc->ops->start(rproc);
 			rproc->state = RPROC_RUNNING;
 		} else {
 			ret = -RPROC_EINVAL;
 		}
+		state = rproc->state;
 		metal_mutex_release(&rproc->lock);
+		remoteproc_state_changed(rproc, old_state, state);
 	}
 	return ret;
 }
@@ -248,9 +292,11 @@ int remoteproc_start(struct remoteproc *rproc)
 int remoteproc_stop(struct remoteproc *rproc)
 {
 	int ret = -RPROC_ENODEV;
+	unsigned int old_state, state;
 
 	if (rproc) {
 		metal_mutex_acquire(&rproc->lock);
+		old_state = rproc->state;
 		if (rproc->state != RPROC_STOPPED &&
 		    rproc->state != RPROC_OFFLINE) {
 			if (rproc->ops->stop)
@@ -260,7 +306,9 @@ int remoteproc_stop(struct remoteproc *rproc)
 		} else {
 			ret = 0;
 		}
+		state = rproc->state;
 		metal_mutex_release(&rproc->lock);
+		remoteproc_state_changed(rproc, old_state, state);
 	}
 	return ret;
 }
@@ -268,10 +316,17 @@ int remoteproc_stop(struct remoteproc *rproc)
 int remoteproc_shutdown(struct remoteproc *rproc)
 {
 	int ret = -RPROC_ENODEV;
+	unsigned int old_state, state;
 
 	if (rproc) {
 		ret = 0;
 		metal_mutex_acquire(&rproc->lock);
+		old_state = rproc->state;
+		/*
+		 * Target memory may be lost once the remote is powered off,
+		 * so the next reload has to write every segment again.
+		 */
+		remoteproc_drop_seg_hashes(rproc);
 		if (rproc->state != RPROC_OFFLINE) {
 			if (rproc->state != RPROC_STOPPED) {
 				if (rproc->ops->stop)
@@ -285,7 +340,9 @@ int remoteproc_shutdown(struct remoteproc *rproc)
 				}
 			}
 		}
+		state = rproc->state;
 		metal_mutex_release(&rproc->lock);
+		remoteproc_state_changed(rproc, old_state, state);
 	}
 	return ret;
 }
@@ -407,9 +464,136 @@ void *remoteproc_mmap(struct remoteproc *rproc,
 	return va;
 }
 
-int remoteproc_load(struct remoteproc *rproc, const char *path,
-		    void *store, const struct image_store_ops *store_ops,
-		    void **img_info)
+/* Wait for the segments the image store is still copying */
+static int remoteproc_load_wait(void *store,
+				const struct image_store_ops *store_ops,
+				bool *pending)
+{
+	int ret;
+
+	if (!*pending)
+		return 0;
+	*pending = false;
+	ret = store_ops->wait(store);
+	if (ret < 0) {
+		metal_log(METAL_LOG_ERROR,
+			  "load failure: non-blocking load failed %d.\r\n",
+			  ret);
+		return -RPROC_EINVAL;
+	}
+
+	return 0;
+}
+
+/* Read only segments are reloaded in chunks of this size */
+#define RPROC_HASH_CHUNK	0x10000UL
+#define RPROC_FNV_OFFSET	0xcbf29ce484222325ULL
+#define RPROC_FNV_PRIME		0x100000001b3ULL
+
+static bool remoteproc_seg_unchanged(struct remoteproc *rproc,
+				     const struct remoteproc_seg_hash *seg)
+{
+	const struct remoteproc_seg_hash *old;
+	unsigned int i;
+
+	for (i = 0; i < rproc->seg_hashes_num; i++) {
+		old = &rproc->seg_hashes[i];
+		if (old->da == seg->da && old->len == seg->len &&
+		    old->hash == seg->hash)
+			return true;
+	}
+
+	return false;
+}
+
+static int remoteproc_seg_hash_add(struct remoteproc_seg_hash **hashes,
+				   unsigned int *num,
+				   const struct remoteproc_seg_hash *seg)
+{
+	struct remoteproc_seg_hash *tmp;
+
+	/* Grow by 8 entries, images rarely have more than a few segments */
+	if ((*num % 8) == 0) {
+		tmp = metal_allocate_memory((*num + 8) * sizeof(*tmp));
+		if (!tmp)
+			return -RPROC_ENOMEM;
+		if (*num)
+			memcpy(tmp, *hashes, *num * sizeof(*tmp));
+		metal_free_memory(*hashes);
+		*hashes = tmp;
+	}
+	(*hashes)[(*num)++] = *seg;
+
+	return 0;
+}
+
+/*
+ * Load a read only segment for remoteproc_reload(). The segment is read
+ * once, in chunks to local memory: each chunk is hashed and only written
+ * to target memory if it differs from the last reload.
+ */
+static int remoteproc_reload_segment(struct remoteproc *rproc, void *store,
+				     const struct image_store_ops *store_ops,
+				     size_t offset, size_t len,
+				     metal_phys_addr_t da, metal_phys_addr_t pa,
+				     struct metal_io_region *io,
+				     struct remoteproc_seg_hash **hashes,
+				     unsigned int *hashes_num)
+{
+	struct remoteproc_seg_hash chunk;
+	const unsigned char *data;
+	unsigned long io_offset;
+	size_t done, i;
+	uint64_t h;
+	int ret;
+
+	for (done = 0; done < len; done += chunk.len) {
+		chunk.len = len - done;
+		if (chunk.len > RPROC_HASH_CHUNK)
+			chunk.len = RPROC_HASH_CHUNK;
+		data = NULL;
+		ret = store_ops->load(store, offset + done, chunk.len,
+				      (const void **)&data,
+				      RPROC_LOAD_ANYADDR, NULL, 1);
+		if (ret != (int)chunk.len || !data) {
+			metal_log(METAL_LOG_ERROR,
+				  "reload: failed to read 0x%lx, 0x%lx\r\n",
+				  offset + done, chunk.len);
+			return -RPROC_EINVAL;
+		}
+		chunk.da = da + done;
+		h = RPROC_FNV_OFFSET;
+		for (i = 0; i < chunk.len; i++)
+			h = (h ^ data[i]) * RPROC_FNV_PRIME;
+		chunk.hash = h;
+
+		if (remoteproc_seg_unchanged(rproc, &chunk)) {
+			metal_log(METAL_LOG_DEBUG,
+				  "reload: 0x%lx, 0x%lx unchanged\r\n",
+				  chunk.da, chunk.len);
+		} else {
+			io_offset = metal_io_phys_to_offset(io, pa + done);
+			ret = metal_io_block_write(io, io_offset, data,
+						   chunk.len);
+			if (ret != (int)chunk.len) {
+				metal_log(METAL_LOG_ERROR,
+					  "reload: failed to write 0x%lx\r\n",
+					  pa + done);
+				return -RPROC_EINVAL;
+			}
+		}
+		ret = remoteproc_seg_hash_add(hashes, hashes_num, &chunk);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int remoteproc_load_image(struct remoteproc *rproc, const char *path,
+				 void *store,
+				 const struct image_store_ops *store_ops,
+				 void **img_info, bool delta)
 {
 	int ret;
 	const struct loader_ops *loader;
@@ -422,6 +606,10 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 	size_t rsc_size = 0;
 	void *rsc_table = NULL;
 	struct metal_io_region *io = NULL;
+	bool nonblock, pending = false;
+	struct remoteproc_seg_hash *hashes = NULL;
+	unsigned int hashes_num = 0;
+	unsigned int old_state;
 
 	if (!rproc)
 		return -RPROC_ENODEV;
@@ -444,6 +632,10 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 		return -RPROC_EINVAL;
 	}
 
+	/* Target memory is about to change, only a reload keeps track */
+	if (!delta)
+		remoteproc_drop_seg_hashes(rproc);
+
 	/* Open executable to get ready to parse */
 	metal_log(METAL_LOG_DEBUG, "%s: open executable image\r\n", __func__);
 	ret = store_ops->open(store, path, &img_data);
@@ -526,14 +718,22 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 						     offset, rsc_size);
 	}
 
-	/* load executable data */
+	/*
+	 * load executable data
+	 * With a non-blocking store, a segment is copied while its BSS is
+	 * cleared and the next segment is parsed and issued. Segments do not
+	 * overlap, so only the resource table update has to wait for them.
+	 */
 	metal_log(METAL_LOG_DEBUG, "%s: load executable data\r\n", __func__);
+	nonblock = (store_ops->features & SUPPORT_NONBLOCK_LOAD) != 0 &&
+		   store_ops->wait;
 	offset = 0;
 	len = 0;
 	while (1) {
 		unsigned char padding;
 		size_t nmemsize;
 		metal_phys_addr_t pa;
+		bool reloaded;
 
 		da = RPROC_LOAD_ANYADDR;
 		nlen = 0;
@@ -566,9 +766,25 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 				ret = -RPROC_EINVAL;
 				goto error3;
 			}
-			if (nlen > 0) {
+			/* Only read only segments are kept intact */
+			reloaded = false;
+			if (delta && nlen > 0 && loader->segment_is_writable &&
+			    loader->segment_is_writable(limg_info) == 0) {
+				ret = remoteproc_reload_segment(rproc, store,
+								store_ops,
+								noffset, nlen,
+								da, pa, io,
+								&hashes,
+								&hashes_num);
+				if (ret)
+					goto error3;
+				reloaded = true;
+			}
+			if (nlen > 0 && !reloaded) {
 				ret = store_ops->load(store, noffset, nlen,
-						      &img_data, pa, io, 1);
+						      &img_data, pa, io,
+						      !nonblock);
+				pending |= nonblock;
 				if (ret != (int)nlen) {
 					metal_log(METAL_LOG_ERROR,
 						  "load data failed 0x%lx, 0x%lx, 0x%x\r\n",
@@ -610,6 +826,10 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 		}
 	}
 
+	ret = remoteproc_load_wait(store, store_ops, &pending);
+	if (ret)
+		goto error3;
+
 	if (rsc_size == 0) {
 		ret = loader->locate_rsc_table(limg_info, &rsc_da,
 					       &offset, &rsc_size);
@@ -657,7 +877,13 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 		  __func__);
 	/* get entry point from the firmware */
 	rproc->bootaddr = loader->get_entry(limg_info);
+	old_state = rproc->state;
 	rproc->state = RPROC_READY;
+	if (delta) {
+		remoteproc_drop_seg_hashes(rproc);
+		rproc->seg_hashes = hashes;
+		rproc->seg_hashes_num = hashes_num;
+	}
 
 	metal_mutex_release(&rproc->lock);
 	if (img_info)
@@ -665,19 +891,40 @@ int remoteproc_load(struct remoteproc *rproc, const char *path,
 	else
 		loader->release(limg_info);
 	store_ops->close(store);
+	remoteproc_state_changed(rproc, old_state, RPROC_READY);
 	return 0;
 
 error3:
+	(void)remoteproc_load_wait(store, store_ops, &pending);
 	if (rsc_table)
 		metal_free_memory(rsc_table);
 error2:
 	loader->release(limg_info);
 error1:
 	store_ops->close(store);
+	/* Target memory may be partly written, forget what it held */
+	metal_free_memory(hashes);
+	remoteproc_drop_seg_hashes(rproc);
 	metal_mutex_release(&rproc->lock);
 	return ret;
 }
 
+int remoteproc_load(struct remoteproc *rproc, const char *path,
+		    void *store, const struct image_store_ops *store_ops,
+		    void **img_info)
+{
+	return remoteproc_load_image(rproc, path, store, store_ops, img_info,
+				     false);
+}
+
+int remoteproc_reload(struct remoteproc *rproc, const char *path,
+		      void *store, const struct image_store_ops *store_ops,
+		      void **img_info)
+{
+	return remoteproc_load_image(rproc, path, store, store_ops, img_info,
+				     true);
+}
+
 int remoteproc_load_noblock(struct remoteproc *rproc,
 			    const void *img_data, size_t offset, size_t len,
 			    void **img_info,
@@ -713,6 +960,8 @@ int remoteproc_load_noblock(struct remoteproc *rproc,
 		metal_mutex_release(&rproc->lock);
 		return -RPROC_EINVAL;
 	}
+	/* The caller writes target memory, reload cannot track it */
+	remoteproc_drop_seg_hashes(rproc);
 
 	/* Check executable format to select a parser */
 	loader = rproc->loader;
@@ -901,10 +1150,48 @@ static int remoteproc_virtio_notify(void *priv, uint32_t id)
 	return 0;
 }
 
-struct virtio_device *
-remoteproc_create_virtio(struct remoteproc *rproc,
-			 int vdev_id, unsigned int role,
-			 void (*rst_cb)(struct virtio_device *vdev))
+static int remoteproc_virtio_init_vrings(struct remoteproc *rproc,
+					 struct virtio_device *vdev,
+					 struct fw_rsc_vdev *vdev_rsc)
+{
+	unsigned int num_vrings, i;
+
+	num_vrings = vdev_rsc->num_of_vrings;
+
+	/* set the notification id for vrings */
+	for (i = 0; i < num_vrings; i++) {
+		struct fw_rsc_vdev_vring *vring_rsc;
+		metal_phys_addr_t da;
+		unsigned int num_descs, align, notifyid;
+		struct metal_io_region *io;
+		void *va;
+		size_t size;
+		int ret;
+
+		vring_rsc = &vdev_rsc->vring[i];
+		notifyid = vring_rsc->notifyid;
+		da = vring_rsc->da;
+		num_descs = vring_rsc->num;
+		align = vring_rsc->align;
+		size = vring_size(num_descs, align);
+		va = remoteproc_mmap(rproc, NULL, &da, size, 0, &io);
+		if (!va)
+			return -RPROC_ENOMEM;
+		ret = rproc_virtio_init_vring(vdev, i, notifyid,
+					      va, io, num_descs, align);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+static struct virtio_device *
+remoteproc_create_vdev(struct remoteproc *rproc,
+		       int vdev_id, unsigned int role,
+		       void (*rst_cb)(struct virtio_device *vdev),
+		       void (*ready_cb)(struct remoteproc *rproc,
+					struct virtio_device *vdev,
+					int status))
 {
 	char *rsc_table;
 	struct fw_rsc_vdev *vdev_rsc;
@@ -913,8 +1200,8 @@ remoteproc_create_virtio(struct remoteproc *rproc,
 	struct remoteproc_virtio *rpvdev;
 	size_t vdev_rsc_offset;
 	unsigned int notifyid;
-	unsigned int num_vrings, i;
 	struct metal_list *node;
+	bool ready;
 
 #ifdef VIRTIO_DRIVER_ONLY
 	role = (role != VIRTIO_DEV_DRIVER) ? 0xFFFFFFFFUL : role;
@@ -931,7 +1218,11 @@ remoteproc_create_virtio(struct remoteproc *rproc,
 	metal_mutex_acquire(&rproc->lock);
 	rsc_table = rproc->rsc_table;
 	vdev_rsc_io = rproc->rsc_io;
-	vdev_rsc_offset = find_rsc(rsc_table, RSC_VDEV, vdev_id);
+	vdev_rsc_offset = rsc_table_cache_find(rproc->rsc_cache, rproc->rsc_len,
+					       RSC_VDEV, vdev_id);
+	if (!vdev_rsc_offset ||
+	    ((struct fw_rsc_hdr *)(rsc_table + vdev_rsc_offset))->type != RSC_VDEV)
+		vdev_rsc_offset = find_rsc(rsc_table, RSC_VDEV, vdev_id);
 	if (!vdev_rsc_offset) {
 		metal_mutex_release(&rproc->lock);
 		return NULL;
@@ -956,37 +1247,27 @@ remoteproc_create_virtio(struct remoteproc *rproc,
 		return NULL;
 	}
 
-	rproc_virtio_wait_remote_ready(vdev);
+	if (!ready_cb)
+		rproc_virtio_wait_remote_ready(vdev);
 
 	rpvdev = metal_container_of(vdev, struct remoteproc_virtio, vdev);
 	metal_list_add_tail(&rproc->vdevs, &rpvdev->node);
-	num_vrings = vdev_rsc->num_of_vrings;
-
-	/* set the notification id for vrings */
-	for (i = 0; i < num_vrings; i++) {
-		struct fw_rsc_vdev_vring *vring_rsc;
-		metal_phys_addr_t da;
-		unsigned int num_descs, align;
-		struct metal_io_region *io;
-		void *va;
-		size_t size;
-		int ret;
 
-		vring_rsc = &vdev_rsc->vring[i];
-		notifyid = vring_rsc->notifyid;
-		da = vring_rsc->da;
-		num_descs = vring_rsc->num;
-		align = vring_rsc->align;
-		size = vring_size(num_descs, align);
-		va = remoteproc_mmap(rproc, NULL, &da, size, 0, &io);
-		if (!va)
-			goto err1;
-		ret = rproc_virtio_init_vring(vdev, i, notifyid,
-					      va, io, num_descs, align);
-		if (ret)
+	/*
+	 * The remote fills in the vrings before it sets DRIVER_OK, if it is
+	 * not there yet remoteproc_get_notification() completes the setup.
+	 */
+	ready = !ready_cb || rproc_virtio_remote_ready(vdev);
+	if (ready) {
+		if (remoteproc_virtio_init_vrings(rproc, vdev, vdev_rsc))
 			goto err1;
+	} else {
+		rpvdev->ready_cb = ready_cb;
+		atomic_fetch_add(&rproc->vdevs_pending, 1);
 	}
 	metal_mutex_release(&rproc->lock);
+	if (ready && ready_cb)
+		ready_cb(rproc, vdev, 0);
 	return vdev;
 
 err1:
@@ -995,21 +1276,77 @@ err1:
 	return NULL;
 }
 
+struct virtio_device *
+remoteproc_create_virtio(struct remoteproc *rproc,
+			 int vdev_id, unsigned int role,
+			 void (*rst_cb)(struct virtio_device *vdev))
+{
+	return remoteproc_create_vdev(rproc, vdev_id, role, rst_cb, NULL);
+}
+
+struct virtio_device *
+remoteproc_create_virtio_async(struct remoteproc *rproc,
+			       int vdev_id, unsigned int role,
+			       void (*rst_cb)(struct virtio_device *vdev),
+			       void (*ready_cb)(struct remoteproc *rproc,
+						struct virtio_device *vdev,
+						int status))
+{
+	if (!ready_cb)
+		return NULL;
+	return remoteproc_create_vdev(rproc, vdev_id, role, rst_cb, ready_cb);
+}
+
 void remoteproc_remove_virtio(struct remoteproc *rproc,
 			      struct virtio_device *vdev)
 {
 	struct remoteproc_virtio *rpvdev;
 
-	(void)rproc;
 	metal_assert(vdev);
 
 	if (vdev) {
 		rpvdev = metal_container_of(vdev, struct remoteproc_virtio, vdev);
+		if (rpvdev->ready_cb)
+			atomic_fetch_sub(&rproc->vdevs_pending, 1);
 		metal_list_del(&rpvdev->node);
 		rproc_virtio_remove_vdev(&rpvdev->vdev);
 	}
 }
 
+/* Complete the setup of a virtio device created by remoteproc_create_virtio_async() */
+static bool remoteproc_virtio_check_ready(struct remoteproc *rproc,
+					  uint32_t notifyid)
+{
+	void (*ready_cb)(struct remoteproc *rproc, struct virtio_device *vdev,
+			 int status) = NULL;
+	struct remoteproc_virtio *rpvdev;
+	struct metal_list *node;
+	int ret = 0;
+
+	metal_mutex_acquire(&rproc->lock);
+	metal_list_for_each(&rproc->vdevs, node) {
+		rpvdev = metal_container_of(node, struct remoteproc_virtio,
+					    node);
+		if (!rpvdev->ready_cb ||
+		    (notifyid != rpvdev->vdev.notifyid &&
+		     notifyid != RSC_NOTIFY_ID_ANY) ||
+		    !rproc_virtio_remote_ready(&rpvdev->vdev))
+			continue;
+		ready_cb = rpvdev->ready_cb;
+		rpvdev->ready_cb = NULL;
+		atomic_fetch_sub(&rproc->vdevs_pending, 1);
+		ret = remoteproc_virtio_init_vrings(rproc, &rpvdev->vdev,
+						    rpvdev->vdev_rsc);
+		break;
+	}
+	metal_mutex_release(&rproc->lock);
+	/* The callback may remove the device, so call it out of the walk */
+	if (!ready_cb)
+		return false;
+	ready_cb(rproc, &rpvdev->vdev, ret);
+	return true;
+}
+
 int remoteproc_get_notification(struct remoteproc *rproc, uint32_t notifyid)
 {
 	struct remoteproc_virtio *rpvdev;
@@ -1019,6 +1356,11 @@ int remoteproc_get_notification(struct remoteproc *rproc, uint32_t notifyid)
 	if (!rproc)
 		return 0;
 
+	/* Keep the lock off the notification path once all devices are up */
+	while (atomic_load(&rproc->vdevs_pending) &&
+	       remoteproc_virtio_check_ready(rproc, notifyid))
+		;
+
 	metal_list_for_each(&rproc->vdevs, node) {
 		rpvdev = metal_container_of(node, struct remoteproc_virtio,
 					    node);
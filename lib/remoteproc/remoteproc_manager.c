@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/time.h>
+#include <metal/utilities.h>
+#include <openamp/remoteproc_manager.h>
+#include <string.h>
+
+static void remoteproc_mgr_state_cb(struct remoteproc *rproc,
+				    unsigned int state)
+{
+	struct remoteproc_mgr_entry *entry = remoteproc_mgr_entry(rproc);
+	struct remoteproc_mgr *mgr = entry->mgr;
+
+	if (state == RPROC_ERROR)
+		entry->errors++;
+	if (state != RPROC_RUNNING)
+		entry->ready = false;
+	if (mgr->state_cb)
+		mgr->state_cb(entry, state);
+}
+
+static void remoteproc_mgr_ready_cb(struct remoteproc *rproc,
+				    struct virtio_device *vdev, int status)
+{
+	struct remoteproc_mgr_entry *entry = remoteproc_mgr_entry(rproc);
+	struct remoteproc_mgr *mgr = entry->mgr;
+
+	if (status) {
+		entry->errors++;
+	} else if (!entry->ready) {
+		entry->ready = true;
+		entry->boot_time = metal_get_timestamp() - entry->start_time;
+	}
+	if (mgr->ready_cb)
+		mgr->ready_cb(entry, vdev, status);
+}
+
+void remoteproc_mgr_init(struct remoteproc_mgr *mgr,
+			 void (*state_cb)(struct remoteproc_mgr_entry *entry,
+					  unsigned int state),
+			 void (*ready_cb)(struct remoteproc_mgr_entry *entry,
+					  struct virtio_device *vdev,
+					  int status))
+{
+	metal_list_init(&mgr->entries);
+	atomic_init(&mgr->pending, 0);
+	mgr->state_cb = state_cb;
+	mgr->ready_cb = ready_cb;
+}
+
+struct remoteproc *remoteproc_mgr_add(struct remoteproc_mgr *mgr,
+				      struct remoteproc_mgr_entry *entry,
+				      const struct remoteproc_ops *ops,
+				      void *priv)
+{
+	struct remoteproc *rproc;
+
+	if (!mgr || !entry)
+		return NULL;
+
+	memset(entry, 0, sizeof(*entry));
+	rproc = remoteproc_init(&entry->rproc, ops, priv);
+	if (!rproc)
+		return NULL;
+	entry->mgr = mgr;
+	atomic_init(&entry->pending, 0);
+	remoteproc_set_state_cb(rproc, remoteproc_mgr_state_cb);
+	metal_list_add_tail(&mgr->entries, &entry->node);
+	return rproc;
+}
+
+int remoteproc_mgr_remove(struct remoteproc_mgr_entry *entry)
+{
+	int ret;
+
+	if (!entry || !entry->mgr)
+		return -RPROC_EINVAL;
+
+	ret = remoteproc_remove(&entry->rproc);
+	if (ret)
+		return ret;
+	if (atomic_exchange(&entry->pending, 0))
+		atomic_fetch_sub(&entry->mgr->pending, 1);
+	metal_list_del(&entry->node);
+	entry->mgr = NULL;
+	return 0;
+}
+
+int remoteproc_mgr_start(struct remoteproc_mgr *mgr)
+{
+	struct remoteproc_mgr_entry *entry;
+	struct metal_list *node;
+	int ret, started = 0, err = 0;
+
+	if (!mgr)
+		return -RPROC_EINVAL;
+
+	metal_list_for_each(&mgr->entries, node) {
+		entry = metal_container_of(node, struct remoteproc_mgr_entry,
+					   node);
+		if (entry->rproc.state != RPROC_READY)
+			continue;
+		entry->ready = false;
+		entry->start_time = metal_get_timestamp();
+		ret = remoteproc_start(&entry->rproc);
+		if (ret) {
+			entry->errors++;
+			err = ret;
+		} else {
+			started++;
+		}
+	}
+
+	return err ? err : started;
+}
+
+struct virtio_device *
+remoteproc_mgr_create_virtio(struct remoteproc_mgr_entry *entry,
+			     int vdev_id, unsigned int role,
+			     void (*rst_cb)(struct virtio_device *vdev))
+{
+	if (!entry)
+		return NULL;
+
+	return remoteproc_create_virtio_async(&entry->rproc, vdev_id, role,
+					      rst_cb,
+					      remoteproc_mgr_ready_cb);
+}
+
+void remoteproc_mgr_notify(struct remoteproc_mgr_entry *entry)
+{
+	/* Count each entry once however many interrupts it got */
+	if (!atomic_exchange(&entry->pending, 1))
+		atomic_fetch_add(&entry->mgr->pending, 1);
+}
+
+int remoteproc_mgr_poll(struct remoteproc_mgr *mgr)
+{
+	struct remoteproc_mgr_entry *entry;
+	struct metal_list *node, *tmp;
+	int dispatched = 0;
+
+	if (!mgr || !atomic_load(&mgr->pending))
+		return 0;
+
+	/* A ready or state callback may remove the entry it is called for */
+	metal_list_for_each_safe(&mgr->entries, tmp, node) {
+		entry = metal_container_of(node, struct remoteproc_mgr_entry,
+					   node);
+		if (!atomic_exchange(&entry->pending, 0))
+			continue;
+		atomic_fetch_sub(&mgr->pending, 1);
+		entry->notifications++;
+		if (remoteproc_get_notification(&entry->rproc,
+						RSC_NOTIFY_ID_ANY))
+			entry->errors++;
+		dispatched++;
+	}
+
+	return dispatched;
+}
+
+void remoteproc_mgr_get_stats(struct remoteproc_mgr *mgr,
+			      struct remoteproc_mgr_stats *stats)
+{
+	struct remoteproc_mgr_entry *entry;
+	struct metal_list *node;
+
+	memset(stats, 0, sizeof(*stats));
+	metal_list_for_each(&mgr->entries, node) {
+		entry = metal_container_of(node, struct remoteproc_mgr_entry,
+					   node);
+		stats->num++;
+		if (entry->rproc.state < RPROC_LAST)
+			stats->states[entry->rproc.state]++;
+		if (entry->ready) {
+			stats->ready++;
+			if (entry->boot_time > stats->max_boot_time)
+				stats->max_boot_time = entry->boot_time;
+		}
+		stats->notifications += entry->notifications;
+		stats->rx_msgs += entry->rx_msgs;
+		stats->rx_bytes += entry->rx_bytes;
+		stats->tx_msgs += entry->tx_msgs;
+		stats->tx_bytes += entry->tx_bytes;
+		stats->errors += entry->errors;
+	}
+	stats->time = metal_get_timestamp();
+}
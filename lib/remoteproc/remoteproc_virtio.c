@@ -28,6 +28,7 @@ static void rproc_virtio_delete_virtqueues(struct virtio_device *vdev)
 		vring_info = &vdev->vrings_info[i];
 		if (vring_info->vq)
 			virtqueue_free(vring_info->vq);
+		vring_info->vq = NULL;
 	}
 }
 
@@ -234,7 +235,6 @@ static void rproc_virtio_read_config(struct virtio_device *vdev,
 	}
 }
 
-#ifndef VIRTIO_DEVICE_ONLY
 static void rproc_virtio_write_config(struct virtio_device *vdev,
 				      uint32_t offset, void *src, int length)
 {
@@ -257,6 +257,7 @@ static void rproc_virtio_write_config(struct virtio_device *vdev,
 	}
 }
 
+#ifndef VIRTIO_DEVICE_ONLY
 static void rproc_virtio_reset_device(struct virtio_device *vdev)
 {
 	if (vdev->role == VIRTIO_DEV_DRIVER)
@@ -272,6 +273,8 @@ static const struct virtio_dispatch remoteproc_virtio_dispatch_funcs = {
 	.get_features = rproc_virtio_get_features,
 	.read_config = rproc_virtio_read_config,
 	.notify = rproc_virtio_virtqueue_notify,
+	/* The configuration space is written by the device, e.g. rpmsg resize */
+	.write_config = rproc_virtio_write_config,
 #ifndef VIRTIO_DEVICE_ONLY
 	/*
 	 * We suppose here that the vdev is in a shared memory so that can
@@ -281,7 +284,6 @@ static const struct virtio_dispatch remoteproc_virtio_dispatch_funcs = {
 	.set_status = rproc_virtio_set_status,
 	.set_features = rproc_virtio_set_features,
 	.negotiate_features = rproc_virtio_negotiate_features,
-	.write_config = rproc_virtio_write_config,
 	.reset_device = rproc_virtio_reset_device,
 #endif
 };
@@ -391,16 +393,16 @@ int rproc_virtio_notified(struct virtio_device *vdev, uint32_t notifyid)
 		if (vring_info->notifyid == notifyid ||
 		    notifyid == RSC_NOTIFY_ID_ANY) {
 			vq = vring_info->vq;
-			virtqueue_notification(vq);
+			/* No virtqueue yet, e.g. the remote is not ready */
+			if (vq)
+				virtqueue_notification(vq);
 		}
 	}
 	return 0;
 }
 
-void rproc_virtio_wait_remote_ready(struct virtio_device *vdev)
+int rproc_virtio_remote_ready(struct virtio_device *vdev)
 {
-	uint8_t status;
-
 #ifndef VIRTIO_DEVICE_ONLY
 	/*
 	 * No status available for remote. As virtio driver has not to wait
@@ -408,12 +410,14 @@ void rproc_virtio_wait_remote_ready(struct virtio_device *vdev)
 	 * in future if a remote status is added.
 	 */
 	if (vdev->role == VIRTIO_DEV_DRIVER)
-		return;
+		return 1;
 #endif
-	while (1) {
-		status = rproc_virtio_get_status(vdev);
-		if (status & VIRTIO_CONFIG_STATUS_DRIVER_OK)
-			return;
+	return (rproc_virtio_get_status(vdev) &
+		VIRTIO_CONFIG_STATUS_DRIVER_OK) != 0;
+}
+
+void rproc_virtio_wait_remote_ready(struct virtio_device *vdev)
+{
+	while (!rproc_virtio_remote_ready(vdev))
 		metal_cpu_yield();
-	}
 }
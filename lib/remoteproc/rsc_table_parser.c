@@ -6,10 +6,14 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <metal/alloc.h>
 #include <metal/io.h>
 #include <metal/utilities.h>
 #include <openamp/rsc_table_parser.h>
 
+#define RSC_CACHE_FNV_OFFSET	0xcbf29ce484222325ULL
+#define RSC_CACHE_FNV_PRIME	0x100000001b3ULL
+
 static int handle_dummy_rsc(struct remoteproc *rproc, void *rsc);
 
 /* Resources handler */
@@ -20,15 +24,146 @@ static const rsc_handler rsc_handler_table[] = {
 	handle_vdev_rsc, /**< virtio resource */
 };
 
+/*
+ * FNV-1a hash of the resource table, taken a word at a time as the table
+ * is made of 32 bits fields
+ */
+static uint64_t rsc_table_hash(const void *rsc_table, size_t size)
+{
+	const uint32_t *words = rsc_table;
+	const unsigned char *data = rsc_table;
+	uint64_t h = RSC_CACHE_FNV_OFFSET;
+	size_t i;
+
+	for (i = 0; i < size / sizeof(*words); i++)
+		h = (h ^ words[i]) * RSC_CACHE_FNV_PRIME;
+	for (i *= sizeof(*words); i < size; i++)
+		h = (h ^ data[i]) * RSC_CACHE_FNV_PRIME;
+	return h;
+}
+
+static bool rsc_is_vendor(uint32_t rsc_type)
+{
+	return rsc_type >= RSC_VENDOR_START && rsc_type <= RSC_VENDOR_END;
+}
+
+/* Record the resources and notify IDs of a successfully parsed table */
+static void rsc_table_cache_build(struct remoteproc *rproc,
+				  struct resource_table *rsc_table,
+				  uint64_t hash, size_t size,
+				  unsigned long bitmap)
+{
+	struct rsc_table_cache *cache;
+	struct fw_rsc_hdr *hdr;
+	struct fw_rsc_vdev *vdev_rsc;
+	unsigned int idx, i, num = 0, num_ids = 0;
+
+	metal_free_memory(rproc->rsc_cache);
+	rproc->rsc_cache = NULL;
+
+	/* Trace and dummy resources have nothing to replay */
+	for (idx = 0; idx < rsc_table->num; idx++) {
+		hdr = (void *)((char *)rsc_table + rsc_table->offset[idx]);
+		if (hdr->type == RSC_VDEV) {
+			vdev_rsc = (struct fw_rsc_vdev *)hdr;
+			num_ids += 1 + vdev_rsc->num_of_vrings;
+		} else if (hdr->type != RSC_CARVEOUT &&
+			   !rsc_is_vendor(hdr->type)) {
+			continue;
+		}
+		num++;
+	}
+
+	cache = metal_allocate_memory(sizeof(*cache) +
+				      num * sizeof(cache->entries[0]) +
+				      num_ids * sizeof(cache->ids[0]));
+	if (!cache)
+		return;
+	cache->hash = hash;
+	cache->size = size;
+	cache->bitmap = bitmap;
+	cache->num = 0;
+	cache->num_ids = 0;
+	cache->entries = (struct rsc_cache_entry *)(cache + 1);
+	cache->ids = (uint32_t *)(cache->entries + num);
+
+	for (idx = 0; idx < rsc_table->num; idx++) {
+		hdr = (void *)((char *)rsc_table + rsc_table->offset[idx]);
+		if (hdr->type == RSC_VDEV) {
+			vdev_rsc = (struct fw_rsc_vdev *)hdr;
+			cache->ids[cache->num_ids++] = vdev_rsc->notifyid;
+			for (i = 0; i < vdev_rsc->num_of_vrings; i++)
+				cache->ids[cache->num_ids++] =
+					vdev_rsc->vring[i].notifyid;
+		} else if (hdr->type != RSC_CARVEOUT &&
+			   !rsc_is_vendor(hdr->type)) {
+			continue;
+		}
+		cache->entries[cache->num].type = hdr->type;
+		cache->entries[cache->num].offset = rsc_table->offset[idx];
+		cache->num++;
+	}
+	rproc->rsc_cache = cache;
+}
+
+/* Redo the side effects of the recorded parse on the same table */
+static int rsc_table_cache_replay(struct remoteproc *rproc,
+				  struct resource_table *rsc_table)
+{
+	struct rsc_table_cache *cache = rproc->rsc_cache;
+	struct rsc_cache_entry *entry;
+	struct fw_rsc_vdev *vdev_rsc;
+	unsigned int idx, i, id = 0;
+	int status = 0;
+
+	rproc->bitmap |= cache->bitmap;
+	for (idx = 0; idx < cache->num; idx++) {
+		entry = &cache->entries[idx];
+		if (entry->type == RSC_VDEV) {
+			vdev_rsc = (void *)((char *)rsc_table + entry->offset);
+			vdev_rsc->notifyid = cache->ids[id++];
+			for (i = 0; i < vdev_rsc->num_of_vrings; i++)
+				vdev_rsc->vring[i].notifyid = cache->ids[id++];
+			continue;
+		}
+		if (entry->type == RSC_CARVEOUT)
+			status = handle_carve_out_rsc(rproc, (char *)rsc_table +
+						      entry->offset);
+		else
+			status = handle_vendor_rsc(rproc, (char *)rsc_table +
+						   entry->offset);
+		if (status == -RPROC_ERR_RSC_TAB_NS)
+			status = 0;
+		else if (status)
+			break;
+	}
+
+	return status;
+}
+
 int handle_rsc_table(struct remoteproc *rproc,
 		     struct resource_table *rsc_table, size_t size,
 		     struct metal_io_region *io)
 {
+	struct rsc_table_cache *cache = rproc ? rproc->rsc_cache : NULL;
 	struct fw_rsc_hdr *hdr;
 	uint32_t rsc_type;
 	unsigned int idx, offset;
+	unsigned long bitmap;
+	uint64_t hash = 0;
 	int status = 0;
 
+	/* Replay the last parse if the table is unchanged */
+	if (rproc)
+		hash = rsc_table_hash(rsc_table, size);
+	if (cache && cache->hash == hash && cache->size == size &&
+	    !(rproc->bitmap & cache->bitmap) &&
+	    (!io || (metal_io_virt_to_offset(io, rsc_table) !=
+		     METAL_BAD_OFFSET &&
+		     metal_io_virt_to_offset(io, (char *)rsc_table + size - 1) !=
+		     METAL_BAD_OFFSET)))
+		return rsc_table_cache_replay(rproc, rsc_table);
+
 	/* Validate rsc table header fields */
 
 	/* Minimum rsc table size */
@@ -55,6 +190,7 @@ int handle_rsc_table(struct remoteproc *rproc,
 	}
 
 	/* Loop through the offset array and parse each resource entry */
+	bitmap = rproc ? rproc->bitmap : 0;
 	for (idx = 0; idx < rsc_table->num; idx++) {
 		hdr = (void *)((char *)rsc_table + rsc_table->offset[idx]);
 		if (io && metal_io_virt_to_offset(io, hdr) == METAL_BAD_OFFSET)
@@ -62,8 +198,7 @@ int handle_rsc_table(struct remoteproc *rproc,
 		rsc_type = hdr->type;
 		if (rsc_type < RSC_LAST)
 			status = rsc_handler_table[rsc_type](rproc, hdr);
-		else if (rsc_type >= RSC_VENDOR_START &&
-			 rsc_type <= RSC_VENDOR_END)
+		else if (rsc_is_vendor(rsc_type))
 			status = handle_vendor_rsc(rproc, hdr);
 		if (status == -RPROC_ERR_RSC_TAB_NS) {
 			status = 0;
@@ -73,6 +208,9 @@ int handle_rsc_table(struct remoteproc *rproc,
 		}
 	}
 
+	if (!status && rproc)
+		rsc_table_cache_build(rproc, rsc_table, hash, size,
+				      rproc->bitmap & ~bitmap);
 	return status;
 }
 
@@ -210,3 +348,18 @@ size_t find_rsc(void *rsc_table, unsigned int rsc_type, unsigned int index)
 	}
 	return 0;
 }
+
+size_t rsc_table_cache_find(const struct rsc_table_cache *cache, size_t size,
+			    unsigned int rsc_type, unsigned int index)
+{
+	unsigned int i, rsc_index = 0;
+
+	if (!cache || cache->size != size)
+		return 0;
+	for (i = 0; i < cache->num; i++) {
+		if (cache->entries[i].type == rsc_type &&
+		    rsc_index++ == index)
+			return cache->entries[i].offset;
+	}
+	return 0;
+}
@@ -268,6 +268,60 @@ static void *rpmsg_virtio_get_rx_buffer(struct rpmsg_virtio_device *rvdev,
 	return data;
 }
 
+/**
+ * @internal
+ *
+ * @brief Check whether the shared buffer I/O region can be accessed directly.
+ *
+ * Plain stores, and the possibly vectorized or unaligned accesses of
+ * memcpy(), are only safe on normal memory coherent with the peer, which
+ * cannot be told from the I/O region. Device or non-cacheable memory may
+ * fault on such accesses, so the platform has to opt in with
+ * RPMSG_VIRTIO_SHBUF_DIRECT (WITH_SHBUF_DIRECT). A region with its own
+ * block_write or block_read ops still goes through them. The buffer
+ * contents are then ordered before the vring index update by the virtqueue.
+ *
+ * @param io	Pointer to the shared buffer I/O region
+ *
+ * @return true if buffers can be written with plain stores
+ */
+static bool rpmsg_virtio_shbuf_io_is_direct(struct metal_io_region *io)
+{
+#ifdef RPMSG_VIRTIO_SHBUF_DIRECT
+	return io->virt != METAL_BAD_VA && !io->ops.block_write &&
+	       !io->ops.block_read;
+#else
+	(void)io;
+	return false;
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Copy data into a shared buffer.
+ *
+ * @param rvdev	Pointer to rpmsg virtio device
+ * @param dst	Destination address in the shared buffer region
+ * @param src	Source data
+ * @param len	Length of the data to copy
+ *
+ * @return Number of bytes written or negative value for failure.
+ */
+static int rpmsg_virtio_shbuf_write(struct rpmsg_virtio_device *rvdev,
+				    void *dst, const void *src, int len)
+{
+	struct metal_io_region *io = rvdev->shbuf_io;
+
+	if (rvdev->shbuf_io_direct) {
+		memcpy(dst, src, len);
+		return len;
+	}
+
+	return metal_io_block_write(io, metal_io_virt_to_offset(io, dst),
+				    src, len);
+}
+
 #ifndef VIRTIO_DRIVER_ONLY
 /*
  * check if the remote is ready to start RPMsg communication
@@ -432,7 +486,6 @@ static int rpmsg_virtio_send_offchannel_nocopy(struct rpmsg_device *rdev,
 					       const void *data, int len)
 {
 	struct rpmsg_virtio_device *rvdev;
-	struct metal_io_region *io;
 	struct rpmsg_hdr rp_hdr;
 	struct rpmsg_hdr *hdr;
 	uint32_t buff_len;
@@ -446,18 +499,27 @@ static int rpmsg_virtio_send_offchannel_nocopy(struct rpmsg_device *rdev,
 	/* The reserved field contains buffer index */
 	idx = hdr->reserved;
 
-	/* Initialize RPMSG header. */
-	rp_hdr.dst = dst;
-	rp_hdr.src = src;
-	rp_hdr.len = len;
-	rp_hdr.reserved = 0;
-	rp_hdr.flags = 0;
-
-	/* Copy data to rpmsg buffer. */
-	io = rvdev->shbuf_io;
-	status = metal_io_block_write(io, metal_io_virt_to_offset(io, hdr),
-				      &rp_hdr, sizeof(rp_hdr));
-	RPMSG_ASSERT(status == sizeof(rp_hdr), "failed to write header\r\n");
+	if (rvdev->shbuf_io_direct) {
+		/* Initialize RPMSG header in place. */
+		hdr->dst = dst;
+		hdr->src = src;
+		hdr->len = len;
+		hdr->reserved = 0;
+		hdr->flags = 0;
+	} else {
+		/* Initialize RPMSG header. */
+		rp_hdr.dst = dst;
+		rp_hdr.src = src;
+		rp_hdr.len = len;
+		rp_hdr.reserved = 0;
+		rp_hdr.flags = 0;
+
+		/* Copy data to rpmsg buffer. */
+		status = rpmsg_virtio_shbuf_write(rvdev, hdr, &rp_hdr,
+						  sizeof(rp_hdr));
+		RPMSG_ASSERT(status == sizeof(rp_hdr),
+			     "failed to write header\r\n");
+	}
 
 	metal_mutex_acquire(&rdev->lock);
 
@@ -526,7 +588,6 @@ static int rpmsg_virtio_send_offchannel_raw(struct rpmsg_device *rdev,
 					    int len, int wait)
 {
 	struct rpmsg_virtio_device *rvdev;
-	struct metal_io_region *io;
 	uint32_t buff_len;
 	void *buffer;
 	int status;
@@ -542,9 +603,7 @@ static int rpmsg_virtio_send_offchannel_raw(struct rpmsg_device *rdev,
 	/* Copy data to rpmsg buffer. */
 	if (len > (int)buff_len)
 		len = buff_len;
-	io = rvdev->shbuf_io;
-	status = metal_io_block_write(io, metal_io_virt_to_offset(io, buffer),
-				      data, len);
+	status = rpmsg_virtio_shbuf_write(rvdev, buffer, data, len);
 	RPMSG_ASSERT(status == len, "failed to write buffer\r\n");
 
 	return rpmsg_virtio_send_offchannel_nocopy(rdev, src, dst, buffer, len);
@@ -794,84 +853,33 @@ int rpmsg_virtio_get_rx_buffer_size(struct rpmsg_device *rdev)
 	return size;
 }
 
-int rpmsg_init_vdev(struct rpmsg_virtio_device *rvdev,
-		    struct virtio_device *vdev,
-		    rpmsg_ns_bind_cb ns_bind_cb,
-		    struct metal_io_region *shm_io,
-		    struct rpmsg_virtio_shm_pool *shpool)
-{
-	return rpmsg_init_vdev_with_config(rvdev, vdev, ns_bind_cb, shm_io,
-			   shpool, RPMSG_VIRTIO_DEFAULT_CONFIG);
-}
-
-int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
-				struct virtio_device *vdev,
-				rpmsg_ns_bind_cb ns_bind_cb,
-				struct metal_io_region *shm_io,
-				struct rpmsg_virtio_shm_pool *shpool,
-				const struct rpmsg_virtio_config *config)
+/**
+ * @internal
+ *
+ * @brief Create the virtqueues of the rpmsg virtio device
+ *
+ * Host side, the receive virtqueue is also filled with buffers of the
+ * shared memory pool.
+ *
+ * @param rvdev		Pointer to the rpmsg virtio device
+ * @param shpool	Pointer to the shared memory pool of the receive buffers
+ *
+ * @return Status of function execution
+ */
+static int rpmsg_virtio_setup_vqs(struct rpmsg_virtio_device *rvdev,
+				  struct rpmsg_virtio_shm_pool *shpool)
 {
-	struct rpmsg_device *rdev;
+	struct virtio_device *vdev = rvdev->vdev;
+	struct metal_io_region *shm_io = rvdev->shbuf_io;
 	const char *vq_names[RPMSG_NUM_VRINGS];
 	vq_callback callback[RPMSG_NUM_VRINGS];
-	int status;
 	unsigned int i, role;
+	int status;
 
-	if (!rvdev || !vdev || !shm_io)
-		return RPMSG_ERR_PARAM;
-
-	rdev = &rvdev->rdev;
-	memset(rdev, 0, sizeof(*rdev));
-	metal_mutex_init(&rdev->lock);
-	rvdev->vdev = vdev;
-	rdev->ns_bind_cb = ns_bind_cb;
-	vdev->priv = rvdev;
-	rdev->ops.send_offchannel_raw = rpmsg_virtio_send_offchannel_raw;
-	rdev->ops.hold_rx_buffer = rpmsg_virtio_hold_rx_buffer;
-	rdev->ops.release_rx_buffer = rpmsg_virtio_release_rx_buffer;
-	rdev->ops.get_tx_payload_buffer = rpmsg_virtio_get_tx_payload_buffer;
-	rdev->ops.send_offchannel_nocopy = rpmsg_virtio_send_offchannel_nocopy;
-	rdev->ops.release_tx_buffer = rpmsg_virtio_release_tx_buffer;
 	role = rpmsg_virtio_get_role(rvdev);
 
 #ifndef VIRTIO_DEVICE_ONLY
 	if (role == RPMSG_HOST) {
-		/*
-		 * The virtio configuration contains only options applicable to
-		 * a virtio driver, implying rpmsg host role.
-		 */
-		if (config == NULL) {
-			return RPMSG_ERR_PARAM;
-		}
-		rvdev->config = *config;
-	}
-#else /*!VIRTIO_DEVICE_ONLY*/
-	/* Ignore passed config in the virtio-device-only configuration. */
-	(void)config;
-#endif /*!VIRTIO_DEVICE_ONLY*/
-
-
-#ifndef VIRTIO_DRIVER_ONLY
-	if (role == RPMSG_REMOTE) {
-		/* wait synchro with the host */
-		rpmsg_virtio_wait_remote_ready(rvdev);
-	}
-#endif /*!VIRTIO_DRIVER_ONLY*/
-	vdev->features = rpmsg_virtio_get_features(rvdev);
-	rdev->support_ns = !!(vdev->features & (1 << VIRTIO_RPMSG_F_NS));
-
-#ifndef VIRTIO_DEVICE_ONLY
-	if (role == RPMSG_HOST) {
-		/*
-		 * Since device is RPMSG Remote so we need to manage the
-		 * shared buffers. Create shared memory pool to handle buffers.
-		 */
-		rvdev->shpool = config->split_shpool ? shpool + 1 : shpool;
-		if (!shpool)
-			return RPMSG_ERR_PARAM;
-		if (!shpool->size || !rvdev->shpool->size)
-			return RPMSG_ERR_NO_BUFF;
-
 		vq_names[0] = "rx_vq";
 		vq_names[1] = "tx_vq";
 		callback[0] = rpmsg_virtio_rx_callback;
@@ -888,8 +896,6 @@ int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
 		callback[1] = rpmsg_virtio_rx_callback;
 	}
 #endif /*!VIRTIO_DRIVER_ONLY*/
-	rvdev->shbuf_io = shm_io;
-	metal_list_init(&rvdev->reclaimer);
 
 	/* Create virtqueues for remote device */
 	status = rpmsg_virtio_create_virtqueues(rvdev, 0, RPMSG_NUM_VRINGS,
@@ -960,6 +966,108 @@ int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
 	}
 #endif /*!VIRTIO_DEVICE_ONLY*/
 
+	return RPMSG_SUCCESS;
+
+#ifndef VIRTIO_DEVICE_ONLY
+err:
+	rpmsg_virtio_delete_virtqueues(rvdev);
+	rvdev->rvq = NULL;
+	rvdev->svq = NULL;
+	return status;
+#endif /*!VIRTIO_DEVICE_ONLY*/
+}
+
+int rpmsg_init_vdev(struct rpmsg_virtio_device *rvdev,
+		    struct virtio_device *vdev,
+		    rpmsg_ns_bind_cb ns_bind_cb,
+		    struct metal_io_region *shm_io,
+		    struct rpmsg_virtio_shm_pool *shpool)
+{
+	return rpmsg_init_vdev_with_config(rvdev, vdev, ns_bind_cb, shm_io,
+			   shpool, RPMSG_VIRTIO_DEFAULT_CONFIG);
+}
+
+int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
+				struct virtio_device *vdev,
+				rpmsg_ns_bind_cb ns_bind_cb,
+				struct metal_io_region *shm_io,
+				struct rpmsg_virtio_shm_pool *shpool,
+				const struct rpmsg_virtio_config *config)
+{
+	struct rpmsg_device *rdev;
+	int status;
+	unsigned int role;
+
+	if (!rvdev || !vdev || !shm_io)
+		return RPMSG_ERR_PARAM;
+
+	rdev = &rvdev->rdev;
+	memset(rdev, 0, sizeof(*rdev));
+	metal_mutex_init(&rdev->lock);
+	rvdev->vdev = vdev;
+	rdev->ns_bind_cb = ns_bind_cb;
+	vdev->priv = rvdev;
+	rdev->ops.send_offchannel_raw = rpmsg_virtio_send_offchannel_raw;
+	rdev->ops.hold_rx_buffer = rpmsg_virtio_hold_rx_buffer;
+	rdev->ops.release_rx_buffer = rpmsg_virtio_release_rx_buffer;
+	rdev->ops.get_tx_payload_buffer = rpmsg_virtio_get_tx_payload_buffer;
+	rdev->ops.send_offchannel_nocopy = rpmsg_virtio_send_offchannel_nocopy;
+	rdev->ops.release_tx_buffer = rpmsg_virtio_release_tx_buffer;
+	role = rpmsg_virtio_get_role(rvdev);
+
+#ifndef VIRTIO_DEVICE_ONLY
+	if (role == RPMSG_HOST) {
+		/*
+		 * The virtio configuration contains only options applicable to
+		 * a virtio driver, implying rpmsg host role.
+		 */
+		if (config == NULL) {
+			return RPMSG_ERR_PARAM;
+		}
+		rvdev->config = *config;
+	}
+#else /*!VIRTIO_DEVICE_ONLY*/
+	/* Ignore passed config in the virtio-device-only configuration. */
+	(void)config;
+#endif /*!VIRTIO_DEVICE_ONLY*/
+
+
+#ifndef VIRTIO_DRIVER_ONLY
+	if (role == RPMSG_REMOTE) {
+		/* wait synchro with the host */
+		rpmsg_virtio_wait_remote_ready(rvdev);
+	}
+#endif /*!VIRTIO_DRIVER_ONLY*/
+	vdev->features = rpmsg_virtio_get_features(rvdev);
+	rdev->support_ns = !!(vdev->features & (1 << VIRTIO_RPMSG_F_NS));
+
+#ifndef VIRTIO_DEVICE_ONLY
+	if (role == RPMSG_HOST) {
+		/*
+		 * Since device is RPMSG Remote so we need to manage the
+		 * shared buffers. Create shared memory pool to handle buffers.
+		 */
+		rvdev->shpool = config->split_shpool ? shpool + 1 : shpool;
+		if (!shpool)
+			return RPMSG_ERR_PARAM;
+		if (!shpool->size || !rvdev->shpool->size)
+			return RPMSG_ERR_NO_BUFF;
+	}
+#endif /*!VIRTIO_DEVICE_ONLY*/
+
+	rvdev->shbuf_io = shm_io;
+	rvdev->shbuf_io_direct = rpmsg_virtio_shbuf_io_is_direct(shm_io);
+	metal_list_init(&rvdev->reclaimer);
+	/* A resize cannot grow the vrings beyond the memory they have */
+	if (vdev->vrings_num >= RPMSG_NUM_VRINGS) {
+		rvdev->vring_num_max[0] = vdev->vrings_info[0].info.num_descs;
+		rvdev->vring_num_max[1] = vdev->vrings_info[1].info.num_descs;
+	}
+
+	status = rpmsg_virtio_setup_vqs(rvdev, shpool);
+	if (status != RPMSG_SUCCESS)
+		return status;
+
 	/* Initialize channels and endpoints list */
 	metal_list_init(&rdev->endpoints);
 
@@ -979,13 +1087,248 @@ int rpmsg_init_vdev_with_config(struct rpmsg_virtio_device *rvdev,
 #endif /*!VIRTIO_DEVICE_ONLY*/
 
 	return RPMSG_SUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * @brief Read the resize area of the configuration space
+ *
+ * @param rvdev	Pointer to the rpmsg virtio device
+ * @param rcfg	Pointer to the resize area to fill
+ *
+ * @return true if the device supports vring resizing
+ */
+static bool rpmsg_virtio_read_resize(struct rpmsg_virtio_device *rvdev,
+				     struct rpmsg_virtio_resize_config *rcfg)
+{
+	struct virtio_device *vdev = rvdev->vdev;
+
+	if (!(vdev->features & (1 << VIRTIO_RPMSG_F_RESIZE)) ||
+	    vdev->vrings_num < RPMSG_NUM_VRINGS)
+		return false;
+
+	/* Nothing is read if the configuration space is too small */
+	memset(rcfg, 0xff, sizeof(*rcfg));
+	rpmsg_virtio_read_config(rvdev, 0, rcfg, sizeof(*rcfg));
+	return rcfg->vring_num[0] != UINT32_MAX;
+}
+
+/**
+ * @internal
+ *
+ * @brief Check the number of descriptors of a vring
+ *
+ * @param num	Number of descriptors
+ * @param max	Number of descriptors the vring memory has room for
+ *
+ * @return true if the vring can be created with num descriptors
+ */
+static bool rpmsg_virtio_vring_num_valid(uint32_t num, uint32_t max)
+{
+	return num && num <= max && num <= 0x8000 && !(num & (num - 1));
+}
+
+/**
+ * @internal
+ *
+ * @brief Abort a vring resize
+ *
+ * @param rvdev	Pointer to the rpmsg virtio device
+ * @param req	Sequence number of the resize
+ */
+static void rpmsg_virtio_resize_abort(struct rpmsg_virtio_device *rvdev,
+				      uint32_t req)
+{
+	rpmsg_virtio_write_config(rvdev,
+				  offsetof(struct rpmsg_virtio_resize_config,
+					   abort),
+				  &req, sizeof(req));
+}
+
+/**
+ * @internal
+ *
+ * @brief Wait for the other side to go on with a vring resize
+ *
+ * The host waits for the remote to acknowledge the resize, the remote for
+ * the host to set the driver ready on the rebuilt vrings. The resize is
+ * aborted if the other side does not answer within RPMSG_TICK_COUNT.
+ *
+ * @param rvdev	Pointer to the rpmsg virtio device
+ * @param req	Sequence number of the resize
+ *
+ * @return RPMSG_SUCCESS, RPMSG_ERR_PARAM if the other side aborted the
+ * resize, RPMSG_ERR_DEV_STATE if it timed out.
+ */
+static int rpmsg_virtio_resize_wait(struct rpmsg_virtio_device *rvdev,
+				    uint32_t req)
+{
+	struct rpmsg_virtio_resize_config rcfg;
+	int tick_count = RPMSG_TICK_COUNT / RPMSG_TICKS_PER_INTERVAL;
+	bool done;
+
+	while (1) {
+		rpmsg_virtio_read_config(rvdev, 0, &rcfg, sizeof(rcfg));
+		if (rcfg.abort == req)
+			return RPMSG_ERR_PARAM;
+		if (rpmsg_virtio_get_role(rvdev) == RPMSG_HOST)
+			done = rcfg.ack == req;
+		else
+			done = rpmsg_virtio_get_status(rvdev) &
+			       VIRTIO_CONFIG_STATUS_DRIVER_OK;
+		if (done)
+			return RPMSG_SUCCESS;
+		if (!tick_count--) {
+			rpmsg_virtio_resize_abort(rvdev, req);
+			return RPMSG_ERR_DEV_STATE;
+		}
+		metal_sleep_usec(RPMSG_TICKS_PER_INTERVAL);
+	}
+}
 
 #ifndef VIRTIO_DEVICE_ONLY
-err:
+int rpmsg_virtio_resize(struct rpmsg_virtio_device *rvdev,
+			unsigned int rx_num, unsigned int tx_num,
+			struct rpmsg_virtio_shm_pool *shpool,
+			const struct rpmsg_virtio_config *config)
+{
+	struct rpmsg_virtio_resize_config rcfg;
+	struct rpmsg_virtio_shm_pool *txpool;
+	struct rpmsg_virtio_config cfg;
+	struct virtio_device *vdev;
+	struct rpmsg_device *rdev;
+	uint32_t req;
+	int status;
+
+	if (!rvdev || !rvdev->vdev || !shpool ||
+	    rpmsg_virtio_get_role(rvdev) != RPMSG_HOST)
+		return RPMSG_ERR_PARAM;
+	if (!rpmsg_virtio_vring_num_valid(rx_num, rvdev->vring_num_max[0]) ||
+	    !rpmsg_virtio_vring_num_valid(tx_num, rvdev->vring_num_max[1]))
+		return RPMSG_ERR_PARAM;
+	if (!rpmsg_virtio_read_resize(rvdev, &rcfg))
+		return RPMSG_ERR_PERM;
+
+	cfg = config ? *config : rvdev->config;
+	txpool = cfg.split_shpool ? shpool + 1 : shpool;
+	if (!shpool->size || !txpool->size ||
+	    shpool->size < (size_t)rx_num * cfg.r2h_buf_size)
+		return RPMSG_ERR_NO_BUFF;
+
+	rdev = &rvdev->rdev;
+	vdev = rvdev->vdev;
+	metal_mutex_acquire(&rdev->lock);
+
+	/*
+	 * Clear the driver ready first: once it has acknowledged, the remote
+	 * waits for it to be set again on the rebuilt vrings.
+	 */
+	rpmsg_virtio_set_status(rvdev, 0);
+	rcfg.vring_num[0] = rx_num;
+	rcfg.vring_num[1] = tx_num;
+	rpmsg_virtio_write_config(rvdev,
+				  offsetof(struct rpmsg_virtio_resize_config,
+					   vring_num),
+				  rcfg.vring_num, sizeof(rcfg.vring_num));
+	req = rcfg.req + 1;
+	rpmsg_virtio_write_config(rvdev,
+				  offsetof(struct rpmsg_virtio_resize_config,
+					   req),
+				  &req, sizeof(req));
+
+	/* Wait for the remote to stop using the vrings */
+	status = rpmsg_virtio_resize_wait(rvdev, req);
+	if (status == RPMSG_ERR_PARAM) {
+		/* Rejected before it was acknowledged, the vrings are intact */
+		rpmsg_virtio_set_status(rvdev, VIRTIO_CONFIG_STATUS_DRIVER_OK);
+		goto out;
+	} else if (status != RPMSG_SUCCESS) {
+		goto out;
+	}
+
 	rpmsg_virtio_delete_virtqueues(rvdev);
+	rvdev->rvq = NULL;
+	rvdev->svq = NULL;
+	vdev->vrings_info[0].info.num_descs = rx_num;
+	vdev->vrings_info[1].info.num_descs = tx_num;
+	rvdev->config = cfg;
+	rpmsg_virtio_init_shm_pool(shpool, shpool->base, shpool->size);
+	if (txpool != shpool)
+		rpmsg_virtio_init_shm_pool(txpool, txpool->base, txpool->size);
+	rvdev->shpool = txpool;
+	metal_list_init(&rvdev->reclaimer);
+
+	status = rpmsg_virtio_setup_vqs(rvdev, shpool);
+	if (status != RPMSG_SUCCESS) {
+		/* Do not leave the remote waiting for the driver ready */
+		rpmsg_virtio_resize_abort(rvdev, req);
+		goto out;
+	}
+	/* The remote may have given up meanwhile */
+	rpmsg_virtio_read_config(rvdev, 0, &rcfg, sizeof(rcfg));
+	if (rcfg.abort == req)
+		status = RPMSG_ERR_DEV_STATE;
+	else
+		rpmsg_virtio_set_status(rvdev, VIRTIO_CONFIG_STATUS_DRIVER_OK);
+
+out:
+	metal_mutex_release(&rdev->lock);
+
 	return status;
+}
 #endif /*!VIRTIO_DEVICE_ONLY*/
+
+#ifndef VIRTIO_DRIVER_ONLY
+int rpmsg_virtio_resize_poll(struct rpmsg_virtio_device *rvdev)
+{
+	struct rpmsg_virtio_resize_config rcfg;
+	struct virtio_device *vdev;
+	struct rpmsg_device *rdev;
+	int status;
+
+	if (!rvdev || !rvdev->vdev ||
+	    rpmsg_virtio_get_role(rvdev) != RPMSG_REMOTE)
+		return RPMSG_ERR_PARAM;
+	if (!rpmsg_virtio_read_resize(rvdev, &rcfg) || rcfg.req == rcfg.ack ||
+	    rcfg.req == rcfg.abort)
+		return 0;
+	/* The vrings are still in use: reject, the host keeps them */
+	if (!rpmsg_virtio_vring_num_valid(rcfg.vring_num[0],
+					  rvdev->vring_num_max[0]) ||
+	    !rpmsg_virtio_vring_num_valid(rcfg.vring_num[1],
+					  rvdev->vring_num_max[1])) {
+		rpmsg_virtio_resize_abort(rvdev, rcfg.req);
+		return RPMSG_ERR_PARAM;
+	}
+
+	rdev = &rvdev->rdev;
+	vdev = rvdev->vdev;
+	metal_mutex_acquire(&rdev->lock);
+
+	rpmsg_virtio_delete_virtqueues(rvdev);
+	rvdev->rvq = NULL;
+	rvdev->svq = NULL;
+	vdev->vrings_info[0].info.num_descs = rcfg.vring_num[0];
+	vdev->vrings_info[1].info.num_descs = rcfg.vring_num[1];
+	metal_list_init(&rvdev->reclaimer);
+
+	/* Acknowledge, and wait for the host to rebuild the vrings */
+	rpmsg_virtio_write_config(rvdev,
+				  offsetof(struct rpmsg_virtio_resize_config,
+					   ack),
+				  &rcfg.req, sizeof(rcfg.req));
+	status = rpmsg_virtio_resize_wait(rvdev, rcfg.req);
+	if (status == RPMSG_SUCCESS)
+		status = rpmsg_virtio_setup_vqs(rvdev, NULL);
+	else
+		/* The vrings are gone either way */
+		status = RPMSG_ERR_DEV_STATE;
+	metal_mutex_release(&rdev->lock);
+
+	return status == RPMSG_SUCCESS ? 1 : status;
 }
+#endif /*!VIRTIO_DRIVER_ONLY*/
 
 void rpmsg_deinit_vdev(struct rpmsg_virtio_device *rvdev)
 {
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <metal/alloc.h>
+#include <metal/utilities.h>
+#include <openamp/rpmsg_bulk.h>
+#include <string.h>
+
+static int rpmsg_bulk_pool_init(struct rpmsg_bulk_pool *pool,
+				unsigned long base, unsigned long size)
+{
+	unsigned int num = size / RPMSG_BULK_BLOCK_SIZE;
+	unsigned int longs, k, i;
+	unsigned long *mem;
+
+	if (!num)
+		return -EINVAL;
+
+	pool->base = base;
+	pool->num = num;
+	pool->max_order = 0;
+	while (pool->max_order + 1 < RPMSG_BULK_MAX_ORDERS &&
+	       (2UL << pool->max_order) <= num)
+		pool->max_order++;
+
+	longs = metal_bitmap_longs(num);
+	/* Free bitmaps of each order, sent bitmap, then the orders */
+	mem = metal_allocate_memory((pool->max_order + 2) * longs *
+				    sizeof(*mem) + num);
+	if (!mem)
+		return -ENOMEM;
+	memset(mem, 0, (pool->max_order + 2) * longs * sizeof(*mem) + num);
+	for (k = 0; k <= pool->max_order; k++)
+		pool->free[k] = mem + k * longs;
+	pool->sent = mem + (pool->max_order + 1) * longs;
+	pool->order = (uint8_t *)(mem + (pool->max_order + 2) * longs);
+
+	/* Start with the largest aligned blocks fitting the part */
+	for (i = 0; i < num; i += 1U << k) {
+		k = pool->max_order;
+		while ((i & ((1U << k) - 1)) || i + (1U << k) > num)
+			k--;
+		metal_bitmap_set_bit(pool->free[k], i);
+	}
+
+	return 0;
+}
+
+/* First free block of an order, skipping the empty words */
+static unsigned int rpmsg_bulk_first_free(unsigned long *bitmap,
+					  unsigned int num)
+{
+	unsigned int w;
+
+	for (w = 0; w < metal_bitmap_longs(num); w++) {
+		if (bitmap[w])
+			return metal_bitmap_next_set_bit(bitmap,
+							 w * METAL_BITS_PER_ULONG,
+							 num);
+	}
+
+	return num;
+}
+
+static int rpmsg_bulk_pool_alloc(struct rpmsg_bulk_pool *pool,
+				 unsigned int order)
+{
+	unsigned int k, i = pool->num;
+
+	for (k = order; k <= pool->max_order; k++) {
+		i = rpmsg_bulk_first_free(pool->free[k], pool->num);
+		if (i < pool->num)
+			break;
+	}
+	if (k > pool->max_order)
+		return -ENOMEM;
+
+	/* Split down to the order asked, freeing the upper halves */
+	metal_bitmap_clear_bit(pool->free[k], i);
+	while (k > order) {
+		k--;
+		metal_bitmap_set_bit(pool->free[k], i + (1U << k));
+	}
+	pool->order[i] = order + 1;
+
+	return i;
+}
+
+static void rpmsg_bulk_pool_free(struct rpmsg_bulk_pool *pool,
+				 unsigned int i)
+{
+	unsigned int k = pool->order[i] - 1;
+	unsigned int buddy;
+
+	pool->order[i] = 0;
+	/* Merge with the free buddies */
+	while (k < pool->max_order) {
+		buddy = i ^ (1U << k);
+		if (buddy >= pool->num ||
+		    !metal_bitmap_is_bit_set(pool->free[k], buddy))
+			break;
+		metal_bitmap_clear_bit(pool->free[k], buddy);
+		i &= ~(1U << k);
+		k++;
+	}
+	metal_bitmap_set_bit(pool->free[k], i);
+}
+
+/* Get the first block of a buffer allocated from the local pool */
+static int rpmsg_bulk_pool_index(struct rpmsg_bulk *ch, unsigned long offset)
+{
+	struct rpmsg_bulk_pool *pool = &ch->pool;
+	unsigned long i;
+
+	if (offset < pool->base ||
+	    (offset - pool->base) % RPMSG_BULK_BLOCK_SIZE)
+		return -EINVAL;
+	i = (offset - pool->base) / RPMSG_BULK_BLOCK_SIZE;
+	if (i >= pool->num || !pool->order[i])
+		return -EINVAL;
+
+	return i;
+}
+
+/* Get a buffer passed by the peer, which must lie out of the local pool */
+static void *rpmsg_bulk_peer_buf(struct rpmsg_bulk *ch,
+				 const struct rpmsg_bulk_desc *desc)
+{
+	unsigned long size = metal_io_region_size(ch->io);
+	unsigned long start = ch->pool.base;
+	unsigned long end = start +
+			    (unsigned long)ch->pool.num * RPMSG_BULK_BLOCK_SIZE;
+
+	if (desc->offset >= size || desc->len > size - desc->offset ||
+	    (desc->offset < end && desc->offset + desc->len > start))
+		return NULL;
+
+	return metal_io_virt(ch->io, desc->offset);
+}
+
+static void rpmsg_bulk_done(struct rpmsg_bulk *ch,
+			    const struct rpmsg_bulk_desc *desc)
+{
+	void *data = metal_io_virt(ch->io, desc->offset);
+	int i;
+
+	/* Only a buffer passed to the peer may come back, and only once */
+	metal_spinlock_acquire(&ch->lock);
+	i = rpmsg_bulk_pool_index(ch, desc->offset);
+	if (i >= 0 && metal_bitmap_is_bit_set(ch->pool.sent, i)) {
+		metal_bitmap_clear_bit(ch->pool.sent, i);
+		ch->in_flight--;
+	} else {
+		i = -EINVAL;
+		ch->invalid++;
+	}
+	metal_spinlock_release(&ch->lock);
+	if (i < 0)
+		return;
+
+	if (ch->done_cb)
+		ch->done_cb(ch, data, desc->cookie);
+
+	metal_spinlock_acquire(&ch->lock);
+	rpmsg_bulk_pool_free(&ch->pool, i);
+	metal_spinlock_release(&ch->lock);
+}
+
+static int rpmsg_bulk_ept_cb(struct rpmsg_endpoint *ept, void *data,
+			     size_t len, uint32_t src, void *priv)
+{
+	struct rpmsg_bulk *ch = metal_container_of(ept, struct rpmsg_bulk, ept);
+	struct rpmsg_bulk_msg *msg = data;
+	struct rpmsg_bulk_desc *desc = (struct rpmsg_bulk_desc *)(msg + 1);
+	unsigned int i;
+	void *buf;
+
+	(void)src;
+	(void)priv;
+	if (len < sizeof(*msg) ||
+	    len < sizeof(*msg) +
+		  (size_t)(msg->num_xfer + msg->num_ret) * sizeof(*desc))
+		return RPMSG_SUCCESS;
+
+	/* Returns first, their buffers may serve the answers */
+	for (i = 0; i < msg->num_ret; i++)
+		rpmsg_bulk_done(ch, &desc[msg->num_xfer + i]);
+
+	for (i = 0; i < msg->num_xfer; i++) {
+		buf = rpmsg_bulk_peer_buf(ch, &desc[i]);
+		if (!buf) {
+			ch->invalid++;
+			continue;
+		}
+		BUFFER_INVALIDATE(buf, desc[i].len);
+		ch->rx_cb(ch, &desc[i], buf);
+	}
+
+	return RPMSG_SUCCESS;
+}
+
+int rpmsg_bulk_create(struct rpmsg_bulk *ch, struct rpmsg_device *rdev,
+		      const char *name, uint32_t src, uint32_t dest,
+		      struct metal_io_region *io, unsigned long tx_off,
+		      unsigned long tx_size, rpmsg_bulk_rx_cb rx_cb,
+		      rpmsg_bulk_done_cb done_cb)
+{
+	int ret;
+
+	if (!ch || !rdev || !io || !rx_cb ||
+	    tx_off > metal_io_region_size(io) ||
+	    tx_size > metal_io_region_size(io) - tx_off ||
+	    tx_off + tx_size > UINT32_MAX)
+		return -EINVAL;
+
+	metal_spinlock_init(&ch->lock);
+	ch->io = io;
+	ch->num_xfer = 0;
+	ch->num_ret = 0;
+	ch->rx_cb = rx_cb;
+	ch->done_cb = done_cb;
+	ch->in_flight = 0;
+	ch->invalid = 0;
+	ret = rpmsg_bulk_pool_init(&ch->pool, tx_off, tx_size);
+	if (ret)
+		return ret;
+
+	ret = rpmsg_create_ept(&ch->ept, rdev, name, src, dest,
+			       rpmsg_bulk_ept_cb, NULL);
+	if (ret) {
+		metal_free_memory(ch->pool.free[0]);
+		ch->pool.free[0] = NULL;
+	}
+
+	return ret;
+}
+
+void rpmsg_bulk_destroy(struct rpmsg_bulk *ch)
+{
+	if (!ch || !ch->pool.free[0])
+		return;
+
+	rpmsg_destroy_ept(&ch->ept);
+	metal_free_memory(ch->pool.free[0]);
+	ch->pool.free[0] = NULL;
+}
+
+void *rpmsg_bulk_alloc(struct rpmsg_bulk *ch, uint32_t size)
+{
+	unsigned int blocks, order = 0;
+	int i;
+
+	if (!ch || !size)
+		return NULL;
+
+	blocks = metal_div_round_up(size, RPMSG_BULK_BLOCK_SIZE);
+	while ((1U << order) < blocks)
+		order++;
+	if (order > ch->pool.max_order)
+		return NULL;
+
+	metal_spinlock_acquire(&ch->lock);
+	i = rpmsg_bulk_pool_alloc(&ch->pool, order);
+	metal_spinlock_release(&ch->lock);
+	if (i < 0)
+		return NULL;
+
+	return metal_io_virt(ch->io, ch->pool.base +
+				     (unsigned long)i * RPMSG_BULK_BLOCK_SIZE);
+}
+
+void rpmsg_bulk_free(struct rpmsg_bulk *ch, void *data)
+{
+	int i;
+
+	if (!ch || !data)
+		return;
+
+	metal_spinlock_acquire(&ch->lock);
+	i = rpmsg_bulk_pool_index(ch, metal_io_virt_to_offset(ch->io, data));
+	/* A buffer in flight goes back to the pool when returned */
+	if (i >= 0 && !metal_bitmap_is_bit_set(ch->pool.sent, i))
+		rpmsg_bulk_pool_free(&ch->pool, i);
+	metal_spinlock_release(&ch->lock);
+}
+
+int rpmsg_bulk_flush(struct rpmsg_bulk *ch)
+{
+	struct rpmsg_bulk_desc *desc;
+	struct rpmsg_bulk_msg *msg;
+	unsigned int room, nx, nr;
+	uint32_t size;
+	int ret;
+
+	if (!ch)
+		return -EINVAL;
+
+	for (;;) {
+		metal_spinlock_acquire(&ch->lock);
+		nx = ch->num_xfer + ch->num_ret;
+		metal_spinlock_release(&ch->lock);
+		if (!nx)
+			return 0;
+
+		msg = rpmsg_get_tx_payload_buffer(&ch->ept, &size, 0);
+		if (!msg)
+			return -EAGAIN;
+		room = (size - sizeof(*msg)) / sizeof(*desc);
+		desc = (struct rpmsg_bulk_desc *)(msg + 1);
+
+		/* Take as many descriptors as fit in the buffer */
+		metal_spinlock_acquire(&ch->lock);
+		nx = metal_min(ch->num_xfer, room);
+		nr = metal_min(ch->num_ret, room - nx);
+		memcpy(desc, ch->xfer, nx * sizeof(*desc));
+		memcpy(desc + nx, ch->ret, nr * sizeof(*desc));
+		ch->num_xfer -= nx;
+		ch->num_ret -= nr;
+		memmove(ch->xfer, ch->xfer + nx, ch->num_xfer * sizeof(*desc));
+		memmove(ch->ret, ch->ret + nr, ch->num_ret * sizeof(*desc));
+		metal_spinlock_release(&ch->lock);
+
+		if (!nx && !nr) {
+			rpmsg_release_tx_buffer(&ch->ept, msg);
+			return 0;
+		}
+		msg->num_xfer = nx;
+		msg->num_ret = nr;
+		ret = rpmsg_send_nocopy(&ch->ept, msg,
+					sizeof(*msg) + (nx + nr) * sizeof(*desc));
+		if (ret < 0)
+			return ret;
+	}
+}
+
+/* Queue a descriptor, sending the batch once complete */
+static int rpmsg_bulk_queue(struct rpmsg_bulk *ch,
+			    struct rpmsg_bulk_desc *queue, unsigned int *num,
+			    unsigned int max, uint32_t offset, uint32_t len,
+			    uint64_t cookie)
+{
+	bool full;
+
+	metal_spinlock_acquire(&ch->lock);
+	if (*num == max) {
+		metal_spinlock_release(&ch->lock);
+		rpmsg_bulk_flush(ch);
+		metal_spinlock_acquire(&ch->lock);
+		if (*num == max) {
+			metal_spinlock_release(&ch->lock);
+			return -EAGAIN;
+		}
+	}
+	queue[*num].offset = offset;
+	queue[*num].len = len;
+	queue[*num].cookie = cookie;
+	full = ++(*num) >= RPMSG_BULK_BATCH;
+	metal_spinlock_release(&ch->lock);
+
+	/* Queued anyway, the next call or flush sends it */
+	if (full)
+		rpmsg_bulk_flush(ch);
+
+	return 0;
+}
+
+int rpmsg_bulk_send(struct rpmsg_bulk *ch, void *data, uint32_t len,
+		    uint64_t cookie)
+{
+	unsigned long offset;
+	int ret, i;
+
+	if (!ch || !data)
+		return -EINVAL;
+
+	offset = metal_io_virt_to_offset(ch->io, data);
+	metal_spinlock_acquire(&ch->lock);
+	i = rpmsg_bulk_pool_index(ch, offset);
+	if (i >= 0 && metal_bitmap_is_bit_set(ch->pool.sent, i))
+		i = -EINVAL;
+	if (i >= 0 && ch->in_flight == RPMSG_BULK_MAX_IN_FLIGHT) {
+		metal_spinlock_release(&ch->lock);
+		return -EAGAIN;
+	}
+	/* Marked first, the peer may return the buffer before we return */
+	if (i >= 0) {
+		metal_bitmap_set_bit(ch->pool.sent, i);
+		ch->in_flight++;
+	}
+	metal_spinlock_release(&ch->lock);
+	if (i < 0)
+		return -EINVAL;
+
+	ret = -EINVAL;
+	if (len <= ((uint32_t)RPMSG_BULK_BLOCK_SIZE << (ch->pool.order[i] - 1))) {
+		BUFFER_FLUSH(data, len);
+		ret = rpmsg_bulk_queue(ch, ch->xfer, &ch->num_xfer,
+				       RPMSG_BULK_BATCH, offset, len, cookie);
+	}
+	if (ret) {
+		metal_spinlock_acquire(&ch->lock);
+		metal_bitmap_clear_bit(ch->pool.sent, i);
+		ch->in_flight--;
+		metal_spinlock_release(&ch->lock);
+	}
+
+	return ret;
+}
+
+int rpmsg_bulk_release(struct rpmsg_bulk *ch,
+		       const struct rpmsg_bulk_desc *desc)
+{
+	if (!ch || !desc)
+		return -EINVAL;
+
+	/* Room for all the buffers the peer may have in flight */
+	return rpmsg_bulk_queue(ch, ch->ret, &ch->num_ret,
+				RPMSG_BULK_MAX_IN_FLIGHT, desc->offset,
+				desc->len, desc->cookie);
+}
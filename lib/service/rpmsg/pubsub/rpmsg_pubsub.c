@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <openamp/rpmsg_pubsub.h>
+#include <string.h>
+
+/* Get a free message, a local one if asked, otherwise a received one */
+static struct rpmsg_pubsub_msg *
+rpmsg_pubsub_msg_get(struct rpmsg_pubsub_topic *topic, bool local)
+{
+	struct rpmsg_pubsub_msg *msg;
+	unsigned int i;
+
+	if (local) {
+		i = metal_bitmap_next_clear_bit(topic->used, 0, topic->num);
+		if (i == topic->num)
+			return NULL;
+	} else {
+		/* Spare the messages owning a payload buffer */
+		i = metal_bitmap_next_clear_bit(topic->used, topic->num,
+						RPMSG_PUBSUB_MSGS);
+		if (i == RPMSG_PUBSUB_MSGS) {
+			i = metal_bitmap_next_clear_bit(topic->used, 0,
+							topic->num);
+			if (i == topic->num)
+				return NULL;
+		}
+	}
+	metal_bitmap_set_bit(topic->used, i);
+
+	msg = &topic->msgs[i];
+	msg->data = local ? topic->pool + i * topic->size : NULL;
+	msg->len = 0;
+	msg->topic = topic;
+	msg->ref = 1;
+	msg->rx_buf = NULL;
+	msg->next = NULL;
+
+	return msg;
+}
+
+/*
+ * Free messages chained by rpmsg_pubsub_deliver() or put, unlocked: the
+ * release of the received buffers takes the device lock.
+ */
+static void rpmsg_pubsub_msg_free(struct rpmsg_pubsub_topic *topic,
+				  struct rpmsg_pubsub_msg *msg)
+{
+	struct rpmsg_pubsub_msg *next;
+
+	for (; msg; msg = next) {
+		next = msg->next;
+		if (msg->rx_buf)
+			rpmsg_release_rx_buffer(&topic->ept, msg->rx_buf);
+		metal_spinlock_acquire(&topic->lock);
+		metal_bitmap_clear_bit(topic->used, msg - topic->msgs);
+		metal_spinlock_release(&topic->lock);
+	}
+}
+
+void rpmsg_pubsub_put(struct rpmsg_pubsub_msg *msg)
+{
+	struct rpmsg_pubsub_topic *topic;
+	bool last;
+
+	if (!msg)
+		return;
+
+	topic = msg->topic;
+	metal_spinlock_acquire(&topic->lock);
+	last = !--msg->ref;
+	metal_spinlock_release(&topic->lock);
+	if (last) {
+		msg->next = NULL;
+		rpmsg_pubsub_msg_free(topic, msg);
+	}
+}
+
+/* Tell the peer whether there are local subscribers, once its address known */
+static void rpmsg_pubsub_advertise(struct rpmsg_pubsub_topic *topic,
+				   bool force)
+{
+	struct rpmsg_pubsub_hdr hdr;
+	int state;
+
+	if (topic->ept.dest_addr == RPMSG_ADDR_ANY)
+		return;
+
+	metal_spinlock_acquire(&topic->lock);
+	state = topic->num_subs ? 1 : 0;
+	if (state == topic->advertised && !force) {
+		metal_spinlock_release(&topic->lock);
+		return;
+	}
+	topic->advertised = state;
+	metal_spinlock_release(&topic->lock);
+
+	hdr.type = state ? RPMSG_PUBSUB_SUB : RPMSG_PUBSUB_UNSUB;
+	hdr.reserved = 0;
+	if (rpmsg_trysend(&topic->ept, &hdr, sizeof(hdr)) < 0) {
+		/* Try again on the next call */
+		metal_spinlock_acquire(&topic->lock);
+		topic->advertised = -1;
+		metal_spinlock_release(&topic->lock);
+	}
+}
+
+/* Queue a message to each subscriber, the reference of the caller is kept */
+static void rpmsg_pubsub_deliver(struct rpmsg_pubsub_topic *topic,
+				 struct rpmsg_pubsub_msg *msg)
+{
+	struct rpmsg_pubsub_msg *old, *dead = NULL;
+	struct rpmsg_pubsub_sub *sub;
+	struct metal_list *node;
+
+	metal_spinlock_acquire(&topic->lock);
+	metal_list_for_each(&topic->subs, node) {
+		sub = metal_container_of(node, struct rpmsg_pubsub_sub, node);
+		if (sub->head - sub->tail == sub->depth) {
+			sub->dropped++;
+			if (sub->policy == RPMSG_PUBSUB_DROP_NEWEST)
+				continue;
+			old = sub->queue[sub->tail % sub->depth];
+			sub->tail++;
+			/* Freed once unlocked */
+			if (!--old->ref) {
+				old->next = dead;
+				dead = old;
+			}
+		}
+		msg->ref++;
+		sub->queue[sub->head % sub->depth] = msg;
+		sub->head++;
+		if (sub->notify_cb)
+			sub->notify_cb(sub);
+	}
+	metal_spinlock_release(&topic->lock);
+
+	rpmsg_pubsub_msg_free(topic, dead);
+}
+
+static int rpmsg_pubsub_ept_cb(struct rpmsg_endpoint *ept, void *data,
+			       size_t len, uint32_t src, void *priv)
+{
+	struct rpmsg_pubsub_topic *topic =
+		metal_container_of(ept, struct rpmsg_pubsub_topic, ept);
+	struct rpmsg_pubsub_hdr *hdr = data;
+	struct rpmsg_pubsub_msg *msg;
+	bool first;
+
+	(void)src;
+	(void)priv;
+	if (len < sizeof(*hdr))
+		return RPMSG_SUCCESS;
+
+	switch (hdr->type) {
+	case RPMSG_PUBSUB_SUB:
+	case RPMSG_PUBSUB_UNSUB:
+		metal_spinlock_acquire(&topic->lock);
+		topic->peer_subs = hdr->type == RPMSG_PUBSUB_SUB;
+		first = topic->advertised < 0;
+		metal_spinlock_release(&topic->lock);
+		/* The peer may have learnt our address from this exchange */
+		if (first)
+			rpmsg_pubsub_advertise(topic, true);
+		break;
+	case RPMSG_PUBSUB_DATA:
+		metal_spinlock_acquire(&topic->lock);
+		msg = topic->num_subs ? rpmsg_pubsub_msg_get(topic, false) :
+					NULL;
+		if (topic->num_subs && !msg)
+			topic->rx_dropped++;
+		metal_spinlock_release(&topic->lock);
+		if (!msg)
+			break;
+
+		/* The buffer is shared by the subscribers, without copy */
+		rpmsg_hold_rx_buffer(ept, data);
+		msg->rx_buf = data;
+		msg->data = hdr + 1;
+		msg->len = len - sizeof(*hdr);
+		rpmsg_pubsub_deliver(topic, msg);
+		rpmsg_pubsub_put(msg);
+		break;
+	default:
+		break;
+	}
+
+	return RPMSG_SUCCESS;
+}
+
+int rpmsg_pubsub_topic_create(struct rpmsg_pubsub_topic *topic,
+			      struct rpmsg_device *rdev, const char *name,
+			      uint32_t dest, void *pool, unsigned int num,
+			      uint32_t size)
+{
+	int ret;
+
+	if (!topic || !rdev || !name || num > RPMSG_PUBSUB_MSGS ||
+	    (num && (!pool || !size)))
+		return -EINVAL;
+
+	metal_spinlock_init(&topic->lock);
+	metal_list_init(&topic->subs);
+	topic->num_subs = 0;
+	topic->advertised = -1;
+	topic->peer_subs = false;
+	memset(topic->used, 0, sizeof(topic->used));
+	topic->pool = pool;
+	topic->num = num;
+	topic->size = size;
+	topic->tx_dropped = 0;
+	topic->rx_dropped = 0;
+
+	ret = rpmsg_create_ept(&topic->ept, rdev, name, RPMSG_ADDR_ANY, dest,
+			       rpmsg_pubsub_ept_cb, NULL);
+	if (ret)
+		return ret;
+
+	rpmsg_pubsub_advertise(topic, false);
+
+	return 0;
+}
+
+void rpmsg_pubsub_topic_destroy(struct rpmsg_pubsub_topic *topic)
+{
+	if (!topic)
+		return;
+
+	rpmsg_destroy_ept(&topic->ept);
+}
+
+int rpmsg_pubsub_subscribe(struct rpmsg_pubsub_topic *topic,
+			   struct rpmsg_pubsub_sub *sub,
+			   struct rpmsg_pubsub_msg **queue, unsigned int depth,
+			   int policy, rpmsg_pubsub_notify_cb notify_cb)
+{
+	if (!topic || !sub || !queue || !depth ||
+	    (policy != RPMSG_PUBSUB_DROP_NEWEST &&
+	     policy != RPMSG_PUBSUB_DROP_OLDEST))
+		return -EINVAL;
+
+	sub->topic = topic;
+	sub->queue = queue;
+	sub->depth = depth;
+	sub->head = 0;
+	sub->tail = 0;
+	sub->policy = policy;
+	sub->notify_cb = notify_cb;
+	sub->dropped = 0;
+
+	metal_spinlock_acquire(&topic->lock);
+	metal_list_add_tail(&topic->subs, &sub->node);
+	topic->num_subs++;
+	metal_spinlock_release(&topic->lock);
+
+	rpmsg_pubsub_advertise(topic, false);
+
+	return 0;
+}
+
+void rpmsg_pubsub_unsubscribe(struct rpmsg_pubsub_sub *sub)
+{
+	struct rpmsg_pubsub_topic *topic;
+
+	if (!sub || !sub->topic)
+		return;
+
+	topic = sub->topic;
+	metal_spinlock_acquire(&topic->lock);
+	metal_list_del(&sub->node);
+	topic->num_subs--;
+	metal_spinlock_release(&topic->lock);
+
+	while (sub->tail != sub->head) {
+		rpmsg_pubsub_put(sub->queue[sub->tail % sub->depth]);
+		sub->tail++;
+	}
+	sub->topic = NULL;
+
+	rpmsg_pubsub_advertise(topic, false);
+}
+
+struct rpmsg_pubsub_msg *rpmsg_pubsub_alloc(struct rpmsg_pubsub_topic *topic)
+{
+	struct rpmsg_pubsub_msg *msg;
+
+	if (!topic)
+		return NULL;
+
+	metal_spinlock_acquire(&topic->lock);
+	msg = rpmsg_pubsub_msg_get(topic, true);
+	metal_spinlock_release(&topic->lock);
+
+	return msg;
+}
+
+/* Copy a payload to the peer, once for all its subscribers */
+static int rpmsg_pubsub_send(struct rpmsg_pubsub_topic *topic,
+			     const void *data, uint32_t len)
+{
+	struct rpmsg_pubsub_hdr *hdr;
+	uint32_t size;
+	int ret;
+
+	rpmsg_pubsub_advertise(topic, false);
+	if (!topic->peer_subs || topic->ept.dest_addr == RPMSG_ADDR_ANY)
+		return 0;
+
+	hdr = rpmsg_get_tx_payload_buffer(&topic->ept, &size, 0);
+	if (!hdr) {
+		topic->tx_dropped++;
+		return -EAGAIN;
+	}
+	if (size - sizeof(*hdr) < len) {
+		rpmsg_release_tx_buffer(&topic->ept, hdr);
+		return -EMSGSIZE;
+	}
+	hdr->type = RPMSG_PUBSUB_DATA;
+	hdr->reserved = 0;
+	memcpy(hdr + 1, data, len);
+	ret = rpmsg_send_nocopy(&topic->ept, hdr, sizeof(*hdr) + len);
+
+	return ret < 0 ? ret : 0;
+}
+
+int rpmsg_pubsub_publish(struct rpmsg_pubsub_msg *msg, uint32_t len)
+{
+	struct rpmsg_pubsub_topic *topic;
+	int ret;
+
+	if (!msg || msg->rx_buf)
+		return -EINVAL;
+
+	topic = msg->topic;
+	if (len > topic->size) {
+		rpmsg_pubsub_put(msg);
+		return -EINVAL;
+	}
+	msg->len = len;
+
+	ret = rpmsg_pubsub_send(topic, msg->data, len);
+	rpmsg_pubsub_deliver(topic, msg);
+	rpmsg_pubsub_put(msg);
+
+	return ret;
+}
+
+int rpmsg_pubsub_publish_copy(struct rpmsg_pubsub_topic *topic,
+			      const void *data, uint32_t len)
+{
+	struct rpmsg_pubsub_msg *msg;
+
+	if (!topic || (!data && len))
+		return -EINVAL;
+
+	/* Without local subscribers, only the copy to the peer is needed */
+	if (!topic->num_subs)
+		return rpmsg_pubsub_send(topic, data, len);
+
+	if (len > topic->size)
+		return -EINVAL;
+	msg = rpmsg_pubsub_alloc(topic);
+	if (!msg)
+		return -EAGAIN;
+	memcpy(msg->data, data, len);
+
+	return rpmsg_pubsub_publish(msg, len);
+}
+
+struct rpmsg_pubsub_msg *rpmsg_pubsub_take(struct rpmsg_pubsub_sub *sub)
+{
+	struct rpmsg_pubsub_msg *msg = NULL;
+	struct rpmsg_pubsub_topic *topic;
+
+	if (!sub || !sub->topic)
+		return NULL;
+
+	topic = sub->topic;
+	metal_spinlock_acquire(&topic->lock);
+	if (sub->tail != sub->head) {
+		msg = sub->queue[sub->tail % sub->depth];
+		sub->tail++;
+	}
+	metal_spinlock_release(&topic->lock);
+
+	return msg;
+}
@@ -6,11 +6,75 @@
  */
 
 #include <errno.h>
+#include <metal/sleep.h>
 #include <openamp/rpmsg_rpc_client_server.h>
 
+#include "rpmsg_rpc_internal.h"
+
+/* Time to wait between two checks of the call status, in usecs. */
+#define RPMSG_RPC_WAIT_INTERVAL_US	10
+
 static int rpmsg_endpoint_client_cb(struct rpmsg_endpoint *, void *, size_t,
 				    uint32_t, void *);
 
+/**
+ * @internal
+ *
+ * @brief Complete a call removed from the pending list
+ *
+ * The call is handed back to its owner before the completion callback is
+ * invoked, and is not touched once cb is called: the callback may free or
+ * reuse it. A call without callback keeps a copy of the answer params in
+ * its buffer for the waiter.
+ */
+static void rpmsg_rpc_call_complete(struct rpmsg_rpc_call *call, int status,
+				    void *data, size_t len)
+{
+	rpmsg_rpc_call_cb cb = call->cb;
+
+	if (!cb && call->rx_buf && data && data != call->rx_buf) {
+		if (len > call->rx_len) {
+			status = -EMSGSIZE;
+			len = 0;
+		} else {
+			memcpy(call->rx_buf, data, len);
+		}
+		call->rx_off = len;
+	}
+
+	call->status = status;
+	atomic_flag_clear(&call->nacked);
+	if (cb)
+		cb(call, status, data, len);
+}
+
+/**
+ * @internal
+ *
+ * @brief Complete all the pending calls with the given status
+ *
+ * @param rpc		Pointer to the client remote procedure call data
+ * @param status	Status of the completed calls
+ */
+static void rpmsg_rpc_client_flush(struct rpmsg_rpc_clt *rpc, int status)
+{
+	struct rpmsg_rpc_call *call;
+	struct metal_list *node;
+
+	while (1) {
+		metal_spinlock_acquire(&rpc->lock);
+		node = metal_list_first(&rpc->pending);
+		if (node)
+			metal_list_del(node);
+		metal_spinlock_release(&rpc->lock);
+		if (!node)
+			break;
+
+		call = metal_container_of(node, struct rpmsg_rpc_call, node);
+		rpmsg_rpc_call_complete(call, status, NULL, 0);
+	}
+}
+
 static void rpmsg_service_client_unbind(struct rpmsg_endpoint *ept)
 {
 	struct rpmsg_rpc_clt *rpc;
@@ -18,6 +82,7 @@ static void rpmsg_service_client_unbind(struct rpmsg_endpoint *ept)
 
 	rpc = metal_container_of(ept, struct rpmsg_rpc_clt, ept);
 	rpmsg_destroy_ept(&rpc->ept);
+	rpmsg_rpc_client_flush(rpc, -ECONNRESET);
 	if (rpc->shutdown_cb)
 		rpc->shutdown_cb(rpc);
 }
@@ -35,55 +100,317 @@ int rpmsg_rpc_client_init(struct rpmsg_rpc_clt *rpc,
 
 	rpc->services = services;
 	rpc->n_services = len;
+	rpmsg_rpc_index_build(&rpc->index, services, sizeof(*services), len);
 
 	rpc->shutdown_cb = shutdown_cb;
 
+	metal_list_init(&rpc->pending);
+	metal_spinlock_init(&rpc->lock);
+	metal_mutex_init(&rpc->tx_lock);
+	rpc->seq = 0;
+
 	ret = rpmsg_create_ept(&rpc->ept, rdev,
 			       RPMSG_RPC_SERVICE_NAME, RPMSG_ADDR_ANY,
 			       RPMSG_ADDR_ANY,
 			       rpmsg_endpoint_client_cb,
 			       rpmsg_service_client_unbind);
+	if (ret) {
+		rpmsg_rpc_index_free(&rpc->index);
+		metal_mutex_deinit(&rpc->tx_lock);
+	}
 
 	return ret;
 }
 
+/**
+ * @internal
+ *
+ * @brief Allocate the correlation ID of a call and queue it
+ *
+ * The call is queued before the request is sent, the answer can be
+ * received before rpmsg_send() returns.
+ */
+static void rpmsg_rpc_client_track(struct rpmsg_rpc_clt *rpc,
+				   struct rpmsg_rpc_call *call,
+				   unsigned int rpc_id,
+				   void *resp_buf, size_t resp_len,
+				   rpmsg_rpc_call_cb cb, void *priv)
+{
+	call->rpc = rpc;
+	call->id = rpc_id;
+	call->cb = cb;
+	call->priv = priv;
+	call->status = RPMSG_RPC_OK;
+	call->rx_buf = resp_buf;
+	call->rx_len = resp_buf ? resp_len : 0;
+	call->rx_off = 0;
+	atomic_flag_clear(&call->nacked);
+	(void)atomic_flag_test_and_set(&call->nacked);
+
+	metal_spinlock_acquire(&rpc->lock);
+	/* Correlation ID 0 is reserved for untracked requests */
+	rpc->seq = (rpc->seq + 1) & ~RPMSG_RPC_SEQ_FRAG;
+	if (rpc->seq == 0)
+		rpc->seq = 1;
+	call->seq = rpc->seq;
+	metal_list_add_tail(&rpc->pending, &call->node);
+	metal_spinlock_release(&rpc->lock);
+}
+
+static int rpmsg_rpc_client_send_req(struct rpmsg_rpc_clt *rpc,
+				     uint32_t rpc_id, uint32_t seq,
+				     void *request_param,
+				     size_t req_param_size)
+{
+	struct rpmsg_rpc_req_hdr hdr;
+
+	hdr.id = rpc_id;
+	hdr.seq = seq;
+	return rpmsg_rpc_send_msg(&rpc->ept, &rpc->tx_lock, &hdr, sizeof(hdr),
+				  request_param, req_param_size);
+}
+
 int rpmsg_rpc_client_send(struct rpmsg_rpc_clt *rpc,
 			  unsigned int rpc_id, void *request_param,
 			  size_t req_param_size)
 {
-	unsigned char tmpbuf[MAX_BUF_LEN];
+	if (!rpc)
+		return -EINVAL;
+
+	return rpmsg_rpc_client_send_req(rpc, rpc_id, 0, request_param,
+					 req_param_size);
+}
+
+int rpmsg_rpc_client_call_async(struct rpmsg_rpc_clt *rpc,
+				struct rpmsg_rpc_call *call,
+				unsigned int rpc_id, void *request_param,
+				size_t req_param_size,
+				rpmsg_rpc_call_cb cb, void *priv)
+{
+	return rpmsg_rpc_client_call_stream(rpc, call, rpc_id, request_param,
+					    req_param_size, NULL, 0, cb, priv);
+}
+
+int rpmsg_rpc_client_call_stream(struct rpmsg_rpc_clt *rpc,
+				 struct rpmsg_rpc_call *call,
+				 unsigned int rpc_id, void *request_param,
+				 size_t req_param_size,
+				 void *resp_buf, size_t resp_len,
+				 rpmsg_rpc_call_cb cb, void *priv)
+{
+	int ret;
+
+	if (!rpc || !call)
+		return -EINVAL;
+
+	rpmsg_rpc_client_track(rpc, call, rpc_id, resp_buf, resp_len, cb, priv);
+	ret = rpmsg_rpc_client_send_req(rpc, rpc_id, call->seq, request_param,
+					req_param_size);
+	if (ret < 0)
+		(void)rpmsg_rpc_client_cancel(call);
+
+	return ret;
+}
 
+void *rpmsg_rpc_client_get_tx_params(struct rpmsg_rpc_clt *rpc, size_t len,
+				     bool wait)
+{
 	if (!rpc)
+		return NULL;
+
+	return rpmsg_rpc_get_tx_params(&rpc->ept,
+				       sizeof(struct rpmsg_rpc_req_hdr), len,
+				       wait);
+}
+
+void rpmsg_rpc_client_release_tx_params(struct rpmsg_rpc_clt *rpc,
+					void *params)
+{
+	if (!rpc || !params)
+		return;
+
+	rpmsg_rpc_release_tx_params(&rpc->ept, sizeof(struct rpmsg_rpc_req_hdr),
+				    params);
+}
+
+int rpmsg_rpc_client_call_nocopy(struct rpmsg_rpc_clt *rpc,
+				 struct rpmsg_rpc_call *call,
+				 unsigned int rpc_id, void *params, size_t len,
+				 void *resp_buf, size_t resp_len,
+				 rpmsg_rpc_call_cb cb, void *priv)
+{
+	struct rpmsg_rpc_req_hdr hdr;
+	int ret;
+
+	if (!rpc || !params)
+		return -EINVAL;
+
+	if (call)
+		rpmsg_rpc_client_track(rpc, call, rpc_id, resp_buf, resp_len, cb,
+				       priv);
+
+	hdr.id = rpc_id;
+	hdr.seq = call ? call->seq : 0;
+	ret = rpmsg_rpc_send_nocopy(&rpc->ept, &hdr, sizeof(hdr), params, len);
+	if (ret < 0 && call)
+		(void)rpmsg_rpc_client_cancel(call);
+
+	return ret;
+}
+
+int rpmsg_rpc_client_cancel(struct rpmsg_rpc_call *call)
+{
+	struct rpmsg_rpc_clt *rpc;
+	struct metal_list *node;
+	int ret = -ENOENT;
+
+	if (!call || !call->rpc)
+		return -EINVAL;
+
+	rpc = call->rpc;
+	metal_spinlock_acquire(&rpc->lock);
+	metal_list_for_each(&rpc->pending, node) {
+		if (node == &call->node) {
+			metal_list_del(node);
+			ret = 0;
+			break;
+		}
+	}
+	metal_spinlock_release(&rpc->lock);
+
+	if (!ret) {
+		call->status = -ECANCELED;
+		atomic_flag_clear(&call->nacked);
+	}
+
+	return ret;
+}
+
+int rpmsg_rpc_client_wait(struct rpmsg_rpc_call *call,
+			  rpmsg_rpc_clt_poll poll, void *poll_arg,
+			  uint32_t timeout_ms)
+{
+	uint64_t timeout_us = (uint64_t)timeout_ms * 1000;
+
+	if (!call)
 		return -EINVAL;
 
-	/* to optimize with the zero copy API */
-	memcpy(tmpbuf, &rpc_id, MAX_FUNC_ID_LEN);
-	memcpy(&tmpbuf[MAX_FUNC_ID_LEN], request_param, req_param_size);
-	return rpmsg_send(&rpc->ept, tmpbuf, MAX_FUNC_ID_LEN + req_param_size);
+	while (atomic_flag_test_and_set(&call->nacked)) {
+		if (timeout_ms != RPMSG_RPC_WAIT_FOREVER && !timeout_us) {
+			if (!rpmsg_rpc_client_cancel(call)) {
+				call->status = -ETIMEDOUT;
+				break;
+			}
+			/* The answer raced with the timeout, wait for it */
+			continue;
+		}
+
+		if (poll)
+			poll(poll_arg);
+		metal_sleep_usec(RPMSG_RPC_WAIT_INTERVAL_US);
+		if (timeout_us > RPMSG_RPC_WAIT_INTERVAL_US)
+			timeout_us -= RPMSG_RPC_WAIT_INTERVAL_US;
+		else
+			timeout_us = 0;
+	}
+	atomic_flag_clear(&call->nacked);
+
+	return call->status;
 }
 
 static const struct rpmsg_rpc_client_services *find_service(struct
 							    rpmsg_rpc_clt * rpc,
 							    uint32_t id)
 {
-	const struct rpmsg_rpc_client_services *service;
+	return rpmsg_rpc_index_find(&rpc->index, rpc->services,
+				    sizeof(*rpc->services), rpc->n_services,
+				    id);
+}
 
-	for (unsigned int i = 0; i < rpc->n_services; i++) {
-		service = &rpc->services[i];
+/* Must be called with the client lock held */
+static struct rpmsg_rpc_call *find_call(struct rpmsg_rpc_clt *rpc,
+					uint32_t seq)
+{
+	struct rpmsg_rpc_call *call;
+	struct metal_list *node;
 
-		if (service->id == id) {
-			return service;
-		}
+	metal_list_for_each(&rpc->pending, node) {
+		call = metal_container_of(node, struct rpmsg_rpc_call, node);
+		if (call->seq == seq)
+			return call;
 	}
+
 	return NULL;
 }
 
+/**
+ * @internal
+ *
+ * @brief Reassemble a fragment of an answer
+ *
+ * @param rpc	Pointer to the client remote procedure call data
+ * @param msg	Pointer to the fragment
+ * @param len	Length of the fragment
+ */
+static void rpmsg_rpc_client_rx_frag(struct rpmsg_rpc_clt *rpc,
+				     struct rpmsg_rpc_answer_hdr *msg,
+				     size_t len)
+{
+	struct rpmsg_rpc_frag_hdr frag;
+	struct rpmsg_rpc_call *call;
+	unsigned char *chunk;
+	size_t chunk_len;
+	int status = RPMSG_RPC_OK;
+
+	if (len < sizeof(*msg) + sizeof(frag))
+		return;
+	memcpy(&frag, msg + 1, sizeof(frag));
+	chunk = (unsigned char *)(msg + 1) + sizeof(frag);
+	chunk_len = len - sizeof(*msg) - sizeof(frag);
+
+	metal_spinlock_acquire(&rpc->lock);
+	call = find_call(rpc, msg->seq & ~RPMSG_RPC_SEQ_FRAG);
+	if (!call) {
+		/* Cancelled, timed out or failed call */
+		metal_spinlock_release(&rpc->lock);
+		return;
+	}
+
+	if (frag.offset == 0)
+		call->rx_off = 0;
+	if (frag.total > call->rx_len)
+		status = -EMSGSIZE;
+	else if (frag.offset != call->rx_off ||
+		 chunk_len > frag.total - frag.offset)
+		status = -EPROTO;
+
+	if (status != RPMSG_RPC_OK) {
+		metal_list_del(&call->node);
+		metal_spinlock_release(&rpc->lock);
+		rpmsg_rpc_call_complete(call, status, NULL, 0);
+		return;
+	}
+
+	memcpy((unsigned char *)call->rx_buf + call->rx_off, chunk, chunk_len);
+	call->rx_off += chunk_len;
+	if (call->rx_off < frag.total) {
+		metal_spinlock_release(&rpc->lock);
+		return;
+	}
+	metal_list_del(&call->node);
+	metal_spinlock_release(&rpc->lock);
+
+	rpmsg_rpc_call_complete(call, msg->status, call->rx_buf, call->rx_off);
+}
+
 void rpmsg_rpc_client_release(struct rpmsg_rpc_clt *rpc)
 {
 	if (!rpc)
 		return;
 	rpmsg_destroy_ept(&rpc->ept);
-
+	rpmsg_rpc_client_flush(rpc, -ECONNRESET);
+	rpmsg_rpc_index_free(&rpc->index);
+	metal_mutex_deinit(&rpc->tx_lock);
 }
 
 static int rpmsg_endpoint_client_cb(struct rpmsg_endpoint *ept,
@@ -93,10 +420,12 @@ static int rpmsg_endpoint_client_cb(struct rpmsg_endpoint *ept,
 	struct rpmsg_rpc_clt *rpc;
 	const struct rpmsg_rpc_client_services *service;
 	struct rpmsg_rpc_answer *msg;
+	struct rpmsg_rpc_call *call;
+	size_t hdr_len = sizeof(struct rpmsg_rpc_answer_hdr);
 	(void)priv;
 	(void)src;
 
-	if (!data || !ept)
+	if (!data || !ept || len < hdr_len)
 		return -EINVAL;
 
 	msg = (struct rpmsg_rpc_answer *)data;
@@ -104,6 +433,28 @@ static int rpmsg_endpoint_client_cb(struct rpmsg_endpoint *ept,
 	rpc = metal_container_of(ept,
 				 struct rpmsg_rpc_clt,
 				 ept);
+
+	if (msg->seq & RPMSG_RPC_SEQ_FRAG) {
+		rpmsg_rpc_client_rx_frag(rpc, data, len);
+		return RPMSG_SUCCESS;
+	}
+
+	if (msg->seq) {
+		metal_spinlock_acquire(&rpc->lock);
+		call = find_call(rpc, msg->seq);
+		if (call)
+			metal_list_del(&call->node);
+		metal_spinlock_release(&rpc->lock);
+		/* Drop answers of cancelled or timed out calls */
+		if (!call)
+			return RPMSG_SUCCESS;
+
+		rpmsg_rpc_call_complete(call, msg->status, msg->params,
+					len - hdr_len);
+
+		return RPMSG_SUCCESS;
+	}
+
 	service = find_service(rpc, msg->id);
 	if (!service)
 		return -EINVAL;
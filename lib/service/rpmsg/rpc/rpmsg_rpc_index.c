@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/alloc.h>
+#include <metal/utilities.h>
+#include <string.h>
+
+#include "rpmsg_rpc_internal.h"
+
+/*
+ * IDs are used as direct slot indexes as long as the table is at least this
+ * dense, otherwise they are hashed.
+ */
+#define RPMSG_RPC_INDEX_DENSITY		4
+
+/* Largest table that can be indexed, slots store a 16-bit position */
+#define RPMSG_RPC_INDEX_MAX_SERVICES	0xFFFEU
+
+/* Multiplicative (Fibonacci) hashing constant, 2^32 / golden ratio */
+#define RPMSG_RPC_INDEX_HASH_MULT	0x9E3779B1U
+
+#define RPMSG_RPC_INDEX_ID(table, stride, i) \
+	(*(const uint32_t *)((const char *)(table) + (size_t)(i) * (stride)))
+
+static unsigned int rpmsg_rpc_index_hash(const struct rpmsg_rpc_index *index,
+					 uint32_t id)
+{
+	return (uint32_t)(id * RPMSG_RPC_INDEX_HASH_MULT) >> index->shift;
+}
+
+void rpmsg_rpc_index_build(struct rpmsg_rpc_index *index, const void *table,
+			   size_t stride, unsigned int n)
+{
+	uint32_t id, max_id = 0;
+	unsigned int i, slot, n_slots;
+
+	memset(index, 0, sizeof(*index));
+	if (!table || !n || n > RPMSG_RPC_INDEX_MAX_SERVICES)
+		return;
+
+	for (i = 0; i < n; i++) {
+		id = RPMSG_RPC_INDEX_ID(table, stride, i);
+		if (id > max_id)
+			max_id = id;
+	}
+
+	if (max_id < n * RPMSG_RPC_INDEX_DENSITY) {
+		index->dense = true;
+		n_slots = max_id + 1;
+	} else {
+		/* Power of two at least twice the number of services */
+		index->shift = 32;
+		for (n_slots = 1; n_slots < 2 * n; n_slots <<= 1)
+			index->shift--;
+	}
+
+	index->slots = metal_allocate_memory(n_slots * sizeof(*index->slots));
+	if (!index->slots)
+		return;
+	memset(index->slots, 0, n_slots * sizeof(*index->slots));
+	index->n_slots = n_slots;
+
+	for (i = 0; i < n; i++) {
+		id = RPMSG_RPC_INDEX_ID(table, stride, i);
+		if (index->dense) {
+			slot = id;
+		} else {
+			slot = rpmsg_rpc_index_hash(index, id);
+			/* Linear probing, stop on a duplicated ID */
+			while (index->slots[slot] &&
+			       RPMSG_RPC_INDEX_ID(table, stride,
+						  index->slots[slot] - 1) != id)
+				slot = (slot + 1) & (n_slots - 1);
+		}
+		/* Keep the first entry of a duplicated ID */
+		if (!index->slots[slot])
+			index->slots[slot] = i + 1;
+	}
+}
+
+void rpmsg_rpc_index_free(struct rpmsg_rpc_index *index)
+{
+	if (index->slots)
+		metal_free_memory(index->slots);
+	memset(index, 0, sizeof(*index));
+}
+
+const void *rpmsg_rpc_index_find(const struct rpmsg_rpc_index *index,
+				 const void *table, size_t stride,
+				 unsigned int n, uint32_t id)
+{
+	unsigned int i, slot;
+
+	if (!index->slots) {
+		for (i = 0; i < n; i++) {
+			if (RPMSG_RPC_INDEX_ID(table, stride, i) == id)
+				return (const char *)table + i * stride;
+		}
+		return NULL;
+	}
+
+	if (index->dense) {
+		if (id >= index->n_slots || !index->slots[id])
+			return NULL;
+		i = index->slots[id] - 1;
+		return (const char *)table + i * stride;
+	}
+
+	slot = rpmsg_rpc_index_hash(index, id);
+	while (index->slots[slot]) {
+		i = index->slots[slot] - 1;
+		if (RPMSG_RPC_INDEX_ID(table, stride, i) == id)
+			return (const char *)table + i * stride;
+		slot = (slot + 1) & (index->n_slots - 1);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _RPMSG_RPC_INTERNAL_H_
+#define _RPMSG_RPC_INTERNAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <openamp/rpmsg_rpc_client_server.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal
+ *
+ * @brief Build the service ID lookup index of a service table
+ *
+ * Each entry of the table must start with its uint32_t service ID. If
+ * several entries share the same ID, the first one is used. On allocation
+ * failure the index is left empty and lookups fall back to a linear scan.
+ *
+ * @param index		Pointer to the index to build
+ * @param table		Pointer to the service table
+ * @param stride	Size of one entry of the table
+ * @param n		Number of entries in the table
+ */
+void rpmsg_rpc_index_build(struct rpmsg_rpc_index *index, const void *table,
+			   size_t stride, unsigned int n);
+
+/**
+ * @internal
+ *
+ * @brief Release the memory of a service ID lookup index
+ *
+ * @param index	Pointer to the index
+ */
+void rpmsg_rpc_index_free(struct rpmsg_rpc_index *index);
+
+/**
+ * @internal
+ *
+ * @brief Look up a service in a service table
+ *
+ * @param index		Pointer to the index of the table
+ * @param table		Pointer to the service table
+ * @param stride	Size of one entry of the table
+ * @param n		Number of entries in the table
+ * @param id		Service ID to look up
+ *
+ * @return Pointer to the table entry, NULL if the ID is not in the table.
+ */
+const void *rpmsg_rpc_index_find(const struct rpmsg_rpc_index *index,
+				 const void *table, size_t stride,
+				 unsigned int n, uint32_t id);
+
+/**
+ * @internal
+ *
+ * @brief Send an RPC message, in fragments if it does not fit one buffer
+ *
+ * The message header must start with the uint32_t service ID and
+ * correlation ID. Fragments are sent with RPMSG_RPC_SEQ_FRAG set in the
+ * correlation ID and a \ref rpmsg_rpc_frag_hdr after the message header.
+ * Sending blocks while no tx buffer is available.
+ *
+ * @param ept		Pointer to the rpmsg endpoint
+ * @param lock		Lock held while sending fragments, may be NULL
+ * @param hdr		Pointer to the message header
+ * @param hdr_len	Length of the message header
+ * @param data		Pointer to the message params
+ * @param len		Length of the message params
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_send_msg(struct rpmsg_endpoint *ept, metal_mutex_t *lock,
+		       const void *hdr, size_t hdr_len,
+		       const void *data, size_t len);
+
+/**
+ * @internal
+ *
+ * @brief Get a tx buffer to build a message in place
+ *
+ * @param ept		Pointer to the rpmsg endpoint
+ * @param hdr_len	Length of the message header
+ * @param len		Length of the message params
+ * @param wait		Wait while no tx buffer is available
+ *
+ * @return Pointer to the params area of the buffer, after room for the
+ * header, NULL if no buffer is available or the params do not fit.
+ */
+void *rpmsg_rpc_get_tx_params(struct rpmsg_endpoint *ept, size_t hdr_len,
+			      size_t len, bool wait);
+
+/**
+ * @internal
+ *
+ * @brief Release a tx buffer from rpmsg_rpc_get_tx_params() not sent
+ *
+ * @param ept		Pointer to the rpmsg endpoint
+ * @param hdr_len	Length of the message header
+ * @param params	Pointer to the params area of the buffer
+ */
+void rpmsg_rpc_release_tx_params(struct rpmsg_endpoint *ept, size_t hdr_len,
+				 void *params);
+
+/**
+ * @internal
+ *
+ * @brief Send a message built in place in a tx buffer
+ *
+ * The header is written in front of the params, which are sent without
+ * copy. The buffer is released on failure.
+ *
+ * @param ept		Pointer to the rpmsg endpoint
+ * @param hdr		Pointer to the message header
+ * @param hdr_len	Length of the message header
+ * @param params	Params area from rpmsg_rpc_get_tx_params()
+ * @param len		Length of the message params
+ *
+ * @return Number of bytes sent, negative value for failure.
+ */
+int rpmsg_rpc_send_nocopy(struct rpmsg_endpoint *ept, const void *hdr,
+			  size_t hdr_len, void *params, size_t len);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* _RPMSG_RPC_INTERNAL_H_ */
@@ -8,6 +8,8 @@
 #include <errno.h>
 #include <openamp/rpmsg_rpc_client_server.h>
 
+#include "rpmsg_rpc_internal.h"
+
 #define LPERROR(format, ...) metal_log(METAL_LOG_ERROR, format, ##__VA_ARGS__)
 
 static int rpmsg_endpoint_server_cb(struct rpmsg_endpoint *, void *,
@@ -21,54 +23,150 @@ int rpmsg_rpc_server_init(struct rpmsg_rpc_svr *rpcs, struct rpmsg_device *rdev,
 
 	rpcs->services = services;
 	rpcs->n_services = len;
+	rpcs->seq = 0;
+	rpcs->len = 0;
+	rpcs->rx_buf = NULL;
+	rpcs->rx_buf_len = 0;
+	rpcs->rx_total = 0;
+	rpmsg_rpc_index_build(&rpcs->index, services, sizeof(*services), len);
 
 	ret = rpmsg_create_ept(&rpcs->ept, rdev, RPMSG_RPC_SERVICE_NAME,
 			       RPMSG_ADDR_ANY, RPMSG_ADDR_ANY,
 			       rpmsg_endpoint_server_cb,
 			       rpmsg_service_server_unbind);
 	if (ret)
-		return ret;
+		rpmsg_rpc_index_free(&rpcs->index);
 
 	return ret;
 }
 
+void rpmsg_rpc_server_set_rx_buffer(struct rpmsg_rpc_svr *rpcs, void *buf,
+				    size_t len)
+{
+	if (!rpcs)
+		return;
+	rpcs->rx_buf = buf;
+	rpcs->rx_buf_len = buf ? len : 0;
+	rpcs->rx_total = 0;
+}
+
+void rpmsg_rpc_server_release(struct rpmsg_rpc_svr *rpcs)
+{
+	if (!rpcs)
+		return;
+	rpmsg_destroy_ept(&rpcs->ept);
+	rpmsg_rpc_index_free(&rpcs->index);
+}
+
 static const struct rpmsg_rpc_services *find_service(struct rpmsg_rpc_svr *rpcs,
 						     unsigned int id)
 {
-	const struct rpmsg_rpc_services *service;
-
-	for (unsigned int i = 0; i < rpcs->n_services; i++) {
-		service = &rpcs->services[i];
+	return rpmsg_rpc_index_find(&rpcs->index, rpcs->services,
+				    sizeof(*rpcs->services), rpcs->n_services,
+				    id);
+}
 
-		if (service->id == id) {
-			return service;
+/**
+ * @internal
+ *
+ * @brief Reassemble a fragment of a request
+ *
+ * @param rpcs	Pointer to the server rpc
+ * @param hdr	Pointer to the fragment
+ * @param len	Length of the fragment
+ *
+ * @return Pointer to the reassembled request once its last fragment is
+ * received, NULL otherwise.
+ */
+static void *rpmsg_rpc_server_rx_frag(struct rpmsg_rpc_svr *rpcs,
+				      struct rpmsg_rpc_req_hdr *hdr,
+				      size_t len)
+{
+	struct rpmsg_rpc_req_hdr *req;
+	struct rpmsg_rpc_frag_hdr frag;
+	uint32_t seq = hdr->seq & ~RPMSG_RPC_SEQ_FRAG;
+	unsigned char *chunk;
+	size_t chunk_len;
+
+	if (len < sizeof(*hdr) + sizeof(frag))
+		return NULL;
+	memcpy(&frag, hdr + 1, sizeof(frag));
+	chunk = (unsigned char *)(hdr + 1) + sizeof(frag);
+	chunk_len = len - sizeof(*hdr) - sizeof(frag);
+
+	if (frag.offset == 0) {
+		if (rpcs->rx_total)
+			LPERROR("Dropping incomplete request: rpc id %u\r\n",
+				(unsigned int)hdr->id);
+		rpcs->rx_total = 0;
+		if (!frag.total ||
+		    rpcs->rx_buf_len < sizeof(*req) ||
+		    frag.total > rpcs->rx_buf_len - sizeof(*req)) {
+			rpcs->seq = seq;
+			rpmsg_rpc_server_send(rpcs, hdr->id,
+					      RPMSG_RPC_MSG_TOO_BIG, NULL, 0);
+			return NULL;
 		}
+		req = rpcs->rx_buf;
+		req->id = hdr->id;
+		req->seq = seq;
+		rpcs->rx_seq = seq;
+		rpcs->rx_off = 0;
+		rpcs->rx_total = frag.total;
+	} else if (!rpcs->rx_total || seq != rpcs->rx_seq ||
+		   frag.offset != rpcs->rx_off) {
+		/* Remaining fragments of a refused or broken request */
+		return NULL;
 	}
-	return NULL;
+
+	if (chunk_len > rpcs->rx_total - rpcs->rx_off) {
+		rpcs->rx_total = 0;
+		return NULL;
+	}
+
+	req = rpcs->rx_buf;
+	memcpy((unsigned char *)(req + 1) + rpcs->rx_off, chunk, chunk_len);
+	rpcs->rx_off += chunk_len;
+	if (rpcs->rx_off < rpcs->rx_total)
+		return NULL;
+
+	rpcs->rx_total = 0;
+	return req;
 }
 
 static int rpmsg_endpoint_server_cb(struct rpmsg_endpoint *ept, void *data,
 				    size_t len,
 				    uint32_t src, void *priv)
 {
-	unsigned char buf[MAX_BUF_LEN];
+	struct rpmsg_rpc_req_hdr *hdr = data;
 	unsigned int id;
 	const struct rpmsg_rpc_services *service;
 	struct rpmsg_rpc_svr *rpcs;
 	(void)priv;
 	(void)src;
 
-	if (len > MAX_BUF_LEN)
+	if (len < MAX_FUNC_ID_LEN)
 		return -EINVAL;
 
 	rpcs = metal_container_of(ept, struct rpmsg_rpc_svr, ept);
 
-	memcpy(buf, data, len);
-	id = *buf;
+	if (hdr->seq & RPMSG_RPC_SEQ_FRAG) {
+		data = rpmsg_rpc_server_rx_frag(rpcs, hdr, len);
+		if (!data)
+			return RPMSG_SUCCESS;
+		hdr = data;
+		len = sizeof(*hdr) + rpcs->rx_off;
+	}
+
+	/* Decode the request in place in the receive buffer */
+	id = hdr->id;
+	/* The answer sent by the service echoes the correlation ID */
+	rpcs->seq = hdr->seq;
+	rpcs->len = len;
 	service = find_service(rpcs, id);
 
 	if (service) {
-		if (service->cb_function(buf, rpcs)) {
+		if (service->cb_function(data, rpcs)) {
 			LPERROR("Service failed at rpc id: %ld\r\n", id);
 		}
 	} else {
@@ -83,16 +181,52 @@ int rpmsg_rpc_server_send(struct rpmsg_rpc_svr *rpcs, uint32_t rpc_id,
 			  int status, void *request_param, size_t param_size)
 {
 	struct rpmsg_endpoint *ept = &rpcs->ept;
-	struct rpmsg_rpc_answer msg;
+	struct rpmsg_rpc_answer_hdr msg;
 
 	if (!ept)
 		return -EINVAL;
-	if (param_size > (MAX_BUF_LEN - sizeof(msg.status)))
+
+	msg.id = rpc_id;
+	msg.seq = rpcs->seq;
+	msg.status = status;
+
+	return rpmsg_rpc_send_msg(ept, NULL, &msg, sizeof(msg),
+				  request_param, param_size);
+}
+
+void *rpmsg_rpc_server_get_tx_params(struct rpmsg_rpc_svr *rpcs, size_t len,
+				     bool wait)
+{
+	if (!rpcs)
+		return NULL;
+
+	return rpmsg_rpc_get_tx_params(&rpcs->ept,
+				       sizeof(struct rpmsg_rpc_answer_hdr), len,
+				       wait);
+}
+
+void rpmsg_rpc_server_release_tx_params(struct rpmsg_rpc_svr *rpcs,
+					void *params)
+{
+	if (!rpcs || !params)
+		return;
+
+	rpmsg_rpc_release_tx_params(&rpcs->ept,
+				    sizeof(struct rpmsg_rpc_answer_hdr), params);
+}
+
+int rpmsg_rpc_server_send_nocopy(struct rpmsg_rpc_svr *rpcs, uint32_t rpc_id,
+				 int status, void *params, size_t len)
+{
+	struct rpmsg_rpc_answer_hdr msg;
+
+	if (!rpcs || !params)
 		return -EINVAL;
 
 	msg.id = rpc_id;
+	msg.seq = rpcs->seq;
 	msg.status = status;
-	memcpy(msg.params, request_param, param_size);
 
-	return rpmsg_send(ept, &msg, MAX_FUNC_ID_LEN + param_size);
+	return rpmsg_rpc_send_nocopy(&rpcs->ept, &msg, sizeof(msg), params,
+				     len);
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <metal/utilities.h>
+#include <openamp/rpmsg_virtio.h>
+#include <string.h>
+
+#include "rpmsg_rpc_internal.h"
+
+static int rpmsg_rpc_send_buf(struct rpmsg_endpoint *ept,
+			      const void *hdr, size_t hdr_len,
+			      const struct rpmsg_rpc_frag_hdr *frag,
+			      const void *data, size_t len)
+{
+	struct rpmsg_rpc_req_hdr *msg_hdr;
+	unsigned char *buf;
+	uint32_t buf_len;
+	size_t off;
+	int ret;
+
+	buf = rpmsg_get_tx_payload_buffer(ept, &buf_len, true);
+	if (!buf)
+		return RPMSG_ERR_NO_BUFF;
+
+	off = hdr_len + (frag ? sizeof(*frag) : 0);
+	if (off + len > buf_len) {
+		rpmsg_release_tx_buffer(ept, buf);
+		return RPMSG_ERR_BUFF_SIZE;
+	}
+
+	memcpy(buf, hdr, hdr_len);
+	if (frag) {
+		msg_hdr = (struct rpmsg_rpc_req_hdr *)buf;
+		msg_hdr->seq |= RPMSG_RPC_SEQ_FRAG;
+		memcpy(buf + hdr_len, frag, sizeof(*frag));
+	}
+	if (len)
+		memcpy(buf + off, data, len);
+
+	ret = rpmsg_send_nocopy(ept, buf, off + len);
+	if (ret < 0)
+		rpmsg_release_tx_buffer(ept, buf);
+
+	return ret;
+}
+
+int rpmsg_rpc_send_msg(struct rpmsg_endpoint *ept, metal_mutex_t *lock,
+		       const void *hdr, size_t hdr_len,
+		       const void *data, size_t len)
+{
+	struct rpmsg_rpc_frag_hdr frag;
+	size_t chunk;
+	int buf_size;
+	int ret = 0;
+
+	if (!is_rpmsg_ept_ready(ept))
+		return RPMSG_ERR_ADDR;
+
+	buf_size = rpmsg_virtio_get_tx_buffer_size(ept->rdev);
+	if (buf_size < 0)
+		return buf_size;
+
+	if (hdr_len + len <= (size_t)buf_size)
+		return rpmsg_rpc_send_buf(ept, hdr, hdr_len, NULL, data, len);
+
+	if ((size_t)buf_size <= hdr_len + sizeof(frag) || len > UINT32_MAX)
+		return -EINVAL;
+	chunk = buf_size - hdr_len - sizeof(frag);
+
+	if (lock)
+		metal_mutex_acquire(lock);
+	frag.total = len;
+	for (frag.offset = 0; frag.offset < len; frag.offset += chunk) {
+		ret = rpmsg_rpc_send_buf(ept, hdr, hdr_len, &frag,
+					 (const char *)data + frag.offset,
+					 metal_min(chunk, len - frag.offset));
+		if (ret < 0)
+			break;
+	}
+	if (lock)
+		metal_mutex_release(lock);
+
+	return ret < 0 ? ret : (int)(hdr_len + len);
+}
+
+void *rpmsg_rpc_get_tx_params(struct rpmsg_endpoint *ept, size_t hdr_len,
+			      size_t len, bool wait)
+{
+	unsigned char *buf;
+	uint32_t buf_len;
+
+	buf = rpmsg_get_tx_payload_buffer(ept, &buf_len, wait);
+	if (!buf)
+		return NULL;
+
+	if (hdr_len + len > buf_len) {
+		rpmsg_release_tx_buffer(ept, buf);
+		return NULL;
+	}
+
+	return buf + hdr_len;
+}
+
+void rpmsg_rpc_release_tx_params(struct rpmsg_endpoint *ept, size_t hdr_len,
+				 void *params)
+{
+	rpmsg_release_tx_buffer(ept, (unsigned char *)params - hdr_len);
+}
+
+int rpmsg_rpc_send_nocopy(struct rpmsg_endpoint *ept, const void *hdr,
+			  size_t hdr_len, void *params, size_t len)
+{
+	unsigned char *buf = (unsigned char *)params - hdr_len;
+	int ret;
+
+	memcpy(buf, hdr, hdr_len);
+	ret = rpmsg_send_nocopy(ept, buf, hdr_len + len);
+	if (ret < 0)
+		rpmsg_release_tx_buffer(ept, buf);
+
+	return ret;
+}
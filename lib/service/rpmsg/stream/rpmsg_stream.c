@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <metal/utilities.h>
+#include <openamp/rpmsg_stream.h>
+#include <string.h>
+
+/* Consumed buffers worth a CREDIT message of their own */
+#define RPMSG_STREAM_CREDIT_THRESHOLD \
+	(RPMSG_STREAM_WINDOW > 1 ? RPMSG_STREAM_WINDOW / 2 : 1)
+
+static int rpmsg_stream_ept_cb(struct rpmsg_endpoint *ept, void *data,
+			       size_t len, uint32_t src, void *priv);
+
+static void rpmsg_stream_init(struct rpmsg_stream *s, int state)
+{
+	s->state = state;
+	metal_spinlock_init(&s->lock);
+	s->rx_head = 0;
+	s->rx_tail = 0;
+	s->rx_off = 0;
+	s->fwd_cnt = 0;
+	s->fwd_sent = 0;
+	s->tx_buf = NULL;
+	s->tx_len = 0;
+	s->tx_size = 0;
+	s->tx_cnt = 0;
+	s->peer_buf_alloc = 0;
+	s->peer_fwd_cnt = 0;
+}
+
+static void rpmsg_stream_event(struct rpmsg_stream *s, int event)
+{
+	if (s->event_cb)
+		s->event_cb(s, event);
+}
+
+static int rpmsg_stream_send_ctrl(struct rpmsg_stream *s, uint16_t type,
+				  uint32_t dst, bool wait)
+{
+	struct rpmsg_stream_hdr hdr;
+	int ret;
+
+	hdr.type = type;
+	hdr.reserved = 0;
+	hdr.buf_alloc = RPMSG_STREAM_WINDOW;
+	hdr.fwd_cnt = s->fwd_cnt;
+	if (wait)
+		ret = rpmsg_sendto(&s->ept, &hdr, sizeof(hdr), dst);
+	else
+		ret = rpmsg_trysendto(&s->ept, &hdr, sizeof(hdr), dst);
+	if (ret < 0)
+		return ret;
+	s->fwd_sent = hdr.fwd_cnt;
+
+	return 0;
+}
+
+/*
+ * Return the credit of the consumed buffers once worth it, without
+ * waiting for a TX buffer: if none is free, the credit stays owed and the
+ * next write, flush, peek or consume retries. Once every received buffer
+ * is consumed, the peer may have nothing left to send until it gets the
+ * credit, so it is then sent waiting for a TX buffer.
+ */
+static void rpmsg_stream_send_credit(struct rpmsg_stream *s)
+{
+	bool idle;
+
+	if (s->state != RPMSG_STREAM_CONNECTED ||
+	    s->fwd_cnt - s->fwd_sent < RPMSG_STREAM_CREDIT_THRESHOLD)
+		return;
+	if (!rpmsg_stream_send_ctrl(s, RPMSG_STREAM_CREDIT, s->ept.dest_addr,
+				    false))
+		return;
+
+	metal_spinlock_acquire(&s->lock);
+	idle = s->rx_tail == s->rx_head;
+	metal_spinlock_release(&s->lock);
+	if (idle)
+		rpmsg_stream_send_ctrl(s, RPMSG_STREAM_CREDIT,
+				       s->ept.dest_addr, true);
+}
+
+static void rpmsg_stream_unbind(struct rpmsg_endpoint *ept)
+{
+	struct rpmsg_stream *s = metal_container_of(ept, struct rpmsg_stream,
+						    ept);
+
+	if (s->state == RPMSG_STREAM_CONNECTING ||
+	    s->state == RPMSG_STREAM_CONNECTED) {
+		s->state = RPMSG_STREAM_PEER_CLOSED;
+		rpmsg_stream_event(s, RPMSG_STREAM_EV_CLOSED);
+	}
+}
+
+static void rpmsg_stream_accept(struct rpmsg_stream *ls,
+				struct rpmsg_stream_hdr *hdr, uint32_t src)
+{
+	struct rpmsg_stream *s = NULL;
+
+	if (ls->accept_cb)
+		s = ls->accept_cb(ls, src);
+	if (!s) {
+		rpmsg_stream_send_ctrl(ls, RPMSG_STREAM_RESET, src, true);
+		return;
+	}
+
+	rpmsg_stream_init(s, RPMSG_STREAM_CONNECTED);
+	if (!s->event_cb)
+		s->event_cb = ls->event_cb;
+	s->peer_buf_alloc = hdr->buf_alloc;
+	s->peer_fwd_cnt = hdr->fwd_cnt;
+	if (rpmsg_create_ept(&s->ept, ls->ept.rdev, ls->ept.name,
+			     RPMSG_ADDR_ANY, src, rpmsg_stream_ept_cb,
+			     rpmsg_stream_unbind)) {
+		s->state = RPMSG_STREAM_CLOSED;
+		rpmsg_stream_send_ctrl(ls, RPMSG_STREAM_RESET, src, true);
+		return;
+	}
+
+	/* The peer learns the address of the connection from the answer */
+	if (rpmsg_stream_send_ctrl(s, RPMSG_STREAM_ACCEPT, src, true)) {
+		rpmsg_destroy_ept(&s->ept);
+		s->state = RPMSG_STREAM_CLOSED;
+		return;
+	}
+	rpmsg_stream_event(s, RPMSG_STREAM_EV_CONNECTED);
+}
+
+static int rpmsg_stream_ept_cb(struct rpmsg_endpoint *ept, void *data,
+			       size_t len, uint32_t src, void *priv)
+{
+	struct rpmsg_stream *s = metal_container_of(ept, struct rpmsg_stream,
+						    ept);
+	struct rpmsg_stream_hdr *hdr = data;
+	struct rpmsg_stream_seg *seg;
+	bool full;
+	int event = 0;
+
+	(void)priv;
+	if (len < sizeof(*hdr))
+		return RPMSG_SUCCESS;
+
+	if (s->state == RPMSG_STREAM_LISTEN) {
+		if (hdr->type == RPMSG_STREAM_CONNECT)
+			rpmsg_stream_accept(s, hdr, src);
+		return RPMSG_SUCCESS;
+	}
+
+	if (hdr->type == RPMSG_STREAM_DATA) {
+		if (s->state != RPMSG_STREAM_CONNECTED || len == sizeof(*hdr))
+			return RPMSG_SUCCESS;
+		/* Only this callback fills the ring */
+		metal_spinlock_acquire(&s->lock);
+		full = s->rx_head - s->rx_tail == RPMSG_STREAM_WINDOW;
+		metal_spinlock_release(&s->lock);
+		if (full)
+			/* Beyond the window advertised to the peer */
+			return RPMSG_SUCCESS;
+		rpmsg_hold_rx_buffer(ept, data);
+	}
+
+	metal_spinlock_acquire(&s->lock);
+	s->peer_buf_alloc = hdr->buf_alloc;
+	s->peer_fwd_cnt = hdr->fwd_cnt;
+	switch (hdr->type) {
+	case RPMSG_STREAM_DATA:
+		seg = &s->rx[s->rx_head % RPMSG_STREAM_WINDOW];
+		seg->buf = data;
+		seg->len = len - sizeof(*hdr);
+		s->rx_head++;
+		event = RPMSG_STREAM_EV_READABLE;
+		break;
+	case RPMSG_STREAM_CREDIT:
+		event = RPMSG_STREAM_EV_WRITABLE;
+		break;
+	case RPMSG_STREAM_ACCEPT:
+		if (s->state == RPMSG_STREAM_CONNECTING) {
+			ept->dest_addr = src;
+			s->state = RPMSG_STREAM_CONNECTED;
+			event = RPMSG_STREAM_EV_CONNECTED;
+		}
+		break;
+	case RPMSG_STREAM_CLOSE:
+	case RPMSG_STREAM_RESET:
+		if (s->state == RPMSG_STREAM_CONNECTING ||
+		    s->state == RPMSG_STREAM_CONNECTED) {
+			s->state = RPMSG_STREAM_PEER_CLOSED;
+			event = RPMSG_STREAM_EV_CLOSED;
+		}
+		break;
+	default:
+		break;
+	}
+	metal_spinlock_release(&s->lock);
+
+	if (event)
+		rpmsg_stream_event(s, event);
+
+	return RPMSG_SUCCESS;
+}
+
+int rpmsg_stream_listen(struct rpmsg_stream *ls, struct rpmsg_device *rdev,
+			const char *name, rpmsg_stream_accept_cb accept_cb,
+			rpmsg_stream_event_cb event_cb)
+{
+	int ret;
+
+	if (!ls || !rdev || !name || !accept_cb)
+		return -EINVAL;
+
+	rpmsg_stream_init(ls, RPMSG_STREAM_LISTEN);
+	ls->accept_cb = accept_cb;
+	ls->event_cb = event_cb;
+	ret = rpmsg_create_ept(&ls->ept, rdev, name, RPMSG_ADDR_ANY,
+			       RPMSG_ADDR_ANY, rpmsg_stream_ept_cb,
+			       rpmsg_stream_unbind);
+	if (ret)
+		ls->state = RPMSG_STREAM_CLOSED;
+
+	return ret;
+}
+
+int rpmsg_stream_connect(struct rpmsg_stream *s, struct rpmsg_device *rdev,
+			 const char *name, uint32_t dest,
+			 rpmsg_stream_event_cb event_cb)
+{
+	int ret;
+
+	if (!s || !rdev || !name || dest == RPMSG_ADDR_ANY)
+		return -EINVAL;
+
+	rpmsg_stream_init(s, RPMSG_STREAM_CONNECTING);
+	s->accept_cb = NULL;
+	s->event_cb = event_cb;
+	ret = rpmsg_create_ept(&s->ept, rdev, name, RPMSG_ADDR_ANY, dest,
+			       rpmsg_stream_ept_cb, rpmsg_stream_unbind);
+	if (ret) {
+		s->state = RPMSG_STREAM_CLOSED;
+		return ret;
+	}
+
+	ret = rpmsg_stream_send_ctrl(s, RPMSG_STREAM_CONNECT, dest, true);
+	if (ret) {
+		rpmsg_destroy_ept(&s->ept);
+		s->state = RPMSG_STREAM_CLOSED;
+	}
+
+	return ret;
+}
+
+static int rpmsg_stream_send_buf(struct rpmsg_stream *s)
+{
+	struct rpmsg_stream_hdr *hdr = (struct rpmsg_stream_hdr *)s->tx_buf;
+	int ret;
+
+	hdr->type = RPMSG_STREAM_DATA;
+	hdr->reserved = 0;
+	hdr->buf_alloc = RPMSG_STREAM_WINDOW;
+	hdr->fwd_cnt = s->fwd_cnt;
+	ret = rpmsg_send_nocopy(&s->ept, s->tx_buf, sizeof(*hdr) + s->tx_len);
+	if (ret < 0)
+		return ret;
+	s->fwd_sent = hdr->fwd_cnt;
+	s->tx_buf = NULL;
+
+	return 0;
+}
+
+int rpmsg_stream_write(struct rpmsg_stream *s, const void *data,
+		       uint32_t len)
+{
+	uint32_t done = 0, size, chunk;
+	bool credit;
+	char *buf;
+	int ret;
+
+	if (!s || (!data && len))
+		return -EINVAL;
+	if (s->state == RPMSG_STREAM_CONNECTING)
+		return -ENOTCONN;
+	if (s->state != RPMSG_STREAM_CONNECTED)
+		return -EPIPE;
+
+	/* Data sent below carries the credit, unless it runs out of buffers */
+	rpmsg_stream_send_credit(s);
+
+	while (done < len) {
+		if (!s->tx_buf) {
+			/* Each buffer takes one credit, taken when started */
+			metal_spinlock_acquire(&s->lock);
+			credit = s->tx_cnt - s->peer_fwd_cnt < s->peer_buf_alloc;
+			metal_spinlock_release(&s->lock);
+			if (!credit)
+				break;
+			buf = rpmsg_get_tx_payload_buffer(&s->ept, &size, 0);
+			if (!buf)
+				break;
+			if (size <= sizeof(struct rpmsg_stream_hdr)) {
+				rpmsg_release_tx_buffer(&s->ept, buf);
+				return -ENOBUFS;
+			}
+			s->tx_buf = buf;
+			s->tx_len = 0;
+			s->tx_size = size - sizeof(struct rpmsg_stream_hdr);
+			s->tx_cnt++;
+		}
+
+		chunk = metal_min(len - done, s->tx_size - s->tx_len);
+		memcpy(s->tx_buf + sizeof(struct rpmsg_stream_hdr) + s->tx_len,
+		       (const char *)data + done, chunk);
+		s->tx_len += chunk;
+		done += chunk;
+
+		if (s->tx_len == s->tx_size) {
+			ret = rpmsg_stream_send_buf(s);
+			if (ret)
+				return done ? (int)done : ret;
+		}
+	}
+
+	return done || !len ? (int)done : -EAGAIN;
+}
+
+int rpmsg_stream_flush(struct rpmsg_stream *s)
+{
+	if (!s)
+		return -EINVAL;
+	rpmsg_stream_send_credit(s);
+	if (!s->tx_buf || !s->tx_len)
+		return 0;
+
+	return rpmsg_stream_send_buf(s);
+}
+
+int rpmsg_stream_peek(struct rpmsg_stream *s, void **data)
+{
+	struct rpmsg_stream_seg *seg;
+	int len;
+
+	if (!s || !data)
+		return -EINVAL;
+
+	metal_spinlock_acquire(&s->lock);
+	if (s->rx_tail == s->rx_head) {
+		metal_spinlock_release(&s->lock);
+		rpmsg_stream_send_credit(s);
+		return s->state == RPMSG_STREAM_CONNECTED ||
+		       s->state == RPMSG_STREAM_CONNECTING ? -EAGAIN : 0;
+	}
+	seg = &s->rx[s->rx_tail % RPMSG_STREAM_WINDOW];
+	*data = seg->buf + sizeof(struct rpmsg_stream_hdr) + s->rx_off;
+	len = seg->len - s->rx_off;
+	metal_spinlock_release(&s->lock);
+
+	return len;
+}
+
+void rpmsg_stream_consume(struct rpmsg_stream *s, uint32_t len)
+{
+	struct rpmsg_stream_seg *seg;
+	uint32_t chunk;
+	char *buf;
+
+	if (!s)
+		return;
+
+	while (len) {
+		buf = NULL;
+		metal_spinlock_acquire(&s->lock);
+		if (s->rx_tail == s->rx_head) {
+			metal_spinlock_release(&s->lock);
+			break;
+		}
+		seg = &s->rx[s->rx_tail % RPMSG_STREAM_WINDOW];
+		chunk = metal_min(len, seg->len - s->rx_off);
+		s->rx_off += chunk;
+		len -= chunk;
+		if (s->rx_off == seg->len) {
+			buf = seg->buf;
+			s->rx_tail++;
+			s->rx_off = 0;
+			s->fwd_cnt++;
+		}
+		metal_spinlock_release(&s->lock);
+
+		if (buf)
+			rpmsg_release_rx_buffer(&s->ept, buf);
+	}
+
+	/* Without data going back, return the credit once worth it */
+	rpmsg_stream_send_credit(s);
+}
+
+int rpmsg_stream_read(struct rpmsg_stream *s, void *buf, uint32_t len)
+{
+	uint32_t done = 0, chunk;
+	void *data;
+	int ret;
+
+	if (!s || !buf)
+		return -EINVAL;
+
+	while (done < len) {
+		ret = rpmsg_stream_peek(s, &data);
+		if (ret <= 0)
+			return done ? (int)done : ret;
+		chunk = metal_min(len - done, (uint32_t)ret);
+		memcpy((char *)buf + done, data, chunk);
+		rpmsg_stream_consume(s, chunk);
+		done += chunk;
+	}
+
+	return done;
+}
+
+void rpmsg_stream_close(struct rpmsg_stream *s)
+{
+	if (!s || s->state == RPMSG_STREAM_CLOSED)
+		return;
+
+	if (s->state == RPMSG_STREAM_CONNECTED) {
+		rpmsg_stream_flush(s);
+		rpmsg_stream_send_ctrl(s, RPMSG_STREAM_CLOSE, s->ept.dest_addr,
+				       true);
+	}
+	if (s->tx_buf) {
+		rpmsg_release_tx_buffer(&s->ept, s->tx_buf);
+		s->tx_buf = NULL;
+	}
+
+	/* Drop the received data not consumed */
+	while (s->rx_tail != s->rx_head) {
+		rpmsg_release_rx_buffer(&s->ept,
+					s->rx[s->rx_tail %
+					      RPMSG_STREAM_WINDOW].buf);
+		s->rx_tail++;
+	}
+
+	rpmsg_destroy_ept(&s->ept);
+	s->state = RPMSG_STREAM_CLOSED;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/cpu.h>
+#include <metal/errno.h>
+#include <metal/log.h>
+#include <metal/utilities.h>
+#include <openamp/virtio_blk.h>
+
+/* Features used by the front end, event index saves notifications */
+#define VIRTIO_BLK_FEATURES	((1 << VIRTIO_BLK_F_RO) | \
+				 (1 << VIRTIO_BLK_F_BLK_SIZE) | \
+				 (1 << VIRTIO_BLK_F_FLUSH) | \
+				 VIRTIO_RING_F_EVENT_IDX)
+
+/*
+ * Runs in the transport interrupt context, concurrently with the request
+ * functions: the virtqueue is left to virtio_blk_poll().
+ */
+static void virtio_blk_vq_callback(struct virtqueue *vq)
+{
+	struct virtio_blk *blk = vq->vq_dev->priv;
+
+	if (blk && blk->done_cb)
+		blk->done_cb(blk);
+}
+
+int virtio_blk_init(struct virtio_blk *blk, struct virtio_device *vdev)
+{
+	const char *names[] = { "requests" };
+	vq_callback callbacks[] = { virtio_blk_vq_callback };
+	uint32_t features = 0;
+	uint8_t status = 0;
+	int ret;
+
+	if (!blk || !vdev || vdev->role != VIRTIO_DEV_DRIVER ||
+	    vdev->id.device != VIRTIO_ID_BLOCK)
+		return -EINVAL;
+
+	blk->vdev = vdev;
+	blk->vq = NULL;
+	blk->inflight = 0;
+	blk->completed = 0;
+	vdev->priv = blk;
+
+	ret = virtio_get_status(vdev, &status);
+	if (ret)
+		return ret;
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER);
+
+	/* Transports negotiating in get_features() offer the preset features */
+	vdev->features = (vdev->features & ~0xffffffffULL) | VIRTIO_BLK_FEATURES;
+	virtio_get_features(vdev, &features);
+	ret = virtio_set_features(vdev, features & VIRTIO_BLK_FEATURES);
+	if (ret)
+		return ret;
+
+	ret = virtio_read_config(vdev, 0, &blk->capacity,
+				 sizeof(blk->capacity));
+	if (ret)
+		return ret;
+	blk->blk_size = VIRTIO_BLK_SECTOR_SIZE;
+	if (vdev->features & (1 << VIRTIO_BLK_F_BLK_SIZE))
+		virtio_read_config(vdev,
+				   metal_offset_of(struct virtio_blk_config,
+						   blk_size),
+				   &blk->blk_size, sizeof(blk->blk_size));
+	blk->ro = !!(vdev->features & (1 << VIRTIO_BLK_F_RO));
+
+	ret = virtio_create_virtqueues(vdev, 0, 1, names, callbacks, NULL);
+	if (ret)
+		return ret;
+	blk->vq = vdev->vrings_info[0].vq;
+
+	virtio_get_status(vdev, &status);
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER_OK);
+	metal_log(METAL_LOG_DEBUG, "virtio_blk: %llu sectors%s\r\n",
+		  (unsigned long long)blk->capacity, blk->ro ? ", ro" : "");
+
+	return 0;
+}
+
+void virtio_blk_deinit(struct virtio_blk *blk)
+{
+	if (!blk || !blk->vdev)
+		return;
+
+	virtio_reset_device(blk->vdev);
+	virtio_delete_virtqueues(blk->vdev);
+	blk->vdev->priv = NULL;
+	blk->vq = NULL;
+	blk->vdev = NULL;
+}
+
+int virtio_blk_submit(struct virtio_blk *blk, struct virtio_blk_req *req,
+		      uint32_t type, uint64_t sector, void *buf, uint32_t len)
+{
+	struct virtqueue_buf vb[VIRTIO_BLK_REQ_DESCS];
+	int readable = 1, writable = 1, num = 0;
+	int ret;
+
+	if (!blk || !blk->vq || !req)
+		return -EINVAL;
+
+	switch (type) {
+	case VIRTIO_BLK_T_IN:
+	case VIRTIO_BLK_T_OUT:
+		if (!buf || !len || len % VIRTIO_BLK_SECTOR_SIZE ||
+		    sector + len / VIRTIO_BLK_SECTOR_SIZE > blk->capacity)
+			return -EINVAL;
+		if (type == VIRTIO_BLK_T_OUT && blk->ro)
+			return -EROFS;
+		break;
+	case VIRTIO_BLK_T_GET_ID:
+		if (!buf || len < VIRTIO_BLK_ID_BYTES)
+			return -EINVAL;
+		break;
+	case VIRTIO_BLK_T_FLUSH:
+		buf = NULL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* The ring checks its space in debug builds only */
+	if (blk->vq->vq_free_cnt < (buf ? 3 : 2))
+		return -EAGAIN;
+
+	req->hdr.type = type;
+	req->hdr.reserved = 0;
+	req->hdr.sector = sector;
+	req->status = VIRTIO_BLK_S_IOERR;
+	req->result = -EBUSY;
+
+	/* Readable descriptors first: header, then data to write */
+	vb[num].buf = &req->hdr;
+	vb[num++].len = sizeof(req->hdr);
+	if (buf) {
+		vb[num].buf = buf;
+		vb[num++].len = len;
+		if (type == VIRTIO_BLK_T_OUT)
+			readable++;
+		else
+			writable++;
+	}
+	vb[num].buf = &req->status;
+	vb[num++].len = sizeof(req->status);
+
+	ret = virtqueue_add_buffer(blk->vq, vb, readable, writable, req);
+	if (ret)
+		return ret;
+	blk->inflight++;
+
+	return 0;
+}
+
+void virtio_blk_kick(struct virtio_blk *blk)
+{
+	if (blk && blk->vq)
+		virtqueue_kick(blk->vq);
+}
+
+int virtio_blk_poll(struct virtio_blk *blk)
+{
+	struct virtio_blk_req *req;
+	uint32_t len;
+	int num = 0;
+
+	if (!blk || !blk->vq)
+		return 0;
+
+	do {
+		while ((req = virtqueue_get_buffer(blk->vq, &len, NULL))) {
+			switch (req->status) {
+			case VIRTIO_BLK_S_OK:
+				req->result = 0;
+				break;
+			case VIRTIO_BLK_S_UNSUPP:
+				req->result = -ENOTSUP;
+				break;
+			default:
+				req->result = -EIO;
+				break;
+			}
+			blk->inflight--;
+			blk->completed++;
+			num++;
+			if (req->done)
+				req->done(req);
+		}
+		/* Ask for the next interrupt, unless completions came meanwhile */
+	} while (virtqueue_enable_cb(blk->vq));
+
+	return num;
+}
+
+int virtio_blk_transfer(struct virtio_blk *blk, struct virtio_blk_req *req,
+			uint32_t type, uint64_t sector, void *buf,
+			uint32_t len)
+{
+	int ret;
+
+	ret = virtio_blk_submit(blk, req, type, sector, buf, len);
+	if (ret)
+		return ret;
+	virtio_blk_kick(blk);
+
+	while (req->result == -EBUSY) {
+		virtio_blk_poll(blk);
+		metal_cpu_yield();
+	}
+
+	return req->result;
+}
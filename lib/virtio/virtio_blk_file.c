@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <metal/log.h>
+#include <openamp/virtio_blk_file.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+int virtio_blk_file_open(struct virtio_blk_file *bf, const char *path,
+			 bool ro)
+{
+	struct stat st;
+	const char *name;
+	int ret;
+
+	if (!bf || !path)
+		return -EINVAL;
+
+	bf->fd = open(path, (ro ? O_RDONLY : O_RDWR) | O_CLOEXEC);
+	if (bf->fd < 0) {
+		ret = -errno;
+		metal_log(METAL_LOG_ERROR, "failed to open %s: %d\r\n",
+			  path, ret);
+		return ret;
+	}
+	if (fstat(bf->fd, &st)) {
+		ret = -errno;
+		close(bf->fd);
+		bf->fd = -1;
+		return ret;
+	}
+
+	bf->capacity = st.st_size / VIRTIO_BLK_SECTOR_SIZE;
+	bf->ro = ro;
+	bf->requests = 0;
+	bf->errors = 0;
+	name = strrchr(path, '/');
+	memset(bf->id, 0, sizeof(bf->id));
+	strncpy(bf->id, name ? name + 1 : path, sizeof(bf->id));
+
+	return 0;
+}
+
+void virtio_blk_file_close(struct virtio_blk_file *bf)
+{
+	if (bf && bf->fd >= 0) {
+		close(bf->fd);
+		bf->fd = -1;
+	}
+}
+
+uint32_t virtio_blk_file_get_config(struct virtio_blk_file *bf,
+				    struct virtio_blk_config *config)
+{
+	uint32_t features = (1 << VIRTIO_BLK_F_SEG_MAX) |
+			    (1 << VIRTIO_BLK_F_BLK_SIZE) |
+			    (1 << VIRTIO_BLK_F_FLUSH);
+
+	memset(config, 0, sizeof(*config));
+	config->capacity = bf->capacity;
+	config->seg_max = VIRTIO_BLK_FILE_SEG_MAX;
+	config->blk_size = VIRTIO_BLK_SECTOR_SIZE;
+	if (bf->ro)
+		features |= 1 << VIRTIO_BLK_F_RO;
+
+	return features;
+}
+
+/* Execute one request, returns its status */
+static uint8_t virtio_blk_file_exec(struct virtio_blk_file *bf,
+				    const struct virtio_blk_outhdr *hdr,
+				    struct iovec *iov, int iovcnt,
+				    uint32_t *written)
+{
+	off_t off = (off_t)(hdr->sector * VIRTIO_BLK_SECTOR_SIZE);
+	size_t len = 0;
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+
+	switch (hdr->type) {
+	case VIRTIO_BLK_T_IN:
+	case VIRTIO_BLK_T_OUT:
+		if (len % VIRTIO_BLK_SECTOR_SIZE ||
+		    hdr->sector + len / VIRTIO_BLK_SECTOR_SIZE > bf->capacity)
+			return VIRTIO_BLK_S_IOERR;
+		if (hdr->type == VIRTIO_BLK_T_IN) {
+			ret = preadv(bf->fd, iov, iovcnt, off);
+			if (ret >= 0)
+				*written = ret;
+		} else if (bf->ro) {
+			return VIRTIO_BLK_S_IOERR;
+		} else {
+			ret = pwritev(bf->fd, iov, iovcnt, off);
+		}
+		return ret == (ssize_t)len ? VIRTIO_BLK_S_OK : VIRTIO_BLK_S_IOERR;
+	case VIRTIO_BLK_T_FLUSH:
+		return fdatasync(bf->fd) ? VIRTIO_BLK_S_IOERR : VIRTIO_BLK_S_OK;
+	case VIRTIO_BLK_T_GET_ID:
+		if (!iovcnt || !iov[0].iov_base ||
+		    iov[0].iov_len < VIRTIO_BLK_ID_BYTES)
+			return VIRTIO_BLK_S_IOERR;
+		memcpy(iov[0].iov_base, bf->id, VIRTIO_BLK_ID_BYTES);
+		*written = VIRTIO_BLK_ID_BYTES;
+		return VIRTIO_BLK_S_OK;
+	default:
+		return VIRTIO_BLK_S_UNSUPP;
+	}
+}
+
+/*
+ * Walk the chain of one request: header, data descriptors, status byte.
+ * Executes the request if the chain is well formed and writes its status,
+ * returns the status byte or NULL if the chain has no usable one.
+ */
+static uint8_t *virtio_blk_file_request(struct virtio_blk_file *bf,
+					struct virtqueue *vq, uint16_t head,
+					const struct virtio_blk_outhdr *hdr,
+					uint32_t len, uint32_t *written)
+{
+	struct iovec iov[VIRTIO_BLK_FILE_SEG_MAX];
+	uint16_t idx, prev = VQ_RING_DESC_CHAIN_END;
+	uint16_t dir = 0, hops = 0;
+	int iovcnt = 0;
+	uint8_t *status;
+	bool bad;
+
+	/* The header is read by the device, the data goes as the type says */
+	bad = !hdr || len < sizeof(*hdr) ||
+	      virtqueue_get_buffer_flags(vq, head) & VRING_DESC_F_WRITE;
+	if (!bad && (hdr->type == VIRTIO_BLK_T_IN ||
+		     hdr->type == VIRTIO_BLK_T_GET_ID))
+		dir = VRING_DESC_F_WRITE;
+
+	idx = virtqueue_get_next_desc(vq, head);
+	while (idx != VQ_RING_DESC_CHAIN_END) {
+		/* A chain longer than the ring loops, nothing in it is trusted */
+		if (++hops >= vq->vq_nentries)
+			return NULL;
+		/* Every descriptor but the last one is data */
+		if (prev == VQ_RING_DESC_CHAIN_END) {
+			/* Nothing behind yet */
+		} else if (iovcnt == VIRTIO_BLK_FILE_SEG_MAX ||
+			   (virtqueue_get_buffer_flags(vq, prev) &
+			    VRING_DESC_F_WRITE) != dir) {
+			bad = true;
+		} else {
+			iov[iovcnt].iov_base = virtqueue_get_buffer_addr(vq, prev);
+			iov[iovcnt].iov_len = virtqueue_get_buffer_length(vq, prev);
+			if (!iov[iovcnt++].iov_base)
+				bad = true;
+		}
+		prev = idx;
+		idx = virtqueue_get_next_desc(vq, idx);
+	}
+	if (prev == VQ_RING_DESC_CHAIN_END ||
+	    !(virtqueue_get_buffer_flags(vq, prev) & VRING_DESC_F_WRITE) ||
+	    !virtqueue_get_buffer_length(vq, prev))
+		return NULL;
+	status = virtqueue_get_buffer_addr(vq, prev);
+	if (!status)
+		return NULL;
+
+	if (bad)
+		*status = VIRTIO_BLK_S_IOERR;
+	else
+		*status = virtio_blk_file_exec(bf, hdr, iov, iovcnt, written);
+
+	return status;
+}
+
+int virtio_blk_file_serve(struct virtio_blk_file *bf, struct virtqueue *vq)
+{
+	struct virtio_blk_outhdr *hdr;
+	uint16_t head, avail;
+	uint32_t len, written;
+	uint8_t *status;
+	int num = 0;
+
+	do {
+		for (;;) {
+			/*
+			 * A NULL header is either an empty ring or a header
+			 * outside of the shared memory, only the ring index
+			 * tells them apart.
+			 */
+			avail = vq->vq_available_idx;
+			hdr = virtqueue_get_available_buffer(vq, &head, &len);
+			if (avail == vq->vq_available_idx)
+				break;
+			bf->requests++;
+			num++;
+			if (head >= vq->vq_nentries) {
+				/* Not a descriptor, there is nothing to return */
+				bf->errors++;
+				continue;
+			}
+
+			written = 0;
+			status = virtio_blk_file_request(bf, vq, head, hdr, len,
+							 &written);
+			/* Without a status byte the request is lost */
+			if (!status || *status != VIRTIO_BLK_S_OK)
+				bf->errors++;
+
+			/* The head always goes back, the front end frees it */
+			virtqueue_add_consumed_buffer(vq, head,
+						      status ? written + 1 : 0);
+		}
+		/* Ask for the next notification, unless requests came meanwhile */
+	} while (virtqueue_enable_cb(vq));
+
+	if (num)
+		virtqueue_kick(vq);
+
+	return num;
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/errno.h>
+#include <metal/utilities.h>
+#include <openamp/virtio_console.h>
+#include <string.h>
+
+static bool virtio_console_id_valid(struct virtio_device *vdev)
+{
+	return vdev->id.device == VIRTIO_ID_CONSOLE ||
+	       vdev->id.device == VIRTIO_ID_RPROC_SERIAL;
+}
+
+int virtio_console_init(struct virtio_console *con, struct virtio_device *vdev,
+			void *ring, uint32_t size)
+{
+	const char *names[] = { "rx", "tx" };
+	vq_callback callbacks[] = { NULL, NULL };
+	int ret;
+
+	if (!con || !vdev || vdev->role != VIRTIO_DEV_DEVICE ||
+	    !virtio_console_id_valid(vdev) || !ring || !size ||
+	    (size & (size - 1)))
+		return -EINVAL;
+
+	memset(con, 0, sizeof(*con));
+	con->vdev = vdev;
+	con->ring = ring;
+	con->size = size;
+	atomic_init(&con->head, 0);
+	atomic_init(&con->tail, 0);
+	atomic_init(&con->dropped, 0);
+	vdev->priv = con;
+
+	/* The buffers are polled by virtio_console_flush() */
+	ret = virtio_create_virtqueues(vdev, 0, 2, names, callbacks, NULL);
+	if (ret)
+		return ret;
+	con->rxq = vdev->vrings_info[VIRTIO_CONSOLE_RXQ].vq;
+	con->txq = vdev->vrings_info[VIRTIO_CONSOLE_TXQ].vq;
+
+	return 0;
+}
+
+void virtio_console_deinit(struct virtio_console *con)
+{
+	if (!con || !con->vdev)
+		return;
+
+	virtio_delete_virtqueues(con->vdev);
+	con->vdev->priv = NULL;
+	con->rxq = NULL;
+	con->txq = NULL;
+	con->vdev = NULL;
+}
+
+int virtio_console_write(struct virtio_console *con, const void *data,
+			 uint32_t len)
+{
+	uint32_t head, tail, off, first;
+
+	if (!con || !con->ring || !data)
+		return -EINVAL;
+
+	head = atomic_load_explicit(&con->head, memory_order_relaxed);
+	tail = atomic_load_explicit(&con->tail, memory_order_acquire);
+	if (len > con->size - (head - tail)) {
+		atomic_fetch_add_explicit(&con->dropped, 1,
+					  memory_order_relaxed);
+		return -EAGAIN;
+	}
+
+	off = head & (con->size - 1);
+	first = metal_min(len, con->size - off);
+	memcpy(con->ring + off, data, first);
+	memcpy(con->ring, (const char *)data + first, len - first);
+
+	/* Publish the message once copied */
+	atomic_store_explicit(&con->head, head + len, memory_order_release);
+
+	return 0;
+}
+
+uint32_t virtio_console_pending(struct virtio_console *con)
+{
+	return atomic_load_explicit(&con->head, memory_order_acquire) -
+	       atomic_load_explicit(&con->tail, memory_order_relaxed);
+}
+
+/* Pass the input of the driver to the input callback */
+static int virtio_console_input(struct virtio_console *con)
+{
+	uint16_t idx;
+	uint32_t len;
+	void *buf;
+	int num = 0;
+
+	while ((buf = virtqueue_get_available_buffer(con->txq, &idx, &len))) {
+		if (con->input_cb)
+			con->input_cb(con, buf, len);
+		virtqueue_add_consumed_buffer(con->txq, idx, 0);
+		num++;
+	}
+
+	return num;
+}
+
+int virtio_console_flush(struct virtio_console *con)
+{
+	uint32_t head, tail, off, room, len, first;
+	uint8_t status = 0;
+	uint32_t features;
+	uint16_t idx;
+	char *buf;
+	int num = 0;
+
+	if (!con || !con->rxq)
+		return -EINVAL;
+
+	if (!con->ready) {
+		/* Keep the data local until the driver is ready */
+		if (virtio_get_status(con->vdev, &status) ||
+		    !(status & VIRTIO_CONFIG_STATUS_DRIVER_OK))
+			return 0;
+		if (!virtio_get_features(con->vdev, &features))
+			con->vdev->features = features;
+		/* Buffers are polled, the driver needs not notify them */
+		virtqueue_disable_cb(con->rxq);
+		virtqueue_disable_cb(con->txq);
+		con->ready = true;
+	}
+
+	if (virtio_console_input(con))
+		virtqueue_kick(con->txq);
+
+	tail = atomic_load_explicit(&con->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&con->head, memory_order_acquire);
+	while (tail != head &&
+	       (buf = virtqueue_get_available_buffer(con->rxq, &idx, &room))) {
+		/* Fill each buffer as much as possible */
+		len = metal_min(head - tail, room);
+		off = tail & (con->size - 1);
+		first = metal_min(len, con->size - off);
+		memcpy(buf, con->ring + off, first);
+		memcpy(buf + first, con->ring, len - first);
+		tail += len;
+		atomic_store_explicit(&con->tail, tail, memory_order_release);
+		virtqueue_add_consumed_buffer(con->rxq, idx, len);
+		num += len;
+	}
+
+	if (num) {
+		virtqueue_kick(con->rxq);
+		con->flushed += num;
+	}
+
+	return num;
+}
+
+static void virtio_console_reader_callback(struct virtqueue *vq)
+{
+	struct virtio_console_reader *rd = vq->vq_dev->priv;
+
+	if (rd->data_cb)
+		rd->data_cb(rd);
+}
+
+static int virtio_console_reader_post(struct virtio_console_reader *rd,
+				      void *buf)
+{
+	struct virtqueue_buf vb = { buf, rd->buf_size };
+
+	return virtqueue_add_buffer(rd->rxq, &vb, 0, 1, buf);
+}
+
+int virtio_console_reader_init(struct virtio_console_reader *rd,
+			       struct virtio_device *vdev, void *pool,
+			       unsigned int num, uint32_t buf_size)
+{
+	const char *names[] = { "rx", "tx" };
+	vq_callback callbacks[] = { virtio_console_reader_callback, NULL };
+	uint32_t features = 0;
+	uint8_t status = 0;
+	unsigned int i;
+	int ret;
+
+	if (!rd || !vdev || vdev->role != VIRTIO_DEV_DRIVER ||
+	    !virtio_console_id_valid(vdev) || !pool || !num || !buf_size)
+		return -EINVAL;
+
+	rd->vdev = vdev;
+	rd->pool = pool;
+	rd->num = num;
+	rd->buf_size = buf_size;
+	rd->cur = NULL;
+	rd->bytes = 0;
+	vdev->priv = rd;
+
+	ret = virtio_get_status(vdev, &status);
+	if (ret)
+		return ret;
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER);
+
+	/* Transports negotiating in get_features() offer the preset features */
+	vdev->features = (vdev->features & ~0xffffffffULL) |
+			 VIRTIO_RING_F_EVENT_IDX;
+	virtio_get_features(vdev, &features);
+	ret = virtio_set_features(vdev, features & VIRTIO_RING_F_EVENT_IDX);
+	if (ret)
+		return ret;
+
+	ret = virtio_create_virtqueues(vdev, 0, 2, names, callbacks, NULL);
+	if (ret)
+		return ret;
+	rd->rxq = vdev->vrings_info[VIRTIO_CONSOLE_RXQ].vq;
+	rd->txq = vdev->vrings_info[VIRTIO_CONSOLE_TXQ].vq;
+	virtqueue_disable_cb(rd->txq);
+
+	for (i = 0; i < num; i++) {
+		if (virtio_console_reader_post(rd, rd->pool + i * buf_size))
+			break;
+	}
+
+	virtio_get_status(vdev, &status);
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER_OK);
+	virtqueue_kick(rd->rxq);
+
+	return 0;
+}
+
+void virtio_console_reader_deinit(struct virtio_console_reader *rd)
+{
+	if (!rd || !rd->vdev)
+		return;
+
+	virtio_reset_device(rd->vdev);
+	virtio_delete_virtqueues(rd->vdev);
+	rd->vdev->priv = NULL;
+	rd->rxq = NULL;
+	rd->txq = NULL;
+	rd->vdev = NULL;
+}
+
+int virtio_console_read(struct virtio_console_reader *rd, void *buf,
+			uint32_t len)
+{
+	uint32_t num = 0, chunk;
+	int posted = 0;
+
+	if (!rd || !rd->rxq || !buf)
+		return -EINVAL;
+
+	do {
+		while (num < len) {
+			if (!rd->cur) {
+				rd->cur = virtqueue_get_buffer(rd->rxq,
+							       &rd->cur_len,
+							       NULL);
+				if (!rd->cur)
+					break;
+				/* The used length comes from the device */
+				if (rd->cur_len > rd->buf_size)
+					rd->cur_len = rd->buf_size;
+				rd->cur_off = 0;
+			}
+			chunk = metal_min(rd->cur_len - rd->cur_off, len - num);
+			memcpy((char *)buf + num, rd->cur + rd->cur_off, chunk);
+			rd->cur_off += chunk;
+			num += chunk;
+			if (rd->cur_off == rd->cur_len) {
+				if (!virtio_console_reader_post(rd, rd->cur))
+					posted++;
+				rd->cur = NULL;
+			}
+		}
+		/* Drained: ask for the next interrupt, unless data came */
+	} while (num < len && virtqueue_enable_cb(rd->rxq));
+
+	if (posted)
+		virtqueue_kick(rd->rxq);
+	rd->bytes += num;
+
+	return num;
+}
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/errno.h>
+#include <metal/log.h>
+#include <metal/utilities.h>
+#include <openamp/virtio_net.h>
+#include <string.h>
+
+/* Features used by the front end, event index saves notifications */
+#define VIRTIO_NET_FEATURES	((1 << VIRTIO_NET_F_MAC) | \
+				 (1 << VIRTIO_NET_F_MRG_RXBUF) | \
+				 VIRTIO_RING_F_EVENT_IDX)
+
+/* Header without num_buffers */
+#define VIRTIO_NET_HDR_LEGACY_SIZE	(sizeof(struct virtio_net_hdr) - \
+					 sizeof(uint16_t))
+
+static void virtio_net_rx_callback(struct virtqueue *vq)
+{
+	struct virtio_net *net = vq->vq_dev->priv;
+
+	if (net && net->rx_notify)
+		net->rx_notify(net);
+}
+
+static bool virtio_net_mrg_rxbuf(struct virtio_net *net)
+{
+	return !!(net->vdev->features & (1 << VIRTIO_NET_F_MRG_RXBUF));
+}
+
+static bool virtio_net_pool_valid(const struct virtio_net_pool *pool)
+{
+	return pool && pool->base && pool->num &&
+	       !(pool->buf_size % sizeof(void *)) &&
+	       !((uintptr_t)pool->base % sizeof(void *));
+}
+
+static int virtio_net_post_rx(struct virtio_net *net, void *buf)
+{
+	struct virtqueue_buf vb = { buf, net->rx_pool.buf_size };
+
+	return virtqueue_add_buffer(net->rxq, &vb, 0, 1, buf);
+}
+
+static void virtio_net_reclaim_tx(struct virtio_net *net)
+{
+	uint32_t len;
+	void *buf;
+
+	while ((buf = virtqueue_get_buffer(net->txq, &len, NULL))) {
+		*(void **)buf = net->tx_free;
+		net->tx_free = buf;
+	}
+}
+
+int virtio_net_init(struct virtio_net *net, struct virtio_device *vdev,
+		    const struct virtio_net_pool *rx_pool,
+		    const struct virtio_net_pool *tx_pool,
+		    virtio_net_rx_cb rx_cb, void *priv)
+{
+	const char *names[] = { "rx", "tx" };
+	vq_callback callbacks[] = { virtio_net_rx_callback, NULL };
+	void (*rx_notify)(struct virtio_net *net);
+	uint32_t features = 0, rx_room;
+	uint8_t status = 0;
+	unsigned int i;
+	char *buf;
+	int ret;
+
+	if (!net || !vdev || vdev->role != VIRTIO_DEV_DRIVER ||
+	    vdev->id.device != VIRTIO_ID_NETWORK ||
+	    !virtio_net_pool_valid(rx_pool) || !virtio_net_pool_valid(tx_pool))
+		return -EINVAL;
+
+	rx_notify = net->rx_notify;
+	memset(net, 0, sizeof(*net));
+	net->rx_notify = rx_notify;
+	net->vdev = vdev;
+	net->rx_pool = *rx_pool;
+	net->tx_pool = *tx_pool;
+	net->rx_cb = rx_cb;
+	net->priv = priv;
+	vdev->priv = net;
+
+	ret = virtio_get_status(vdev, &status);
+	if (ret)
+		return ret;
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER);
+
+	/* Transports negotiating in get_features() offer the preset features */
+	vdev->features = (vdev->features & ~0xffffffffULL) | VIRTIO_NET_FEATURES;
+	virtio_get_features(vdev, &features);
+	ret = virtio_set_features(vdev, features & VIRTIO_NET_FEATURES);
+	if (ret)
+		return ret;
+
+	/* The header has num_buffers with merged buffers and modern devices */
+	net->hdr_len = sizeof(struct virtio_net_hdr);
+	if (!virtio_net_mrg_rxbuf(net) &&
+	    !(vdev->features & VIRTIO_F_VERSION_1))
+		net->hdr_len = VIRTIO_NET_HDR_LEGACY_SIZE;
+
+	rx_room = rx_pool->buf_size;
+	if (virtio_net_mrg_rxbuf(net))
+		rx_room *= VIRTIO_NET_RX_SEG_MAX;
+	if (rx_room < net->hdr_len + VIRTIO_NET_MAX_FRAME ||
+	    tx_pool->buf_size <= net->hdr_len) {
+		metal_log(METAL_LOG_ERROR, "virtio_net: buffers too small\r\n");
+		return -EINVAL;
+	}
+
+	if (vdev->features & (1 << VIRTIO_NET_F_MAC)) {
+		ret = virtio_read_config(vdev, 0, net->mac, sizeof(net->mac));
+		if (ret)
+			return ret;
+	}
+
+	ret = virtio_create_virtqueues(vdev, 0, 2, names, callbacks, NULL);
+	if (ret)
+		return ret;
+	net->rxq = vdev->vrings_info[VIRTIO_NET_RXQ].vq;
+	net->txq = vdev->vrings_info[VIRTIO_NET_TXQ].vq;
+
+	/* TX buffers are reclaimed on demand, not on interrupts */
+	virtqueue_disable_cb(net->txq);
+	for (i = 0, buf = tx_pool->base; i < tx_pool->num;
+	     i++, buf += tx_pool->buf_size) {
+		*(void **)buf = net->tx_free;
+		net->tx_free = buf;
+	}
+
+	for (i = 0, buf = rx_pool->base; i < rx_pool->num;
+	     i++, buf += rx_pool->buf_size) {
+		if (virtio_net_post_rx(net, buf))
+			break;
+	}
+
+	virtio_get_status(vdev, &status);
+	virtio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_DRIVER_OK);
+	virtqueue_kick(net->rxq);
+	metal_log(METAL_LOG_DEBUG,
+		  "virtio_net: %u RX buffers posted%s\r\n", i,
+		  virtio_net_mrg_rxbuf(net) ? ", merged" : "");
+
+	return 0;
+}
+
+void virtio_net_deinit(struct virtio_net *net)
+{
+	if (!net || !net->vdev)
+		return;
+
+	virtio_reset_device(net->vdev);
+	virtio_delete_virtqueues(net->vdev);
+	net->vdev->priv = NULL;
+	net->rxq = NULL;
+	net->txq = NULL;
+	net->vdev = NULL;
+}
+
+/* Post the RX buffers of a frame again, returns the number posted */
+static int virtio_net_recycle(struct virtio_net *net,
+			      struct virtio_net_frame *frame)
+{
+	unsigned int i;
+	int num = 0;
+	void *buf;
+
+	for (i = 0; i < frame->num; i++) {
+		/* The first segment follows the header */
+		buf = i ? frame->data[i] :
+		      (char *)frame->data[0] - net->hdr_len;
+		if (!virtio_net_post_rx(net, buf))
+			num++;
+	}
+	frame->num = 0;
+
+	return num;
+}
+
+/* Gather the next frame in net->rx_frame, returns false if incomplete */
+static bool virtio_net_gather(struct virtio_net *net, int *posted)
+{
+	struct virtio_net_frame *frame = &net->rx_frame;
+	struct virtio_net_hdr *hdr;
+	unsigned int num;
+	uint32_t len;
+	char *buf;
+
+	while ((buf = virtqueue_get_buffer(net->rxq, &len, NULL))) {
+		if (!net->rx_missing) {
+			/* First buffer of a frame */
+			hdr = (struct virtio_net_hdr *)buf;
+			num = virtio_net_mrg_rxbuf(net) ? hdr->num_buffers : 1;
+			frame->num = 0;
+			frame->len = 0;
+			net->rx_missing = num ? num : 1;
+			net->rx_drop = len < net->hdr_len || !num ||
+				       num > VIRTIO_NET_RX_SEG_MAX;
+			if (!net->rx_drop) {
+				buf += net->hdr_len;
+				len -= net->hdr_len;
+			}
+		}
+		net->rx_missing--;
+
+		if (net->rx_drop) {
+			/* Drop the buffers of the frame as they come */
+			if (!virtio_net_post_rx(net, buf))
+				(*posted)++;
+		} else {
+			frame->data[frame->num] = buf;
+			frame->seg_len[frame->num++] = len;
+			frame->len += len;
+		}
+
+		if (!net->rx_missing) {
+			if (!net->rx_drop && frame->len)
+				return true;
+			/* The device had no room for the frame */
+			*posted += virtio_net_recycle(net, frame);
+			net->rx_dropped++;
+		}
+	}
+
+	return false;
+}
+
+int virtio_net_poll(struct virtio_net *net)
+{
+	struct virtio_net_frame *frame;
+	int num = 0, posted = 0;
+
+	if (!net || !net->rxq)
+		return 0;
+
+	frame = &net->rx_frame;
+	do {
+		while (virtio_net_gather(net, &posted)) {
+			frame->held = false;
+			net->rx_frames++;
+			num++;
+			if (net->rx_cb)
+				net->rx_cb(net, frame);
+			if (!frame->held)
+				posted += virtio_net_recycle(net, frame);
+		}
+		/* Ask for the next interrupt, unless frames came meanwhile */
+	} while (virtqueue_enable_cb(net->rxq));
+
+	/* One notification for all the recycled buffers */
+	if (posted)
+		virtqueue_kick(net->rxq);
+
+	return num;
+}
+
+void virtio_net_hold_rx_frame(struct virtio_net_frame *frame)
+{
+	if (frame)
+		frame->held = true;
+}
+
+void virtio_net_release_rx_frame(struct virtio_net *net,
+				 struct virtio_net_frame *frame)
+{
+	if (!net || !net->rxq || !frame)
+		return;
+
+	if (virtio_net_recycle(net, frame))
+		virtqueue_kick(net->rxq);
+}
+
+void *virtio_net_get_tx_buffer(struct virtio_net *net, uint32_t *len)
+{
+	char *buf;
+
+	if (!net || !net->txq || !len)
+		return NULL;
+
+	if (!net->tx_free)
+		virtio_net_reclaim_tx(net);
+	buf = net->tx_free;
+	if (!buf)
+		return NULL;
+	net->tx_free = *(void **)buf;
+
+	*len = net->tx_pool.buf_size - net->hdr_len;
+	return buf + net->hdr_len;
+}
+
+/* Get the TX buffer of frame data, NULL if not from the TX pool */
+static void *virtio_net_tx_buf(struct virtio_net *net, void *data)
+{
+	char *buf = (char *)data - net->hdr_len;
+	char *base = net->tx_pool.base;
+	uintptr_t off = buf - base;
+
+	if (!data || buf < base ||
+	    off >= (uintptr_t)net->tx_pool.num * net->tx_pool.buf_size ||
+	    off % net->tx_pool.buf_size)
+		return NULL;
+
+	return buf;
+}
+
+void virtio_net_release_tx_buffer(struct virtio_net *net, void *data)
+{
+	void *buf;
+
+	if (!net || !net->txq)
+		return;
+
+	buf = virtio_net_tx_buf(net, data);
+	if (buf) {
+		*(void **)buf = net->tx_free;
+		net->tx_free = buf;
+	}
+}
+
+int virtio_net_send_nocopy(struct virtio_net *net, void *data, uint32_t len)
+{
+	struct virtqueue_buf vb;
+	void *buf;
+	int ret;
+
+	if (!net || !net->txq)
+		return -EINVAL;
+
+	buf = virtio_net_tx_buf(net, data);
+	if (!buf || !len || len > net->tx_pool.buf_size - net->hdr_len)
+		return -EINVAL;
+
+	/* The ring checks its space in debug builds only */
+	if (!net->txq->vq_free_cnt)
+		virtio_net_reclaim_tx(net);
+	if (!net->txq->vq_free_cnt)
+		return -EAGAIN;
+
+	/* No offload: the header is all zeros */
+	memset(buf, 0, net->hdr_len);
+	vb.buf = buf;
+	vb.len = net->hdr_len + len;
+	ret = virtqueue_add_buffer(net->txq, &vb, 1, 0, buf);
+	if (ret)
+		return ret;
+	net->tx_frames++;
+
+	return 0;
+}
+
+int virtio_net_send(struct virtio_net *net, const void *data, uint32_t len)
+{
+	uint32_t room;
+	void *buf;
+	int ret;
+
+	if (!data)
+		return -EINVAL;
+
+	buf = virtio_net_get_tx_buffer(net, &room);
+	if (!buf)
+		return -EAGAIN;
+	if (len > room) {
+		virtio_net_release_tx_buffer(net, buf);
+		return -EINVAL;
+	}
+
+	memcpy(buf, data, len);
+	ret = virtio_net_send_nocopy(net, buf, len);
+	if (ret)
+		virtio_net_release_tx_buffer(net, buf);
+
+	return ret;
+}
+
+void virtio_net_kick(struct virtio_net *net)
+{
+	if (net && net->txq)
+		virtqueue_kick(net->txq);
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/errno.h>
+#include <openamp/virtio_net_dev.h>
+#include <string.h>
+
+uint32_t virtio_net_dev_get_config(struct virtio_net_dev *dev,
+				   struct virtio_net_config *config)
+{
+	memset(config, 0, sizeof(*config));
+	memcpy(config->mac, dev->mac, sizeof(config->mac));
+
+	return (1 << VIRTIO_NET_F_MAC) | (1 << VIRTIO_NET_F_MRG_RXBUF);
+}
+
+void virtio_net_dev_start(struct virtio_net_dev *dev, struct virtqueue *rxq,
+			  struct virtqueue *txq)
+{
+	uint64_t features = rxq->vq_dev->features;
+
+	dev->rxq = rxq;
+	dev->txq = txq;
+	dev->mrg_rxbuf = !!(features & (1 << VIRTIO_NET_F_MRG_RXBUF));
+	dev->hdr_len = sizeof(struct virtio_net_hdr);
+	if (!dev->mrg_rxbuf && !(features & VIRTIO_F_VERSION_1))
+		dev->hdr_len -= sizeof(uint16_t);
+	dev->tx_frames = 0;
+	dev->rx_frames = 0;
+	dev->dropped = 0;
+}
+
+int virtio_net_dev_receive(struct virtio_net_dev *dev, const void *frame,
+			   uint32_t len)
+{
+	uint16_t heads[VIRTIO_NET_RX_SEG_MAX];
+	uint32_t lens[VIRTIO_NET_RX_SEG_MAX];
+	struct virtio_net_hdr *hdr = NULL;
+	const uint8_t *src = frame;
+	uint32_t room, chunk, left = len;
+	unsigned int num = 0, i;
+	uint8_t *buf;
+
+	if (!dev->rxq || !frame || !len)
+		return -EINVAL;
+
+	if (!virtqueue_pending(dev->rxq)) {
+		dev->dropped++;
+		return -EAGAIN;
+	}
+
+	/* Header first, then the frame across as many buffers as allowed */
+	do {
+		buf = virtqueue_get_available_buffer(dev->rxq, &heads[num],
+						     &room);
+		if (!buf)
+			break;
+		lens[num] = 0;
+		if (!hdr) {
+			if (room < dev->hdr_len) {
+				num++;
+				break;
+			}
+			hdr = (struct virtio_net_hdr *)buf;
+			memset(hdr, 0, dev->hdr_len);
+			buf += dev->hdr_len;
+			room -= dev->hdr_len;
+			lens[num] = dev->hdr_len;
+		}
+		chunk = left < room ? left : room;
+		memcpy(buf, src, chunk);
+		src += chunk;
+		left -= chunk;
+		lens[num++] += chunk;
+	} while (left && dev->mrg_rxbuf && num < VIRTIO_NET_RX_SEG_MAX);
+
+	if (left) {
+		/* Give the buffers back empty, the front end drops the frame */
+		for (i = 0; i < num; i++)
+			lens[i] = i || !hdr ? 0 : dev->hdr_len;
+		dev->dropped++;
+	} else {
+		dev->rx_frames++;
+	}
+	if (hdr && dev->mrg_rxbuf)
+		hdr->num_buffers = num;
+
+	for (i = 0; i < num; i++)
+		virtqueue_add_consumed_buffer(dev->rxq, heads[i], lens[i]);
+
+	return left ? -EAGAIN : 0;
+}
+
+void virtio_net_dev_kick_rx(struct virtio_net_dev *dev)
+{
+	if (dev->rxq)
+		virtqueue_kick(dev->rxq);
+}
+
+/* Get the frame of a TX chain, copied if it spans several descriptors */
+static const uint8_t *virtio_net_dev_tx_frame(struct virtio_net_dev *dev,
+					      uint8_t *buf, uint16_t head,
+					      uint32_t len, uint32_t *frame_len)
+{
+	uint16_t idx = virtqueue_get_next_desc(dev->txq, head);
+	uint32_t total = 0;
+
+	if (idx == VQ_RING_DESC_CHAIN_END) {
+		if (len <= dev->hdr_len)
+			return NULL;
+		*frame_len = len - dev->hdr_len;
+		return buf + dev->hdr_len;
+	}
+
+	for (;;) {
+		if (total + len > sizeof(dev->bounce))
+			return NULL;
+		memcpy(dev->bounce + total, buf, len);
+		total += len;
+		if (idx == VQ_RING_DESC_CHAIN_END)
+			break;
+		buf = virtqueue_get_buffer_addr(dev->txq, idx);
+		len = virtqueue_get_buffer_length(dev->txq, idx);
+		idx = virtqueue_get_next_desc(dev->txq, idx);
+	}
+	if (total <= dev->hdr_len)
+		return NULL;
+
+	*frame_len = total - dev->hdr_len;
+	return dev->bounce + dev->hdr_len;
+}
+
+int virtio_net_dev_serve_tx(struct virtio_net_dev *dev)
+{
+	const uint8_t *frame;
+	uint32_t len, frame_len = 0;
+	int num = 0, looped = 0;
+	uint16_t head;
+	uint8_t *buf;
+
+	if (!dev->txq)
+		return 0;
+
+	do {
+		while ((buf = virtqueue_get_available_buffer(dev->txq, &head,
+							     &len))) {
+			frame = virtio_net_dev_tx_frame(dev, buf, head, len,
+							&frame_len);
+			if (!frame)
+				dev->dropped++;
+			else if (dev->tx_cb)
+				dev->tx_cb(dev, frame, frame_len);
+			else if (virtio_net_dev_receive(dev, frame, frame_len) !=
+				 -EINVAL)
+				looped++;
+			dev->tx_frames++;
+			virtqueue_add_consumed_buffer(dev->txq, head, 0);
+			num++;
+		}
+		/* Ask for the next notification, unless frames came meanwhile */
+	} while (virtqueue_enable_cb(dev->txq));
+
+	if (num)
+		virtqueue_kick(dev->txq);
+	if (looped)
+		virtio_net_dev_kick_rx(dev);
+
+	return num;
+}
@@ -201,7 +201,8 @@ void *virtqueue_get_buffer(struct virtqueue *vq, uint32_t *len, uint16_t *idx)
 	used_idx = vq->vq_used_cons_idx++ & (vq->vq_nentries - 1);
 	uep = &vq->vq_ring.used->ring[used_idx];
 
-	atomic_thread_fence(memory_order_seq_cst);
+	/* Read the used element after the used index that published it */
+	atomic_thread_fence(memory_order_acquire);
 
 	/* Used.ring is written by remote, invalidate it */
 	VRING_INVALIDATE(&vq->vq_ring.used->ring[used_idx],
@@ -249,6 +250,18 @@ void *virtqueue_get_buffer_addr(struct virtqueue *vq, uint16_t idx)
 	// 使用 virtqueue_phys_to_virt 将物理地址转换为虚拟地址并返回
 	return virtqueue_phys_to_virt(vq, vq->vq_ring.desc[idx].addr);
 }
+/**
+ * @description: 获取指定缓冲区描述符的标志
+ * @param {virtqueue} *vq 指向 VirtIO 队列控制块的指针
+ * @param {uint16_t} idx 缓冲区的索引
+ * @return {*} 返回描述符的 VRING_DESC_F_* 标志
+ */
+uint16_t virtqueue_get_buffer_flags(struct virtqueue *vq, uint16_t idx)
+{
+	VRING_INVALIDATE(&vq->vq_ring.desc[idx].flags,
+			 sizeof(vq->vq_ring.desc[idx].flags));
+	return vq->vq_ring.desc[idx].flags;
+}
 /**
  * @internal
  *
@@ -285,8 +298,6 @@ void *virtqueue_get_available_buffer(struct virtqueue *vq, uint16_t *avail_idx,
 {
 	uint16_t head_idx = 0;
 	void *buffer;
-	// 使用内存屏障确保之前的内存操作完成
-	atomic_thread_fence(memory_order_seq_cst);
 
 	/* Avail.idx is updated by driver, invalidate it */
 	/*验证是否有新的可用缓冲区（通过比较 vq_available_idx 和 vq->vq_ring.avail->idx）*/
@@ -295,6 +306,9 @@ void *virtqueue_get_available_buffer(struct virtqueue *vq, uint16_t *avail_idx,
 		return NULL;
 	}
 
+	/* Read the avail entry and descriptor after the avail index */
+	atomic_thread_fence(memory_order_acquire);
+
 	VQUEUE_BUSY(vq);
 
 	head_idx = vq->vq_available_idx++ & (vq->vq_nentries - 1);
@@ -352,7 +366,8 @@ int virtqueue_add_consumed_buffer(struct virtqueue *vq, uint16_t head_idx,
 	VRING_FLUSH(&vq->vq_ring.used->ring[used_idx],
 		    sizeof(vq->vq_ring.used->ring[used_idx]));
 
-	atomic_thread_fence(memory_order_seq_cst);
+	/* Publish the used element before the used index */
+	atomic_thread_fence(memory_order_release);
 
 	vq->vq_ring.used->idx++;
 
@@ -441,7 +456,11 @@ void virtqueue_kick(struct virtqueue *vq)
 {
 	VQUEUE_BUSY(vq); //标记队列为忙，防止并发访问
 
-	/* Ensure updated avail->idx is visible to host. */
+	/*
+	 * Ensure updated avail->idx is visible to host before the event
+	 * index or flags are read: this is a store followed by a load, so it
+	 * needs a full barrier.
+	 */
 	//确保 avail->idx 的更新对设备可见
 	atomic_thread_fence(memory_order_seq_cst);
 	//判断是否需要通知设备
@@ -500,6 +519,9 @@ uint32_t virtqueue_get_desc_size(struct virtqueue *vq)
 		return 0;
 	}
 
+	/* Read the avail entry and descriptor after the avail index */
+	atomic_thread_fence(memory_order_acquire);
+
 	VQUEUE_BUSY(vq);//使用 VQUEUE_BUSY 宏标记队列为忙
 	//根据 vq->vq_available_idx 计算头索引，并从 avail->ring 获取实际的缓冲区索引
 	head_idx = vq->vq_available_idx & (vq->vq_nentries - 1);
@@ -521,6 +543,31 @@ uint32_t virtqueue_get_desc_size(struct virtqueue *vq)
 	return len;
 }
 
+uint16_t virtqueue_get_next_desc(struct virtqueue *vq, uint16_t idx)
+{
+	struct vring_desc *dp = &vq->vq_ring.desc[idx];
+
+	VRING_INVALIDATE(dp, sizeof(*dp));
+	if (!(dp->flags & VRING_DESC_F_NEXT) || dp->next >= vq->vq_nentries)
+		return VQ_RING_DESC_CHAIN_END;
+
+	return dp->next;
+}
+
+int virtqueue_pending(struct virtqueue *vq)
+{
+#ifndef VIRTIO_DEVICE_ONLY
+	if (vq->vq_dev->role == VIRTIO_DEV_DRIVER)
+		return virtqueue_nused(vq) != 0;
+#endif /*VIRTIO_DEVICE_ONLY*/
+#ifndef VIRTIO_DRIVER_ONLY
+	if (vq->vq_dev->role == VIRTIO_DEV_DEVICE)
+		return virtqueue_navail(vq) != 0;
+#endif /*VIRTIO_DRIVER_ONLY*/
+
+	return 0;
+}
+
 /**************************************************************************
  *                            Helper Functions                            *
  **************************************************************************/
@@ -689,8 +736,8 @@ static void vq_ring_update_avail(struct virtqueue *vq, uint16_t desc_idx)
 	//刷新（flush）更改过的可用环的部分，确保宿主可以看到更新
 	VRING_FLUSH(&vq->vq_ring.avail->ring[avail_idx],
 		    sizeof(vq->vq_ring.avail->ring[avail_idx]));
-	//使用内存屏障（atomic_thread_fence）确保上述更新对宿主立即可见
-	atomic_thread_fence(memory_order_seq_cst);
+	/* Publish the descriptors and avail entry before the avail index */
+	atomic_thread_fence(memory_order_release);
 	// 增加可用环的索引（vq->vq_ring.avail->idx）并再次刷新以确保宿主看到这一变化
 	vq->vq_ring.avail->idx++;
 
@@ -747,7 +794,11 @@ static int vq_ring_enable_interrupt(struct virtqueue *vq, uint16_t ndesc)
 		}
 #endif /*VIRTIO_DRIVER_ONLY*/
 	}
-	/*使用 atomic_thread_fence 确保所有更改对其他处理器可见*/
+	/*
+	 * Full barrier: the event index or flags store above must be visible
+	 * before the index is read below, else a buffer published in between
+	 * goes unnoticed by both sides.
+	 */
 	atomic_thread_fence(memory_order_seq_cst);
 
 	/*
@@ -781,7 +832,8 @@ static int vq_ring_enable_interrupt(struct virtqueue *vq, uint16_t ndesc)
  */
 void virtqueue_notification(struct virtqueue *vq)
 {
-	atomic_thread_fence(memory_order_seq_cst); //使用 atomic_thread_fence 确保所有内存操作完成
+	/* Pairs with the release of the index by the side that notified */
+	atomic_thread_fence(memory_order_acquire);
 	if (vq->callback)
 		vq->callback(vq);// 调用回调函数
 }
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <metal/errno.h>
+#include <metal/log.h>
+#include <metal/utilities.h>
+#include <openamp/virtio_mmio_dev.h>
+#include <string.h>
+
+static const char virtio_mmio_dev_vq_name[] = "virtio_mmio_dev";
+
+/* Selected queue, NULL if the selector is out of range */
+static struct virtio_mmio_dev_queue *
+virtio_mmio_dev_queue(struct virtio_mmio_dev *dev, uint32_t idx)
+{
+	return idx < dev->num_queues ? &dev->queues[idx] : NULL;
+}
+
+static void virtio_mmio_dev_interrupt(struct virtio_mmio_dev *dev, int bits)
+{
+	atomic_fetch_or(&dev->interrupt_status, bits);
+	if (dev->irq_cb)
+		dev->irq_cb(dev);
+}
+
+/* Used buffer notification of the device side virtqueues */
+static void virtio_mmio_dev_notify(struct virtqueue *vq)
+{
+	struct virtio_mmio_dev *dev = metal_container_of(vq->vq_dev,
+							 struct virtio_mmio_dev,
+							 vdev);
+
+	virtio_mmio_dev_interrupt(dev, VIRTIO_MMIO_INT_VRING);
+}
+
+static int virtio_mmio_dev_queue_create(struct virtio_mmio_dev *dev,
+					unsigned int idx)
+{
+	struct virtio_mmio_dev_queue *q = &dev->queues[idx];
+	struct vring_alloc_info info;
+	struct virtqueue *vq;
+	void *desc, *avail, *used;
+	int ret;
+
+	if (!q->num || q->num > q->num_max || (q->num & (q->num - 1)))
+		return -EINVAL;
+
+	desc = metal_io_phys_to_virt(dev->shm_io, q->desc);
+	avail = metal_io_phys_to_virt(dev->shm_io, q->avail);
+	used = metal_io_phys_to_virt(dev->shm_io, q->used);
+	if (!desc || !avail || !used)
+		return -EINVAL;
+
+	vq = virtqueue_allocate(q->num);
+	if (!vq)
+		return -ENOMEM;
+
+	info.vaddr = desc;
+	info.align = 4;
+	info.num_descs = q->num;
+	ret = virtqueue_create(&dev->vdev, idx, virtio_mmio_dev_vq_name, &info,
+			       q->callback, virtio_mmio_dev_notify, vq);
+	if (ret) {
+		virtqueue_free(vq);
+		return ret;
+	}
+
+	/* The driver places the rings independently of each other */
+	vq->vq_ring.avail = avail;
+	vq->vq_ring.used = used;
+	vq->priv = q->priv;
+	virtqueue_set_shmem_io(vq, dev->shm_io);
+	virtqueue_enable_cb(vq);
+	q->vq = vq;
+
+	return 0;
+}
+
+static void virtio_mmio_dev_queue_delete(struct virtio_mmio_dev_queue *q)
+{
+	if (q->vq) {
+		virtqueue_free(q->vq);
+		q->vq = NULL;
+	}
+}
+
+static void virtio_mmio_dev_set_status(struct virtio_mmio_dev *dev,
+				       uint32_t status)
+{
+	uint64_t features = dev->driver_features;
+
+	if (!status) {
+		virtio_mmio_dev_reset(dev);
+	} else {
+		/* Only accept a subset of the offered features with VERSION_1 */
+		if ((status & VIRTIO_CONFIG_FEATURES_OK) &&
+		    !(dev->status & VIRTIO_CONFIG_FEATURES_OK)) {
+			if (!(features & VIRTIO_F_VERSION_1) ||
+			    (features & ~dev->device_features))
+				status &= ~VIRTIO_CONFIG_FEATURES_OK;
+			else
+				dev->vdev.features = features;
+		}
+		dev->status = status;
+	}
+
+	if (dev->status_cb)
+		dev->status_cb(dev, dev->status);
+}
+
+static void virtio_mmio_dev_set_addr(uint64_t *addr, unsigned long offset,
+				     uint64_t value)
+{
+	if (offset & 4)
+		*addr = (*addr & 0xffffffffULL) | (value << 32);
+	else
+		*addr = (*addr & ~0xffffffffULL) | (uint32_t)value;
+}
+
+/* metal_io_region operations giving the driver access to the registers */
+static uint64_t virtio_mmio_dev_io_read(struct metal_io_region *io,
+					unsigned long offset,
+					memory_order order, int width)
+{
+	struct virtio_mmio_dev *dev = metal_container_of(io,
+							 struct virtio_mmio_dev,
+							 io);
+
+	(void)order;
+	return virtio_mmio_dev_read(dev, offset, width);
+}
+
+static void virtio_mmio_dev_io_write(struct metal_io_region *io,
+				     unsigned long offset, uint64_t value,
+				     memory_order order, int width)
+{
+	struct virtio_mmio_dev *dev = metal_container_of(io,
+							 struct virtio_mmio_dev,
+							 io);
+
+	(void)order;
+	virtio_mmio_dev_write(dev, offset, value, width);
+}
+
+int virtio_mmio_dev_init(struct virtio_mmio_dev *dev, uint32_t device_id,
+			 uint64_t features, struct virtio_mmio_dev_queue *queues,
+			 unsigned int num_queues, struct metal_io_region *shm_io,
+			 void *config, uint32_t config_len,
+			 void (*irq_cb)(struct virtio_mmio_dev *dev))
+{
+	struct metal_io_ops ops;
+	unsigned int i;
+
+	if (!dev || !shm_io || (num_queues && !queues) ||
+	    (config_len && !config))
+		return -EINVAL;
+
+	memset(&dev->vdev, 0, sizeof(dev->vdev));
+	dev->vdev.id.device = device_id;
+	dev->vdev.id.vendor = dev->vendor_id;
+	dev->vdev.id.version = 2;
+	dev->vdev.role = VIRTIO_DEV_DEVICE;
+	dev->device_features = features | VIRTIO_F_VERSION_1;
+	dev->shm_io = shm_io;
+	dev->queues = queues;
+	dev->num_queues = num_queues;
+	dev->config = config;
+	dev->config_len = config_len;
+	dev->config_generation = 0;
+	dev->irq_cb = irq_cb;
+	for (i = 0; i < num_queues; i++)
+		queues[i].vq = NULL;
+	virtio_mmio_dev_reset(dev);
+
+	memset(&ops, 0, sizeof(ops));
+	ops.read = virtio_mmio_dev_io_read;
+	ops.write = virtio_mmio_dev_io_write;
+	metal_io_init(&dev->io, METAL_BAD_VA, NULL,
+		      VIRTIO_MMIO_DEV_REGS_SIZE + config_len, -1, 0, &ops);
+
+	return 0;
+}
+
+void virtio_mmio_dev_reset(struct virtio_mmio_dev *dev)
+{
+	struct virtio_mmio_dev_queue *q;
+	unsigned int i;
+
+	for (i = 0; i < dev->num_queues; i++) {
+		q = &dev->queues[i];
+		virtio_mmio_dev_queue_delete(q);
+		q->num = 0;
+		q->desc = 0;
+		q->avail = 0;
+		q->used = 0;
+	}
+	dev->driver_features = 0;
+	dev->vdev.features = 0;
+	dev->device_features_sel = 0;
+	dev->driver_features_sel = 0;
+	dev->queue_sel = 0;
+	dev->status = 0;
+	atomic_store(&dev->interrupt_status, 0);
+}
+
+uint64_t virtio_mmio_dev_read(struct virtio_mmio_dev *dev,
+			      unsigned long offset, int width)
+{
+	struct virtio_mmio_dev_queue *q = virtio_mmio_dev_queue(dev,
+								dev->queue_sel);
+	uint64_t value = 0;
+
+	if (offset >= VIRTIO_MMIO_CONFIG) {
+		offset -= VIRTIO_MMIO_CONFIG;
+		if (offset + width <= dev->config_len)
+			memcpy(&value, dev->config + offset, width);
+		return value;
+	}
+
+	switch (offset) {
+	case VIRTIO_MMIO_MAGIC_VALUE:
+		return VIRTIO_MMIO_MAGIC_VALUE_STRING;
+	case VIRTIO_MMIO_VERSION:
+		return dev->vdev.id.version;
+	case VIRTIO_MMIO_DEVICE_ID:
+		return dev->vdev.id.device;
+	case VIRTIO_MMIO_VENDOR_ID:
+		return dev->vendor_id;
+	case VIRTIO_MMIO_DEVICE_FEATURES:
+		if (dev->device_features_sel > 1)
+			return 0;
+		return (uint32_t)(dev->device_features >>
+				  (32 * dev->device_features_sel));
+	case VIRTIO_MMIO_QUEUE_NUM_MAX:
+		return q && !q->vq ? q->num_max : 0;
+	case VIRTIO_MMIO_QUEUE_READY:
+		return q && q->vq;
+	case VIRTIO_MMIO_INTERRUPT_STATUS:
+		return atomic_load(&dev->interrupt_status);
+	case VIRTIO_MMIO_STATUS:
+		return dev->status;
+	case VIRTIO_MMIO_SHM_LEN_LOW:
+	case VIRTIO_MMIO_SHM_LEN_HIGH:
+		/* No shared memory region */
+		return 0xffffffff;
+	case VIRTIO_MMIO_CONFIG_GENERATION:
+		return dev->config_generation;
+	default:
+		return 0;
+	}
+}
+
+void virtio_mmio_dev_write(struct virtio_mmio_dev *dev, unsigned long offset,
+			   uint64_t value, int width)
+{
+	struct virtio_mmio_dev_queue *q = virtio_mmio_dev_queue(dev,
+								dev->queue_sel);
+	uint32_t sel;
+
+	if (offset >= VIRTIO_MMIO_CONFIG) {
+		offset -= VIRTIO_MMIO_CONFIG;
+		if (offset + width <= dev->config_len)
+			memcpy(dev->config + offset, &value, width);
+		return;
+	}
+
+	switch (offset) {
+	case VIRTIO_MMIO_DEVICE_FEATURES_SEL:
+		dev->device_features_sel = value;
+		break;
+	case VIRTIO_MMIO_DRIVER_FEATURES:
+		sel = dev->driver_features_sel;
+		if (sel > 1 || (dev->status & VIRTIO_CONFIG_FEATURES_OK))
+			break;
+		dev->driver_features &= ~(0xffffffffULL << (32 * sel));
+		dev->driver_features |= (uint64_t)(uint32_t)value << (32 * sel);
+		break;
+	case VIRTIO_MMIO_DRIVER_FEATURES_SEL:
+		dev->driver_features_sel = value;
+		break;
+	case VIRTIO_MMIO_QUEUE_SEL:
+		dev->queue_sel = value;
+		break;
+	case VIRTIO_MMIO_QUEUE_NUM:
+		if (q && !q->vq)
+			q->num = value;
+		break;
+	case VIRTIO_MMIO_QUEUE_DESC_LOW:
+	case VIRTIO_MMIO_QUEUE_DESC_HIGH:
+		if (q && !q->vq)
+			virtio_mmio_dev_set_addr(&q->desc, offset, value);
+		break;
+	case VIRTIO_MMIO_QUEUE_AVAIL_LOW:
+	case VIRTIO_MMIO_QUEUE_AVAIL_HIGH:
+		if (q && !q->vq)
+			virtio_mmio_dev_set_addr(&q->avail, offset, value);
+		break;
+	case VIRTIO_MMIO_QUEUE_USED_LOW:
+	case VIRTIO_MMIO_QUEUE_USED_HIGH:
+		if (q && !q->vq)
+			virtio_mmio_dev_set_addr(&q->used, offset, value);
+		break;
+	case VIRTIO_MMIO_QUEUE_READY:
+		if (!q)
+			break;
+		if (value && !q->vq) {
+			if (virtio_mmio_dev_queue_create(dev, dev->queue_sel))
+				metal_log(METAL_LOG_ERROR,
+					  "virtio_mmio_dev: invalid queue %u\n",
+					  dev->queue_sel);
+		} else if (!value) {
+			virtio_mmio_dev_queue_delete(q);
+		}
+		break;
+	case VIRTIO_MMIO_QUEUE_NOTIFY:
+		/* VIRTIO_F_NOTIFICATION_DATA is not offered, the value is the index */
+		q = virtio_mmio_dev_queue(dev, (uint16_t)value);
+		if (q && q->vq)
+			virtqueue_notification(q->vq);
+		break;
+	case VIRTIO_MMIO_INTERRUPT_ACK:
+		atomic_fetch_and(&dev->interrupt_status, ~(int)value);
+		break;
+	case VIRTIO_MMIO_STATUS:
+		virtio_mmio_dev_set_status(dev, value);
+		break;
+	default:
+		metal_log(METAL_LOG_DEBUG, "virtio_mmio_dev: write to 0x%lx\n",
+			  offset);
+		break;
+	}
+}
+
+void virtio_mmio_dev_config_changed(struct virtio_mmio_dev *dev)
+{
+	dev->config_generation++;
+	virtio_mmio_dev_interrupt(dev, VIRTIO_MMIO_INT_CONFIG);
+}
+
+int virtio_mmio_dev_serve(struct virtio_mmio_dev *dev, unsigned int idx,
+			  uint32_t (*handler)(void *priv, void *buf,
+					      uint32_t len),
+			  void *priv)
+{
+	struct virtio_mmio_dev_queue *q = virtio_mmio_dev_queue(dev, idx);
+	struct virtqueue *vq;
+	uint16_t head;
+	uint32_t len;
+	void *buf;
+	int num = 0;
+
+	if (!q || !q->vq || !handler)
+		return -EINVAL;
+
+	vq = q->vq;
+	do {
+		while ((buf = virtqueue_get_available_buffer(vq, &head, &len))) {
+			len = handler(priv, buf, len);
+			virtqueue_add_consumed_buffer(vq, head, len);
+			num++;
+		}
+		/* Ask for the next notification, unless buffers came meanwhile */
+	} while (virtqueue_enable_cb(vq));
+
+	/* One used buffer notification for the batch, if the driver wants it */
+	if (num)
+		virtqueue_kick(vq);
+
+	return num;
+}
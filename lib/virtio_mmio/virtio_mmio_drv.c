@@ -47,6 +47,14 @@ static inline uint32_t virtio_mmio_read32(struct virtio_device *vdev, int offset
 	return metal_io_read32(vmdev->cfg_io, offset);
 }
 
+/* Write a 64 bits address to a pair of LOW/HIGH registers */
+static inline void virtio_mmio_write_addr(struct virtio_device *vdev, int offset,
+					  metal_phys_addr_t addr)
+{
+	virtio_mmio_write32(vdev, offset, (uint32_t)addr);
+	virtio_mmio_write32(vdev, offset + 4, (uint32_t)((uint64_t)addr >> 32));
+}
+
 static inline uint8_t virtio_mmio_read8(struct virtio_device *vdev, int offset)
 {
 	struct virtio_mmio_device *vmdev = metal_container_of(vdev,
@@ -102,10 +110,16 @@ static void virtio_mmio_read_config(struct virtio_device *vdev,uint32_t offset,
 {
 	int i;
 	uint8_t *d = dst;
-	(void)(offset);
-
-	for (i = 0; i < length; i++)
-		d[i] = virtio_mmio_read8(vdev, VIRTIO_MMIO_CONFIG + i);
+	uint32_t gen = 0;
+
+	/* Version 2 devices bump the generation when the config space changes */
+	do {
+		if (vdev->id.version != 1)
+			gen = virtio_mmio_read32(vdev, VIRTIO_MMIO_CONFIG_GENERATION);
+		for (i = 0; i < length; i++)
+			d[i] = virtio_mmio_read8(vdev, VIRTIO_MMIO_CONFIG + offset + i);
+	} while (vdev->id.version != 1 &&
+		 gen != virtio_mmio_read32(vdev, VIRTIO_MMIO_CONFIG_GENERATION));
 }
 /**
  * @description: 内部函数-用于查询 VirtIO 设备支持的特性集
@@ -126,7 +140,7 @@ static uint32_t _virtio_mmio_get_features(struct virtio_device *vdev, int idx)
 	virtio_mmio_write32(vdev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, idx);
 	/*VIRTIO_MMIO_DEVICE_FEATURES 寄存器读取设备支持的特性，并与设备当前激活的特性 (vdev->features) 进行按位与操作，以确定双方都支持的特性集*/
 	hfeatures = virtio_mmio_read32(vdev, VIRTIO_MMIO_DEVICE_FEATURES);
-	return hfeatures & vdev->features;
+	return hfeatures & (uint32_t)(vdev->features >> (32 * idx));
 }
 /**
  * @description: 此函数是获取设备支持特性的公共接口，它调用_virtio_mmio_get_features 函数查询索引为 0 的特性集，即主特性集
@@ -160,13 +174,41 @@ static void _virtio_mmio_set_features(struct virtio_device *vdev,uint32_t featur
 	virtio_mmio_write32(vdev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, idx);
 	hfeatures = virtio_mmio_read32(vdev, VIRTIO_MMIO_DEVICE_FEATURES);
 	features &= hfeatures;
+	virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, idx);
 	virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES, features);
-	vdev->features = features;
+	vdev->features &= ~(0xffffffffULL << (32 * idx));
+	vdev->features |= (uint64_t)features << (32 * idx);
 }
 
 static void virtio_mmio_set_features(struct virtio_device *vdev, uint32_t features)
 {
+	uint8_t status;
+
 	_virtio_mmio_set_features(vdev, features, 0);
+	if (vdev->id.version == 1)
+		return;
+
+	/*
+	 * Version 2 devices: the upper features, preset in vdev->features,
+	 * include VIRTIO_F_VERSION_1 which the device has to accept, and the
+	 * negotiation ends with FEATURES_OK being accepted by the device.
+	 * Otherwise the device is given up with FAILED, which makes
+	 * virtio_set_features() and virtio_mmio_create_virtqueues() fail.
+	 */
+	_virtio_mmio_set_features(vdev,
+				  (uint32_t)((vdev->features | VIRTIO_F_VERSION_1) >> 32),
+				  1);
+	status = virtio_mmio_get_status(vdev);
+	if (!(vdev->features & VIRTIO_F_VERSION_1)) {
+		metal_log(METAL_LOG_ERROR, "VIRTIO_F_VERSION_1 not offered\n");
+		virtio_mmio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_FAILED);
+		return;
+	}
+	virtio_mmio_set_status(vdev, status | VIRTIO_CONFIG_FEATURES_OK);
+	if (!(virtio_mmio_get_status(vdev) & VIRTIO_CONFIG_FEATURES_OK)) {
+		metal_log(METAL_LOG_ERROR, "features not accepted by the device\n");
+		virtio_mmio_set_status(vdev, status | VIRTIO_CONFIG_STATUS_FAILED);
+	}
 }
 /**
  * @description: 此函数用于重置 VirtIO 设备。它通过将 0 写入 VIRTIO_MMIO_STATUS 寄存器来实现设备的重置操作，清除所有先前的状态和配置
@@ -246,7 +288,9 @@ static int virtio_mmio_get_metal_io(struct virtio_device *vdev, uintptr_t virt_m
 		return err;
 	}
 
-	vmdev->cfg_io = metal_device_io_region(device, 1);
+	/* A preset cfg_io, e.g. of a struct virtio_mmio_dev, replaces region 1 */
+	if (!vmdev->cfg_io)
+		vmdev->cfg_io = metal_device_io_region(device, 1);
 	if (!vmdev->cfg_io) {
 		metal_log(METAL_LOG_ERROR, "metal_device_io_region failed to get region 1");
 		return err;
@@ -311,7 +355,11 @@ int virtio_mmio_device_init(struct virtio_mmio_device *vmdev, uintptr_t virt_mem
 		return -1;
 	}
 
-	if (version != 1) {
+#ifdef VIRTIO_MMIO_LEGACY
+	if (version != 1 && version != 2) {
+#else
+	if (version != 2) {
+#endif
 		metal_log(METAL_LOG_ERROR, "Bad version %08x\n", version);
 		return -1;
 	}
@@ -324,8 +372,11 @@ int virtio_mmio_device_init(struct virtio_mmio_device *vmdev, uintptr_t virt_mem
 	vdev->id.vendor = vendor;
 	// 5.设置设备状态-VIRTIO_CONFIG_STATUS_ACK，表示驱动已识别设备
 	virtio_mmio_set_status(vdev, VIRTIO_CONFIG_STATUS_ACK);
+#ifdef VIRTIO_MMIO_LEGACY
 	// 6.设置页大小-4k
-	virtio_mmio_write32(vdev, VIRTIO_MMIO_GUEST_PAGE_SIZE, 4096);
+	if (version == 1)
+		virtio_mmio_write32(vdev, VIRTIO_MMIO_GUEST_PAGE_SIZE, 4096);
+#endif
 
 	return 0;
 }
@@ -388,16 +439,17 @@ struct virtqueue *virtio_mmio_setup_virtqueue(struct virtio_device *vdev,
 			  "Only preallocated virtqueues are currently supported\n");
 		return NULL;
 	}
-	//检查VirtIO MMIO版本: 确保设备使用的是支持的VirtIO MMIO协议版本（版本1）
-	if (vdev->id.version != 0x1) {
+	if (vdev->id.version != 0x1 && vdev->id.version != 0x2) {
 		metal_log(METAL_LOG_ERROR,
-			  "Only VIRTIO MMIO version 1 is currently supported\n");
+			  "Only VIRTIO MMIO version 1 and 2 are supported\n");
 		return NULL;
 	}
 
 	vring_info->io = vmdev->shm_io;
 	vring_info->info.num_descs = virtio_mmio_get_max_elem(vdev, idx);// 获取设备支持的最大virtqueue元素数
-	vring_info->info.align = VIRTIO_MMIO_VRING_ALIGNMENT;
+	vring_info->info.align = vdev->id.version == 0x1 ?
+				 VIRTIO_MMIO_VRING_ALIGNMENT :
+				 VIRTIO_MMIO_V2_VRING_ALIGNMENT;
 
 	/* Check if vrings are already configured */
 	if (vq->vq_nentries != 0 && vq->vq_nentries == vq->vq_free_cnt &&
@@ -436,44 +488,111 @@ struct virtqueue *virtio_mmio_setup_virtqueue(struct virtio_device *vdev,
 	VIRTIO_ASSERT((maxq >= vq->vq_nentries),
 		      "VIRTIO_MMIO_QUEUE_NUM_MAX must be greater than vqueue->vq_nentries");
 	virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_NUM, vq->vq_nentries);
-	virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_ALIGN, 4096);
-	virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_PFN,
-			    ((uintptr_t)metal_io_virt_to_phys(vq->shm_io,
-			    (char *)vq->vq_ring.desc)) / 4096);
+	if (vdev->id.version == 0x1) {
+#ifdef VIRTIO_MMIO_LEGACY
+		virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_ALIGN, 4096);
+		virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_PFN,
+				    ((uintptr_t)metal_io_virt_to_phys(vq->shm_io,
+				    (char *)vq->vq_ring.desc)) / 4096);
+#endif
+	} else {
+		/* Version 2: the three parts of the vring are located separately */
+		virtio_mmio_write_addr(vdev, VIRTIO_MMIO_QUEUE_DESC_LOW,
+				       metal_io_virt_to_phys(vq->shm_io, vq->vq_ring.desc));
+		virtio_mmio_write_addr(vdev, VIRTIO_MMIO_QUEUE_AVAIL_LOW,
+				       metal_io_virt_to_phys(vq->shm_io, vq->vq_ring.avail));
+		virtio_mmio_write_addr(vdev, VIRTIO_MMIO_QUEUE_USED_LOW,
+				       metal_io_virt_to_phys(vq->shm_io, vq->vq_ring.used));
+		virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_READY, 1);
+	}
 
-	vdev->vrings_info[vdev->vrings_num].vq = vq;
-	vdev->vrings_num++;
+	vdev->vrings_info[idx].vq = vq;
+	if (idx >= vdev->vrings_num)
+		vdev->vrings_num = idx + 1;
 	virtqueue_enable_cb(vq);// 启用virtqueue回调
 
 	return vq;
 }
 
 /**
- * @brief VIRTIO MMIO interrupt service routine.
- * VirtIO MMIO设备的中断服务程序(ISR)，它是硬件中断的响应函数。当VirtIO设备产生中断时，该函数被调用
+ * @brief Invoke the callbacks of the virtqueues with pending buffers.
+ *
+ * virtio-mmio has a single used buffer notification bit for all the
+ * virtqueues, the ring indexes tell which of them has work.
+ *
  * @param vdev Pointer to virtio_device structure.
+ *
+ * @return Number of virtqueue callbacks invoked.
  */
-void virtio_mmio_isr(struct virtio_device *vdev)
+static int virtio_mmio_notify_vqs(struct virtio_device *vdev)
 {
 	struct virtio_vring_info *vrings_info = vdev->vrings_info;
-	// 读取中断状态: 通过读取VIRTIO_MMIO_INTERRUPT_STATUS寄存器来获取当前的中断状态
-	uint32_t isr = virtio_mmio_read32(vdev, VIRTIO_MMIO_INTERRUPT_STATUS);
 	struct virtqueue *vq;
 	unsigned int i;
-	// 处理Vring中断: 如果中断状态表明是Vring相关的中断(VIRTIO_MMIO_INT_VRING标志被设置)，则遍历所有virtqueue，并对于每个有注册回调函数的virtqueue，调用其回调函数
-	if (isr & VIRTIO_MMIO_INT_VRING) {
-		for (i = 0; i < vdev->vrings_num; i++) {
-			vq = vrings_info[i].vq;
-			if (vq->callback)
-				vq->callback(vq->priv);
+	int num = 0;
+
+	for (i = 0; i < vdev->vrings_num; i++) {
+		vq = vrings_info[i].vq;
+		if (vq && vq->callback && virtqueue_pending(vq)) {
+			vq->callback(vq->priv);
+			num++;
 		}
 	}
 
+	return num;
+}
+
+/**
+ * @brief VIRTIO MMIO interrupt service routine.
+ * VirtIO MMIO设备的中断服务程序(ISR)，它是硬件中断的响应函数。当VirtIO设备产生中断时，该函数被调用
+ * @param vdev Pointer to virtio_device structure.
+ */
+void virtio_mmio_isr(struct virtio_device *vdev)
+{
+	struct virtio_mmio_device *vmdev = metal_container_of(vdev,
+							      struct virtio_mmio_device, vdev);
+	// 读取中断状态: 通过读取VIRTIO_MMIO_INTERRUPT_STATUS寄存器来获取当前的中断状态
+	uint32_t isr = virtio_mmio_read32(vdev, VIRTIO_MMIO_INTERRUPT_STATUS);
+
 	if (isr & ~(VIRTIO_MMIO_INT_VRING)) //处理未知中断: 如果存在未处理的中断类型，输出警告信息
 		metal_log(METAL_LOG_WARNING, "Unhandled interrupt type: 0x%x\n", isr);
-	// 清除中断状态: 通过写入VIRTIO_MMIO_INTERRUPT_ACK寄存器来确认并清除已处理的中断
+
+	/*
+	 * Acknowledge before looking at the rings: buffers made available
+	 * after the rings are read raise a new interrupt instead of being
+	 * acknowledged with this one.
+	 */
 	virtio_mmio_write32(vdev, VIRTIO_MMIO_INTERRUPT_ACK, isr);
+
+	if (!(isr & VIRTIO_MMIO_INT_VRING))
+		return;
+
+	if (vmdev->defer_cb) {
+		atomic_store(&vmdev->deferred, 1);
+		vmdev->defer_cb(vmdev);
+	} else {
+		virtio_mmio_notify_vqs(vdev);
+	}
+}
+
+void virtio_mmio_set_deferred(struct virtio_mmio_device *vmdev,
+			      void (*defer_cb)(struct virtio_mmio_device *vmdev))
+{
+	vmdev->defer_cb = defer_cb;
+}
+
+int virtio_mmio_process_deferred(struct virtio_device *vdev)
+{
+	struct virtio_mmio_device *vmdev = metal_container_of(vdev,
+							      struct virtio_mmio_device, vdev);
+
+	/* Cleared first, an interrupt while dispatching schedules a new run */
+	if (!atomic_exchange(&vmdev->deferred, 0))
+		return 0;
+
+	return virtio_mmio_notify_vqs(vdev);
 }
+
 /**
  * @description: 为VirtIO设备创建一组virtqueues
  * @param {virtio_device} *vdev 指向VirtIO设备的指针
@@ -496,6 +615,9 @@ static int virtio_mmio_create_virtqueues(struct virtio_device *vdev, unsigned in
 	// 参数校验: 检查传入的参数是否有效，确保vdev、names和vrings_info非空
 	if (!vdev || !names || !vdev->vrings_info)
 		return -EINVAL;
+	/* The feature negotiation failed */
+	if (virtio_mmio_get_status(vdev) & VIRTIO_CONFIG_STATUS_FAILED)
+		return -ENODEV;
 
 	for (i = 0; i < nvqs; i++) {
 		vring_vq = NULL;
@@ -505,8 +627,11 @@ static int virtio_mmio_create_virtqueues(struct virtio_device *vdev, unsigned in
 			vring_vq = vdev->vrings_info[i].vq;
 		if (callbacks) // 如果提供了callbacks和callback_args，则分别设置为virtqueue的回调函数和回调参数
 			cb = (virtio_mmio_vq_callback)callbacks[i];
+		/* Without arguments the callbacks get their vq, as with remoteproc_virtio */
 		if (callback_args)
 			cb_arg = callback_args[i];
+		else
+			cb_arg = vring_vq;
 		//调用virtio_mmio_setup_virtqueue为每个virtqueue进行配置和初始化
 		vq = virtio_mmio_setup_virtqueue(vdev, i, vring_vq, cb, cb_arg, names[i]);
 		if (!vq)
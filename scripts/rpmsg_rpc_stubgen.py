@@ -0,0 +1,763 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Generate RPMsg RPC client and server stubs from an interface definition.
+
+The stubs marshal the params in place: a request is built directly in the
+RPMsg tx buffer got with rpmsg_rpc_client_get_tx_params() and decoded in
+place in the rx buffer by the server, the answer likewise. The params are
+packed structures, checked at compile time to fit in one buffer, see
+RPMSG_RPC_MAX_REQ_PARAMS in lib/include/openamp/rpmsg_rpc_client_server.h.
+Both cores must share the same byte order.
+
+Interface definition example:
+
+    // Service name, prefix of the generated names, and base service ID
+    service calc = 0x100;
+
+    struct point {
+        int32 x;
+        int32 y;
+    };
+
+    // rpc name = ID offset (request params) -> (answer params);
+    rpc add = 1 (int32 a, int32 b) -> (int32 sum);
+    rpc scale = 2 (point p[2], uint32 k) -> (point r[2]);
+    rpc write = 3 (uint32 fd, bytes<256> buf) -> (int32 len);
+
+    // No answer is sent for a oneway rpc
+    oneway rpc log = 4 (uint8 level, bytes<128> msg);
+
+Field types are int8 to int64, uint8 to uint64, float, double and the
+structures defined before, with an optional fixed array size. A bytes<N>
+field, sent with the length actually used, may be the last param.
+
+For a calc service, calc_rpc.h, calc_rpc_client.c and calc_rpc_server.c
+are written. The server application implements one calc_<rpc>_impl()
+function per rpc and passes calc_services to rpmsg_rpc_server_init().
+The output directory must exist. apps/tests/rpc generates and builds the
+stubs of a sample interface from CMake.
+"""
+
+import argparse
+import os
+import re
+import sys
+import textwrap
+
+SCALARS = {
+    'int8': 'int8_t', 'int16': 'int16_t', 'int32': 'int32_t',
+    'int64': 'int64_t', 'uint8': 'uint8_t', 'uint16': 'uint16_t',
+    'uint32': 'uint32_t', 'uint64': 'uint64_t', 'float': 'float',
+    'double': 'double',
+}
+
+TOKEN = re.compile(r'\s*(?:(//[^\n]*|/\*.*?\*/)|(0[xX][0-9a-fA-F]+|\d+)|'
+                   r'([A-Za-z_]\w*)|(->|[=;,(){}\[\]<>]))', re.S)
+
+
+class IdlError(Exception):
+    """Error in the interface definition."""
+
+
+class Field:
+    """Param or structure member."""
+
+    def __init__(self, type_name, name, count=None, var=False):
+        self.type_name = type_name
+        self.name = name
+        self.count = count
+        self.var = var
+
+
+class Rpc:
+    """Remote procedure."""
+
+    def __init__(self, name, offset, ins, outs, oneway):
+        self.name = name
+        self.offset = offset
+        self.ins = ins
+        self.outs = outs
+        self.oneway = oneway
+
+
+class Parser:
+    """Recursive descent parser of the interface definition."""
+
+    def __init__(self, text):
+        self.tokens = []
+        pos = 0
+        text = text.rstrip()
+        while pos < len(text):
+            match = TOKEN.match(text, pos)
+            if not match:
+                line = text.count('\n', 0, pos) + 1
+                raise IdlError('line %d: unexpected character %r' %
+                               (line, text[pos:].lstrip()[:1]))
+            pos = match.end()
+            if match.group(1) is None:
+                self.tokens.append(match.group(0).strip())
+        self.pos = 0
+        self.service = None
+        self.base = 0
+        self.structs = {}
+        self.rpcs = []
+
+    def peek(self):
+        return self.tokens[self.pos] if self.pos < len(self.tokens) else None
+
+    def next(self):
+        tok = self.peek()
+        if tok is None:
+            raise IdlError('unexpected end of file')
+        self.pos += 1
+        return tok
+
+    def expect(self, tok):
+        got = self.next()
+        if got != tok:
+            raise IdlError('expected %r, got %r' % (tok, got))
+
+    def ident(self):
+        tok = self.next()
+        if not re.match(r'[A-Za-z_]\w*$', tok):
+            raise IdlError('expected a name, got %r' % tok)
+        return tok
+
+    def number(self):
+        tok = self.next()
+        if not re.match(r'(0[xX][0-9a-fA-F]+|\d+)$', tok):
+            raise IdlError('expected a number, got %r' % tok)
+        return int(tok, 0)
+
+    def field(self):
+        type_name = self.ident()
+        if type_name == 'bytes':
+            self.expect('<')
+            count = self.number()
+            self.expect('>')
+            return Field('uint8', self.ident(), count, True)
+        if type_name not in SCALARS and type_name not in self.structs:
+            raise IdlError('unknown type %r' % type_name)
+        name = self.ident()
+        count = None
+        if self.peek() == '[':
+            self.next()
+            count = self.number()
+            self.expect(']')
+        return Field(type_name, name, count)
+
+    def check_fields(self, fields, what, allow_var=True):
+        names = set()
+        for i, fld in enumerate(fields):
+            if fld.name in names:
+                raise IdlError('%s: duplicate field %r' % (what, fld.name))
+            names.add(fld.name)
+            if fld.count is not None and fld.count <= 0:
+                raise IdlError('%s: empty array %r' % (what, fld.name))
+            if fld.var and (not allow_var or i != len(fields) - 1):
+                raise IdlError('%s: bytes field %r must be the last param' %
+                               (what, fld.name))
+            if fld.var:
+                if fld.name + '_len' in names:
+                    raise IdlError('%s: field %r clashes with the length '
+                                   'of %r' % (what, fld.name + '_len',
+                                              fld.name))
+                if fld.count > 0xFFFFFFFF:
+                    raise IdlError('%s: bytes field %r too large' %
+                                   (what, fld.name))
+
+    def params(self):
+        self.expect('(')
+        fields = []
+        while self.peek() != ')':
+            if fields:
+                self.expect(',')
+            fields.append(self.field())
+        self.next()
+        return fields
+
+    def parse(self):
+        while self.peek() is not None:
+            tok = self.next()
+            if tok == 'service':
+                if self.service:
+                    raise IdlError('service defined twice')
+                self.service = self.ident()
+                if self.peek() == '=':
+                    self.next()
+                    self.base = self.number()
+                self.expect(';')
+            elif tok == 'struct':
+                name = self.ident()
+                if name in self.structs or name in SCALARS:
+                    raise IdlError('struct %r defined twice' % name)
+                self.expect('{')
+                fields = []
+                while self.peek() != '}':
+                    fields.append(self.field())
+                    self.expect(';')
+                self.next()
+                self.expect(';')
+                if not fields:
+                    raise IdlError('struct %r is empty' % name)
+                self.check_fields(fields, 'struct ' + name, False)
+                self.structs[name] = fields
+            elif tok in ('rpc', 'oneway'):
+                oneway = tok == 'oneway'
+                if oneway:
+                    self.expect('rpc')
+                name = self.ident()
+                self.expect('=')
+                offset = self.number()
+                ins = self.params()
+                outs = []
+                if not oneway:
+                    self.expect('->')
+                    outs = self.params()
+                self.expect(';')
+                self.check_fields(ins, 'rpc ' + name)
+                self.check_fields(outs, 'rpc ' + name)
+                for rpc in self.rpcs:
+                    if rpc.name == name:
+                        raise IdlError('rpc %r defined twice' % name)
+                    if rpc.offset == offset:
+                        raise IdlError('rpcs %r and %r share ID %d' %
+                                       (rpc.name, name, offset))
+                self.rpcs.append(Rpc(name, offset, ins, outs, oneway))
+            else:
+                raise IdlError('unexpected %r' % tok)
+        if not self.service:
+            raise IdlError('no service defined')
+        if not self.rpcs:
+            raise IdlError('no rpc defined')
+        for rpc in self.rpcs:
+            if self.base + rpc.offset > 0x7FFFFFFF:
+                raise IdlError('rpc %r: ID out of range' % rpc.name)
+
+
+class Generator:
+    """C stubs writer."""
+
+    def __init__(self, idl, source):
+        self.idl = idl
+        self.source = source
+        self.svc = idl.service
+        self.upper = idl.service.upper()
+
+    def ctype(self, type_name):
+        if type_name in SCALARS:
+            return SCALARS[type_name]
+        return 'struct %s_%s' % (self.svc, type_name)
+
+    def rpc_id(self, rpc):
+        return '%s_%s_ID' % (self.upper, rpc.name.upper())
+
+    def req(self, rpc):
+        return 'struct %s_%s_req' % (self.svc, rpc.name)
+
+    def resp(self, rpc):
+        return 'struct %s_%s_resp' % (self.svc, rpc.name)
+
+    def prefix(self, rpc):
+        return '%s_%s' % (self.svc, rpc.name)
+
+    @staticmethod
+    def var_field(fields):
+        return fields[-1] if fields and fields[-1].var else None
+
+    @staticmethod
+    def used_len(var, ptr):
+        """Length of params ending with a bytes field, as actually used."""
+        return 'sizeof(*%s) - sizeof(%s->%s) + %s->%s_len' % (
+            ptr, ptr, var.name, ptr, var.name)
+
+    @staticmethod
+    def banner(out, what):
+        out += ['/*', ' * ' + what, ' *',
+                ' * SPDX-License-Identifier: BSD-3-Clause', ' */', '']
+
+    @staticmethod
+    def comment(out, text):
+        line = '/** @brief %s */' % text
+        if len(line) <= 80:
+            out.append(line)
+            return
+        out.append('/**')
+        out += [' * ' + part for part in textwrap.wrap('@brief ' + text, 77)]
+        out.append(' */')
+
+    @staticmethod
+    def call(out, head, args, end):
+        """Write a call or a prototype, wrapping its args the kernel way."""
+        head += '('
+        width = len(head.expandtabs())
+        indent = '\t' * (width // 8) + ' ' * (width % 8)
+        line = head
+        fresh = True
+        for i, arg in enumerate(args):
+            arg += ',' if i < len(args) - 1 else ')' + end
+            if not fresh and len((line + ' ' + arg).expandtabs()) > 80:
+                out.append(line)
+                line = indent
+                fresh = True
+            line += arg if fresh else ' ' + arg
+            fresh = False
+        out.append(line)
+
+    def packed(self, out, name, fields, doc):
+        self.comment(out, doc)
+        out.append('METAL_PACKED_BEGIN')
+        out.append('%s {' % name)
+        for fld in fields:
+            if fld.var:
+                out.append('\tuint32_t %s_len;' % fld.name)
+            size = '[%d]' % fld.count if fld.count is not None else ''
+            out.append('\t%s %s%s;' % (self.ctype(fld.type_name), fld.name,
+                                       size))
+        out.append('} METAL_PACKED_END;')
+        out.append('')
+
+    def args(self, fields):
+        """Params of the stubs taking the request fields as arguments."""
+        args = []
+        for fld in fields:
+            ctype = self.ctype(fld.type_name)
+            if fld.var:
+                args.append('const void *%s' % fld.name)
+                args.append('uint32_t %s_len' % fld.name)
+            elif fld.count is not None:
+                args.append('const %s %s[%d]' % (ctype, fld.name, fld.count))
+            elif fld.type_name in SCALARS:
+                args.append('%s %s' % (ctype, fld.name))
+            else:
+                args.append('const %s *%s' % (ctype, fld.name))
+        return args
+
+    @staticmethod
+    def arg_names(fields):
+        names = []
+        for fld in fields:
+            names.append(fld.name)
+            if fld.var:
+                names.append(fld.name + '_len')
+        return names
+
+    def client_protos(self, rpc):
+        """Doc, return type, name and params of the client stubs of an rpc."""
+        pfx = self.prefix(rpc)
+        call = [] if rpc.oneway else ['struct rpmsg_rpc_call *call']
+        cb = [] if rpc.oneway else ['rpmsg_rpc_call_cb cb', 'void *priv']
+        protos = {}
+        if rpc.ins:
+            protos['alloc'] = (
+                'Get a tx buffer to build the request of %s in place' %
+                rpc.name, '%s *' % self.req(rpc), pfx + '_alloc',
+                ['struct rpmsg_rpc_clt *rpc', 'bool wait'])
+            protos['send'] = (
+                'Send the request of %s built in place, the buffer is '
+                'released on failure' % rpc.name, 'int ', pfx + '_send',
+                ['struct rpmsg_rpc_clt *rpc'] + call +
+                ['%s *req' % self.req(rpc)] + cb)
+        protos['call'] = (
+            'Build and send the request of %s' % rpc.name, 'int ',
+            pfx + '_call',
+            ['struct rpmsg_rpc_clt *rpc'] + call + self.args(rpc.ins) + cb)
+        if rpc.outs:
+            protos['decode'] = (
+                'Decode the answer of %s in place, in the completion '
+                'callback, NULL if malformed' % rpc.name,
+                'const %s *' % self.resp(rpc), pfx + '_decode',
+                ['const void *data', 'size_t len'])
+        if not rpc.oneway:
+            resp = ['%s *resp' % self.resp(rpc)] if rpc.outs else []
+            protos['sync'] = (
+                'Call %s and wait for its answer%s' %
+                (rpc.name, ', copied to resp' if rpc.outs else ''),
+                'int ', pfx,
+                ['struct rpmsg_rpc_clt *rpc', 'rpmsg_rpc_clt_poll poll',
+                 'void *poll_arg', 'uint32_t timeout_ms'] +
+                self.args(rpc.ins) + resp)
+        return protos
+
+    def impl_proto(self, rpc):
+        args = ['struct rpmsg_rpc_svr *rpcs']
+        if rpc.ins:
+            args.append('const %s *req' % self.req(rpc))
+        if rpc.outs:
+            args.append('%s *resp' % self.resp(rpc))
+        return 'int ' + self.prefix(rpc) + '_impl', args
+
+    def header(self):
+        out = []
+        guard = '%s_RPC_H' % self.upper
+        self.banner(out, 'Generated by rpmsg_rpc_stubgen.py from %s, do not '
+                    'edit.' % self.source)
+        out += ['#ifndef ' + guard, '#define ' + guard, '',
+                '#include <metal/compiler.h>',
+                '#include <openamp/rpmsg_rpc_client_server.h>',
+                '#include <stdbool.h>', '#include <stddef.h>',
+                '#include <stdint.h>', '',
+                '#if defined __cplusplus', 'extern "C" {', '#endif', '']
+        for rpc in self.idl.rpcs:
+            out.append('#define %s\t0x%xU' % (self.rpc_id(rpc),
+                                              self.idl.base + rpc.offset))
+        out.append('')
+        out.append('/* Number of entries of %s_services */' % self.svc)
+        out.append('#define %s_NUM_SERVICES\t%d' % (self.upper,
+                                                    len(self.idl.rpcs)))
+        out.append('')
+        out.append('/* Fails to compile if cond is false */')
+        out.append('#define %s_RPC_CHECK(name, cond) \\' % self.upper)
+        out.append('\ttypedef char %s_rpc_check_##name[(cond) ? 1 : -1]' %
+                   self.svc)
+        out.append('')
+
+        for name, fields in self.idl.structs.items():
+            self.packed(out, 'struct %s_%s' % (self.svc, name), fields,
+                        'Structure ' + name)
+        for rpc in self.idl.rpcs:
+            for fields, struct, what, limit in (
+                    (rpc.ins, self.req(rpc), 'req', 'REQ'),
+                    (rpc.outs, self.resp(rpc), 'resp', 'ANSWER')):
+                if not fields:
+                    continue
+                self.packed(out, struct, fields, '%s params of %s' %
+                            ('Request' if what == 'req' else 'Answer',
+                             rpc.name))
+                self.call(out, '%s_RPC_CHECK' % self.upper,
+                          ['%s_%s' % (rpc.name, what),
+                           'sizeof(%s) <= RPMSG_RPC_MAX_%s_PARAMS' %
+                           (struct, limit)], ';')
+                out.append('')
+
+        out.append('/* Client stubs */')
+        out.append('')
+        for rpc in self.idl.rpcs:
+            for doc, ret, name, args in self.client_protos(rpc).values():
+                self.comment(out, doc)
+                self.call(out, ret + name, args, ';')
+                out.append('')
+
+        out += ['/*',
+                ' * Server implementation, provided by the application. The',
+                ' * request is only valid during the call, the answer is',
+                ' * written in place in the tx buffer. The status returned is',
+                ' * sent to the client, with the answer params if it is not',
+                ' * negative.',
+                ' */']
+        for rpc in self.idl.rpcs:
+            self.call(out, *self.impl_proto(rpc), ';')
+        out.append('')
+        out.append('/* Service table to pass to rpmsg_rpc_server_init() */')
+        out.append('extern const struct rpmsg_rpc_services')
+        out.append('\t%s_services[%s_NUM_SERVICES];' % (self.svc, self.upper))
+        out += ['', '#if defined __cplusplus', '}', '#endif', '',
+                '#endif /* %s */' % guard]
+        return '\n'.join(out) + '\n'
+
+    def client_rpc(self, out, rpc):
+        pfx = self.prefix(rpc)
+        protos = self.client_protos(rpc)
+        call = ['NULL'] if rpc.oneway else ['call']
+        cb = ['NULL', 'NULL'] if rpc.oneway else ['cb', 'priv']
+        var = self.var_field(rpc.ins)
+
+        if rpc.ins:
+            _, ret, name, args = protos['alloc']
+            self.call(out, ret + name, args, '')
+            out.append('{')
+            self.call(out, '\treturn rpmsg_rpc_client_get_tx_params',
+                      ['rpc', 'sizeof(%s)' % self.req(rpc), 'wait'], ';')
+            out.append('}')
+            out.append('')
+
+            _, ret, name, args = protos['send']
+            self.call(out, ret + name, args, '')
+            out.append('{')
+            if var:
+                out.append('\tsize_t len;')
+                out.append('')
+                out.append('\tif (req->%s_len > sizeof(req->%s)) {' %
+                           (var.name, var.name))
+                out.append('\t\trpmsg_rpc_client_release_tx_params(rpc, '
+                           'req);')
+                out.append('\t\treturn -EMSGSIZE;')
+                out.append('\t}')
+                out.append('\tlen = %s;' % self.used_len(var, 'req'))
+                out.append('')
+            self.call(out, '\treturn rpmsg_rpc_client_call_nocopy',
+                      ['rpc'] + call + [self.rpc_id(rpc), 'req',
+                                        'len' if var else 'sizeof(*req)',
+                                        'NULL', '0'] + cb, ';')
+            out.append('}')
+            out.append('')
+
+        # Requests expecting an answer are built by a static helper, which
+        # the sync stub calls with a response buffer and no callback.
+        if rpc.oneway:
+            _, ret, name, args = protos['call']
+            self.call(out, ret + name, args, '')
+        else:
+            self.call(out, 'static int %s_start' % pfx,
+                      ['struct rpmsg_rpc_clt *rpc',
+                       'struct rpmsg_rpc_call *call'] +
+                      self.args(rpc.ins) +
+                      ['void *resp_buf', 'size_t resp_len',
+                       'rpmsg_rpc_call_cb cb', 'void *priv'], '')
+        out.append('{')
+        if rpc.ins:
+            out.append('\t%s *req;' % self.req(rpc))
+            if var and not rpc.oneway:
+                out.append('\tsize_t len;')
+            out.append('')
+            if var:
+                out.append('\tif (%s_len > sizeof(req->%s))' %
+                           (var.name, var.name))
+                out.append('\t\treturn -EMSGSIZE;')
+                out.append('')
+            out.append('\treq = %s_alloc(rpc, true);' % pfx)
+            out.append('\tif (!req)')
+            out.append('\t\treturn -ENOMEM;')
+            out.append('')
+            for fld in rpc.ins:
+                if fld.var:
+                    out.append('\treq->%s_len = %s_len;' % (fld.name,
+                                                            fld.name))
+                    out.append('\tmemcpy(req->%s, %s, %s_len);' %
+                               (fld.name, fld.name, fld.name))
+                elif fld.count is not None:
+                    out.append('\tmemcpy(req->%s, %s, sizeof(req->%s));' %
+                               (fld.name, fld.name, fld.name))
+                elif fld.type_name in SCALARS:
+                    out.append('\treq->%s = %s;' % (fld.name, fld.name))
+                else:
+                    out.append('\tmemcpy(&req->%s, %s, sizeof(req->%s));' %
+                               (fld.name, fld.name, fld.name))
+            out.append('')
+            if rpc.oneway:
+                self.call(out, '\treturn %s_send' % pfx, ['rpc', 'req'], ';')
+            else:
+                if var:
+                    out.append('\tlen = %s;' % self.used_len(var, 'req'))
+                self.call(out, '\treturn rpmsg_rpc_client_call_nocopy',
+                          ['rpc', 'call', self.rpc_id(rpc), 'req',
+                           'len' if var else 'sizeof(*req)',
+                           'resp_buf', 'resp_len', 'cb', 'priv'], ';')
+        else:
+            out.append('\tvoid *params;')
+            out.append('')
+            out.append('\tparams = rpmsg_rpc_client_get_tx_params(rpc, 0, '
+                       'true);')
+            out.append('\tif (!params)')
+            out.append('\t\treturn -ENOMEM;')
+            out.append('')
+            self.call(out, '\treturn rpmsg_rpc_client_call_nocopy',
+                      ['rpc'] + call + [self.rpc_id(rpc), 'params', '0'] +
+                      (['NULL', '0', 'NULL', 'NULL'] if rpc.oneway else
+                       ['resp_buf', 'resp_len', 'cb', 'priv']), ';')
+        out.append('}')
+        out.append('')
+
+        if rpc.oneway:
+            return
+
+        _, ret, name, args = protos['call']
+        self.call(out, ret + name, args, '')
+        out.append('{')
+        self.call(out, '\treturn %s_start' % pfx,
+                  ['rpc', 'call'] + self.arg_names(rpc.ins) +
+                  ['NULL', '0', 'cb', 'priv'], ';')
+        out.append('}')
+        out.append('')
+
+        var = self.var_field(rpc.outs)
+        if rpc.outs:
+            _, ret, name, args = protos['decode']
+            self.call(out, ret + name, args, '')
+            out.append('{')
+            out.append('\tconst %s *resp = data;' % self.resp(rpc))
+            out.append('')
+            if var:
+                out.append('\tif (!data || len < sizeof(*resp) - '
+                           'sizeof(resp->%s) ||' % var.name)
+                out.append('\t    resp->%s_len > sizeof(resp->%s) ||' %
+                           (var.name, var.name))
+                out.append('\t    len < %s)' % self.used_len(var, 'resp'))
+            else:
+                out.append('\tif (!data || len < sizeof(*resp))')
+            out.append('\t\treturn NULL;')
+            out.append('')
+            out.append('\treturn resp;')
+            out.append('}')
+            out.append('')
+
+        _, ret, name, args = protos['sync']
+        self.call(out, ret + name, args, '')
+        out.append('{')
+        out.append('\tstruct rpmsg_rpc_call call;')
+        out.append('\tint ret;')
+        out.append('')
+        resp = ['resp', 'sizeof(*resp)'] if rpc.outs else ['NULL', '0']
+        self.call(out, '\tret = %s_start' % pfx,
+                  ['rpc', '&call'] + self.arg_names(rpc.ins) + resp +
+                  ['NULL', 'NULL'], ';')
+        out.append('\tif (ret < 0)')
+        out.append('\t\treturn ret;')
+        out.append('')
+        if not rpc.outs:
+            out.append('\treturn rpmsg_rpc_client_wait(&call, poll, '
+                       'poll_arg, timeout_ms);')
+            out.append('}')
+            out.append('')
+            return
+        out.append('\tret = rpmsg_rpc_client_wait(&call, poll, poll_arg, '
+                   'timeout_ms);')
+        out.append('\tif (ret < 0)')
+        out.append('\t\treturn ret;')
+        out.append('')
+        out.append('\treturn %s_decode(resp, call.rx_off) ? ret : -EPROTO;'
+                   % pfx)
+        out.append('}')
+        out.append('')
+
+    def client(self):
+        out = []
+        self.banner(out, 'Client stubs generated by rpmsg_rpc_stubgen.py '
+                    'from %s, do not edit.' % self.source)
+        out += ['#include <errno.h>', '#include <string.h>', '',
+                '#include "%s_rpc.h"' % self.svc, '']
+        for rpc in self.idl.rpcs:
+            self.client_rpc(out, rpc)
+        return '\n'.join(out).rstrip('\n') + '\n'
+
+    def server_rpc(self, out, rpc):
+        pfx = self.prefix(rpc)
+        impl, _ = self.impl_proto(rpc)
+        impl = impl[len('int '):]
+        rpc_id = self.rpc_id(rpc)
+
+        out.append('static int %s_svc(void *data, struct rpmsg_rpc_svr '
+                   '*rpcs)' % pfx)
+        out.append('{')
+        if rpc.ins:
+            out.append('\tconst %s *req;' % self.req(rpc))
+        if rpc.outs:
+            out.append('\t%s *resp;' % self.resp(rpc))
+        if rpc.ins or rpc.outs:
+            out.append('\tsize_t len;')
+        out.append('\tint status;')
+        if not rpc.oneway:
+            out.append('\tint ret;')
+        out.append('')
+
+        var = self.var_field(rpc.ins)
+        brace = '' if rpc.oneway else ' {'
+        if rpc.ins:
+            out.append('\treq = (const void *)((struct rpmsg_rpc_req_hdr *)'
+                       'data + 1);')
+            out.append('\tlen = rpcs->len - sizeof(struct '
+                       'rpmsg_rpc_req_hdr);')
+            if var:
+                out.append('\tif (len < sizeof(*req) - sizeof(req->%s) ||' %
+                           var.name)
+                out.append('\t    req->%s_len > sizeof(req->%s) ||' %
+                           (var.name, var.name))
+                out.append('\t    len < %s)%s' %
+                           (self.used_len(var, 'req'), brace))
+            else:
+                out.append('\tif (len < sizeof(*req))%s' % brace)
+            if rpc.oneway:
+                out.append('\t\treturn -EPROTO;')
+            else:
+                self.call(out, '\t\tret = rpmsg_rpc_server_send',
+                          ['rpcs', rpc_id, '-EPROTO', 'NULL', '0'], ';')
+                out.append('\t\treturn ret < 0 ? ret : 0;')
+                out.append('\t}')
+        else:
+            out.append('\t(void)data;')
+        out.append('')
+
+        args = ['rpcs'] + (['req'] if rpc.ins else [])
+        if rpc.outs:
+            self.call(out, '\tresp = rpmsg_rpc_server_get_tx_params',
+                      ['rpcs', 'sizeof(*resp)', 'true'], ';')
+            out.append('\tif (!resp)')
+            out.append('\t\treturn -ENOMEM;')
+            out.append('')
+            self.call(out, '\tstatus = ' + impl, args + ['resp'], ';')
+            var = self.var_field(rpc.outs)
+            if var:
+                out.append('\tif (status >= 0 && resp->%s_len > '
+                           'sizeof(resp->%s))' % (var.name, var.name))
+                out.append('\t\tstatus = -EMSGSIZE;')
+            out.append('\tif (status < 0)')
+            out.append('\t\tlen = 0;')
+            out.append('\telse')
+            out.append('\t\tlen = %s;' % (self.used_len(var, 'resp') if var
+                                          else 'sizeof(*resp)'))
+            out.append('')
+            self.call(out, '\tret = rpmsg_rpc_server_send_nocopy',
+                      ['rpcs', rpc_id, 'status', 'resp', 'len'], ';')
+            out.append('\treturn ret < 0 ? ret : 0;')
+        elif rpc.oneway:
+            self.call(out, '\tstatus = ' + impl, args, ';')
+            out.append('\treturn status < 0 ? status : 0;')
+        else:
+            self.call(out, '\tstatus = ' + impl, args, ';')
+            self.call(out, '\tret = rpmsg_rpc_server_send',
+                      ['rpcs', rpc_id, 'status', 'NULL', '0'], ';')
+            out.append('\treturn ret < 0 ? ret : 0;')
+        out.append('}')
+        out.append('')
+
+    def server(self):
+        out = []
+        self.banner(out, 'Server stubs generated by rpmsg_rpc_stubgen.py '
+                    'from %s, do not edit.' % self.source)
+        out += ['#include <errno.h>', '',
+                '#include "%s_rpc.h"' % self.svc, '']
+        for rpc in self.idl.rpcs:
+            self.server_rpc(out, rpc)
+        out.append('const struct rpmsg_rpc_services')
+        out.append('%s_services[%s_NUM_SERVICES] = {' % (self.svc,
+                                                         self.upper))
+        for rpc in self.idl.rpcs:
+            out.append('\t{ %s, %s_svc },' % (self.rpc_id(rpc),
+                                              self.prefix(rpc)))
+        out.append('};')
+        return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('input', help='interface definition file')
+    parser.add_argument('-o', '--output-dir', default='.',
+                        help='directory of the generated files '
+                             '(default: current directory)')
+    args = parser.parse_args()
+
+    with open(args.input, encoding='utf-8') as f:
+        text = f.read()
+    try:
+        idl = Parser(text)
+        idl.parse()
+    except IdlError as err:
+        parser.error('%s: %s' % (args.input, err))
+
+    gen = Generator(idl, os.path.basename(args.input))
+    files = {'_rpc.h': gen.header(), '_rpc_client.c': gen.client(),
+             '_rpc_server.c': gen.server()}
+    for suffix, data in files.items():
+        path = os.path.join(args.output_dir, idl.service + suffix)
+        with open(path, 'w', encoding='utf-8') as f:
+            f.write(data)
+        print(path)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026, OpenAMP Project Contributors. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Compress a remoteproc firmware image for compressed_image_store_ops.
+
+The image is cut in blocks compressed on their own with the LZ4 block
+format, see struct compressed_image_header in
+lib/include/openamp/compressed_image_store.h. The python lz4 module is
+used when installed, a built-in (slower) compressor otherwise.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x315A5052
+HEADER = struct.Struct('<4I')
+
+# LZ4 block format constraints
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MF_LIMIT = 12
+MAX_OFFSET = 0xFFFF
+
+try:
+    import lz4.block as _lz4_block
+except ImportError:
+    _lz4_block = None
+
+
+def _put_len(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _put_seq(out, literals, offset=0, match_len=0):
+    lit_len = len(literals)
+    token = min(lit_len, 15) << 4
+    if offset:
+        token |= min(match_len - MIN_MATCH, 15)
+    out.append(token)
+    if lit_len >= 15:
+        _put_len(out, lit_len - 15)
+    out += literals
+    if offset:
+        out += struct.pack('<H', offset)
+        if match_len - MIN_MATCH >= 15:
+            _put_len(out, match_len - MIN_MATCH - 15)
+
+
+def lz4_compress_block(src):
+    """Greedy LZ4 block compression."""
+    if _lz4_block:
+        return _lz4_block.compress(bytes(src), store_size=False)
+
+    out = bytearray()
+    table = {}
+    end = len(src)
+    anchor = 0
+    i = 0
+    while i < end - MF_LIMIT:
+        key = src[i:i + MIN_MATCH]
+        ref = table.get(key)
+        table[key] = i
+        if ref is None or i - ref > MAX_OFFSET:
+            i += 1
+            continue
+        match_len = MIN_MATCH
+        max_len = end - LAST_LITERALS - i
+        while match_len < max_len and src[ref + match_len] == src[i + match_len]:
+            match_len += 1
+        _put_seq(out, src[anchor:i], i - ref, match_len)
+        i += match_len
+        anchor = i
+    _put_seq(out, src[anchor:])
+    return bytes(out)
+
+
+def compress_image(image, block_size):
+    blocks = []
+    for start in range(0, len(image), block_size):
+        raw = image[start:start + block_size]
+        packed = lz4_compress_block(raw)
+        # A block is stored as is when compression does not pay off
+        blocks.append(packed if len(packed) < len(raw) else raw)
+
+    offset = HEADER.size + 4 * (len(blocks) + 1)
+    offsets = [offset]
+    for block in blocks:
+        offset += len(block)
+        offsets.append(offset)
+    if offset > 0xFFFFFFFF:
+        raise ValueError('compressed image too large')
+
+    return b''.join([HEADER.pack(MAGIC, block_size, len(image), len(blocks)),
+                     struct.pack('<%dI' % len(offsets), *offsets)] + blocks)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('input', help='firmware image, e.g. an ELF file')
+    parser.add_argument('output', help='compressed image to write')
+    parser.add_argument('-b', '--block-size', type=int, default=32768,
+                        help='uncompressed block size, the scratch memory '
+                             'needed to load the image (default: 32768)')
+    args = parser.parse_args()
+
+    if args.block_size <= 0:
+        parser.error('block size must be positive')
+    with open(args.input, 'rb') as f:
+        image = f.read()
+    if not image:
+        parser.error('empty input image')
+
+    data = compress_image(image, args.block_size)
+    with open(args.output, 'wb') as f:
+        f.write(data)
+    print('%s: %d -> %d bytes (%.1f%%)' % (args.output, len(image), len(data),
+                                           100.0 * len(data) / len(image)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())